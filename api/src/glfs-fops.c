@@ -15,6 +15,7 @@
 #include "syncop.h"
 #include "glfs.h"
 #include "compat-errno.h"
+#include "compound-fop-utils.h"
 #include <limits.h>
 
 #ifdef NAME_MAX
@@ -91,7 +92,7 @@ glfs_open (struct glfs *fs, const char *path, int flags)
 		goto out;
 
 retry:
-	ret = glfs_resolve (fs, subvol, path, &loc, &iatt, reval);
+	ret = glfs_resolve_cached (fs, subvol, path, &loc, &iatt, reval);
 
 	ESTALE_RETRY (ret, errno, reval, &loc, retry);
 
@@ -546,6 +547,134 @@ glfs_pread (struct glfs_fd *glfd, void *buf, size_t count, off_t offset,
 }
 
 
+ssize_t
+glfs_read_file (struct glfs *fs, const char *path, void *buf, size_t count,
+		off_t offset)
+{
+	xlator_t         *subvol = NULL;
+	loc_t             loc = {0, };
+	struct iatt       iatt = {0, };
+	compound_args_t  *args = NULL;
+	compound_fop_t   *cfop = NULL;
+	fd_t             *fd = NULL;
+	struct iovec      iov = {0, };
+	ssize_t           ret = -1;
+	int               reval = 0;
+	gf_boolean_t      fallback = _gf_false;
+	struct glfs_fd   *glfd = NULL;
+
+	__glfs_entry_fs (fs);
+
+	subvol = glfs_active_subvol (fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+retry:
+	ret = glfs_resolve_cached (fs, subvol, path, &loc, &iatt, reval);
+
+	ESTALE_RETRY (ret, errno, reval, &loc, retry);
+
+	if (ret)
+		goto out;
+
+	if (IA_ISDIR (iatt.ia_type)) {
+		ret = -1;
+		errno = EISDIR;
+		goto out;
+	}
+
+	if (!IA_ISREG (iatt.ia_type)) {
+		ret = -1;
+		errno = EINVAL;
+		goto out;
+	}
+
+	if (args) {
+		/* Retry */
+		compound_args_destroy (args);
+		args = NULL;
+	}
+	if (fd) {
+		fd_unref (fd);
+		fd = NULL;
+	}
+
+	fd = fd_create (loc.inode, getpid());
+	args = compound_args_new (3);
+	if (!fd || !args) {
+		ret = -1;
+		errno = ENOMEM;
+		goto out;
+	}
+	fd->flags = O_RDONLY;
+
+	/* open, read and flush as one fop */
+	cfop = &args->fops[0];
+	cfop->fop = GF_FOP_OPEN;
+	cfop->fd = fd_ref (fd);
+	cfop->flags = O_RDONLY;
+	ret = loc_copy (&cfop->loc, &loc);
+	if (ret) {
+		ret = -1;
+		errno = ENOMEM;
+		goto out;
+	}
+
+	cfop = &args->fops[1];
+	cfop->fop = GF_FOP_READ;
+	cfop->fd = fd_ref (fd);
+	cfop->size = count;
+	cfop->offset = offset;
+
+	cfop = &args->fops[2];
+	cfop->fop = GF_FOP_FLUSH;
+	cfop->fd = fd_ref (fd);
+
+	ret = syncop_compound (subvol, args, NULL, NULL);
+        DECODE_SYNCOP_ERR (ret);
+
+	ESTALE_RETRY (ret, errno, reval, &loc, retry);
+
+	if (ret == -1 && errno == EAGAIN)
+		/* could not be run as one (e.g. the file is being
+		   migrated): do it fop by fop */
+		fallback = _gf_true;
+
+	if (ret)
+		goto out;
+
+	iov.iov_base = buf;
+	iov.iov_len = count;
+
+	cfop = &args->fops[1];
+	ret = iov_copy (&iov, 1, cfop->rsp.vector, cfop->rsp.count);
+out:
+	loc_wipe (&loc);
+
+	compound_args_destroy (args);
+
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (fs, subvol);
+
+	if (fallback) {
+		glfd = glfs_open (fs, path, O_RDONLY);
+		if (!glfd)
+			return -1;
+
+		ret = glfs_pread (glfd, buf, count, offset, 0);
+
+		glfs_close (glfd);
+	}
+
+	return ret;
+}
+
+
 ssize_t
 glfs_readv (struct glfs_fd *glfd, const struct iovec *iov, int count,
 	    int flags)
@@ -559,6 +688,7 @@ glfs_readv (struct glfs_fd *glfd, const struct iovec *iov, int count,
 
 
 struct glfs_io {
+	struct glfs         *fs;
 	struct glfs_fd      *glfd;
 	int                  op;
 	off_t                offset;
@@ -567,18 +697,56 @@ struct glfs_io {
 	int                  flags;
 	glfs_io_cbk          fn;
 	void                *data;
+	int                  op_errno;
+
+	/* for the calls on a path, done in a synctask */
+	char                *path;
+	mode_t               mode;
+	struct stat         *stat;
+	struct dirent       *dirent;
 };
 
 
+static struct glfs_io *
+glfs_io_new (struct glfs *fs, struct glfs_fd *glfd, int op, glfs_io_cbk fn,
+	     void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
+	if (!gio) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	gio->fs   = fs;
+	gio->glfd = glfd;
+	gio->op   = op;
+	gio->fn   = fn;
+	gio->data = data;
+
+	return gio;
+}
+
+
+static void
+glfs_io_free (struct glfs_io *gio)
+{
+	GF_FREE (gio->path);
+	GF_FREE (gio->iov);
+	GF_FREE (gio);
+}
+
+
 static int
 glfs_io_async_cbk (int ret, call_frame_t *frame, void *data)
 {
 	struct glfs_io  *gio = data;
 
+	errno = gio->op_errno;
 	gio->fn (gio->glfd, ret, gio->data);
 
-	GF_FREE (gio->iov);
-	GF_FREE (gio);
+	glfs_io_free (gio);
 
 	return 0;
 }
@@ -588,34 +756,277 @@ static int
 glfs_io_async_task (void *data)
 {
 	struct glfs_io *gio = data;
+	struct dirent  *res = NULL;
 	ssize_t         ret = 0;
 
 	switch (gio->op) {
-	case GF_FOP_WRITE:
-		ret = glfs_pwritev (gio->glfd, gio->iov, gio->count,
-				    gio->offset, gio->flags);
-		break;
-	case GF_FOP_FTRUNCATE:
-		ret = glfs_ftruncate (gio->glfd, gio->offset);
-		break;
-	case GF_FOP_FSYNC:
+	case GF_FOP_STAT:
 		if (gio->flags)
-			ret = glfs_fdatasync (gio->glfd);
+			ret = glfs_lstat (gio->fs, gio->path, gio->stat);
 		else
-			ret = glfs_fsync (gio->glfd);
+			ret = glfs_stat (gio->fs, gio->path, gio->stat);
+		break;
+	case GF_FOP_OPEN:
+		gio->glfd = glfs_open (gio->fs, gio->path, gio->flags);
+		ret = gio->glfd ? 0 : -1;
+		break;
+	case GF_FOP_CREATE:
+		gio->glfd = glfs_creat (gio->fs, gio->path, gio->flags,
+					gio->mode);
+		ret = gio->glfd ? 0 : -1;
+		break;
+	case GF_FOP_OPENDIR:
+		gio->glfd = glfs_opendir (gio->fs, gio->path);
+		ret = gio->glfd ? 0 : -1;
 		break;
-	case GF_FOP_DISCARD:
-		ret = glfs_discard (gio->glfd, gio->offset, gio->count);
+	case GF_FOP_MKDIR:
+		ret = glfs_mkdir (gio->fs, gio->path, gio->mode);
+		break;
+	case GF_FOP_UNLINK:
+		ret = glfs_unlink (gio->fs, gio->path);
+		break;
+	case GF_FOP_READDIRP:
+		ret = glfs_readdirplus_r (gio->glfd, gio->stat, gio->dirent,
+					  &res);
+		if (ret == 0)
+			ret = res ? 1 : 0;
 		break;
-        case GF_FOP_ZEROFILL:
-                ret = glfs_zerofill(gio->glfd, gio->offset, gio->count);
-                break;
 	}
 
+	if (ret < 0)
+		gio->op_errno = errno;
+
 	return (int) ret;
 }
 
 
+/* Calls on a path have to resolve it first, which is done with syncops:
+   they are run in a synctask. */
+static int
+glfs_path_async (struct glfs_io *gio, const char *path)
+{
+	int ret = -1;
+
+	if (path) {
+		gio->path = gf_strdup (path);
+		if (!gio->path) {
+			glfs_io_free (gio);
+			errno = ENOMEM;
+			return -1;
+		}
+	}
+
+	ret = synctask_new (gio->fs->ctx->env, glfs_io_async_task,
+			    glfs_io_async_cbk, NULL, gio);
+	if (ret)
+		glfs_io_free (gio);
+
+	return ret;
+}
+
+
+int
+glfs_stat_async (struct glfs *fs, const char *path, struct stat *stat,
+		 glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_STAT, fn, data);
+	if (!gio)
+		return -1;
+	gio->stat = stat;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_lstat_async (struct glfs *fs, const char *path, struct stat *stat,
+		  glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_STAT, fn, data);
+	if (!gio)
+		return -1;
+	gio->stat = stat;
+	gio->flags = 1;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_open_async (struct glfs *fs, const char *path, int flags,
+		 glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_OPEN, fn, data);
+	if (!gio)
+		return -1;
+	gio->flags = flags;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_creat_async (struct glfs *fs, const char *path, int flags, mode_t mode,
+		  glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_CREATE, fn, data);
+	if (!gio)
+		return -1;
+	gio->flags = flags;
+	gio->mode = mode;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_opendir_async (struct glfs *fs, const char *path,
+		    glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_OPENDIR, fn, data);
+	if (!gio)
+		return -1;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_mkdir_async (struct glfs *fs, const char *path, mode_t mode,
+		  glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_MKDIR, fn, data);
+	if (!gio)
+		return -1;
+	gio->mode = mode;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_unlink_async (struct glfs *fs, const char *path,
+		   glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fs (fs);
+
+	gio = glfs_io_new (fs, NULL, GF_FOP_UNLINK, fn, data);
+	if (!gio)
+		return -1;
+
+	return glfs_path_async (gio, path);
+}
+
+
+int
+glfs_readdirplus_async (struct glfs_fd *glfd, struct stat *stat,
+			struct dirent *dirent, glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_READDIRP, fn, data);
+	if (!gio)
+		return -1;
+	gio->stat = stat;
+	gio->dirent = dirent;
+
+	/* refills of the entries cached in @glfd are syncops */
+	return glfs_path_async (gio, NULL);
+}
+
+
+/* The calls on an fd are wound straight to the graph: @fn is called from
+   the thread the fop unwinds in, no synctask is involved. */
+static int
+glfs_io_wind_prepare (struct glfs_io *gio, xlator_t **subvol_p, fd_t **fd_p,
+		      call_frame_t **frame_p)
+{
+	xlator_t     *subvol = NULL;
+	fd_t         *fd = NULL;
+	call_frame_t *frame = NULL;
+
+	subvol = glfs_active_subvol (gio->fs);
+	if (!subvol) {
+		errno = EIO;
+		goto err;
+	}
+
+	fd = glfs_resolve_fd (gio->fs, subvol, gio->glfd);
+	if (!fd) {
+		errno = EBADFD;
+		goto err;
+	}
+
+	frame = syncop_create_frame (THIS);
+	if (!frame) {
+		errno = ENOMEM;
+		goto err;
+	}
+
+	frame->local = gio;
+
+	*subvol_p = subvol;
+	*fd_p = fd;
+	*frame_p = frame;
+	return 0;
+err:
+	if (fd)
+		fd_unref (fd);
+	glfs_subvol_done (gio->fs, subvol);
+	return -1;
+}
+
+
+static int
+glfs_io_wind_done (call_frame_t *frame, xlator_t *subvol, int op_ret,
+		   int op_errno)
+{
+	struct glfs_io *gio = NULL;
+	struct glfs    *fs = NULL;
+
+	gio = frame->local;
+	frame->local = NULL;
+	fs = gio->fs;
+
+	errno = op_errno;
+	gio->fn (gio->glfd, op_ret, gio->data);
+
+	glfs_io_free (gio);
+	STACK_DESTROY (frame->root);
+	glfs_subvol_done (fs, subvol);
+
+	return 0;
+}
+
+
 int
 glfs_preadv_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 		       int op_ret, int op_errno, struct iovec *iovec,
@@ -779,6 +1190,120 @@ glfs_readv_async (struct glfs_fd *glfd, const struct iovec *iov, int count,
 	return ret;
 }
 
+int
+glfs_rbuf_iov (struct glfs_rbuf *buf, const struct iovec **iov)
+{
+	*iov = buf->iov;
+
+	return buf->count;
+}
+
+
+struct glfs_rbuf *
+glfs_rbuf_ref (struct glfs_rbuf *buf)
+{
+	LOCK (&buf->lock);
+	{
+		buf->ref++;
+	}
+	UNLOCK (&buf->lock);
+
+	return buf;
+}
+
+
+void
+glfs_rbuf_unref (struct glfs_rbuf *buf)
+{
+	int ref = 0;
+
+	LOCK (&buf->lock);
+	{
+		ref = --buf->ref;
+	}
+	UNLOCK (&buf->lock);
+
+	if (ref)
+		return;
+
+	iobref_unref (buf->iobref);
+	GF_FREE (buf->iov);
+	LOCK_DESTROY (&buf->lock);
+	GF_FREE (buf);
+}
+
+
+ssize_t
+glfs_preadv_buf (struct glfs_fd *glfd, size_t size, off_t offset, int flags,
+		 struct glfs_rbuf **buf)
+{
+	xlator_t         *subvol = NULL;
+	ssize_t           ret = -1;
+	struct iovec     *iov = NULL;
+	int               cnt = 0;
+	struct iobref    *iobref = NULL;
+	struct glfs_rbuf *rbuf = NULL;
+	fd_t             *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	if (!buf) {
+		errno = EINVAL;
+		return -1;
+	}
+	*buf = NULL;
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	ret = syncop_readv (subvol, fd, size, offset, 0, &iov, &cnt, &iobref);
+        DECODE_SYNCOP_ERR (ret);
+	if (ret <= 0)
+		goto out;
+
+	rbuf = GF_CALLOC (1, sizeof (*rbuf), glfs_mt_rbuf_t);
+	if (!rbuf) {
+		ret = -1;
+		errno = ENOMEM;
+		goto out;
+	}
+
+	/* handed over as they are, instead of copied out */
+	LOCK_INIT (&rbuf->lock);
+	rbuf->ref = 1;
+	rbuf->iov = iov;
+	rbuf->count = cnt;
+	rbuf->iobref = iobref;
+	iov = NULL;
+	iobref = NULL;
+
+	glfd->offset = (offset + ret);
+	*buf = rbuf;
+out:
+        if (iov)
+                GF_FREE (iov);
+        if (iobref)
+                iobref_unref (iobref);
+
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+
+	return ret;
+}
+
 ///// writev /////
 
 ssize_t
@@ -811,52 +1336,287 @@ glfs_pwritev (struct glfs_fd *glfd, const struct iovec *iovec, int iovcnt,
 
 	size = iov_length (iovec, iovcnt);
 
-	iobuf = iobuf_get2 (subvol->ctx->iobuf_pool, size);
-	if (!iobuf) {
-		ret = -1;
-		errno = ENOMEM;
-		goto out;
-	}
-
+	iobuf = iobuf_get2 (subvol->ctx->iobuf_pool, size);
+	if (!iobuf) {
+		ret = -1;
+		errno = ENOMEM;
+		goto out;
+	}
+
+	iobref = iobref_new ();
+	if (!iobref) {
+		iobuf_unref (iobuf);
+		errno = ENOMEM;
+		ret = -1;
+		goto out;
+	}
+
+	ret = iobref_add (iobref, iobuf);
+	if (ret) {
+		iobuf_unref (iobuf);
+		iobref_unref (iobref);
+		errno = ENOMEM;
+		ret = -1;
+		goto out;
+	}
+
+	iov_unload (iobuf_ptr (iobuf), iovec, iovcnt);  /* FIXME!!! */
+
+	iov.iov_base = iobuf_ptr (iobuf);
+	iov.iov_len = size;
+
+	ret = syncop_writev (subvol, fd, &iov, 1, offset, iobref, flags);
+        DECODE_SYNCOP_ERR (ret);
+
+	iobuf_unref (iobuf);
+	iobref_unref (iobref);
+
+	if (ret <= 0)
+		goto out;
+
+	glfd->offset = (offset + size);
+
+out:
+	if (fd)
+		fd_unref (fd);
+
+	glfs_subvol_done (glfd->fs, subvol);
+
+	return ret;
+}
+
+
+int
+glfs_buf_register (struct glfs *fs, void *base, size_t size)
+{
+	struct glfs_buf_region *region = NULL;
+	struct glfs_buf_region *tmp = NULL;
+	int                     ret = -1;
+
+	__glfs_entry_fs (fs);
+
+	if (!base || !size) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	region = GF_CALLOC (1, sizeof (*region), glfs_mt_buf_region_t);
+	if (!region) {
+		errno = ENOMEM;
+		return -1;
+	}
+	region->base = base;
+	region->size = size;
+
+	LOCK (&fs->buf_lock);
+	{
+		list_for_each_entry (tmp, &fs->buf_regions, list) {
+			if ((region->base < tmp->base + tmp->size) &&
+			    (tmp->base < region->base + region->size))
+				goto unlock;
+		}
+		list_add_tail (&region->list, &fs->buf_regions);
+		ret = 0;
+	}
+unlock:
+	UNLOCK (&fs->buf_lock);
+
+	if (ret) {
+		GF_FREE (region);
+		errno = EEXIST;
+	}
+
+	return ret;
+}
+
+
+int
+glfs_buf_unregister (struct glfs *fs, void *base)
+{
+	struct glfs_buf_region *region = NULL;
+	struct glfs_buf_region *tmp = NULL;
+	int                     op_errno = ENOENT;
+
+	__glfs_entry_fs (fs);
+
+	LOCK (&fs->buf_lock);
+	{
+		list_for_each_entry (tmp, &fs->buf_regions, list) {
+			if (tmp->base != base)
+				continue;
+			if (tmp->inflight) {
+				op_errno = EBUSY;
+			} else {
+				list_del_init (&tmp->list);
+				region = tmp;
+			}
+			break;
+		}
+	}
+	UNLOCK (&fs->buf_lock);
+
+	if (!region) {
+		errno = op_errno;
+		return -1;
+	}
+
+	GF_FREE (region);
+	return 0;
+}
+
+
+/* the region all of @iov lies within, with a write accounted to it */
+static struct glfs_buf_region *
+glfs_buf_region_get (struct glfs *fs, const struct iovec *iov, int iovcnt)
+{
+	struct glfs_buf_region *region = NULL;
+	struct glfs_buf_region *tmp = NULL;
+	char                   *start = NULL;
+	int                     i = 0;
+
+	LOCK (&fs->buf_lock);
+	{
+		list_for_each_entry (tmp, &fs->buf_regions, list) {
+			for (i = 0; i < iovcnt; i++) {
+				start = iov[i].iov_base;
+				if ((start < tmp->base) ||
+				    (start + iov[i].iov_len >
+				     tmp->base + tmp->size))
+					break;
+			}
+			if (i == iovcnt) {
+				region = tmp;
+				region->inflight++;
+				break;
+			}
+		}
+	}
+	UNLOCK (&fs->buf_lock);
+
+	return region;
+}
+
+
+static void
+glfs_wbuf_release (void *ptr, void *data)
+{
+	struct glfs_wbuf *wbuf = NULL;
+
+	wbuf = data;
+
+	/* told before the region can be unregistered */
+	wbuf->fn (wbuf->data);
+
+	LOCK (&wbuf->fs->buf_lock);
+	{
+		wbuf->region->inflight--;
+	}
+	UNLOCK (&wbuf->fs->buf_lock);
+
+	GF_FREE (wbuf);
+}
+
+
+ssize_t
+glfs_pwritev_registered (struct glfs_fd *glfd, const struct iovec *iovec,
+			 int iovcnt, off_t offset, int flags,
+			 glfs_buf_release_cbk fn, void *data)
+{
+	xlator_t         *subvol = NULL;
+	ssize_t           ret = -1;
+	int               op_errno = 0;
+	size_t            size = 0;
+	struct iobref    *iobref = NULL;
+	struct iobuf     *iobuf = NULL;
+	struct glfs_wbuf *wbuf = NULL;
+	fd_t             *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	if (!fn || iovcnt <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	wbuf = GF_CALLOC (1, sizeof (*wbuf), glfs_mt_wbuf_t);
+	if (!wbuf) {
+		errno = ENOMEM;
+		return -1;
+	}
+	wbuf->fs = glfd->fs;
+	wbuf->fn = fn;
+	wbuf->data = data;
+
+	wbuf->region = glfs_buf_region_get (glfd->fs, iovec, iovcnt);
+	if (!wbuf->region) {
+		GF_FREE (wbuf);
+
+		ret = glfs_pwritev (glfd, iovec, iovcnt, offset, flags);
+		op_errno = errno;
+		fn (data);
+		errno = op_errno;
+
+		return ret;
+	}
+
+	/* from here on, @fn is called when the last ref of the iobuf goes */
+	iobuf = iobuf_wrap (glfd->fs->ctx->iobuf_pool, iovec[0].iov_base,
+			    glfs_wbuf_release, wbuf);
+	if (!iobuf) {
+		glfs_wbuf_release (NULL, wbuf);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	subvol = glfs_active_subvol (glfd->fs);
+	if (!subvol) {
+		ret = -1;
+		errno = EIO;
+		goto out;
+	}
+
+	fd = glfs_resolve_fd (glfd->fs, subvol, glfd);
+	if (!fd) {
+		ret = -1;
+		errno = EBADFD;
+		goto out;
+	}
+
+	size = iov_length (iovec, iovcnt);
+
 	iobref = iobref_new ();
 	if (!iobref) {
-		iobuf_unref (iobuf);
-		errno = ENOMEM;
 		ret = -1;
+		errno = ENOMEM;
 		goto out;
 	}
 
 	ret = iobref_add (iobref, iobuf);
 	if (ret) {
-		iobuf_unref (iobuf);
-		iobref_unref (iobref);
-		errno = ENOMEM;
 		ret = -1;
+		errno = ENOMEM;
 		goto out;
 	}
 
-	iov_unload (iobuf_ptr (iobuf), iovec, iovcnt);  /* FIXME!!! */
-
-	iov.iov_base = iobuf_ptr (iobuf);
-	iov.iov_len = size;
-
-	ret = syncop_writev (subvol, fd, &iov, 1, offset, iobref, flags);
+	ret = syncop_writev (subvol, fd, iovec, iovcnt, offset, iobref, flags);
         DECODE_SYNCOP_ERR (ret);
-
-	iobuf_unref (iobuf);
-	iobref_unref (iobref);
-
 	if (ret <= 0)
 		goto out;
 
 	glfd->offset = (offset + size);
-
 out:
+	op_errno = errno;
+
+	if (iobref)
+		iobref_unref (iobref);
+	iobuf_unref (iobuf);
+
 	if (fd)
 		fd_unref (fd);
 
 	glfs_subvol_done (glfd->fs, subvol);
 
+	errno = op_errno;
 	return ret;
 }
 
@@ -905,42 +1665,83 @@ glfs_pwrite (struct glfs_fd *glfd, const void *buf, size_t count, off_t offset,
 }
 
 
+int
+glfs_pwritev_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+			int op_ret, int op_errno, struct iatt *prebuf,
+			struct iatt *postbuf, dict_t *xdata)
+{
+	struct glfs_io *gio = NULL;
+
+	gio = frame->local;
+	if (op_ret > 0)
+		gio->glfd->offset = gio->offset + op_ret;
+
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
+}
+
+
 int
 glfs_pwritev_async (struct glfs_fd *glfd, const struct iovec *iovec, int count,
 		    off_t offset, int flags, glfs_io_cbk fn, void *data)
 {
 	struct glfs_io *gio = NULL;
-	int             ret = 0;
+	int             ret = -1;
+	size_t          size = 0;
+	struct iobref  *iobref = NULL;
+	struct iobuf   *iobuf = NULL;
+	struct iovec    iov = {0, };
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
 
-	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
-	if (!gio) {
-		errno = ENOMEM;
+	__glfs_entry_fd (glfd);
+
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_WRITE, fn, data);
+	if (!gio)
 		return -1;
+	gio->offset = offset;
+
+	size = iov_length (iovec, count);
+
+	iobuf = iobuf_get2 (glfd->fs->ctx->iobuf_pool, size);
+	if (!iobuf) {
+		errno = ENOMEM;
+		goto out;
 	}
 
-	gio->iov = iov_dup (iovec, count);
-	if (!gio->iov) {
-		GF_FREE (gio);
+	iobref = iobref_new ();
+	if (!iobref) {
 		errno = ENOMEM;
-		return -1;
+		goto out;
 	}
 
-	gio->op     = GF_FOP_WRITE;
-	gio->glfd   = glfd;
-	gio->count  = count;
-	gio->offset = offset;
-	gio->flags  = flags;
-	gio->fn     = fn;
-	gio->data   = data;
+	if (iobref_add (iobref, iobuf)) {
+		errno = ENOMEM;
+		goto out;
+	}
 
-	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
-			    glfs_io_async_task, glfs_io_async_cbk,
-			    NULL, gio);
+	/* copied, the caller may reuse @iovec as soon as we return */
+	iov_unload (iobuf_ptr (iobuf), iovec, count);
 
-	if (ret) {
-		GF_FREE (gio->iov);
-		GF_FREE (gio);
-	}
+	iov.iov_base = iobuf_ptr (iobuf);
+	iov.iov_len = size;
+
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame))
+		goto out;
+
+	STACK_WIND_COOKIE (frame, glfs_pwritev_async_cbk, subvol, subvol,
+			   subvol->fops->writev, fd, &iov, 1, offset, flags,
+			   iobref, NULL);
+	ret = 0;
+out:
+	if (iobuf)
+		iobuf_unref (iobuf);
+	if (iobref)
+		iobref_unref (iobref);
+	if (fd)
+		fd_unref (fd);
+	if (ret)
+		glfs_io_free (gio);
 
 	return ret;
 }
@@ -1025,36 +1826,41 @@ out:
 }
 
 
+int
+glfs_fsync_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+		      int op_ret, int op_errno, struct iatt *prebuf,
+		      struct iatt *postbuf, dict_t *xdata)
+{
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
+}
+
+
 static int
 glfs_fsync_async_common (struct glfs_fd *glfd, glfs_io_cbk fn, void *data,
 			 int dataonly)
 {
 	struct glfs_io *gio = NULL;
-	int             ret = 0;
-
-	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
-	if (!gio) {
-		errno = ENOMEM;
-		return -1;
-	}
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
 
-	gio->op     = GF_FOP_FSYNC;
-	gio->glfd   = glfd;
-	gio->flags  = dataonly;
-	gio->fn     = fn;
-	gio->data   = data;
+	__glfs_entry_fd (glfd);
 
-	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
-			    glfs_io_async_task, glfs_io_async_cbk,
-			    NULL, gio);
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_FSYNC, fn, data);
+	if (!gio)
+		return -1;
 
-	if (ret) {
-		GF_FREE (gio->iov);
-		GF_FREE (gio);
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame)) {
+		glfs_io_free (gio);
+		return -1;
 	}
 
-	return ret;
+	STACK_WIND_COOKIE (frame, glfs_fsync_async_cbk, subvol, subvol,
+			   subvol->fops->fsync, fd, dataonly, NULL);
 
+	fd_unref (fd);
+
+	return 0;
 }
 
 
@@ -1142,35 +1948,86 @@ out:
 }
 
 
+int
+glfs_ftruncate_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+			  int op_ret, int op_errno, struct iatt *prebuf,
+			  struct iatt *postbuf, dict_t *xdata)
+{
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
+}
+
+
 int
 glfs_ftruncate_async (struct glfs_fd *glfd, off_t offset,
 		      glfs_io_cbk fn, void *data)
 {
 	struct glfs_io *gio = NULL;
-	int             ret = 0;
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
 
-	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
-	if (!gio) {
-		errno = ENOMEM;
+	__glfs_entry_fd (glfd);
+
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_FTRUNCATE, fn, data);
+	if (!gio)
+		return -1;
+
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame)) {
+		glfs_io_free (gio);
 		return -1;
 	}
 
-	gio->op     = GF_FOP_FTRUNCATE;
-	gio->glfd   = glfd;
-	gio->offset = offset;
-	gio->fn     = fn;
-	gio->data   = data;
+	STACK_WIND_COOKIE (frame, glfs_ftruncate_async_cbk, subvol, subvol,
+			   subvol->fops->ftruncate, fd, offset, NULL);
 
-	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
-			    glfs_io_async_task, glfs_io_async_cbk,
-			    NULL, gio);
+	fd_unref (fd);
 
-	if (ret) {
-		GF_FREE (gio->iov);
-		GF_FREE (gio);
+	return 0;
+}
+
+
+int
+glfs_fstat_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+		      int op_ret, int op_errno, struct iatt *buf,
+		      dict_t *xdata)
+{
+	struct glfs_io *gio = NULL;
+
+	gio = frame->local;
+	if (op_ret == 0 && gio->stat)
+		glfs_iatt_to_stat (gio->fs, buf, gio->stat);
+
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
+}
+
+
+int
+glfs_fstat_async (struct glfs_fd *glfd, struct stat *stat,
+		  glfs_io_cbk fn, void *data)
+{
+	struct glfs_io *gio = NULL;
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
+
+	__glfs_entry_fd (glfd);
+
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_FSTAT, fn, data);
+	if (!gio)
+		return -1;
+	gio->stat = stat;
+
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame)) {
+		glfs_io_free (gio);
+		return -1;
 	}
 
-	return ret;
+	STACK_WIND_COOKIE (frame, glfs_fstat_async_cbk, subvol, subvol,
+			   subvol->fops->fstat, fd, NULL);
+
+	fd_unref (fd);
+
+	return 0;
 }
 
 
@@ -1774,7 +2631,7 @@ glfs_opendir (struct glfs *fs, const char *path)
 
 	INIT_LIST_HEAD (&glfd->entries);
 retry:
-	ret = glfs_resolve (fs, subvol, path, &loc, &iatt, reval);
+	ret = glfs_resolve_cached (fs, subvol, path, &loc, &iatt, reval);
 
 	ESTALE_RETRY (ret, errno, reval, &loc, retry);
 
@@ -1870,68 +2727,79 @@ glfs_seekdir (struct glfs_fd *fd, long offset)
 	*/
 }
 
+int
+glfs_discard_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+			int op_ret, int op_errno, struct iatt *preop,
+			struct iatt *postop, dict_t *xdata)
+{
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
+}
+
+
 int
 glfs_discard_async (struct glfs_fd *glfd, off_t offset, size_t len,
 		      glfs_io_cbk fn, void *data)
 {
 	struct glfs_io *gio = NULL;
-	int             ret = 0;
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
 
-	gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
-	if (!gio) {
-		errno = ENOMEM;
+	__glfs_entry_fd (glfd);
+
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_DISCARD, fn, data);
+	if (!gio)
+		return -1;
+
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame)) {
+		glfs_io_free (gio);
 		return -1;
 	}
 
-	gio->op     = GF_FOP_DISCARD;
-	gio->glfd   = glfd;
-	gio->offset = offset;
-	gio->count  = len;
-	gio->fn     = fn;
-	gio->data   = data;
+	STACK_WIND_COOKIE (frame, glfs_discard_async_cbk, subvol, subvol,
+			   subvol->fops->discard, fd, offset, len, NULL);
 
-	ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
-			    glfs_io_async_task, glfs_io_async_cbk,
-			    NULL, gio);
+	fd_unref (fd);
 
-	if (ret) {
-		GF_FREE (gio->iov);
-		GF_FREE (gio);
-	}
+	return 0;
+}
 
-	return ret;
+
+int
+glfs_zerofill_async_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+			 int op_ret, int op_errno, struct iatt *preop,
+			 struct iatt *postop, dict_t *xdata)
+{
+	return glfs_io_wind_done (frame, cookie, op_ret, op_errno);
 }
 
+
 int
 glfs_zerofill_async (struct glfs_fd *glfd, off_t offset, off_t len,
                       glfs_io_cbk fn, void *data)
 {
-        struct glfs_io *gio  = NULL;
-        int             ret  = 0;
+	struct glfs_io *gio = NULL;
+	call_frame_t   *frame = NULL;
+	xlator_t       *subvol = NULL;
+	fd_t           *fd = NULL;
 
-        gio = GF_CALLOC (1, sizeof (*gio), glfs_mt_glfs_io_t);
-        if (!gio) {
-                errno = ENOMEM;
-                return -1;
-        }
+	__glfs_entry_fd (glfd);
 
-        gio->op     = GF_FOP_ZEROFILL;
-        gio->glfd   = glfd;
-        gio->offset = offset;
-        gio->count  = len;
-        gio->fn     = fn;
-        gio->data   = data;
+	gio = glfs_io_new (glfd->fs, glfd, GF_FOP_ZEROFILL, fn, data);
+	if (!gio)
+		return -1;
 
-        ret = synctask_new (glfs_from_glfd (glfd)->ctx->env,
-                            glfs_io_async_task, glfs_io_async_cbk,
-                            NULL, gio);
+	if (glfs_io_wind_prepare (gio, &subvol, &fd, &frame)) {
+		glfs_io_free (gio);
+		return -1;
+	}
 
-        if (ret) {
-                GF_FREE (gio->iov);
-                GF_FREE (gio);
-        }
+	STACK_WIND_COOKIE (frame, glfs_zerofill_async_cbk, subvol, subvol,
+			   subvol->fops->zerofill, fd, offset, len, NULL);
 
-        return ret;
+	fd_unref (fd);
+
+	return 0;
 }
 
 
@@ -3317,3 +4185,109 @@ out:
 
 	return dupfd;
 }
+
+
+/* completion queues */
+
+glfs_cq_t *
+glfs_cq_new (struct glfs *fs)
+{
+	struct glfs_cq *cq = NULL;
+
+	__glfs_entry_fs (fs);
+
+	cq = GF_CALLOC (1, sizeof (*cq), glfs_mt_cq_t);
+	if (!cq) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	if (pipe (cq->pipe) < 0) {
+		GF_FREE (cq);
+		return NULL;
+	}
+
+	fcntl (cq->pipe[0], F_SETFL, O_NONBLOCK);
+	fcntl (cq->pipe[1], F_SETFL, O_NONBLOCK);
+	fcntl (cq->pipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl (cq->pipe[1], F_SETFD, FD_CLOEXEC);
+
+	pthread_mutex_init (&cq->mutex, NULL);
+	cq->fs = fs;
+
+	return cq;
+}
+
+
+int
+glfs_cq_fd (struct glfs_cq *cq)
+{
+	return cq->pipe[0];
+}
+
+
+/* The pipe holds one byte as long as entries are queued: it is written
+   and drained under cq->mutex, so that no wakeup gets lost. */
+void
+glfs_cq_cbk (struct glfs_fd *glfd, ssize_t ret, void *data)
+{
+	struct glfs_cq_entry *entry = NULL;
+	struct glfs_cq       *cq = NULL;
+	char                  c = 0;
+
+	entry = data;
+	cq = entry->cq;
+
+	entry->fd = glfd;
+	entry->ret = ret;
+	entry->err = (ret < 0) ? errno : 0;
+	entry->next = NULL;
+
+	pthread_mutex_lock (&cq->mutex);
+	{
+		if (cq->tail)
+			cq->tail->next = entry;
+		else
+			cq->head = entry;
+		cq->tail = entry;
+
+		if (!cq->signalled && (write (cq->pipe[1], &c, 1) == 1))
+			cq->signalled = _gf_true;
+	}
+	pthread_mutex_unlock (&cq->mutex);
+}
+
+
+int
+glfs_cq_reap (struct glfs_cq *cq, struct glfs_cq_entry **entries, int max)
+{
+	int  count = 0;
+	char c = 0;
+
+	pthread_mutex_lock (&cq->mutex);
+	{
+		while (cq->head && (count < max)) {
+			entries[count++] = cq->head;
+			cq->head = cq->head->next;
+		}
+
+		if (!cq->head) {
+			cq->tail = NULL;
+			if (cq->signalled && (read (cq->pipe[0], &c, 1) == 1))
+				cq->signalled = _gf_false;
+		}
+	}
+	pthread_mutex_unlock (&cq->mutex);
+
+	return count;
+}
+
+
+void
+glfs_cq_destroy (struct glfs_cq *cq)
+{
+	close (cq->pipe[0]);
+	close (cq->pipe[1]);
+	pthread_mutex_destroy (&cq->mutex);
+	GF_FREE (cq);
+}
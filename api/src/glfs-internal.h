@@ -107,6 +107,46 @@ struct glfs {
 	struct list_head    openfds;
 
 	gf_boolean_t        migration_in_progress;
+
+	gf_lock_t           buf_lock; /* for buf_regions */
+	struct list_head    buf_regions;
+
+	uint32_t            resolve_timeout; /* msecs, 0 if not caching */
+};
+
+/* memory registered by the application with glfs_buf_register() */
+struct glfs_buf_region {
+	struct list_head   list;
+	char              *base;
+	size_t             size;
+	int                inflight; /* writes from it not released yet */
+};
+
+/* a write from a registered region, until the iobuf wrapping it goes */
+struct glfs_wbuf {
+	struct glfs             *fs;
+	struct glfs_buf_region  *region;
+	void                   (*fn) (void *data);
+	void                    *data;
+};
+
+struct glfs_cq_entry;
+
+struct glfs_cq {
+	struct glfs           *fs;
+	pthread_mutex_t        mutex;
+	struct glfs_cq_entry  *head;
+	struct glfs_cq_entry  *tail;
+	int                    pipe[2];
+	gf_boolean_t           signalled;
+};
+
+struct glfs_rbuf {
+	gf_lock_t          lock;
+	int                ref;
+	struct iovec      *iov;
+	int                count;
+	struct iobref     *iobref;
 };
 
 struct glfs_fd {
@@ -141,6 +181,8 @@ int glfs_resolve (struct glfs *fs, xlator_t *subvol, const char *path, loc_t *lo
 		  struct iatt *iatt, int reval);
 int glfs_lresolve (struct glfs *fs, xlator_t *subvol, const char *path, loc_t *loc,
 		   struct iatt *iatt, int reval);
+int glfs_resolve_cached (struct glfs *fs, xlator_t *subvol, const char *path,
+			 loc_t *loc, struct iatt *iatt, int reval);
 fd_t *glfs_resolve_fd (struct glfs *fs, xlator_t *subvol, struct glfs_fd *glfd);
 
 fd_t *__glfs_migrate_fd (struct glfs *fs, xlator_t *subvol, struct glfs_fd *glfd);
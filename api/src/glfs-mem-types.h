@@ -26,6 +26,10 @@ enum glfs_mem_types_ {
         glfs_mt_server_cmdline_t,
 	glfs_mt_glfs_object_t,
 	glfs_mt_readdirbuf_t,
+	glfs_mt_buf_region_t,
+	glfs_mt_wbuf_t,
+	glfs_mt_rbuf_t,
+	glfs_mt_cq_t,
 	glfs_mt_end
 
 };
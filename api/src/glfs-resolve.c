@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <sys/time.h>
 
 #ifndef _CONFIG_H
 #define _CONFIG_H
@@ -29,6 +30,7 @@
 #include "common-utils.h"
 #include "syncop.h"
 #include "call-stub.h"
+#include "byte-order.h"
 
 #include "glfs-internal.h"
 
@@ -221,10 +223,151 @@ out:
 }
 
 
+static uint64_t
+glfs_resolve_now (void)
+{
+	struct timeval tv = {0, };
+
+	gettimeofday (&tv, NULL);
+
+	return ((uint64_t) tv.tv_sec * 1000) + (tv.tv_usec / 1000);
+}
+
+
+/* the master xlator's slot in the inode ctx holds when the inode was last
+   looked up, if fs->resolve_timeout is set */
+static void
+glfs_resolve_stamp (struct glfs *fs, inode_t *inode)
+{
+	uint64_t now = 0;
+
+	if (!fs->resolve_timeout)
+		return;
+
+	now = glfs_resolve_now ();
+	inode_ctx_set (inode, fs->ctx->master, &now);
+}
+
+
+static int
+glfs_resolve_fresh (struct glfs *fs, inode_t *inode)
+{
+	uint64_t stamp = 0;
+
+	if (!fs->resolve_timeout)
+		return 0;
+
+	if (inode_ctx_get (inode, fs->ctx->master, &stamp) || !stamp)
+		return 0;
+
+	return (glfs_resolve_now () - stamp) < fs->resolve_timeout;
+}
+
+
+/* looks up @parent asking the bricks to resolve @rest below it in the same
+   call, and links the directories they report with their attributes, so
+   that resolving them needs no lookup each. The bricks only report
+   entries matching their gfid handles, and access-control only those the
+   caller may reach. */
+static void
+glfs_resolve_prefetch (struct glfs *fs, xlator_t *subvol, inode_t *parent,
+		       const char *rest)
+{
+	loc_t                        loc = {0, };
+	char                        *path = NULL;
+	char                        *dup = NULL;
+	char                        *component = NULL;
+	char                        *saveptr = NULL;
+	dict_t                      *xattr_req = NULL;
+	dict_t                      *xattr_rsp = NULL;
+	data_t                      *data = NULL;
+	struct gf_lookup_path_entry *entries = NULL;
+	inode_t                     *dir = NULL;
+	inode_t                     *inode = NULL;
+	inode_t                     *linked = NULL;
+	struct iatt                  iatt = {0, };
+	int                          count = 0;
+	int                          i = 0;
+	int                          ret = -1;
+
+	loc.inode = inode_ref (parent);
+	uuid_copy (loc.gfid, parent->gfid);
+
+	ret = inode_path (loc.inode, NULL, &path);
+	loc.path = path;
+	if (ret < 0)
+		goto out;
+
+	xattr_req = dict_new ();
+	if (!xattr_req)
+		goto out;
+
+	ret = dict_set_str (xattr_req, GF_LOOKUP_PATH, (char *) rest);
+	if (ret)
+		goto out;
+
+	ret = syncop_lookup (subvol, &loc, xattr_req, &iatt, &xattr_rsp, NULL);
+	DECODE_SYNCOP_ERR (ret);
+	if (ret)
+		goto out;
+
+	data = dict_get (xattr_rsp, GF_LOOKUP_PATH);
+	if (!data || (data->len % sizeof (*entries)))
+		goto out;
+
+	entries = (struct gf_lookup_path_entry *) data->data;
+	count = data->len / sizeof (*entries);
+
+	dup = gf_strdup (rest);
+	if (!dup)
+		goto out;
+
+	dir = inode_ref (parent);
+
+	for (component = strtok_r (dup, "/", &saveptr);
+	     component && i < count;
+	     component = strtok_r (NULL, "/", &saveptr), i++) {
+		gf_lookup_path_entry_to_iatt (&entries[i], &iatt);
+		if (!IA_ISDIR (iatt.ia_type) || uuid_is_null (iatt.ia_gfid))
+			break;
+
+		inode = inode_find (parent->table, iatt.ia_gfid);
+		if (!inode)
+			inode = inode_new (parent->table);
+		if (!inode)
+			break;
+
+		linked = inode_link (inode, dir, component, &iatt);
+		inode_unref (inode);
+		if (!linked)
+			break;
+
+		glfs_resolve_stamp (fs, linked);
+		inode_lookup (linked);
+		inode_unref (dir);
+		dir = linked;
+	}
+
+	gf_log (subvol->name, GF_LOG_TRACE, "prefetched %d of %d entries of %s",
+		i, count, rest);
+out:
+	if (dir)
+		inode_unref (dir);
+	if (xattr_req)
+		dict_unref (xattr_req);
+	if (xattr_rsp)
+		dict_unref (xattr_rsp);
+	GF_FREE (dup);
+	loc_wipe (&loc);
+}
+
+
+/* With @cached set, an entry looked up within fs->resolve_timeout is
+   trusted even when @force_lookup is */
 inode_t *
 glfs_resolve_component (struct glfs *fs, xlator_t *subvol, inode_t *parent,
 			const char *component, struct iatt *iatt,
-			int force_lookup)
+			int force_lookup, int cached)
 {
 	loc_t        loc = {0, };
 	inode_t     *inode = NULL;
@@ -256,7 +399,8 @@ glfs_resolve_component (struct glfs *fs, xlator_t *subvol, inode_t *parent,
 		uuid_copy (loc.gfid, loc.inode->gfid);
 		reval = 1;
 
-		if (!force_lookup) {
+		if (!force_lookup ||
+		    (cached && glfs_resolve_fresh (fs, loc.inode))) {
 			inode = inode_ref (loc.inode);
 			ciatt.ia_type = inode->ia_type;
 			goto found;
@@ -327,6 +471,8 @@ glfs_resolve_component (struct glfs *fs, xlator_t *subvol, inode_t *parent,
 		goto out;
 
 	inode = inode_link (loc.inode, loc.parent, component, &ciatt);
+	if (inode)
+		glfs_resolve_stamp (fs, inode);
 found:
 	if (inode)
 		inode_lookup (inode);
@@ -342,13 +488,15 @@ out:
 }
 
 
-int
-glfs_resolve_at (struct glfs *fs, xlator_t *subvol, inode_t *at,
-		 const char *origpath, loc_t *loc, struct iatt *iatt,
-		 int follow, int reval)
+static int
+glfs_resolve_walk (struct glfs *fs, xlator_t *subvol, inode_t *at,
+		   const char *origpath, loc_t *loc, struct iatt *iatt,
+		   int follow, int reval, int cached)
 {
 	inode_t    *inode = NULL;
 	inode_t    *parent = NULL;
+	inode_t    *dentry = NULL;
+	int         prefetched = 0;
 	char       *saveptr = NULL;
 	char       *path = NULL;
 	char       *component = NULL;
@@ -385,6 +533,21 @@ glfs_resolve_at (struct glfs *fs, xlator_t *subvol, inode_t *at,
 
 		parent = inode;
 
+		/* a path not known past here is resolved by the bricks
+		   as far as they can, in a single lookup */
+		if (!prefetched && next_component &&
+		    strcmp (component, ".") && strcmp (component, "..")) {
+			dentry = inode_grep (parent->table, parent, component);
+			if (dentry) {
+				inode_unref (dentry);
+			} else {
+				prefetched = 1;
+				glfs_resolve_prefetch (fs, subvol, parent,
+						       origpath +
+						       (component - path));
+			}
+		}
+
 		inode = glfs_resolve_component (fs, subvol, parent,
 						component, &ciatt,
 						/* force hard lookup on the last
@@ -392,7 +555,7 @@ glfs_resolve_at (struct glfs *fs, xlator_t *subvol, inode_t *at,
 						   wants proper iatt filled
 						*/
 						(reval || (!next_component &&
-						iatt)));
+						iatt)), (cached && !reval));
 		if (!inode)
 			break;
 
@@ -420,16 +583,16 @@ glfs_resolve_at (struct glfs *fs, xlator_t *subvol, inode_t *at,
 			if (ret < 0)
 				break;
 
-			ret = glfs_resolve_at (fs, subvol, parent, lpath,
-					       &sym_loc,
-					       /* followed iatt becomes the
-						  component iatt
-					       */
-					       &ciatt,
-					       /* always recurisvely follow while
-						  following symlink
-					       */
-					       follow + 1, reval);
+			ret = glfs_resolve_walk (fs, subvol, parent, lpath,
+						 &sym_loc,
+						 /* followed iatt becomes the
+						    component iatt
+						 */
+						 &ciatt,
+						 /* always recurisvely follow
+						    while following symlink
+						 */
+						 follow + 1, reval, cached);
 			if (ret == 0)
 				inode = inode_ref (sym_loc.inode);
 			loc_wipe (&sym_loc);
@@ -486,21 +649,32 @@ out:
 }
 
 
+int
+glfs_resolve_at (struct glfs *fs, xlator_t *subvol, inode_t *at,
+		 const char *origpath, loc_t *loc, struct iatt *iatt,
+		 int follow, int reval)
+{
+	return glfs_resolve_walk (fs, subvol, at, origpath, loc, iatt,
+				  follow, reval, 0);
+}
+
+
 int
 glfs_resolve_path (struct glfs *fs, xlator_t *subvol, const char *origpath,
-		   loc_t *loc, struct iatt *iatt, int follow, int reval)
+		   loc_t *loc, struct iatt *iatt, int follow, int reval,
+		   int cached)
 {
 	int ret = -1;
 	inode_t *cwd = NULL;
 
 	if (origpath[0] == '/')
-		return glfs_resolve_at (fs, subvol, NULL, origpath, loc, iatt,
-					follow, reval);
+		return glfs_resolve_walk (fs, subvol, NULL, origpath, loc,
+					  iatt, follow, reval, cached);
 
 	cwd = glfs_cwd_get (fs);
 
-	ret = glfs_resolve_at (fs, subvol, cwd, origpath, loc, iatt,
-			       follow, reval);
+	ret = glfs_resolve_walk (fs, subvol, cwd, origpath, loc, iatt,
+				 follow, reval, cached);
 	if (cwd)
 		inode_unref (cwd);
 
@@ -514,7 +688,21 @@ glfs_resolve (struct glfs *fs, xlator_t *subvol, const char *origpath,
 {
 	int ret = -1;
 
-	ret = glfs_resolve_path (fs, subvol, origpath, loc, iatt, 1, reval);
+	ret = glfs_resolve_path (fs, subvol, origpath, loc, iatt, 1, reval, 0);
+
+	return ret;
+}
+
+
+/* glfs_resolve() trusting the entries looked up recently, for callers
+   which only need the type of the last component */
+int
+glfs_resolve_cached (struct glfs *fs, xlator_t *subvol, const char *origpath,
+		     loc_t *loc, struct iatt *iatt, int reval)
+{
+	int ret = -1;
+
+	ret = glfs_resolve_path (fs, subvol, origpath, loc, iatt, 1, reval, 1);
 
 	return ret;
 }
@@ -526,7 +714,7 @@ glfs_lresolve (struct glfs *fs, xlator_t *subvol, const char *origpath,
 {
 	int ret = -1;
 
-	ret = glfs_resolve_path (fs, subvol, origpath, loc, iatt, 0, reval);
+	ret = glfs_resolve_path (fs, subvol, origpath, loc, iatt, 0, reval, 0);
 
 	return ret;
 }
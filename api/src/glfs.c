@@ -550,6 +550,9 @@ glfs_new (const char *volname)
 
 	INIT_LIST_HEAD (&fs->openfds);
 
+	LOCK_INIT (&fs->buf_lock);
+	INIT_LIST_HEAD (&fs->buf_regions);
+
 	return fs;
 }
 
@@ -602,6 +605,15 @@ out:
 }
 
 
+int
+glfs_set_resolve_timeout (struct glfs *fs, unsigned int msecs)
+{
+	fs->resolve_timeout = msecs;
+
+	return 0;
+}
+
+
 int
 glfs_init_wait (struct glfs *fs)
 {
@@ -718,6 +730,33 @@ glfs_init (struct glfs *fs)
 }
 
 
+/* the regions the application did not unregister. One with writes not
+   released yet is left alone: the release would still reach it. */
+static void
+glfs_buf_regions_free (struct glfs *fs)
+{
+        struct glfs_buf_region *region = NULL;
+        struct glfs_buf_region *tmp = NULL;
+
+        LOCK (&fs->buf_lock);
+        {
+                list_for_each_entry_safe (region, tmp, &fs->buf_regions,
+                                          list) {
+                        if (region->inflight) {
+                                gf_log ("glfs", GF_LOG_WARNING,
+                                        "registered buffer %p still has %d "
+                                        "writes in flight", region->base,
+                                        region->inflight);
+                                continue;
+                        }
+                        list_del_init (&region->list);
+                        GF_FREE (region);
+                }
+        }
+        UNLOCK (&fs->buf_lock);
+}
+
+
 int
 glfs_fini (struct glfs *fs)
 {
@@ -775,6 +814,8 @@ glfs_fini (struct glfs *fs)
                 glfs_subvol_done (fs, subvol);
         }
 
+        glfs_buf_regions_free (fs);
+
         if (gf_log_fini(ctx) != 0)
                 ret = -1;
 
@@ -204,6 +204,34 @@ int glfs_unset_volfile_server (glfs_t *fs, const char *transport,
 
 int glfs_set_logging (glfs_t *fs, const char *logfile, int loglevel) __THROW;
 
+/*
+  SYNOPSIS
+
+  glfs_set_resolve_timeout: Let path resolution trust cached entries.
+
+  DESCRIPTION
+
+  By default the last component of a path is looked up on every call that
+  resolves it. With a timeout set, glfs_open() and glfs_opendir() skip that
+  lookup for an entry successfully looked up less than @msecs ago, so
+  changes made by other clients in that window may go unnoticed (a stale
+  entry is still detected and looked up again by the open itself).
+
+  PARAMETERS
+
+  @fs: The 'virtual mount' object to be configured.
+
+  @msecs: How long a looked up entry is trusted. 0 (default) disables the
+          cache.
+
+  RETURN VALUES
+
+   0 : Success.
+
+*/
+
+int glfs_set_resolve_timeout (glfs_t *fs, unsigned int msecs) __THROW;
+
 
 /*
   SYNOPSIS
@@ -461,6 +489,72 @@ int glfs_set_xlator_option (glfs_t *fs, const char *xlator, const char *key,
 
 typedef void (*glfs_io_cbk) (glfs_fd_t *fd, ssize_t ret, void *data);
 
+/*
+ * The _async() calls on an fd are wound straight to the translators, and
+ * @fn is called from the thread in which the call completes. The calls on
+ * a path first resolve it, and are run by the pool of synctask threads.
+ *
+ * @fd of glfs_open_async(), glfs_creat_async() and glfs_opendir_async()
+ * callbacks is the fd opened (NULL on failure). glfs_readdirplus_async()
+ * completes with @ret 1 when @dirent (and @stat, if not NULL) is filled
+ * in, 0 at the end of the directory.
+ */
+
+int glfs_stat_async (glfs_t *fs, const char *path, struct stat *buf,
+		     glfs_io_cbk fn, void *data) __THROW;
+int glfs_lstat_async (glfs_t *fs, const char *path, struct stat *buf,
+		      glfs_io_cbk fn, void *data) __THROW;
+int glfs_fstat_async (glfs_fd_t *fd, struct stat *buf,
+		      glfs_io_cbk fn, void *data) __THROW;
+int glfs_open_async (glfs_t *fs, const char *path, int flags,
+		     glfs_io_cbk fn, void *data) __THROW;
+int glfs_creat_async (glfs_t *fs, const char *path, int flags, mode_t mode,
+		      glfs_io_cbk fn, void *data) __THROW;
+int glfs_opendir_async (glfs_t *fs, const char *path,
+			glfs_io_cbk fn, void *data) __THROW;
+int glfs_mkdir_async (glfs_t *fs, const char *path, mode_t mode,
+		      glfs_io_cbk fn, void *data) __THROW;
+int glfs_unlink_async (glfs_t *fs, const char *path,
+		       glfs_io_cbk fn, void *data) __THROW;
+int glfs_readdirplus_async (glfs_fd_t *fd, struct stat *stat,
+			    struct dirent *dirent,
+			    glfs_io_cbk fn, void *data) __THROW;
+
+/*
+ * COMPLETION QUEUES
+ *
+ * Instead of having callbacks run in gfapi threads, completions can be
+ * queued and reaped in batches by the application: pass glfs_cq_cbk as
+ * @fn of any _async() call, and as @data a glfs_cq_entry with @cq set.
+ * The entry is returned by glfs_cq_reap() once the call completed, with
+ * @fd, @ret and @err (the errno when @ret is -1) filled in.
+ *
+ * glfs_cq_fd() is readable as long as entries are waiting to be reaped,
+ * for use with poll(2) and the like. It must not be read from.
+ *
+ * A queue must not be destroyed while calls completing into it are in
+ * flight.
+ */
+
+struct glfs_cq;
+typedef struct glfs_cq glfs_cq_t;
+
+struct glfs_cq_entry {
+	glfs_cq_t             *cq;     /* set by the caller */
+	void                  *data;   /* left alone */
+	glfs_fd_t             *fd;
+	ssize_t                ret;
+	int                    err;
+	struct glfs_cq_entry  *next;   /* private */
+};
+
+glfs_cq_t *glfs_cq_new (glfs_t *fs) __THROW;
+int glfs_cq_fd (glfs_cq_t *cq) __THROW;
+void glfs_cq_cbk (glfs_fd_t *fd, ssize_t ret, void *data) __THROW;
+int glfs_cq_reap (glfs_cq_t *cq, struct glfs_cq_entry **entries,
+		  int max) __THROW;
+void glfs_cq_destroy (glfs_cq_t *cq) __THROW;
+
 // glfs_{read,write}[_async]
 
 ssize_t glfs_read (glfs_fd_t *fd, void *buf,
@@ -507,6 +601,60 @@ int glfs_pwritev_async (glfs_fd_t *fd, const struct iovec *iov,
                         int count, off_t offset, int flags,
                         glfs_io_cbk fn, void *data) __THROW;
 
+/*
+ * glfs_read_file() reads up to @count bytes at @offset of the file at
+ * @path without keeping it open. The open, the read and the flush are
+ * sent as one compound fop, which takes a single round trip to the brick
+ * when none of the translators on the way has to run them one by one.
+ * Returns the number of bytes read, or -1 with @errno set.
+ */
+
+ssize_t glfs_read_file (glfs_t *fs, const char *path, void *buf, size_t count,
+			off_t offset) __THROW;
+
+
+/*
+ * ZERO-COPY IO
+ *
+ * glfs_pwritev() copies the data into buffers of its own, and
+ * glfs_preadv() copies what is read into @iov. The following calls
+ * skip these copies.
+ *
+ * Memory registered with glfs_buf_register() is sent as is by
+ * glfs_pwritev_registered(). As the translators may keep hold of it
+ * after the write returned (eg. write-behind), the application must
+ * not modify the data nor unregister the memory before @fn is called
+ * with @data. @fn may be called from any thread, possibly before the
+ * write returns. A write whose @iov does not lie within a single
+ * registered region is copied, and @fn called right away.
+ *
+ * glfs_buf_unregister() fails with EBUSY while writes from the region
+ * are not released.
+ *
+ * glfs_preadv_buf() returns the buffers the data was read into in @buf,
+ * a reference counted object valid until the last glfs_rbuf_unref().
+ * The memory it points to must not be modified: it may be shared with
+ * caches. @buf is only set when something was read.
+ */
+
+typedef void (*glfs_buf_release_cbk) (void *data);
+
+struct glfs_rbuf;
+typedef struct glfs_rbuf glfs_rbuf_t;
+
+int glfs_buf_register (glfs_t *fs, void *base, size_t size) __THROW;
+int glfs_buf_unregister (glfs_t *fs, void *base) __THROW;
+
+ssize_t glfs_pwritev_registered (glfs_fd_t *fd, const struct iovec *iov,
+				 int iovcnt, off_t offset, int flags,
+				 glfs_buf_release_cbk fn, void *data) __THROW;
+
+ssize_t glfs_preadv_buf (glfs_fd_t *fd, size_t size, off_t offset, int flags,
+			 glfs_rbuf_t **buf) __THROW;
+int glfs_rbuf_iov (glfs_rbuf_t *buf, const struct iovec **iov) __THROW;
+glfs_rbuf_t *glfs_rbuf_ref (glfs_rbuf_t *buf) __THROW;
+void glfs_rbuf_unref (glfs_rbuf_t *buf) __THROW;
+
 
 off_t glfs_lseek (glfs_fd_t *fd, off_t offset, int whence) __THROW;
 
@@ -7067,6 +7067,8 @@ cmd_heal_volume_statistics_out (dict_t *dict, int  brick)
         char            *end_time_str = NULL;
         char            *crawl_type = NULL;
         int             progress = -1;
+        double          heal_rate = 0;
+        uint64_t        queued = 0;
 
         snprintf (key, sizeof key, "%d-hostname", brick);
         ret = dict_get_str (dict, key, &hostname);
@@ -7135,6 +7137,17 @@ cmd_heal_volume_statistics_out (dict_t *dict, int  brick)
                 cli_out ("No. of heal failed entries: %"PRIu64,
                          heal_failed_count);
 
+                /* not sent by older self-heal daemons */
+                snprintf (key, sizeof key, "statistics_heal_rate-%d-%"PRIu64,
+                          brick, i);
+                if (!dict_get_double (dict, key, &heal_rate))
+                        cli_out ("Heal rate: %.2f entries/sec", heal_rate);
+
+                snprintf (key, sizeof key, "statistics_queued-%d-%"PRIu64,
+                          brick, i);
+                if (!dict_get_uint64 (dict, key, &queued) && progress == 1)
+                        cli_out ("No. of entries queued for heal: %"PRIu64,
+                                 queued);
         }
 
 
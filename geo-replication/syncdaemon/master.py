@@ -19,6 +19,11 @@ import string
 import errno
 from errno import ENOENT, ENODATA, EPIPE, EEXIST
 from threading import Condition, Lock
+try:
+    from Queue import Queue
+except ImportError:
+    # py 3
+    from queue import Queue
 from datetime import datetime
 from gconf import gconf
 from tempfile import NamedTemporaryFile
@@ -758,6 +763,9 @@ class GMasterChangelogMixin(GMasterCommon):
     CHANGELOG_LOG_LEVEL = 9
     CHANGELOG_CONN_RETRIES = 5
 
+    # number of changelogs decoded ahead of the one being synced
+    PARSE_AHEAD = 2
+
     def fallback_xsync(self):
         logging.info('falling back to xsync mode')
         gconf.configinterface.set('change-detector', 'xsync')
@@ -774,12 +782,30 @@ class GMasterChangelogMixin(GMasterCommon):
             purge_time = None
         return purge_time
 
-    def process_change(self, change, done, retry):
+    @staticmethod
+    def edct(op, **ed):
+        dct = {}
+        dct['op'] = op
+        for k in ed:
+            if k == 'stat':
+                st = ed[k]
+                dst = dct['stat'] = {}
+                dst['uid'] = st.st_uid
+                dst['gid'] = st.st_gid
+                dst['mode'] = st.st_mode
+            else:
+                dct[k] = ed[k]
+        return dct
+
+    def parse_change(self, change):
+        """decode a changelog into its entry, metadata and data
+           operations (nothing is sent to the slave here)"""
         pfx = gauxpfx()
         clist = []
         entries = []
         meta_gfid = set()
         datas = set()
+        edct = self.edct
 
         # basic crawl stats: files and bytes
         files_pending = {'count': 0, 'purge': 0, 'bytes': 0, 'files': []}
@@ -790,20 +816,6 @@ class GMasterChangelogMixin(GMasterCommon):
         except IOError:
             raise
 
-        def edct(op, **ed):
-            dct = {}
-            dct['op'] = op
-            for k in ed:
-                if k == 'stat':
-                    st = ed[k]
-                    dst = dct['stat'] = {}
-                    dst['uid'] = st.st_uid
-                    dst['gid'] = st.st_gid
-                    dst['mode'] = st.st_mode
-                else:
-                    dct[k] = ed[k]
-            return dct
-
         # entry counts (not purges)
         def entry_update():
             files_pending['count'] += 1
@@ -884,11 +896,19 @@ class GMasterChangelogMixin(GMasterCommon):
             else:
                 logging.warn('got invalid changelog type: %s' % (et))
         logging.debug('entries: %s' % repr(entries))
+        return (entries, meta_gfid, datas, files_pending)
+
+    def apply_change(self, parsed, retry):
+        """sync a decoded changelog: entries and metadata synchronously,
+           data is only queued to the syncer"""
+        entries, meta_gfid, datas, files_pending = parsed
+        edct = self.edct
+
         if not retry:
             self.update_worker_cumilitive_status(files_pending)
         # sync namespace
         if entries:
-            self.slave.server.entry_ops(entries)
+            self.entry_ops(entries)
         # sync metadata
         if meta_gfid:
             meta_entries = []
@@ -907,6 +927,121 @@ class GMasterChangelogMixin(GMasterCommon):
         if datas:
             self.a_syncdata(datas)
 
+    def process_change(self, change, done, retry):
+        self.apply_change(self.parse_change(change), retry)
+
+    @staticmethod
+    def entry_keys(e):
+        """gfids an entry operation depends on: the entry itself and
+           the parent directory (both of them for renames)"""
+        keys = [e['gfid'], os.path.basename(os.path.dirname(e['entry']))]
+        if 'entry1' in e:
+            keys.append(os.path.basename(os.path.dirname(e['entry1'])))
+        return keys
+
+    def entry_groups(self, entries):
+        """split entry operations into groups which do not share any
+           gfid (see entry_keys()), keeping their order within a group.
+           Groups can be replayed on the slave independently."""
+        parent = {}
+
+        def find(k):
+            parent.setdefault(k, k)
+            while parent[k] != k:
+                parent[k] = parent[parent[k]]
+                k = parent[k]
+            return k
+
+        for e in entries:
+            keys = self.entry_keys(e)
+            root = find(keys[0])
+            for k in keys[1:]:
+                r = find(k)
+                if r != root:
+                    parent[r] = root
+
+        groups = {}
+        order = []
+        for e in entries:
+            r = find(e['gfid'])
+            if r not in groups:
+                groups[r] = []
+                order.append(r)
+            groups[r].append(e)
+        return [groups[r] for r in order]
+
+    def entry_ops(self, entries):
+        """replay entry operations on the slave
+
+        Operations on independent directories are spread over (at most)
+        sync_jobs concurrent entry_ops() calls, the slave serving them
+        with as many workers. Dependent operations stay in one call, in
+        changelog order.
+        """
+        groups = self.entry_groups(entries)
+        nr = min(len(groups), int(gconf.sync_jobs))
+        if nr < 2:
+            self.slave.server.entry_ops(entries)
+            return
+
+        buckets = [[] for i in range(nr)]
+        for g in sorted(groups, key=len, reverse=True):
+            min(buckets, key=len).extend(g)
+
+        errs = []
+
+        def replay(bucket):
+            try:
+                self.slave.server.entry_ops(bucket)
+            except:
+                errs.append(sys.exc_info()[1])
+
+        threads = []
+        for b in buckets[1:]:
+            t = Thread(target=replay, args=(b,))
+            t.start()
+            threads.append(t)
+        replay(buckets[0])
+        for t in threads:
+            t.join()
+        if errs:
+            raise errs[0]
+
+    def parse_ahead(self, changes):
+        """yield (change, decoded change) pairs, decoding in a separate
+           thread at most PARSE_AHEAD changelogs ahead of the caller"""
+        if len(changes) < 2:
+            for change in changes:
+                yield (change, self.parse_change(change))
+            return
+
+        q = Queue(self.PARSE_AHEAD)
+        stop = []
+
+        def parser():
+            for change in changes:
+                if stop:
+                    return
+                try:
+                    q.put((change, self.parse_change(change), None))
+                except:
+                    q.put((change, None, sys.exc_info()[1]))
+                    return
+
+        t = Thread(target=parser)
+        t.start()
+        try:
+            for i in range(len(changes)):
+                change, parsed, exc = q.get()
+                if exc:
+                    raise exc
+                yield (change, parsed)
+        finally:
+            # let the parser run to completion if we bailed out early
+            stop.append(True)
+            while not q.empty():
+                q.get()
+
     def process(self, changes, done=1):
         tries = 0
         retry = False
@@ -916,15 +1051,18 @@ class GMasterChangelogMixin(GMasterCommon):
             self.current_files_skipped_count = 0
 
             # first, fire all changelog transfers in parallel. entry and
-            # metadata are performed synchronously, therefore in serial.
-            # However at the end of each changelog, data is synchronized
-            # with syncdata_async() - which means it is serial w.r.t
-            # entries/metadata of that changelog but happens in parallel
-            # with data of other changelogs.
-
-            for change in changes:
+            # metadata are performed synchronously, changelog after
+            # changelog (entries of independent directories of a changelog
+            # are replayed concurrently, see entry_ops()). At the end of
+            # each changelog, data is synchronized with syncdata_async() -
+            # which means it is serial w.r.t entries/metadata of that
+            # changelog but happens in parallel with data of other
+            # changelogs. The next changelogs are decoded while the
+            # current one is synced.
+
+            for change, parsed in self.parse_ahead(changes):
                 logging.debug('processing change %s' % change)
-                self.process_change(change, done, retry)
+                self.apply_change(parsed, retry)
                 if not retry:
                     # number of changelogs processed in the batch
                     self.turns += 1
@@ -1565,28 +1703,38 @@ class Syncer(object):
     To aid accumlation of items in the PostBoxen before grabbed
     by an rsync worker, the worker goes to sleep a bit after
     each completed syncjob.
+
+    The queue is sharded by gfid (the basename of the item), with a
+    worker per shard: the transfers are spread over all the workers
+    and an item is never being synced by two of them at once.
     """
 
     def __init__(self, slave, sync_engine, resilient_errnos=[]):
         """spawn worker threads"""
         self.slave = slave
-        self.lock = Lock()
-        self.pb = PostBox()
         self.sync_engine = sync_engine
         self.errnos_ok = resilient_errnos
+        self.locks = []
+        self.pbs = []
         for i in range(int(gconf.sync_jobs)):
-            t = Thread(target=self.syncjob)
+            self.locks.append(Lock())
+            self.pbs.append(PostBox())
+            t = Thread(target=self.syncjob, args=(i,))
             t.start()
 
-    def syncjob(self):
+    def shard(self, e):
+        return hash(os.path.basename(e)) % len(self.pbs)
+
+    def syncjob(self, shard):
         """the life of a worker"""
+        lock = self.locks[shard]
         while True:
             pb = None
             while True:
-                self.lock.acquire()
-                if self.pb:
-                    pb, self.pb = self.pb, PostBox()
-                self.lock.release()
+                lock.acquire()
+                if self.pbs[shard]:
+                    pb, self.pbs[shard] = self.pbs[shard], PostBox()
+                lock.release()
                 if pb:
                     break
                 time.sleep(0.5)
@@ -1601,8 +1749,9 @@ class Syncer(object):
             pb.wakeup(ret)
 
     def add(self, e):
+        shard = self.shard(e)
         while True:
-            pb = self.pb
+            pb = self.pbs[shard]
             try:
                 pb.append(e)
                 return pb
@@ -12,7 +12,7 @@ import os
 import sys
 import time
 import logging
-from threading import Condition
+from threading import Condition, Lock
 try:
     import thread
 except ImportError:
@@ -79,6 +79,7 @@ class RepceServer(object):
         self.inf, self.out = ioparse(i, o)
         self.wnum = wnum
         self.q = Queue()
+        self.lock = Lock()
 
     def service_loop(self):
         """fire up worker threads, get messages and dispatch among them"""
@@ -115,7 +116,11 @@ class RepceServer(object):
                     res = sys.exc_info()[1]
                     exc = True
                     logging.exception("call failed: ")
-            send(self.out, rid, exc, res)
+            self.lock.acquire()
+            try:
+                send(self.out, rid, exc, res)
+            finally:
+                self.lock.release()
 
 
 class RepceJob(object):
@@ -164,6 +169,9 @@ class RepceClient(object):
     def __init__(self, i, o):
         self.inf, self.out = ioparse(i, o)
         self.jtab = {}
+        # calls are made from several threads (eg. parallel entry_ops),
+        # and a message larger than PIPE_BUF is not written atomically
+        self.lock = Lock()
         t = Thread(target=self.listen)
         t.start()
 
@@ -189,7 +197,11 @@ class RepceClient(object):
         rjob = RepceJob(cbk)
         self.jtab[rjob.rid] = rjob
         logging.debug("call %s %s%s ..." % (repr(rjob), meth, repr(args)))
-        send(self.out, rjob.rid, meth, *args)
+        self.lock.acquire()
+        try:
+            send(self.out, rjob.rid, meth, *args)
+        finally:
+            self.lock.release()
         return rjob
 
     def __call__(self, meth, *args):
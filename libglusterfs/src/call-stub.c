@@ -2296,6 +2296,53 @@ out:
 
 }
 
+call_stub_t *
+fop_compound_cbk_stub (call_frame_t *frame, fop_compound_cbk_t fn,
+                       int32_t op_ret, int32_t op_errno,
+                       compound_args_t *args, dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_COMPOUND);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn_cbk.compound = fn;
+
+        stub->args_cbk.op_ret = op_ret;
+        stub->args_cbk.op_errno = op_errno;
+        stub->args_cbk.compound = args;
+
+        if (xdata)
+                stub->args_cbk.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_compound_stub (call_frame_t *frame, fop_compound_t fn,
+                   compound_args_t *args, dict_t *xdata)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_COMPOUND);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->fn.compound = fn;
+
+        /* the compound stays with whoever wound it until it unwinds */
+        stub->args.compound = args;
+
+        if (xdata)
+                stub->args.xdata = dict_ref (xdata);
+out:
+        return stub;
+}
+
 
 static void
 call_resume_wind (call_stub_t *stub)
@@ -2529,6 +2576,10 @@ call_resume_wind (call_stub_t *stub)
                                  stub->args.fd, stub->args.offset,
                                  stub->args.size, stub->args.xdata);
                 break;
+        case GF_FOP_COMPOUND:
+                stub->fn.compound (stub->frame, stub->frame->this,
+                                   stub->args.compound, stub->args.xdata);
+                break;
 
         default:
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -2736,6 +2787,10 @@ call_resume_unwind (call_stub_t *stub)
                 STUB_UNWIND(stub, zerofill, &stub->args_cbk.prestat,
                             &stub->args_cbk.poststat, stub->args_cbk.xdata);
                 break;
+        case GF_FOP_COMPOUND:
+                STUB_UNWIND (stub, compound, stub->args_cbk.compound,
+                             stub->args_cbk.xdata);
+                break;
 
         default:
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -72,6 +72,7 @@ typedef struct {
 		fop_fallocate_t fallocate;
 		fop_discard_t discard;
                 fop_zerofill_t zerofill;
+                fop_compound_t compound;
 	} fn;
 
 	union {
@@ -119,6 +120,7 @@ typedef struct {
 		fop_fallocate_cbk_t fallocate;
 		fop_discard_cbk_t discard;
                 fop_zerofill_cbk_t zerofill;
+                fop_compound_cbk_t compound;
 	} fn_cbk;
 
 	struct {
@@ -148,6 +150,7 @@ typedef struct {
 		gf_xattrop_flags_t optype;
 		int valid;
 		struct iatt stat;
+		compound_args_t *compound; /* not owned by the stub */
 		dict_t *xdata;
 	} args;
 
@@ -174,6 +177,7 @@ typedef struct {
 		uint8_t *strong_checksum;
 		dict_t *xdata;
                 gf_dirent_t entries;
+                compound_args_t *compound; /* not owned by the stub */
 	} args_cbk;
 } call_stub_t;
 
@@ -761,6 +765,19 @@ fop_zerofill_cbk_stub(call_frame_t *frame,
                      struct iatt *statpre, struct iatt *statpost,
                      dict_t *xdata);
 
+call_stub_t *
+fop_compound_stub (call_frame_t *frame,
+                   fop_compound_t fn,
+                   compound_args_t *args,
+                   dict_t *xdata);
+
+call_stub_t *
+fop_compound_cbk_stub (call_frame_t *frame,
+                       fop_compound_cbk_t fn,
+                       int32_t op_ret, int32_t op_errno,
+                       compound_args_t *args,
+                       dict_t *xdata);
+
 void call_resume (call_stub_t *stub);
 void call_stub_destroy (call_stub_t *stub);
 void call_unwind_error (call_stub_t *stub, int op_ret, int op_errno);
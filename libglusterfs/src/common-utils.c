@@ -47,6 +47,7 @@
 #include "globals.h"
 #include "lkowner.h"
 #include "syscall.h"
+#include "byte-order.h"
 #include <ifaddrs.h>
 
 #ifndef AI_ADDRCONFIG
@@ -3164,6 +3165,61 @@ dht_is_linkfile (struct iatt *buf, dict_t *dict)
         return linkfile_key_found;
 }
 
+
+void
+gf_lookup_path_entry_from_iatt (struct gf_lookup_path_entry *entry,
+                                struct iatt *iatt)
+{
+        memcpy (entry->gfid, iatt->ia_gfid, sizeof (entry->gfid));
+        entry->ino        = hton64 (iatt->ia_ino);
+        entry->dev        = hton64 (iatt->ia_dev);
+        entry->mode       = hton32 (st_mode_from_ia (iatt->ia_prot,
+                                                     iatt->ia_type));
+        entry->nlink      = hton32 (iatt->ia_nlink);
+        entry->uid        = hton32 (iatt->ia_uid);
+        entry->gid        = hton32 (iatt->ia_gid);
+        entry->rdev       = hton64 (iatt->ia_rdev);
+        entry->size       = hton64 (iatt->ia_size);
+        entry->blksize    = hton32 (iatt->ia_blksize);
+        entry->blocks     = hton64 (iatt->ia_blocks);
+        entry->atime      = hton32 (iatt->ia_atime);
+        entry->atime_nsec = hton32 (iatt->ia_atime_nsec);
+        entry->mtime      = hton32 (iatt->ia_mtime);
+        entry->mtime_nsec = hton32 (iatt->ia_mtime_nsec);
+        entry->ctime      = hton32 (iatt->ia_ctime);
+        entry->ctime_nsec = hton32 (iatt->ia_ctime_nsec);
+}
+
+
+void
+gf_lookup_path_entry_to_iatt (struct gf_lookup_path_entry *entry,
+                              struct iatt *iatt)
+{
+        mode_t mode = 0;
+
+        mode = ntoh32 (entry->mode);
+
+        memcpy (iatt->ia_gfid, entry->gfid, sizeof (iatt->ia_gfid));
+        iatt->ia_ino        = ntoh64 (entry->ino);
+        iatt->ia_dev        = ntoh64 (entry->dev);
+        iatt->ia_type       = ia_type_from_st_mode (mode);
+        iatt->ia_prot       = ia_prot_from_st_mode (mode);
+        iatt->ia_nlink      = ntoh32 (entry->nlink);
+        iatt->ia_uid        = ntoh32 (entry->uid);
+        iatt->ia_gid        = ntoh32 (entry->gid);
+        iatt->ia_rdev       = ntoh64 (entry->rdev);
+        iatt->ia_size       = ntoh64 (entry->size);
+        iatt->ia_blksize    = ntoh32 (entry->blksize);
+        iatt->ia_blocks     = ntoh64 (entry->blocks);
+        iatt->ia_atime      = ntoh32 (entry->atime);
+        iatt->ia_atime_nsec = ntoh32 (entry->atime_nsec);
+        iatt->ia_mtime      = ntoh32 (entry->mtime);
+        iatt->ia_mtime_nsec = ntoh32 (entry->mtime_nsec);
+        iatt->ia_ctime      = ntoh32 (entry->ctime);
+        iatt->ia_ctime_nsec = ntoh32 (entry->ctime_nsec);
+}
+
+
 int
 gf_check_log_format (const char *value)
 {
@@ -630,6 +630,15 @@ int
 gf_skip_header_section (int fd, int header_len);
 
 struct iatt;
+struct gf_lookup_path_entry;
+
+void
+gf_lookup_path_entry_from_iatt (struct gf_lookup_path_entry *entry,
+                                struct iatt *iatt);
+void
+gf_lookup_path_entry_to_iatt (struct gf_lookup_path_entry *entry,
+                              struct iatt *iatt);
+
 struct _dict;
 
 gf_boolean_t
@@ -0,0 +1,432 @@
+/*
+  Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+#include "mem-types.h"
+#include "common-utils.h"
+#include "defaults.h"
+#include "compound-fop-utils.h"
+
+typedef struct {
+        compound_args_t *args;
+        int              index;
+} compound_local_t;
+
+
+compound_args_t *
+compound_args_new (int count)
+{
+        compound_args_t *args = NULL;
+
+        if (count <= 0 || count > GF_COMPOUND_MAX_FOPS)
+                return NULL;
+
+        args = GF_CALLOC (1, sizeof (*args), gf_common_mt_compound_args_t);
+        if (!args)
+                return NULL;
+
+        args->fops = GF_CALLOC (count, sizeof (*args->fops),
+                                gf_common_mt_compound_fop_t);
+        if (!args->fops) {
+                GF_FREE (args);
+                return NULL;
+        }
+
+        args->count = count;
+
+        return args;
+}
+
+
+static void
+compound_fop_wipe (compound_fop_t *cfop)
+{
+        loc_wipe (&cfop->loc);
+
+        if (cfop->fd)
+                fd_unref (cfop->fd);
+        if (cfop->iobref)
+                iobref_unref (cfop->iobref);
+        GF_FREE (cfop->vector);
+        GF_FREE (cfop->name);
+        if (cfop->xattr)
+                dict_unref (cfop->xattr);
+        if (cfop->xdata)
+                dict_unref (cfop->xdata);
+
+        if (cfop->rsp.inode)
+                inode_unref (cfop->rsp.inode);
+        if (cfop->rsp.iobref)
+                iobref_unref (cfop->rsp.iobref);
+        GF_FREE (cfop->rsp.vector);
+        if (cfop->rsp.xattr)
+                dict_unref (cfop->rsp.xattr);
+        if (cfop->rsp.xdata)
+                dict_unref (cfop->rsp.xdata);
+}
+
+
+void
+compound_args_destroy (compound_args_t *args)
+{
+        int i = 0;
+
+        if (!args)
+                return;
+
+        for (i = 0; i < args->count; i++)
+                compound_fop_wipe (&args->fops[i]);
+
+        GF_FREE (args->fops);
+        GF_FREE (args);
+}
+
+
+/* fops from @from on are not run */
+void
+compound_args_fail (compound_args_t *args, int from, int32_t op_errno)
+{
+        int i = 0;
+
+        for (i = from; i < args->count; i++) {
+                args->fops[i].rsp.op_ret = -1;
+                args->fops[i].rsp.op_errno = (i == from) ? op_errno :
+                                                           ECANCELED;
+        }
+}
+
+
+/* none of the fops has run: all fail, @failed with @op_errno and the
+   others with ECANCELED */
+void
+compound_args_cancel (compound_args_t *args, int failed, int32_t op_errno)
+{
+        int i = 0;
+
+        for (i = 0; i < args->count; i++) {
+                args->fops[i].rsp.op_ret = -1;
+                args->fops[i].rsp.op_errno = (i == failed) ? op_errno :
+                                                             ECANCELED;
+        }
+}
+
+
+gf_boolean_t
+compound_fop_supported (glusterfs_fop_t fop)
+{
+        switch (fop) {
+        case GF_FOP_LOOKUP:
+        case GF_FOP_OPEN:
+        case GF_FOP_CREATE:
+        case GF_FOP_READ:
+        case GF_FOP_WRITE:
+        case GF_FOP_FLUSH:
+        case GF_FOP_FSTAT:
+        case GF_FOP_GETXATTR:
+        case GF_FOP_FXATTROP:
+                return _gf_true;
+        default:
+                return _gf_false;
+        }
+}
+
+
+
+/* whether an xlator implements any of the fops a compound can carry, in
+   which case it has to see them one by one */
+gf_boolean_t
+compound_fops_handled (struct xlator_fops *fops)
+{
+        return (fops->lookup || fops->open || fops->create || fops->readv ||
+                fops->writev || fops->flush || fops->fstat ||
+                fops->getxattr || fops->fxattrop);
+}
+
+
+static int compound_serial_wind (call_frame_t *frame, xlator_t *this);
+
+
+static int
+compound_serial_unwind (call_frame_t *frame, int32_t op_ret,
+                        int32_t op_errno)
+{
+        compound_local_t *local = NULL;
+        compound_args_t  *args  = NULL;
+
+        local = frame->local;
+        frame->local = NULL;
+
+        args = local->args;
+        GF_FREE (local);
+
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args, NULL);
+
+        return 0;
+}
+
+
+static int
+compound_serial_resume (call_frame_t *frame, xlator_t *this, int32_t op_ret,
+                        int32_t op_errno, dict_t *xdata)
+{
+        compound_local_t *local = NULL;
+        compound_fop_t   *cfop  = NULL;
+
+        local = frame->local;
+        cfop = &local->args->fops[local->index];
+
+        cfop->rsp.op_ret = op_ret;
+        cfop->rsp.op_errno = op_errno;
+        if (xdata)
+                cfop->rsp.xdata = dict_ref (xdata);
+
+        local->index++;
+
+        if (op_ret < 0) {
+                if (local->index < local->args->count)
+                        compound_args_fail (local->args, local->index,
+                                            ECANCELED);
+                return compound_serial_unwind (frame, -1, op_errno);
+        }
+
+        return compound_serial_wind (frame, this);
+}
+
+
+static int32_t
+compound_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, inode_t *inode,
+                     struct iatt *buf, dict_t *xdata, struct iatt *postparent)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0) {
+                cfop->rsp.inode = inode_ref (inode);
+                cfop->rsp.stat = *buf;
+        }
+        if (postparent)
+                cfop->rsp.postparent = *postparent;
+
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_create_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, fd_t *fd,
+                     inode_t *inode, struct iatt *buf, struct iatt *preparent,
+                     struct iatt *postparent, dict_t *xdata)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0) {
+                cfop->rsp.inode = inode_ref (inode);
+                cfop->rsp.stat = *buf;
+                cfop->rsp.preparent = *preparent;
+                cfop->rsp.postparent = *postparent;
+        }
+
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                    int32_t count, struct iatt *stbuf, struct iobref *iobref,
+                    dict_t *xdata)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0) {
+                cfop->rsp.vector = iov_dup (vector, count);
+                if (count && !cfop->rsp.vector) {
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        goto out;
+                }
+                cfop->rsp.count = count;
+                if (iobref)
+                        cfop->rsp.iobref = iobref_ref (iobref);
+                cfop->rsp.stat = *stbuf;
+        }
+out:
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                     struct iatt *postbuf, dict_t *xdata)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0) {
+                cfop->rsp.prestat = *prebuf;
+                cfop->rsp.stat = *postbuf;
+        }
+
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_flush_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_fstat_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                    dict_t *xdata)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0)
+                cfop->rsp.stat = *buf;
+
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int32_t
+compound_xattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, dict_t *dict,
+                    dict_t *xdata)
+{
+        compound_local_t *local = frame->local;
+        compound_fop_t   *cfop  = &local->args->fops[local->index];
+
+        if (op_ret >= 0 && dict)
+                cfop->rsp.xattr = dict_ref (dict);
+
+        return compound_serial_resume (frame, this, op_ret, op_errno, xdata);
+}
+
+
+static int
+compound_serial_wind (call_frame_t *frame, xlator_t *this)
+{
+        compound_local_t *local = NULL;
+        compound_fop_t   *cfop  = NULL;
+
+        local = frame->local;
+
+        if (local->index == local->args->count)
+                return compound_serial_unwind (frame, 0, 0);
+
+        cfop = &local->args->fops[local->index];
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                STACK_WIND (frame, compound_lookup_cbk, this,
+                            this->fops->lookup, &cfop->loc, cfop->xdata);
+                break;
+        case GF_FOP_OPEN:
+                STACK_WIND (frame, compound_open_cbk, this,
+                            this->fops->open, &cfop->loc, cfop->flags,
+                            cfop->fd, cfop->xdata);
+                break;
+        case GF_FOP_CREATE:
+                STACK_WIND (frame, compound_create_cbk, this,
+                            this->fops->create, &cfop->loc, cfop->flags,
+                            cfop->mode, cfop->umask, cfop->fd, cfop->xdata);
+                break;
+        case GF_FOP_READ:
+                STACK_WIND (frame, compound_readv_cbk, this,
+                            this->fops->readv, cfop->fd, cfop->size,
+                            cfop->offset, cfop->flags, cfop->xdata);
+                break;
+        case GF_FOP_WRITE:
+                STACK_WIND (frame, compound_writev_cbk, this,
+                            this->fops->writev, cfop->fd, cfop->vector,
+                            cfop->count, cfop->offset, cfop->flags,
+                            cfop->iobref, cfop->xdata);
+                break;
+        case GF_FOP_FLUSH:
+                STACK_WIND (frame, compound_flush_cbk, this,
+                            this->fops->flush, cfop->fd, cfop->xdata);
+                break;
+        case GF_FOP_FSTAT:
+                STACK_WIND (frame, compound_fstat_cbk, this,
+                            this->fops->fstat, cfop->fd, cfop->xdata);
+                break;
+        case GF_FOP_GETXATTR:
+                STACK_WIND (frame, compound_xattr_cbk, this,
+                            this->fops->getxattr, &cfop->loc, cfop->name,
+                            cfop->xdata);
+                break;
+        case GF_FOP_FXATTROP:
+                STACK_WIND (frame, compound_xattr_cbk, this,
+                            this->fops->fxattrop, cfop->fd, cfop->optype,
+                            cfop->xattr, cfop->xdata);
+                break;
+        default:
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s cannot be part of a compound fop",
+                        gf_fop_list[cfop->fop]);
+                compound_args_fail (local->args, local->index, ENOTSUP);
+                return compound_serial_unwind (frame, -1, ENOTSUP);
+        }
+
+        return 0;
+}
+
+
+/* runs the fops of the compound one after the other through this xlator's
+   own fops: the default for xlators handling any of them (see
+   fill_defaults()) */
+int32_t
+compound_fop_serial (call_frame_t *frame, xlator_t *this,
+                     compound_args_t *args, dict_t *xdata)
+{
+        compound_local_t *local = NULL;
+
+        if (!args || !args->count) {
+                STACK_UNWIND_STRICT (compound, frame, -1, EINVAL, args, NULL);
+                return 0;
+        }
+
+        local = GF_CALLOC (1, sizeof (*local), gf_common_mt_compound_local_t);
+        if (!local) {
+                compound_args_fail (args, 0, ENOMEM);
+                STACK_UNWIND_STRICT (compound, frame, -1, ENOMEM, args, NULL);
+                return 0;
+        }
+
+        local->args = args;
+        frame->local = local;
+
+        compound_serial_wind (frame, this);
+
+        return 0;
+}
@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef _COMPOUND_FOP_UTILS_H
+#define _COMPOUND_FOP_UTILS_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+
+#define GF_COMPOUND_MAX_FOPS 16
+
+/*
+ * A compound fop is a sequence of fops sent down (and over the wire) as a
+ * single one. They are run in order; the first one failing ends the
+ * compound, the fops after it failing with ECANCELED. A fop can use the fd
+ * opened or created by an earlier one. An xlator which cannot let the
+ * compound go on as one (e.g. dht finding the file under migration) fails
+ * all of its fops with EAGAIN; the caller then sends them one by one.
+ *
+ * Fops which can be part of a compound, with the arguments and results
+ * they use:
+ *
+ *   LOOKUP    loc, xdata                    inode, stat, postparent, xdata
+ *   OPEN      loc, fd, flags, xdata         xdata
+ *   CREATE    loc, fd, flags, mode, umask,  inode, stat, preparent,
+ *             xdata                         postparent, xdata
+ *   READV     fd, size, offset, flags,      vector, count, iobref, stat,
+ *             xdata                         xdata
+ *   WRITEV    fd, vector, count, iobref,    prestat, stat, xdata
+ *             offset, flags, xdata
+ *   FLUSH     fd, xdata                     xdata
+ *   FSTAT     fd, xdata                     stat, xdata
+ *   GETXATTR  loc, name, xdata              xattr, xdata
+ *   FXATTROP  fd, optype, xattr, xdata      xattr, xdata
+ *
+ * Every reference held in there (loc, fd, dicts, iobrefs, vectors, name)
+ * is released by compound_args_destroy().
+ */
+typedef struct {
+        glusterfs_fop_t      fop;
+
+        loc_t                loc;
+        fd_t                *fd;
+        int32_t              flags;
+        mode_t               mode;
+        mode_t               umask;
+        size_t               size;
+        off_t                offset;
+        struct iovec        *vector;
+        int32_t              count;
+        struct iobref       *iobref;
+        char                *name;
+        gf_xattrop_flags_t   optype;
+        dict_t              *xattr;
+        dict_t              *xdata;
+
+        struct {
+                int32_t          op_ret;
+                int32_t          op_errno;
+                inode_t         *inode;
+                struct iatt      stat;
+                struct iatt      prestat;
+                struct iatt      preparent;
+                struct iatt      postparent;
+                struct iovec    *vector;
+                int32_t          count;
+                struct iobref   *iobref;
+                dict_t          *xattr;
+                dict_t          *xdata;
+        } rsp;
+} compound_fop_t;
+
+struct _compound_args {
+        int              count;
+        compound_fop_t  *fops;
+};
+
+compound_args_t *
+compound_args_new (int count);
+
+void
+compound_args_destroy (compound_args_t *args);
+
+void
+compound_args_fail (compound_args_t *args, int from, int32_t op_errno);
+
+void
+compound_args_cancel (compound_args_t *args, int failed, int32_t op_errno);
+
+gf_boolean_t
+compound_fop_supported (glusterfs_fop_t fop);
+
+gf_boolean_t
+compound_fops_handled (struct xlator_fops *fops);
+
+#endif /* _COMPOUND_FOP_UTILS_H */
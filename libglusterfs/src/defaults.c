@@ -366,6 +366,14 @@ default_zerofill_failure_cbk (call_frame_t *frame, int32_t op_errno)
 }
 
 
+int32_t
+default_compound_failure_cbk (call_frame_t *frame, int32_t op_errno)
+{
+        STACK_UNWIND_STRICT (compound, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+
 int32_t
 default_getspec_failure_cbk (call_frame_t *frame, int32_t op_errno)
 {
@@ -823,6 +831,16 @@ default_zerofill_cbk_resume(call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+int32_t
+default_compound_cbk_resume (call_frame_t *frame, void *cookie,
+                             xlator_t *this, int32_t op_ret, int32_t op_errno,
+                             compound_args_t *args, dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args, xdata);
+        return 0;
+}
+
+
 int32_t
 default_getspec_cbk_resume (call_frame_t *frame, void *cookie, xlator_t *this,
                             int32_t op_ret, int32_t op_errno, char *spec_data)
@@ -1287,6 +1305,16 @@ default_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+int32_t
+default_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, compound_args_t *args,
+                      dict_t *xdata)
+{
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args, xdata);
+        return 0;
+}
+
+
 int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data)
@@ -1726,6 +1754,16 @@ default_zerofill_resume(call_frame_t *frame, xlator_t *this, fd_t *fd,
 }
 
 
+int32_t
+default_compound_resume (call_frame_t *frame, xlator_t *this,
+                         compound_args_t *args, dict_t *xdata)
+{
+        STACK_WIND (frame, default_compound_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound, args, xdata);
+        return 0;
+}
+
+
 /* FOPS */
 
 int32_t
@@ -2161,6 +2199,19 @@ default_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd,
 }
 
 
+/* passes the compound down as a whole: used by xlators which do not
+   handle any of the fops a compound is made of (see fill_defaults()), and
+   by those which handle them but have nothing to do on them */
+int32_t
+default_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+                  dict_t *xdata)
+{
+        STACK_WIND_TAIL (frame, FIRST_CHILD(this),
+                         FIRST_CHILD(this)->fops->compound, args, xdata);
+        return 0;
+}
+
+
 int32_t
 default_forget (xlator_t *this, inode_t *inode)
 {
@@ -2246,6 +2297,7 @@ struct xlator_fops _default_fops = {
 	.fallocate = default_fallocate,
 	.discard = default_discard,
         .zerofill = default_zerofill,
+        .compound = default_compound,
 
         .getspec = default_getspec,
 };
@@ -2287,6 +2339,19 @@ default_notify (xlator_t *this, int32_t event, void *data, ...)
                 }
         }
         break;
+        case GF_EVENT_UPCALL:
+        {
+                /* the payload (struct gf_upcall) goes up with it */
+                xlator_list_t *parent = this->parents;
+
+                while (parent) {
+                        if (parent->xlator->init_succeeded)
+                                xlator_notify (parent->xlator, event,
+                                               data, NULL);
+                        parent = parent->next;
+                }
+        }
+        break;
         default:
         {
                 xlator_list_t *parent = this->parents;
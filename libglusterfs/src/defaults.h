@@ -263,6 +263,18 @@ int32_t default_zerofill(call_frame_t *frame,
                         off_t offset,
                         off_t len, dict_t *xdata);
 
+int32_t default_compound (call_frame_t *frame,
+                          xlator_t *this,
+                          compound_args_t *args,
+                          dict_t *xdata);
+
+/* runs the fops of a compound one by one through the xlator, see
+   compound-fop-utils.c */
+int32_t compound_fop_serial (call_frame_t *frame,
+                             xlator_t *this,
+                             compound_args_t *args,
+                             dict_t *xdata);
+
 
 /* Resume */
 int32_t default_getspec_resume (call_frame_t *frame,
@@ -492,6 +504,11 @@ int32_t default_zerofill_resume(call_frame_t *frame,
                                off_t offset,
                                off_t len, dict_t *xdata);
 
+int32_t default_compound_resume (call_frame_t *frame,
+                                 xlator_t *this,
+                                 compound_args_t *args,
+                                 dict_t *xdata);
+
 
 /* _cbk_resume */
 
@@ -759,6 +776,11 @@ int32_t default_zerofill_cbk_resume (call_frame_t * frame, void *cookie,
                                      int32_t op_errno, struct iatt *pre,
                                      struct iatt *post, dict_t * xdata);
 
+int32_t default_compound_cbk_resume (call_frame_t *frame, void *cookie,
+                                     xlator_t *this, int32_t op_ret,
+                                     int32_t op_errno, compound_args_t *args,
+                                     dict_t *xdata);
+
 int32_t
 default_getspec_cbk_resume (call_frame_t * frame, void *cookie,
                             xlator_t * this, int32_t op_ret, int32_t op_errno,
@@ -985,6 +1007,11 @@ int32_t default_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                             int32_t op_ret, int32_t op_errno, struct iatt *pre,
                             struct iatt *post, dict_t *xdata);
 
+int32_t default_compound_cbk (call_frame_t *frame, void *cookie,
+                              xlator_t *this, int32_t op_ret,
+                              int32_t op_errno, compound_args_t *args,
+                              dict_t *xdata);
+
 int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data);
@@ -1123,6 +1150,9 @@ default_discard_failure_cbk (call_frame_t *frame, int32_t op_errno);
 int32_t
 default_zerofill_failure_cbk (call_frame_t *frame, int32_t op_errno);
 
+int32_t
+default_compound_failure_cbk (call_frame_t *frame, int32_t op_errno);
+
 int32_t
 default_getspec_failure_cbk (call_frame_t *frame, int32_t op_errno);
 
@@ -128,6 +128,15 @@
 #define GLUSTERFS_POSIXLK_COUNT "glusterfs.posixlk-count"
 #define GLUSTERFS_PARENT_ENTRYLK "glusterfs.parent-entrylk"
 #define GLUSTERFS_INODELK_DOM_COUNT "glusterfs.inodelk-dom-count"
+/* an inodelk with this key set asks the locks xlator to send an upcall to
+ * the client holding it once another owner's request conflicts with it */
+#define GLUSTERFS_INODELK_CONTENTION_NOTIFY "glusterfs.inodelk-contention-notify"
+/* a serialized dict of GF_XATTROP_ADD_ARRAY deltas the brick applies just
+ * before a writev; the reply carries the resulting values under the same key */
+#define GLUSTERFS_WRITE_XATTROP "glusterfs.write-xattrop"
+/* readv may answer with an iobref file segment instead of data; translators
+ * that need the bytes of a read reply must drop this key from the request */
+#define GLUSTERFS_ZERO_COPY_READ "glusterfs.zero-copy-read"
 #define QUOTA_SIZE_KEY "trusted.glusterfs.quota.size"
 #define GFID_TO_PATH_KEY "glusterfs.gfid2path"
 #define GF_XATTR_STIME_PATTERN "trusted.glusterfs.*.stime"
@@ -137,6 +146,38 @@
 #define GF_XATTROP_INDEX_COUNT "glusterfs.xattrop_index_count"
 
 #define GF_GFIDLESS_LOOKUP "gfidless-lookup"
+
+/* a lookup of a directory with this key set to a relative path resolves
+   the path on the brick as far as it goes: the reply carries, under the
+   same key, one gf_lookup_path_entry per directory resolved, in order.
+   The access ACL of the i-th one, if any, comes under GF_LOOKUP_PATH_ACL.i
+   for access-control, which cuts the walk at the first directory the
+   caller may not search. */
+#define GF_LOOKUP_PATH "glusterfs.lookup-path"
+#define GF_LOOKUP_PATH_ACL "glusterfs.lookup-path.acl"
+#define GF_LOOKUP_PATH_MAX_DEPTH 64
+
+/* the iatt of an entry, in network order */
+struct gf_lookup_path_entry {
+        unsigned char gfid[16];
+        uint64_t      ino;
+        uint64_t      dev;
+        uint32_t      mode;
+        uint32_t      nlink;
+        uint32_t      uid;
+        uint32_t      gid;
+        uint64_t      rdev;
+        uint64_t      size;
+        uint32_t      blksize;
+        uint64_t      blocks;
+        uint32_t      atime;
+        uint32_t      atime_nsec;
+        uint32_t      mtime;
+        uint32_t      mtime_nsec;
+        uint32_t      ctime;
+        uint32_t      ctime_nsec;
+} __attribute__ ((packed));
+
 /* replace-brick and pump related internal xattrs */
 #define RB_PUMP_CMD_START       "glusterfs.pump.start"
 #define RB_PUMP_CMD_PAUSE       "glusterfs.pump.pause"
@@ -261,6 +302,7 @@ typedef enum {
 	GF_FOP_FALLOCATE,
 	GF_FOP_DISCARD,
         GF_FOP_ZEROFILL,
+        GF_FOP_COMPOUND,
         GF_FOP_MAXVALUE,
 } glusterfs_fop_t;
 
@@ -545,6 +587,7 @@ typedef enum {
         GF_EVENT_VOLUME_DEFRAG,
         GF_EVENT_PARENT_DOWN,
         GF_EVENT_VOLUME_BARRIER_OP,
+        GF_EVENT_UPCALL,
         GF_EVENT_MAXVAL,
 } glusterfs_event_t;
 
@@ -571,6 +571,50 @@ out:
 }
 
 
+/* An iobuf over memory owned by the caller, which must leave it alone
+ * until @release is called: the last unref may come well after the fop
+ * it was handed to unwinds (eg. write-behind). */
+struct iobuf *
+iobuf_wrap (struct iobuf_pool *iobuf_pool, void *ptr,
+            iobuf_release_t release, void *data)
+{
+        struct iobuf       *iobuf       = NULL;
+        struct iobuf_arena *iobuf_arena = NULL;
+        struct iobuf_arena *trav        = NULL;
+
+        GF_VALIDATE_OR_GOTO ("iobuf", iobuf_pool, out);
+        GF_VALIDATE_OR_GOTO ("iobuf", release, out);
+
+        /* only so that iobuf_size() and friends have an arena to look
+           at: a wrapped iobuf is never put back into it, the last unref
+           hands it to @release */
+        pthread_mutex_lock (&iobuf_pool->mutex);
+        {
+                list_for_each_entry (trav,
+                                     &iobuf_pool->arenas[IOBUF_ARENA_MAX_INDEX],
+                                     list) {
+                        iobuf_arena = trav;
+                        break;
+                }
+        }
+        pthread_mutex_unlock (&iobuf_pool->mutex);
+
+        iobuf = GF_CALLOC (1, sizeof (*iobuf), gf_common_mt_iobuf);
+        if (!iobuf)
+                goto out;
+
+        iobuf->ptr = ptr;
+        iobuf->iobuf_arena = iobuf_arena;
+        iobuf->release = release;
+        iobuf->release_data = data;
+        LOCK_INIT (&iobuf->lock);
+
+        iobuf->ref = 1;
+out:
+        return iobuf;
+}
+
+
 struct iobuf *
 iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size)
 {
@@ -702,6 +746,13 @@ iobuf_put (struct iobuf *iobuf)
 
         GF_VALIDATE_OR_GOTO ("iobuf", iobuf, out);
 
+        if (iobuf->release) {
+                iobuf->release (iobuf->ptr, iobuf->release_data);
+                LOCK_DESTROY (&iobuf->lock);
+                GF_FREE (iobuf);
+                return;
+        }
+
         iobuf_arena = iobuf->iobuf_arena;
         if (!iobuf_arena) {
                 gf_log (THIS->name, GF_LOG_WARNING, "arena not found");
@@ -824,6 +875,12 @@ iobref_destroy (struct iobref *iobref)
         }
 
 	GF_FREE (iobref->iobrefs);
+
+        if (iobref->fdseg) {
+                close (iobref->fdseg->fd);
+                GF_FREE (iobref->fdseg);
+        }
+
         GF_FREE (iobref);
 
 out:
@@ -970,6 +1027,59 @@ iobref_merge (struct iobref *to, struct iobref *from)
         }
         UNLOCK (&from->lock);
 
+        /* a reply with only a file segment has no iobufs to merge */
+        if (from->fdseg && (ret >= 0 || !from->iobrefs[0]))
+                ret = iobref_set_fdseg (to, from->fdseg->fd,
+                                        from->fdseg->offset,
+                                        from->fdseg->len);
+
+out:
+        return ret;
+}
+
+
+/*
+ * Attach @len bytes of @fd at @offset to be sent by the transport after the
+ * message's iovecs. The fd is duplicated, so the caller may close its own
+ * once the iobref is handed over.
+ */
+int
+iobref_set_fdseg (struct iobref *iobref, int fd, off_t offset, size_t len)
+{
+        struct iobref_fdseg *fdseg = NULL;
+        int                  ret   = -1;
+
+        GF_VALIDATE_OR_GOTO ("iobuf", iobref, out);
+
+        fdseg = GF_CALLOC (1, sizeof (*fdseg), gf_common_mt_iobref_fdseg);
+        if (!fdseg)
+                goto out;
+
+        fdseg->fd = dup (fd);
+        if (fdseg->fd < 0) {
+                GF_FREE (fdseg);
+                goto out;
+        }
+        fdseg->offset = offset;
+        fdseg->len = len;
+
+        LOCK (&iobref->lock);
+        {
+                if (!iobref->fdseg) {
+                        iobref->fdseg = fdseg;
+                        fdseg = NULL;
+                }
+        }
+        UNLOCK (&iobref->lock);
+
+        if (fdseg) {
+                /* a message carries at most one segment */
+                close (fdseg->fd);
+                GF_FREE (fdseg);
+                goto out;
+        }
+
+        ret = 0;
 out:
         return ret;
 }
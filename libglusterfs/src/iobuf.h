@@ -47,6 +47,8 @@ struct iobuf_arena;
 /* expandable and contractable pool of memory, internally broken into arenas */
 struct iobuf_pool;
 
+typedef void (*iobuf_release_t) (void *ptr, void *data);
+
 struct iobuf_init_config {
         size_t   pagesize;
         int32_t  num_pages;
@@ -69,6 +71,10 @@ struct iobuf {
 
         void                *free_ptr; /* in case of stdalloc, this is the
                                           one to be freed */
+
+        iobuf_release_t      release; /* in case of memory not owned by the
+                                         iobuf, called on the last unref */
+        void                *release_data;
 };
 
 
@@ -138,12 +144,21 @@ void iobuf_to_iovec(struct iobuf *iob, struct iovec *iov);
 #define iobuf_pagesize(iob) (iob->iobuf_arena->page_size)
 
 
+/* file data a transport sends straight from the page cache (zero-copy
+ * read replies); it follows the message's iovecs on the wire */
+struct iobref_fdseg {
+        int                fd;      /* private dup, closed with the iobref */
+        off_t              offset;
+        size_t             len;
+};
+
 struct iobref {
         gf_lock_t          lock;
         int                ref;
         struct iobuf     **iobrefs;
 	int                alloced;
 	int                used;
+        struct iobref_fdseg *fdseg;
 };
 
 struct iobref *iobref_new ();
@@ -152,6 +167,7 @@ void iobref_unref (struct iobref *iobref);
 int iobref_add (struct iobref *iobref, struct iobuf *iobuf);
 int iobref_merge (struct iobref *to, struct iobref *from);
 void iobref_clear (struct iobref *iobref);
+int iobref_set_fdseg (struct iobref *iobref, int fd, off_t offset, size_t len);
 
 size_t iobuf_size (struct iobuf *iobuf);
 size_t iobref_size (struct iobref *iobref);
@@ -159,4 +175,8 @@ void   iobuf_stats_dump (struct iobuf_pool *iobuf_pool);
 
 struct iobuf *
 iobuf_get2 (struct iobuf_pool *iobuf_pool, size_t page_size);
+
+struct iobuf *
+iobuf_wrap (struct iobuf_pool *iobuf_pool, void *ptr,
+            iobuf_release_t release, void *data);
 #endif /* !_IOBUF_H_ */
@@ -125,6 +125,11 @@ enum gf_common_mem_types_ {
 	gf_common_mt_strfd_t              = 109,
 	gf_common_mt_strfd_data_t         = 110,
         gf_common_mt_regex_t              = 111,
+        gf_common_mt_iobref_fdseg         = 112,
+        gf_common_mt_compound_args_t      = 113,
+        gf_common_mt_compound_fop_t       = 114,
+        gf_common_mt_compound_local_t     = 115,
+        gf_common_mt_rpcsvc_request_queue_t = 116,
         gf_common_mt_end
 };
 #endif
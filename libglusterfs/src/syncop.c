@@ -1042,6 +1042,8 @@ entry_copy (gf_dirent_t *source)
 
 	if (source->inode)
 		sink->inode = inode_ref (source->inode);
+        if (source->dict)
+                sink->dict = dict_ref (source->dict);
         return sink;
 }
 
@@ -2296,6 +2298,46 @@ syncop_zerofill(xlator_t *subvol, fd_t *fd, off_t offset, off_t len)
 }
 
 
+int
+syncop_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int op_ret, int op_errno, compound_args_t *cargs,
+                     dict_t *xdata)
+{
+        struct syncargs *args = NULL;
+
+        args = cookie;
+
+        args->op_ret   = op_ret;
+        args->op_errno = op_errno;
+        if (xdata)
+                args->xdata = dict_ref (xdata);
+
+        __wake (args);
+
+        return 0;
+}
+
+/* results of the fops are in @cargs, whether the compound failed or not */
+int
+syncop_compound (xlator_t *subvol, compound_args_t *cargs, dict_t *xdata_in,
+                 dict_t **xdata_out)
+{
+        struct syncargs args = {0, };
+
+        SYNCOP (subvol, (&args), syncop_compound_cbk, subvol->fops->compound,
+                cargs, xdata_in);
+
+        if (xdata_out)
+                *xdata_out = args.xdata;
+        else if (args.xdata)
+                dict_unref (args.xdata);
+
+        if (args.op_ret < 0)
+                return -args.op_errno;
+        return args.op_ret;
+}
+
+
 int
 syncop_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 	       int op_ret, int op_errno, struct gf_flock *flock,
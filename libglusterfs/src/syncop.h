@@ -414,6 +414,9 @@ int syncop_discard(xlator_t *subvol, fd_t *fd, off_t offset, size_t len);
 
 int syncop_zerofill(xlator_t *subvol, fd_t *fd, off_t offset, off_t len);
 
+int syncop_compound (xlator_t *subvol, compound_args_t *cargs,
+                     dict_t *xdata_in, dict_t **xdata_out);
+
 int syncop_rename (xlator_t *subvol, loc_t *oldloc, loc_t *newloc);
 
 int syncop_lk (xlator_t *subvol, fd_t *fd, int cmd, struct gf_flock *flock);
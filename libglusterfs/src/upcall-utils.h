@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef _UPCALL_UTILS_H
+#define _UPCALL_UTILS_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "glusterfs.h"
+
+/*
+ * Upcalls are notifications a brick sends to one of its clients, not in
+ * reply to a fop. Brick side, a translator passes a struct gf_upcall up
+ * with GF_EVENT_UPCALL; protocol/server sends it to the client named by
+ * client_uid, where protocol/client passes it up again with the same event.
+ * The struct only lives for the time of the notify.
+ */
+typedef enum {
+        GF_UPCALL_EVENT_NULL = 0,
+        GF_UPCALL_INODELK_CONTENTION,
+} gf_upcall_event_t;
+
+struct gf_upcall {
+        char            *client_uid;
+        uuid_t           gfid;
+        uint32_t         event_type;
+        void            *data;
+};
+
+/* GF_UPCALL_INODELK_CONTENTION: a request of another owner conflicts with
+ * the inodelk 'flock' held in 'domain' on the inode */
+struct gf_upcall_inodelk_contention {
+        struct gf_flock  flock;
+        const char      *domain;
+        dict_t          *xdata;
+};
+
+#endif /* _UPCALL_UTILS_H */
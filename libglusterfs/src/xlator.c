@@ -18,6 +18,7 @@
 #include <netdb.h>
 #include <fnmatch.h>
 #include "defaults.h"
+#include "compound-fop-utils.h"
 
 #define SET_DEFAULT_FOP(fn) do {			\
                 if (!xl->fops->fn)			\
@@ -38,6 +39,14 @@ fill_defaults (xlator_t *xl)
                 return;
         }
 
+        /* an xlator handling any of the fops a compound is made of runs
+           them one by one, unless it knows better (its own .compound, or
+           default_compound when it only passes them on); others pass
+           compounds down as they are */
+        if (!xl->fops->compound)
+                xl->fops->compound = compound_fops_handled (xl->fops) ?
+                        compound_fop_serial : default_compound;
+
         SET_DEFAULT_FOP (create);
         SET_DEFAULT_FOP (open);
         SET_DEFAULT_FOP (stat);
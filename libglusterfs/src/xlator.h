@@ -53,6 +53,8 @@ struct _gf_dirent_t;
 typedef struct _gf_dirent_t gf_dirent_t;
 struct _loc;
 typedef struct _loc loc_t;
+struct _compound_args;
+typedef struct _compound_args compound_args_t;
 
 
 typedef int32_t (*event_notify_fn_t) (xlator_t *this, int32_t event, void *data,
@@ -443,6 +445,14 @@ typedef int32_t (*fop_zerofill_cbk_t) (call_frame_t *frame,
                                       struct iatt *preop_stbuf,
                                       struct iatt *postop_stbuf, dict_t *xdata);
 
+typedef int32_t (*fop_compound_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       compound_args_t *args,
+                                       dict_t *xdata);
+
 typedef int32_t (*fop_lookup_t) (call_frame_t *frame,
                                  xlator_t *this,
                                  loc_t *loc,
@@ -680,6 +690,10 @@ typedef int32_t (*fop_zerofill_t) (call_frame_t *frame,
                                   off_t offset,
                                   off_t len,
                                   dict_t *xdata);
+typedef int32_t (*fop_compound_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   compound_args_t *args,
+                                   dict_t *xdata);
 
 struct xlator_fops {
         fop_lookup_t         lookup;
@@ -727,6 +741,7 @@ struct xlator_fops {
 	fop_fallocate_t	     fallocate;
 	fop_discard_t	     discard;
         fop_zerofill_t       zerofill;
+        fop_compound_t       compound;
 
         /* these entries are used for a typechecking hack in STACK_WIND _only_ */
         fop_lookup_cbk_t         lookup_cbk;
@@ -774,6 +789,7 @@ struct xlator_fops {
 	fop_fallocate_cbk_t	 fallocate_cbk;
 	fop_discard_cbk_t	 discard_cbk;
         fop_zerofill_cbk_t       zerofill_cbk;
+        fop_compound_cbk_t       compound_cbk;
 };
 
 typedef int32_t (*cbk_forget_t) (xlator_t *this,
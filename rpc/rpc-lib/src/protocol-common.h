@@ -59,6 +59,7 @@ enum gf_fop_procnum {
 	GFS3_OP_FALLOCATE,
 	GFS3_OP_DISCARD,
         GFS3_OP_ZEROFILL,
+        GFS3_OP_COMPOUND,
         GFS3_OP_MAXVALUE,
 } ;
 
@@ -130,6 +131,7 @@ enum gf_cbk_procnum {
         GF_CBK_FETCHSPEC,
         GF_CBK_INO_FLUSH,
         GF_CBK_EVENT_NOTIFY,
+        GF_CBK_INODELK_CONTENTION,
         GF_CBK_MAXVALUE,
 };
 
@@ -193,6 +193,9 @@ struct rpc_transport {
         int32_t                    refcount;
 
         int32_t                    outstanding_rpc_count;
+        int32_t                    outstanding_rpc_window;
+        gf_boolean_t               outstanding_rpc_throttled;
+        struct timeval             outstanding_rpc_throttle_start;
 
         glusterfs_ctx_t           *ctx;
         dict_t                    *options;
@@ -215,6 +218,7 @@ struct rpc_transport {
         int                        bind_insecure;
         void                      *dl_handle; /* handle of dlopen() */
         char                      *ssl_name;
+        gf_boolean_t               zero_copy; /* sends iobref file segments */
 };
 
 struct rpc_transport_ops {
@@ -33,6 +33,9 @@ typedef int (*rpcsvc_notify_t) (struct rpcsvc_state *, void *mydata,
 struct drc_globals;
 typedef struct drc_globals rpcsvc_drc_globals_t;
 
+struct rpcsvc_request_queue;
+typedef struct rpcsvc_request_queue rpcsvc_request_queue_t;
+
 /* Contains global state required for all the RPC services.
  */
 typedef struct rpcsvc_state {
@@ -76,7 +79,17 @@ typedef struct rpcsvc_state {
 
 	/* per-client limit of outstanding rpc requests */
         int                     outstanding_rpc_limit;
+        /* upper bound of the per-client window grown from
+         * outstanding_rpc_limit, 0 if the window is fixed */
+        int                     outstanding_rpc_window_max;
         gf_boolean_t            addr_namelookup;
+
+        /* worker threads running the actors, requests are handled in the
+         * thread which read them when there are none */
+        rpcsvc_request_queue_t  *request_queues;
+        int                     request_thread_count;
+        int                     request_threads_started;
+        unsigned int            request_queue_next;
 } rpcsvc_t;
 
 /* DRC START */
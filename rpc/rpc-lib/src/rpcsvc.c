@@ -176,35 +176,102 @@ rpcsvc_can_outstanding_req_be_ignored (rpcsvc_request_t *req)
         return _gf_false;
 }
 
+/* Resize the window of a client when it is let go after having been
+ * throttled, depending on how long it waited. Called with trans->lock held.
+ */
+static void
+__rpcsvc_outstanding_window_adapt (rpc_transport_t *trans, int limit,
+                                   int winmax)
+{
+        struct timeval  now     = {0,};
+        int64_t         elapsed = 0;
+        int             window  = 0;
+
+        window = trans->outstanding_rpc_window;
+
+        gettimeofday (&now, NULL);
+        elapsed = (now.tv_sec - trans->outstanding_rpc_throttle_start.tv_sec)
+                  * 1000000 + (now.tv_usec -
+                               trans->outstanding_rpc_throttle_start.tv_usec);
+
+        if (elapsed < RPCSVC_WINDOW_GROW_USEC)
+                window = min (window * 2, winmax);
+        else if (elapsed > RPCSVC_WINDOW_SHRINK_USEC)
+                window = max (window / 2, limit);
+
+        if (window != trans->outstanding_rpc_window)
+                gf_log (GF_RPCSVC, GF_LOG_DEBUG, "outstanding rpc window of "
+                        "%s: %d -> %d (throttled for %"PRId64"us)",
+                        trans->peerinfo.identifier,
+                        trans->outstanding_rpc_window, window, elapsed);
+
+        trans->outstanding_rpc_window = window;
+}
+
 int
 rpcsvc_request_outstanding (rpcsvc_request_t *req, int delta)
 {
-        int ret = 0;
-        int old_count = 0;
-        int new_count = 0;
-        int limit = 0;
+        int              ret    = 0;
+        int              count  = 0;
+        int              limit  = 0;
+        int              winmax = 0;
+        rpc_transport_t *trans  = NULL;
 
         if (rpcsvc_can_outstanding_req_be_ignored (req))
                 return 0;
 
-        pthread_mutex_lock (&req->trans->lock);
+        trans = req->trans;
+
+        pthread_mutex_lock (&trans->lock);
         {
                 limit = req->svc->outstanding_rpc_limit;
-                if (!limit)
+                winmax = req->svc->outstanding_rpc_window_max;
+
+                trans->outstanding_rpc_count += delta;
+                count = trans->outstanding_rpc_count;
+
+                /* the limit is the window a client starts with; when
+                 * adaptive, it grows up to max */
+                if (limit && winmax > limit) {
+                        if (trans->outstanding_rpc_window < limit)
+                                trans->outstanding_rpc_window = limit;
+                        if (trans->outstanding_rpc_window > winmax)
+                                trans->outstanding_rpc_window = winmax;
+                } else {
+                        trans->outstanding_rpc_window = limit;
+                }
+
+                if (!trans->outstanding_rpc_throttled) {
+                        if (!limit ||
+                            count <= trans->outstanding_rpc_window)
+                                goto unlock;
+
+                        ret = rpc_transport_throttle (trans, _gf_true);
+                        trans->outstanding_rpc_throttled = _gf_true;
+                        gettimeofday (&trans->outstanding_rpc_throttle_start,
+                                      NULL);
                         goto unlock;
+                }
 
-                old_count = req->trans->outstanding_rpc_count;
-                req->trans->outstanding_rpc_count += delta;
-                new_count = req->trans->outstanding_rpc_count;
+                if (limit && count > trans->outstanding_rpc_window)
+                        goto unlock;
 
-                if (old_count <= limit && new_count > limit)
-                        ret = rpc_transport_throttle (req->trans, _gf_true);
+                if (limit && winmax > limit) {
+                        __rpcsvc_outstanding_window_adapt (trans, limit, winmax);
+                        if (count > trans->outstanding_rpc_window) {
+                                /* shrunk, wait for more replies */
+                                gettimeofday (
+                                        &trans->outstanding_rpc_throttle_start,
+                                        NULL);
+                                goto unlock;
+                        }
+                }
 
-                if (old_count > limit && new_count <= limit)
-                        ret = rpc_transport_throttle (req->trans, _gf_false);
+                ret = rpc_transport_throttle (trans, _gf_false);
+                trans->outstanding_rpc_throttled = _gf_false;
         }
 unlock:
-        pthread_mutex_unlock (&req->trans->lock);
+        pthread_mutex_unlock (&trans->lock);
 
         return ret;
 }
@@ -412,6 +479,7 @@ rpcsvc_request_init (rpcsvc_t *svc, rpc_transport_t *trans,
         req->trans_private = msg->private;
 
         INIT_LIST_HEAD (&req->txlist);
+        INIT_LIST_HEAD (&req->request_list);
         req->payloadsize = 0;
 
         /* By this time, the data bytes for the auth scheme would have already
@@ -553,6 +621,77 @@ rpcsvc_check_and_reply_error (int ret, call_frame_t *frame, void *opaque)
         return 0;
 }
 
+static void *
+rpcsvc_request_handler (void *arg)
+{
+        rpcsvc_request_queue_t *queue    = NULL;
+        rpcsvc_request_t       *req      = NULL;
+        rpcsvc_program_t       *program  = NULL;
+        int                     ret      = -1;
+
+        queue = arg;
+
+        for (;;) {
+                pthread_mutex_lock (&queue->lock);
+                {
+                        while (list_empty (&queue->requests))
+                                pthread_cond_wait (&queue->cond, &queue->lock);
+
+                        req = list_entry (queue->requests.next,
+                                          rpcsvc_request_t, request_list);
+                        list_del_init (&req->request_list);
+                }
+                pthread_mutex_unlock (&queue->lock);
+
+                THIS = queue->svc->mydata;
+
+                program = rpcsvc_request_program (req);
+                ret = program->actors[req->procnum].actor (req);
+
+                rpcsvc_check_and_reply_error (ret, NULL, req);
+        }
+
+        return NULL;
+}
+
+/* Hand a request over to a worker thread. Requests of an ordered program
+ * from a client all go to the same thread, the others are spread.
+ */
+static int
+rpcsvc_request_enqueue (rpcsvc_t *svc, rpcsvc_request_t *req)
+{
+        rpcsvc_request_queue_t *queue = NULL;
+        unsigned long           idx   = 0;
+
+        pthread_mutex_lock (&svc->rpclock);
+        {
+                if (!svc->request_thread_count)
+                        goto unlock;
+
+                if (rpcsvc_request_program (req)->ordered)
+                        idx = (unsigned long) req->trans
+                              / sizeof (*req->trans);
+                else
+                        idx = svc->request_queue_next++;
+
+                queue = &svc->request_queues[idx % svc->request_thread_count];
+        }
+unlock:
+        pthread_mutex_unlock (&svc->rpclock);
+
+        if (!queue)
+                return -1;
+
+        pthread_mutex_lock (&queue->lock);
+        {
+                list_add_tail (&req->request_list, &queue->requests);
+                pthread_cond_signal (&queue->cond);
+        }
+        pthread_mutex_unlock (&queue->lock);
+
+        return 0;
+}
+
 int
 rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                         rpc_transport_pollin_t *msg)
@@ -678,6 +817,13 @@ rpcsvc_handle_rpc_call (rpcsvc_t *svc, rpc_transport_t *trans,
                                             (synctask_fn_t) actor_fn,
                                             rpcsvc_check_and_reply_error, NULL,
                                             req);
+                } else if (svc->request_thread_count) {
+                        if (msg->hdr_iobuf)
+                                req->hdr_iobuf = iobuf_ref (msg->hdr_iobuf);
+
+                        ret = rpcsvc_request_enqueue (svc, req);
+                        if (ret)
+                                ret = actor_fn (req);
                 } else {
                         ret = actor_fn (req);
                 }
@@ -2147,6 +2293,124 @@ rpcsvc_set_outstanding_rpc_limit (rpcsvc_t *svc, dict_t *options, int defvalue)
         return (0);
 }
 
+/*
+ * Configure() the rpc.outstanding-rpc-window-max param, the size up to which
+ * the window of outstanding requests of a client can grow from
+ * rpc.outstanding-rpc-limit when the client keeps hitting it. A value not
+ * above the limit keeps the window fixed.
+ */
+int
+rpcsvc_set_outstanding_rpc_window_max (rpcsvc_t *svc, dict_t *options,
+                                       int defvalue)
+{
+        int            ret        = -1;
+        int            winmax     = 0;
+        static char    *winmaxkey = "rpc.outstanding-rpc-window-max";
+
+        if ((!svc) || (!options))
+                return (-1);
+
+        if ((defvalue < RPCSVC_MIN_OUTSTANDING_RPC_LIMIT) ||
+            (defvalue > RPCSVC_MAX_OUTSTANDING_RPC_LIMIT)) {
+                return (-1);
+        }
+
+        ret = dict_get_int32 (options, winmaxkey, &winmax);
+        if (ret < 0) {
+                winmax = defvalue;
+        }
+
+        winmax = ((winmax + 8 - 1) >> 3) * 8;
+        if (winmax > RPCSVC_MAX_OUTSTANDING_RPC_LIMIT) {
+                winmax = RPCSVC_MAX_OUTSTANDING_RPC_LIMIT;
+        }
+
+        if (svc->outstanding_rpc_window_max != winmax) {
+                svc->outstanding_rpc_window_max = winmax;
+                gf_log (GF_RPCSVC, GF_LOG_INFO,
+                        "Configured %s with value %d", winmaxkey, winmax);
+        }
+
+        return (0);
+}
+
+/*
+ * Configure() the rpc.request-threads param: the number of threads the
+ * actors are run in. With 0, they run in the thread which read the request.
+ * Threads are started as needed and never stopped; when the count is
+ * lowered, the ones above it are simply not handed requests anymore.
+ */
+int
+rpcsvc_set_request_threads (rpcsvc_t *svc, dict_t *options, int defvalue)
+{
+        int                     ret        = -1;
+        int                     count      = 0;
+        int                     i          = 0;
+        rpcsvc_request_queue_t *queue      = NULL;
+        static char            *threadskey = "rpc.request-threads";
+
+        if ((!svc) || (!options))
+                return (-1);
+
+        ret = dict_get_int32 (options, threadskey, &count);
+        if (ret < 0) {
+                count = defvalue;
+        }
+
+        if ((count < 0) || (count > RPCSVC_MAX_REQUEST_THREADS))
+                return (-1);
+
+        pthread_mutex_lock (&svc->rpclock);
+        {
+                ret = 0;
+
+                if (count && !svc->request_queues) {
+                        svc->request_queues =
+                                GF_CALLOC (RPCSVC_MAX_REQUEST_THREADS,
+                                           sizeof (*svc->request_queues),
+                                           gf_common_mt_rpcsvc_request_queue_t);
+                        if (!svc->request_queues) {
+                                ret = -1;
+                                goto unlock;
+                        }
+                }
+
+                for (i = svc->request_threads_started; i < count; i++) {
+                        queue = &svc->request_queues[i];
+                        queue->svc = svc;
+                        pthread_mutex_init (&queue->lock, NULL);
+                        pthread_cond_init (&queue->cond, NULL);
+                        INIT_LIST_HEAD (&queue->requests);
+
+                        ret = gf_thread_create (&queue->thread, NULL,
+                                                rpcsvc_request_handler, queue);
+                        if (ret) {
+                                gf_log (GF_RPCSVC, GF_LOG_ERROR,
+                                        "failed to start request thread: %s",
+                                        strerror (ret));
+                                pthread_cond_destroy (&queue->cond);
+                                pthread_mutex_destroy (&queue->lock);
+                                ret = -1;
+                                break;
+                        }
+                        pthread_detach (queue->thread);
+                        svc->request_threads_started++;
+                }
+
+                count = min (count, svc->request_threads_started);
+                if (svc->request_thread_count != count) {
+                        svc->request_thread_count = count;
+                        gf_log (GF_RPCSVC, GF_LOG_INFO,
+                                "Configured %s with value %d", threadskey,
+                                count);
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&svc->rpclock);
+
+        return ret;
+}
+
 /* The global RPC service initializer.
  */
 rpcsvc_t *
@@ -39,9 +39,20 @@
 #endif
 
 #define RPCSVC_DEFAULT_OUTSTANDING_RPC_LIMIT 64 /* Default for protocol/server */
-#define RPCSVC_DEF_NFS_OUTSTANDING_RPC_LIMIT 16 /* Default for nfs/server */
+#define RPCSVC_DEF_NFS_OUTSTANDING_RPC_LIMIT 64 /* Default for nfs/server */
 #define RPCSVC_MAX_OUTSTANDING_RPC_LIMIT 65536
 #define RPCSVC_MIN_OUTSTANDING_RPC_LIMIT 0 /* No limit i.e. Unlimited */
+#define RPCSVC_DEF_NFS_OUTSTANDING_RPC_WINDOW_MAX 1024 /* nfs/server */
+
+/* A per-client window throttled for less than this was drained quickly
+ * enough to be the bottleneck: double it. Throttled for longer than the
+ * second one, the backend is behind: halve it back towards the limit.
+ */
+#define RPCSVC_WINDOW_GROW_USEC   2000
+#define RPCSVC_WINDOW_SHRINK_USEC 100000
+
+#define RPCSVC_DEF_NFS_REQUEST_THREADS 0
+#define RPCSVC_MAX_REQUEST_THREADS     64
 
 #define GF_RPCSVC       "rpc-service"
 #define RPCSVC_THREAD_STACK_SIZE ((size_t)(1024 * GF_UNIT_KB))
@@ -254,6 +265,17 @@ struct rpcsvc_request {
 
         /* pointer to cached reply for use in DRC */
         drc_cached_op_t         *reply;
+
+        /* to link to the queue of a request worker thread */
+        struct list_head        request_list;
+};
+
+struct rpcsvc_request_queue {
+        rpcsvc_t                *svc;
+        pthread_t               thread;
+        pthread_mutex_t         lock;
+        pthread_cond_t          cond;
+        struct list_head        requests;
 };
 
 #define rpcsvc_request_program(req) ((rpcsvc_program_t *)((req)->prog))
@@ -407,6 +429,10 @@ struct rpcsvc_program {
 	/* Execute actor function as a synctask? */
 	gf_boolean_t            synctask;
 
+        /* Requests of a client must be handled in the order they came
+         * in, even with worker threads? */
+        gf_boolean_t            ordered;
+
         /* list member to link to list of registered services with rpcsvc */
         struct list_head        program;
 };
@@ -601,6 +627,11 @@ rpcsvc_set_root_squash (rpcsvc_t *svc, dict_t *options);
 int
 rpcsvc_set_outstanding_rpc_limit (rpcsvc_t *svc, dict_t *options, int defvalue);
 int
+rpcsvc_set_outstanding_rpc_window_max (rpcsvc_t *svc, dict_t *options,
+                                       int defvalue);
+int
+rpcsvc_set_request_threads (rpcsvc_t *svc, dict_t *options, int defvalue);
+int
 rpcsvc_auth_array (rpcsvc_t *svc, char *volname, int *autharr, int arrlen);
 rpcsvc_vector_sizer
 rpcsvc_get_program_vector_sizer (rpcsvc_t *svc, uint32_t prognum,
@@ -36,6 +36,9 @@
 #include <netinet/tcp.h>
 #include <rpc/xdr.h>
 #include <sys/ioctl.h>
+#ifdef GF_LINUX_HOST_OS
+#include <sys/sendfile.h>
+#endif
 #define GF_LOG_ERRNO(errno) ((errno == ENOTCONN) ? GF_LOG_DEBUG : GF_LOG_ERROR)
 #define SA(ptr) ((struct sockaddr *)ptr)
 
@@ -909,6 +912,9 @@ __socket_ioq_new (rpc_transport_t *this, rpc_transport_msg_t *msg)
                 + iov_length (msg->proghdr, msg->proghdrcount)
                 + iov_length (msg->progpayload, msg->progpayloadcount);
 
+        if (msg->iobref && msg->iobref->fdseg)
+                size += msg->iobref->fdseg->len;
+
         if (size > RPC_MAX_FRAGMENT_SIZE) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "msg size (%u) bigger than the maximum allowed size on "
@@ -944,8 +950,14 @@ __socket_ioq_new (rpc_transport_t *this, rpc_transport_msg_t *msg)
         entry->pending_vector = entry->vector;
         entry->pending_count  = entry->count;
 
-        if (msg->iobref != NULL)
+        if (msg->iobref != NULL) {
                 entry->iobref = iobref_ref (msg->iobref);
+                entry->fdseg = entry->iobref->fdseg;
+                if (entry->fdseg) {
+                        entry->fdseg_offset = entry->fdseg->offset;
+                        entry->fdseg_pending = entry->fdseg->len;
+                }
+        }
 
         INIT_LIST_HEAD (&entry->list);
 
@@ -992,6 +1004,58 @@ out:
 }
 
 
+/*
+ * Send the file segment of @entry straight from the page cache. Same return
+ * values as __socket_rwv().
+ */
+static int
+__socket_sendfile (rpc_transport_t *this, struct ioq *entry)
+{
+#ifdef GF_LINUX_HOST_OS
+        static char       zeroes[4096];
+        socket_private_t *priv = NULL;
+        ssize_t           ret  = -1;
+        size_t            len  = 0;
+
+        priv = this->private;
+
+        while (entry->fdseg_pending) {
+                ret = sendfile (priv->sock, entry->fdseg->fd,
+                                &entry->fdseg_offset, entry->fdseg_pending);
+                if (ret == 0) {
+                        /* file got truncated after the reply was built,
+                           the peer still expects the advertised size */
+                        len = min (entry->fdseg_pending, sizeof (zeroes));
+                        ret = write (priv->sock, zeroes, len);
+                }
+
+                if (ret == -1) {
+                        if (errno == EINTR)
+                                continue;
+                        if (errno == EAGAIN)
+                                return 1;
+
+                        if (__does_socket_rwv_error_need_logging (priv, 1)) {
+                                gf_log (this->name, GF_LOG_WARNING,
+                                        "sendfile on %s failed (%s)",
+                                        this->peerinfo.identifier,
+                                        strerror (errno));
+                        }
+                        return -1;
+                }
+
+                entry->fdseg_pending -= ret;
+                this->total_bytes_write += ret;
+        }
+
+        return 0;
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+}
+
+
 static int
 __socket_ioq_churn_entry (rpc_transport_t *this, struct ioq *entry, int direct)
 {
@@ -1004,6 +1068,9 @@ __socket_ioq_churn_entry (rpc_transport_t *this, struct ioq *entry, int direct)
                                &entry->pending_vector,
                                &entry->pending_count);
 
+        if (ret == 0 && entry->fdseg_pending)
+                ret = __socket_sendfile (this, entry);
+
         if (ret == 0) {
                 /* current entry was completely written */
                 GF_ASSERT (entry->pending_count == 0);
@@ -2592,6 +2659,10 @@ socket_server_event_handler (int fd, int idx, void *data,
 
 			new_priv->sock = new_sock;
 			new_priv->own_thread = priv->own_thread;
+#ifdef GF_LINUX_HOST_OS
+                        /* sendfile() would bypass the SSL layer */
+                        new_trans->zero_copy = !new_priv->use_ssl;
+#endif
 
                         new_priv->ssl_ctx = priv->ssl_ctx;
 			if (new_priv->use_ssl && !new_priv->own_thread) {
@@ -106,6 +106,10 @@ struct ioq {
         struct iovec      *pending_vector;
         int                pending_count;
         struct iobref     *iobref;
+        /* zero-copy payload, sent with sendfile() after the vectors */
+        struct iobref_fdseg *fdseg;
+        off_t              fdseg_offset;
+        size_t             fdseg_pending;
 };
 
 typedef struct {
@@ -616,6 +616,36 @@ struct gfs3_fstat_req {
 }  ;
 
 
+/* a compound fop carries the requests of its fops, each encoded as the
+   request of that fop, and gets their replies back the same way. A fop
+   working on an fd opened by an earlier fop of the compound refers to it
+   with fd_link (index of that fop) instead of a remote fd */
+ struct gfs3_compound_fop_req {
+        int      fop;
+        int      fd_link;
+        opaque   args<>;
+        opaque   data<>; /* payload of a write */
+}  ;
+
+ struct gfs3_compound_req {
+        struct gfs3_compound_fop_req fops<>;
+        opaque   xdata<>; /* Extra data */
+}  ;
+
+ struct gfs3_compound_fop_rsp {
+        int      fop;
+        opaque   rsp<>;
+        opaque   data<>; /* payload of a read */
+}  ;
+
+ struct gfs3_compound_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gfs3_compound_fop_rsp fops<>;
+        opaque   xdata<>; /* Extra data */
+}  ;
+
+
  struct gfs3_rchecksum_req {
         quad_t   fd;
         u_quad_t  offset;
@@ -759,6 +789,15 @@ struct gf_event_notify_rsp {
 	opaque dict<>;
 };
 
+/* GF_CBK_INODELK_CONTENTION: another owner waits on the inodelk 'flock'
+   the client holds in 'domain' */
+struct gfs3_cbk_inodelk_contention_req {
+        opaque gfid[16];
+        struct gf_proto_flock flock;
+        string domain<>;
+        opaque xdata<>;
+};
+
 
 struct gf_getsnap_name_uuid_req {
         opaque dict<>;
@@ -0,0 +1,63 @@
+#!/bin/bash
+
+#With dirty-region tracking, data self-heal copies only the regions written
+#while a brick was down and drops the bitmap once healed.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function region_md5sum {
+        dd if=$1 bs=4k skip=$2 count=1 2>/dev/null | md5sum | awk '{print $1}'
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.dirty-region-size 1MB
+TEST $CLI volume set $V0 cluster.data-self-heal-algorithm full
+TEST $CLI volume set $V0 cluster.data-self-heal off
+TEST $CLI volume set $V0 cluster.metadata-self-heal off
+TEST $CLI volume set $V0 cluster.entry-self-heal off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST dd if=/dev/urandom of=$M0/file bs=1024k count=16
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+
+#Only the region at 8M is written while the brick is down
+TEST dd if=/dev/urandom of=$M0/file bs=4k seek=2048 count=1 conv=notrunc
+TEST getfattr -n trusted.afr.dirty-regions $B0/${V0}1/file
+
+#Changed behind gluster's back, not in a dirty region: must not be healed
+TEST dd if=/dev/zero of=$B0/${V0}0/file bs=4k count=1 conv=notrunc
+zero_md5sum=$(dd if=/dev/zero bs=4k count=1 2>/dev/null | md5sum | awk '{print $1}')
+
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+
+EXPECT $(region_md5sum $B0/${V0}1/file 2048) region_md5sum $B0/${V0}0/file 2048
+EXPECT $zero_md5sum region_md5sum $B0/${V0}0/file 0
+
+#Bitmaps are gone once nothing is pending
+TEST ! getfattr -n trusted.afr.dirty-regions $B0/${V0}0/file
+TEST ! getfattr -n trusted.afr.dirty-regions $B0/${V0}1/file
+
+#Without tracking the whole file is healed
+TEST $CLI volume set $V0 cluster.dirty-region-size 0
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST dd if=/dev/urandom of=$M0/file bs=4k seek=1024 count=1 conv=notrunc
+TEST ! getfattr -n trusted.afr.dirty-regions $B0/${V0}1/file
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+EXPECT $(md5sum < $B0/${V0}1/file | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+
+cleanup;
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+#Full crawls are checkpointed on the bricks: each completed crawl bumps the
+#checkpoint and marks the directories it went through.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function crawl_ckpt {
+        getfattr -d -m trusted.afr.shd-crawl-ckpt -e text $1 2>/dev/null | \
+                grep "shd-crawl-ckpt" | cut -f2 -d'"' | \
+                awk -F: '{ if ($1 == $3) print $3; else print "-" }'
+}
+
+function crawl_mark {
+        getfattr -d -m trusted.afr.shd-crawl-mark -e text $1 2>/dev/null | \
+                grep "shd-crawl-mark" | cut -f2 -d'"' | cut -f1 -d:
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.shd-max-threads 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST mkdir -p $M0/a/b/c $M0/d
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST touch $M0/a/b/c/file $M0/d/file
+
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0 full
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+TEST stat $B0/${V0}0/a/b/c/file
+TEST stat $B0/${V0}0/d/file
+
+EXPECT_WITHIN $HEAL_TIMEOUT "1" crawl_ckpt $B0/${V0}1
+EXPECT "1" crawl_mark $B0/${V0}1/a/b/c
+EXPECT "1" crawl_mark $B0/${V0}1/d
+
+#Incremental crawls still go into modified directories
+TEST $CLI volume set $V0 cluster.shd-full-crawl-incremental on
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST touch $M0/d/file2
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+TEST $CLI volume heal $V0 full
+EXPECT_WITHIN $HEAL_TIMEOUT "2" crawl_ckpt $B0/${V0}1
+TEST stat $B0/${V0}0/d/file2
+EXPECT "2" crawl_mark $B0/${V0}1/d
+EXPECT "2" crawl_mark $B0/${V0}1/a
+EXPECT "1" crawl_mark $B0/${V0}1/a/b
+
+cleanup;
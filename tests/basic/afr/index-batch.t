@@ -0,0 +1,48 @@
+#!/bin/bash
+
+#Index entries of files written to with all bricks up go away once the
+#batch window is over, and index heal still heals what is pending.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.data-self-heal off
+TEST $CLI volume set $V0 cluster.metadata-self-heal off
+TEST $CLI volume set $V0 cluster.entry-self-heal off
+TEST $CLI volume set $V0 features.index-batch-window 2000
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+
+for i in {1..10}
+do
+        TEST dd if=/dev/urandom of=$M0/file bs=4k count=1 seek=$i conv=notrunc
+done
+EXPECT_WITHIN 5 "0" afr_get_index_count $B0/${V0}0
+EXPECT_WITHIN 5 "0" afr_get_index_count $B0/${V0}1
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+for i in {1..10}
+do
+        echo $i > $M0/file$i
+done
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=1 conv=notrunc
+
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+
+EXPECT "10" cat $B0/${V0}0/file10
+EXPECT $(md5sum < $B0/${V0}1/file | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+EXPECT_WITHIN 5 "0" afr_get_index_count $B0/${V0}0
+EXPECT_WITHIN 5 "0" afr_get_index_count $B0/${V0}1
+
+cleanup;
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+#With lock-caching, the eager-lock held through an fd is released as soon as
+#another fd, here of another mount, wants to write, instead of after the
+#post-op delay.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../fileio.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.lock-caching on
+TEST $CLI volume set $V0 cluster.post-op-delay-secs 30
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M1;
+
+TEST touch $M0/file
+TEST fd1=`fd_available`
+TEST fd_open $fd1 'w' $M0/file
+TEST fd2=`fd_available`
+TEST fd_open $fd2 'w' $M0/file
+
+#Both fds keep writing under their eager-lock
+TEST fd_write $fd1 "first"
+TEST fd_write $fd2 "second"
+TEST fd_write $fd1 "third"
+
+#The other mount would wait for the post-op delay without the upcall
+TEST timeout 15 dd if=/dev/zero of=$M1/file bs=4k count=1 conv=notrunc
+TEST timeout 15 dd if=/dev/zero of=$M1/file bs=4k seek=1 count=1 conv=notrunc
+
+TEST fd_close $fd1
+TEST fd_close $fd2
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+#Nothing pending, and the bricks agree
+EXPECT "0" afr_get_pending_heal_count $V0
+EXPECT $(md5sum < $B0/${V0}1/file | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+
+cleanup;
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#With read-hash-mode 3 reads go to the brick measured as least loaded, and
+#move to the other one when it goes down.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+function read_fast_child {
+        local fpath=$(generate_mount_statedump $V0)
+        grep read_fast_child $fpath | head -1 | cut -f2 -d'='
+        rm -f $fpath
+}
+
+function read_latency_sampled {
+        local fpath=$(generate_mount_statedump $V0)
+        grep "read_latency\[" $fpath | cut -f2 -d'=' | grep -vc "^0$"
+        rm -f $fpath
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.read-hash-mode 3
+TEST $CLI volume set $V0 cluster.choose-local off
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0 --direct-io-mode=yes;
+
+TEST dd if=/dev/urandom of=$M0/file bs=1024k count=4
+md5=$(md5sum < $B0/${V0}0/file | awk '{print $1}')
+for i in {1..10}
+do
+        EXPECT $md5 echo $(md5sum < $M0/file | awk '{print $1}')
+done
+
+#The reads were measured
+EXPECT_NOT "0" read_latency_sampled
+fast=$(read_fast_child)
+TEST [ "$fast" -ge 0 ]
+
+#Reads go on from the other brick
+TEST kill_brick $V0 $H0 $B0/${V0}$fast
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "0" afr_child_up_status $V0 $fast
+EXPECT $md5 echo $(md5sum < $M0/file | awk '{print $1}')
+EXPECT_NOT "$fast" read_fast_child
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+#Index heal with several healer threads per brick: directories, metadata
+#and data of many files pending heal must all be healed.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.shd-max-threads 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+
+for i in {1..10}
+do
+        TEST mkdir $M0/dir$i
+        for j in {1..10}
+        do
+                echo $i$j > $M0/dir$i/file$j
+        done
+done
+TEST dd if=/dev/urandom of=$M0/big bs=1024k count=4
+TEST chmod 600 $M0/dir1/file1
+
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+
+EXPECT "100" echo $(ls $B0/${V0}0/dir*/ | grep -c file)
+EXPECT "510" echo $(cat $B0/${V0}0/dir5/file10)
+EXPECT "600" stat -c %a $B0/${V0}0/dir1/file1
+big_md5sum=$(md5sum $B0/${V0}1/big | awk '{print $1}')
+EXPECT $big_md5sum echo $(md5sum $B0/${V0}0/big | awk '{print $1}')
+
+#Heal rate is reported in the crawl statistics
+EXPECT_NOT "0" echo $($CLI volume heal $V0 statistics | grep -c "Heal rate")
+
+#Lowering the number of threads does not stop index heal
+TEST $CLI volume set $V0 cluster.shd-max-threads 1
+TEST kill_brick $V0 $H0 $B0/${V0}1
+TEST touch $M0/dir2/newfile
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+TEST stat $B0/${V0}1/dir2/newfile
+
+cleanup;
@@ -0,0 +1,63 @@
+#!/bin/bash
+
+#With pre-op-compat off the pre-op of a write is applied by the bricks along
+#with it, and with post-op-piggyback the undirtying rides on the next write
+#under the same eager-lock, or is sent before the lock is released: either
+#way the file ends up clean on all bricks. With a brick down the full
+#sequence marks the pending counts for heal.
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../fileio.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 cluster.pre-op-compat off
+TEST $CLI volume set $V0 cluster.post-op-piggyback on
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 cluster.self-heal-daemon off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+
+TEST touch $M0/file
+TEST fd=`fd_available`
+TEST fd_open $fd 'w' $M0/file
+for i in {1..10}
+do
+        TEST fd_write $fd "write$i"
+done
+
+#The last undirtying is sent before the lock goes
+EXPECT_WITHIN 10 "000000000000000000000000" get_hex_xattr trusted.afr.dirty $B0/${V0}0/file
+EXPECT_WITHIN 10 "000000000000000000000000" get_hex_xattr trusted.afr.dirty $B0/${V0}1/file
+EXPECT_WITHIN 10 "0" afr_get_index_count $B0/${V0}0
+EXPECT_WITHIN 10 "0" afr_get_index_count $B0/${V0}1
+
+#Also with the lock taken and released for each write
+TEST $CLI volume set $V0 cluster.eager-lock off
+TEST fd_write $fd "close"
+TEST fd_close $fd
+EXPECT_WITHIN 10 "000000000000000000000000" get_hex_xattr trusted.afr.dirty $B0/${V0}0/file
+EXPECT_WITHIN 10 "000000000000000000000000" get_hex_xattr trusted.afr.dirty $B0/${V0}1/file
+
+#A brick down: the write is accounted as pending on the other
+TEST kill_brick $V0 $H0 $B0/${V0}0
+TEST dd if=/dev/urandom of=$M0/file bs=4k count=4 conv=notrunc
+EXPECT_NOT "00000000" afr_get_specific_changelog_xattr $B0/${V0}1/file trusted.afr.$V0-client-0 data
+
+TEST $CLI volume set $V0 cluster.self-heal-daemon on
+$CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 1
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "0" afr_get_pending_heal_count $V0
+EXPECT $(md5sum < $B0/${V0}1/file | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup;
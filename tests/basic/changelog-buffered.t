@@ -0,0 +1,40 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+CHANGELOG_DIR=$B0/${V0}0/.glusterfs/changelogs
+
+function entry_records()
+{
+        cat $CHANGELOG_DIR/CHANGELOG.* 2>/dev/null | \
+                grep -a -o "E[0-9a-f-]\{36\}" | wc -l
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 changelog.op-mode buffered
+TEST $CLI volume set $V0 changelog.buffered-flush-interval 10
+TEST ! $CLI volume set $V0 changelog.buffered-flush-interval 0
+TEST $CLI volume set $V0 changelog.encoding ascii
+TEST $CLI volume set $V0 changelog.rollover-time 2
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST $CLI volume set $V0 changelog on
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..20}
+
+## mkdir + 20 creates, merged into the changelogs by the writer thread
+EXPECT_WITHIN 10 "21" entry_records
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+CHANGELOG_DIR=$B0/${V0}0/.glusterfs/changelogs
+
+function indexed_changelogs()
+{
+        local count=0
+        for f in $CHANGELOG_DIR/CHANGELOG.*; do
+                [ -f $f ] || continue
+                [ "$(tail -c 24 $f | head -c 8)" == "GFCLIDX1" ] && count=$((count+1))
+        done
+        echo $count
+}
+
+function htime_index_magic()
+{
+        head -c 8 $CHANGELOG_DIR/htime/index/HTIME.* 2>/dev/null | head -1
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 changelog.encoding indexed
+TEST $CLI volume set $V0 changelog.rollover-time 2
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST $CLI volume set $V0 changelog on
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..20}
+TEST mv $M0/dir/file1 $M0/dir/file0
+TEST chmod 600 $M0/dir/file2
+TEST dd if=/dev/zero of=$M0/dir/file3 bs=4k count=1
+
+## rolled over changelogs carry the record index
+EXPECT_WITHIN 10 "^[1-9]" indexed_changelogs
+EXPECT "GFHTIDX1" htime_index_magic
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
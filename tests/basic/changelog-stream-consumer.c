@@ -0,0 +1,62 @@
+/* Subscribes to the records streamed by the changelog translator of a
+   brick and prints them, one "<type> <gfid in hex>" line per record and
+   "OVERRUN" when the brick dropped records, until killed or <seconds>
+   are over.
+
+   usage: changelog-stream-consumer <brick> <scratch-dir> <logfile>
+                                    <seconds> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <glusterfs/gfchangelog/changelog.h>
+
+static void
+stream_cbk (gf_changelog_record_t *records, size_t nr, void *data)
+{
+        size_t i = 0;
+        int    j = 0;
+
+        if (!nr)
+                printf ("OVERRUN\n");
+
+        for (i = 0; i < nr; i++) {
+                printf ("%c ", records[i].type);
+                for (j = 0; j < 16; j++)
+                        printf ("%02x", records[i].gfid[j]);
+                printf ("\n");
+        }
+
+        fflush (stdout);
+}
+
+int
+main (int argc, char *argv[])
+{
+        int seconds = 0;
+
+        if (argc != 5) {
+                fprintf (stderr, "usage: %s <brick> <scratch-dir> <logfile> "
+                         "<seconds>\n", argv[0]);
+                return 1;
+        }
+
+        if (gf_changelog_register (argv[1], argv[2], argv[3], 9, 5)) {
+                fprintf (stderr, "gf_changelog_register: %s\n",
+                         strerror (errno));
+                return 1;
+        }
+
+        if (gf_changelog_stream (stream_cbk, NULL, 4)) {
+                fprintf (stderr, "gf_changelog_stream: %s\n",
+                         strerror (errno));
+                return 1;
+        }
+
+        for (seconds = atoi (argv[4]); seconds > 0; seconds--)
+                sleep (1);
+
+        return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+CHANGELOG_DIR=$B0/${V0}0/.glusterfs/changelogs
+SCRATCH_DIR=/tmp/changelog-streaming-scratch
+STREAM_OUT=/tmp/changelog-streaming.out
+
+function rolled_over_changelogs()
+{
+        ls $CHANGELOG_DIR/CHANGELOG.* 2>/dev/null | wc -l
+}
+
+## the consumer starts getting records at a rollover after it subscribed:
+## keep the changelogs from being empty until it does
+function streamed_records()
+{
+        touch $M0/warmup.$RANDOM
+        grep -c "^[DME] " $STREAM_OUT
+}
+
+## how many times a record of type $1 for the gfid of $2 was streamed
+function streamed()
+{
+        local gfid=$(getfattr -n trusted.gfid -e hex $B0/${V0}0/$2 \
+                     2>/dev/null | grep "trusted.gfid=" | cut -d= -f2)
+        grep -c "^$1 ${gfid#0x}$" $STREAM_OUT
+}
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 changelog.rollover-time 2
+TEST $CLI volume set $V0 changelog.streaming on
+TEST $CLI volume set $V0 changelog.stream-buffer-size 1MB
+TEST ! $CLI volume set $V0 changelog.stream-buffer-size 1KB
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=/$V0 --volfile-server=$H0 $M0
+TEST $CLI volume set $V0 changelog on
+
+build_tester $(dirname $0)/changelog-stream-consumer.c -lgfchangelog
+rm -rf $SCRATCH_DIR $STREAM_OUT
+$(dirname $0)/changelog-stream-consumer $B0/${V0}0 $SCRATCH_DIR /dev/null 120 \
+        > $STREAM_OUT &
+CONSUMER=$!
+EXPECT_WITHIN 30 "^[1-9]" streamed_records
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..20}
+TEST mv $M0/dir/file1 $M0/dir/file0
+echo data > $M0/dir/file2
+
+## entry and data records come through as journalled, with their gfids
+EXPECT_WITHIN 10 "^[1-9]" streamed E dir
+EXPECT_WITHIN 10 "^[1-9]" streamed E dir/file0
+EXPECT_WITHIN 10 "^[1-9]" streamed E dir/file20
+EXPECT_WITHIN 10 "^[1-9]" streamed D dir/file2
+
+## changelogs are still journalled and rolled over with streaming on
+EXPECT_WITHIN 10 "^[1-9]" rolled_over_changelogs
+
+## turning streaming off sends the consumer back to the changelogs
+TEST $CLI volume set $V0 changelog.streaming off
+EXPECT_WITHIN 10 "^[1-9]" grep -c "^OVERRUN$" $STREAM_OUT
+TEST touch $M0/dir/file21
+EXPECT "1" online_brick_count
+TEST kill -0 $CONSUMER
+
+kill $CONSUMER
+wait $CONSUMER 2>/dev/null
+cleanup_tester $(dirname $0)/changelog-stream-consumer
+rm -rf $SCRATCH_DIR $STREAM_OUT
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,57 @@
+/* Reads a file with glfs_read_file() and checks what comes back.
+
+   usage: gfapi-compound-read <host> <volume> <logfile> <path> <offset>
+                              <expected> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <glusterfs/api/glfs.h>
+
+int
+main (int argc, char *argv[])
+{
+        glfs_t  *fs     = NULL;
+        char     buf[4096];
+        ssize_t  ret    = -1;
+        size_t   len    = 0;
+
+        if (argc != 7) {
+                fprintf (stderr, "usage: %s <host> <volume> <logfile> "
+                         "<path> <offset> <expected>\n", argv[0]);
+                return 1;
+        }
+
+        fs = glfs_new (argv[2]);
+        if (!fs)
+                return 1;
+
+        if (glfs_set_volfile_server (fs, "tcp", argv[1], 24007) ||
+            glfs_set_logging (fs, argv[3], 7) || glfs_init (fs)) {
+                fprintf (stderr, "cannot initialize %s\n", argv[2]);
+                return 1;
+        }
+
+        len = strlen (argv[6]);
+
+        ret = glfs_read_file (fs, argv[4], buf, sizeof (buf),
+                              atoll (argv[5]));
+        if (ret < 0) {
+                fprintf (stderr, "glfs_read_file: %s\n", strerror (errno));
+                goto out;
+        }
+
+        if (ret != len || memcmp (buf, argv[6], len)) {
+                fprintf (stderr, "read %zd bytes: \"%.*s\"\n", ret, (int) ret,
+                         buf);
+                ret = -1;
+                goto out;
+        }
+
+        ret = 0;
+out:
+        glfs_fini (fs);
+
+        return (ret < 0) ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+#!/bin/bash
+
+#glfs_read_file() sends open, read and flush as a single compound fop: the
+#brick sees one COMPOUND call and no READ of its own, with the performance
+#xlators off and on.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function brick_fop_calls {
+        $CLI volume profile $V0 info | grep -w "$1" | head -1 | \
+                awk '{print $(NF-1)}'
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST glusterfs -s $H0 --volfile-id $V0 $M0
+TEST mkdir $M0/dir
+echo -n "hello compound" > $M0/dir/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+build_tester $(dirname $0)/gfapi-compound-read.c -lgfapi
+
+TEST $CLI volume profile $V0 start
+TEST $(dirname $0)/gfapi-compound-read $H0 $V0 /dev/null /dir/file 0 \
+        "hello compound"
+TEST $(dirname $0)/gfapi-compound-read $H0 $V0 /dev/null /dir/file 6 \
+        "compound"
+
+EXPECT "2" brick_fop_calls COMPOUND
+EXPECT "" brick_fop_calls READ
+EXPECT "" brick_fop_calls OPEN
+EXPECT "" brick_fop_calls FLUSH
+
+#a missing file fails before anything is sent
+TEST ! $(dirname $0)/gfapi-compound-read $H0 $V0 /dev/null /dir/none 0 x
+EXPECT "2" brick_fop_calls COMPOUND
+
+#with the default graph the performance xlators let it through as well
+TEST $CLI volume set $V0 performance.stat-prefetch on
+TEST $CLI volume set $V0 performance.open-behind on
+TEST $CLI volume set $V0 performance.quick-read on
+TEST $CLI volume set $V0 performance.io-cache on
+TEST $CLI volume set $V0 performance.read-ahead on
+TEST $CLI volume set $V0 performance.write-behind on
+TEST $CLI volume profile $V0 info clear
+TEST $(dirname $0)/gfapi-compound-read $H0 $V0 /dev/null /dir/file 0 \
+        "hello compound"
+EXPECT "1" brick_fop_calls COMPOUND
+EXPECT "" brick_fop_calls READ
+EXPECT "" brick_fop_calls OPEN
+
+cleanup_tester $(dirname $0)/gfapi-compound-read
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,285 @@
+/* Writes from registered buffers, reads with glfs_preadv_buf() and reads
+   reaped from a completion queue, checking the data and the release
+   notifications on the way.
+
+   usage: gfapi-registered-io <host> <volume> <logfile> <path> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <glusterfs/api/glfs.h>
+
+#define BLOCK     4096
+#define NBLOCKS   4
+#define TIMEOUT   20 /* seconds */
+
+static pthread_mutex_t  lock     = PTHREAD_MUTEX_INITIALIZER;
+static int              released = 0;
+
+static void
+release_cbk (void *data)
+{
+        pthread_mutex_lock (&lock);
+        {
+                released += (long) data;
+        }
+        pthread_mutex_unlock (&lock);
+}
+
+static int
+released_get (void)
+{
+        int ret = 0;
+
+        pthread_mutex_lock (&lock);
+        {
+                ret = released;
+        }
+        pthread_mutex_unlock (&lock);
+
+        return ret;
+}
+
+static int
+released_wait (int count)
+{
+        int i = 0;
+
+        for (i = 0; i < TIMEOUT * 10; i++) {
+                if (released_get () >= count)
+                        return 0;
+                usleep (100000);
+        }
+
+        fprintf (stderr, "%d releases, expected %d\n", released_get (),
+                 count);
+        return -1;
+}
+
+static int
+check_block (const char *buf, int block)
+{
+        int i = 0;
+
+        for (i = 0; i < BLOCK; i++) {
+                if (buf[i] != (char) ('a' + block)) {
+                        fprintf (stderr, "block %d differs at %d\n", block,
+                                 i);
+                        return -1;
+                }
+        }
+
+        return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+        glfs_t                *fs       = NULL;
+        glfs_fd_t             *fd       = NULL;
+        glfs_rbuf_t           *rbuf     = NULL;
+        glfs_cq_t             *cq       = NULL;
+        const struct iovec    *riov     = NULL;
+        struct glfs_cq_entry   entries[NBLOCKS];
+        struct glfs_cq_entry  *reaped[NBLOCKS];
+        struct iovec           iov      = {0, };
+        struct pollfd          pfd      = {0, };
+        char                  *region   = NULL;
+        char                  *spare    = NULL;
+        char                  *copy     = NULL;
+        char                  *readbuf  = NULL;
+        ssize_t                ret      = -1;
+        int                    count    = 0;
+        int                    done     = 0;
+        int                    i        = 0;
+
+        if (argc != 5) {
+                fprintf (stderr, "usage: %s <host> <volume> <logfile> "
+                         "<path>\n", argv[0]);
+                return 1;
+        }
+
+        region = malloc (BLOCK * NBLOCKS);
+        spare = malloc (BLOCK);
+        copy = malloc (BLOCK);
+        readbuf = malloc (BLOCK * NBLOCKS);
+        if (!region || !spare || !copy || !readbuf)
+                return 1;
+
+        fs = glfs_new (argv[2]);
+        if (!fs)
+                return 1;
+
+        if (glfs_set_volfile_server (fs, "tcp", argv[1], 24007) ||
+            glfs_set_logging (fs, argv[3], 7) || glfs_init (fs)) {
+                fprintf (stderr, "cannot initialize %s\n", argv[2]);
+                return 1;
+        }
+
+        fd = glfs_creat (fs, argv[4], O_RDWR, 0644);
+        if (!fd) {
+                fprintf (stderr, "glfs_creat: %s\n", strerror (errno));
+                goto out;
+        }
+
+        if (glfs_buf_register (fs, region, BLOCK * NBLOCKS)) {
+                fprintf (stderr, "glfs_buf_register: %s\n", strerror (errno));
+                goto out;
+        }
+        if (!glfs_buf_register (fs, region + BLOCK, BLOCK) ||
+            errno != EEXIST) {
+                fprintf (stderr, "overlapping registration accepted\n");
+                goto out;
+        }
+        /* left registered until glfs_fini() */
+        if (glfs_buf_register (fs, spare, BLOCK)) {
+                fprintf (stderr, "glfs_buf_register: %s\n", strerror (errno));
+                goto out;
+        }
+
+        /* from the registered region: released some time later */
+        for (i = 0; i < NBLOCKS; i++) {
+                memset (region + i * BLOCK, 'a' + i, BLOCK);
+                iov.iov_base = region + i * BLOCK;
+                iov.iov_len = BLOCK;
+                ret = glfs_pwritev_registered (fd, &iov, 1, i * BLOCK, 0,
+                                               release_cbk, (void *) 1L);
+                if (ret != BLOCK) {
+                        fprintf (stderr, "glfs_pwritev_registered: %zd "
+                                 "(%s)\n", ret, strerror (errno));
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        if (glfs_buf_unregister (fs, region) == 0) {
+                if (released_get () != NBLOCKS) {
+                        fprintf (stderr, "unregistered with writes in "
+                                 "flight\n");
+                        ret = -1;
+                        goto out;
+                }
+        } else if (errno != EBUSY) {
+                fprintf (stderr, "glfs_buf_unregister: %s\n",
+                         strerror (errno));
+                ret = -1;
+                goto out;
+        } else {
+                if (glfs_fsync (fd) || released_wait (NBLOCKS)) {
+                        ret = -1;
+                        goto out;
+                }
+                if (glfs_buf_unregister (fs, region)) {
+                        fprintf (stderr, "glfs_buf_unregister: %s\n",
+                                 strerror (errno));
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        /* not registered: copied, released before it returns */
+        memset (copy, 'a', BLOCK);
+        iov.iov_base = copy;
+        iov.iov_len = BLOCK;
+        ret = glfs_pwritev_registered (fd, &iov, 1, 0, 0, release_cbk,
+                                       (void *) 1L);
+        if (ret != BLOCK || released_get () != NBLOCKS + 1) {
+                fprintf (stderr, "unregistered write: %zd, %d releases\n",
+                         ret, released_get ());
+                ret = -1;
+                goto out;
+        }
+
+        if (glfs_fsync (fd)) {
+                ret = -1;
+                goto out;
+        }
+
+        ret = glfs_preadv_buf (fd, BLOCK, BLOCK, 0, &rbuf);
+        if (ret != BLOCK || !rbuf) {
+                fprintf (stderr, "glfs_preadv_buf: %zd (%s)\n", ret,
+                         strerror (errno));
+                ret = -1;
+                goto out;
+        }
+        count = glfs_rbuf_iov (glfs_rbuf_ref (rbuf), &riov);
+        glfs_rbuf_unref (rbuf);
+        for (i = 0, ret = 0; i < count; i++) {
+                memcpy (copy + ret, riov[i].iov_base, riov[i].iov_len);
+                ret += riov[i].iov_len;
+        }
+        glfs_rbuf_unref (rbuf);
+        if (ret != BLOCK || check_block (copy, 1)) {
+                ret = -1;
+                goto out;
+        }
+
+        cq = glfs_cq_new (fs);
+        if (!cq) {
+                fprintf (stderr, "glfs_cq_new: %s\n", strerror (errno));
+                ret = -1;
+                goto out;
+        }
+
+        for (i = 0; i < NBLOCKS; i++) {
+                memset (&entries[i], 0, sizeof (entries[i]));
+                entries[i].cq = cq;
+                entries[i].data = readbuf + i * BLOCK;
+                if (glfs_pread_async (fd, readbuf + i * BLOCK, BLOCK,
+                                      i * BLOCK, 0, glfs_cq_cbk,
+                                      &entries[i])) {
+                        fprintf (stderr, "glfs_pread_async: %s\n",
+                                 strerror (errno));
+                        ret = -1;
+                        goto out;
+                }
+        }
+
+        pfd.fd = glfs_cq_fd (cq);
+        pfd.events = POLLIN;
+        while (done < NBLOCKS) {
+                if (poll (&pfd, 1, TIMEOUT * 1000) != 1) {
+                        fprintf (stderr, "%d of %d reads completed\n", done,
+                                 NBLOCKS);
+                        ret = -1;
+                        goto out;
+                }
+                count = glfs_cq_reap (cq, reaped, NBLOCKS);
+                for (i = 0; i < count; i++) {
+                        if (reaped[i]->fd != fd || reaped[i]->ret != BLOCK) {
+                                fprintf (stderr, "read %zd (%s)\n",
+                                         reaped[i]->ret,
+                                         strerror (reaped[i]->err));
+                                ret = -1;
+                                goto out;
+                        }
+                        if (check_block (reaped[i]->data,
+                                         reaped[i] - entries)) {
+                                ret = -1;
+                                goto out;
+                        }
+                }
+                done += count;
+        }
+
+        ret = 0;
+out:
+        if (cq)
+                glfs_cq_destroy (cq);
+        if (fd)
+                glfs_close (fd);
+        glfs_fini (fs);
+
+        free (region);
+        free (spare);
+        free (copy);
+        free (readbuf);
+
+        return (ret < 0) ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+#glfs_pwritev_registered() writes from registered memory and tells when it
+#is released, glfs_preadv_buf() hands back the buffers read into, and
+#reads issued with glfs_cq_cbk are reaped from a completion queue. Run with
+#write-behind off and on, as it keeps the written buffers after the write.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+build_tester $(dirname $0)/gfapi-registered-io.c -lgfapi -lpthread
+
+TEST $(dirname $0)/gfapi-registered-io $H0 $V0 /dev/null /file1
+
+TEST $CLI volume set $V0 performance.write-behind on
+TEST $(dirname $0)/gfapi-registered-io $H0 $V0 /dev/null /file2
+
+TEST glusterfs -s $H0 --volfile-id $V0 $M0
+EXPECT "16384" stat -c %s $M0/file1
+EXPECT "16384" stat -c %s $M0/file2
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup_tester $(dirname $0)/gfapi-registered-io
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,48 @@
+/* Stats a path with glfs_stat(), as user <uid>.
+
+   usage: gfapi-resolve-path <host> <volume> <logfile> <uid> <path> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <glusterfs/api/glfs.h>
+
+int
+main (int argc, char *argv[])
+{
+        glfs_t      *fs  = NULL;
+        struct stat  st;
+        int          ret = -1;
+
+        if (argc != 6) {
+                fprintf (stderr, "usage: %s <host> <volume> <logfile> "
+                         "<uid> <path>\n", argv[0]);
+                return 1;
+        }
+
+        fs = glfs_new (argv[2]);
+        if (!fs)
+                return 1;
+
+        if (glfs_set_volfile_server (fs, "tcp", argv[1], 24007) ||
+            glfs_set_logging (fs, argv[3], 7) || glfs_init (fs)) {
+                fprintf (stderr, "cannot initialize %s\n", argv[2]);
+                return 1;
+        }
+
+        ret = glfs_setfsuid (atoi (argv[4]));
+        if (ret) {
+                fprintf (stderr, "glfs_setfsuid: %s\n", strerror (errno));
+                goto out;
+        }
+
+        ret = glfs_stat (fs, argv[5], &st);
+        if (ret)
+                fprintf (stderr, "glfs_stat: %s\n", strerror (errno));
+out:
+        glfs_fini (fs);
+
+        return ret ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+#A cold path is resolved by the brick in a single lookup of its first
+#directory: stat of a file five directories deep takes one lookup more than
+#stat of the root, not one per directory. The walk stops at a directory the
+#caller may not search.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function brick_lookups {
+        $CLI volume profile $V0 info | grep -w LOOKUP | head -1 | \
+                awk '{print $(NF-1)}'
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume start $V0
+
+TEST glusterfs -s $H0 --volfile-id $V0 $M0
+TEST mkdir -p $M0/a/b/c/d/e
+TEST touch $M0/a/b/c/d/e/file
+TEST mkdir -p $M0/a/secret/c
+TEST touch $M0/a/secret/c/file
+TEST chmod 700 $M0/a/secret
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+build_tester $(dirname $0)/gfapi-resolve-path.c -lgfapi
+
+TEST $CLI volume profile $V0 start
+TEST $(dirname $0)/gfapi-resolve-path $H0 $V0 /dev/null 0 /
+base=$(brick_lookups)
+
+TEST $CLI volume profile $V0 info clear
+TEST $(dirname $0)/gfapi-resolve-path $H0 $V0 /dev/null 0 /a/b/c/d/e/file
+EXPECT "$((base + 1))" brick_lookups
+
+#another user gets no further than /a/secret
+TEST $(dirname $0)/gfapi-resolve-path $H0 $V0 /dev/null 1000 /a/b/c/d/e/file
+TEST ! $(dirname $0)/gfapi-resolve-path $H0 $V0 /dev/null 1000 \
+        /a/secret/c/file
+
+cleanup_tester $(dirname $0)/gfapi-resolve-path
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+#Concurrent writes from two mounts on a replicated file: the inodelks AFR
+#takes are granted through the locks fast path or after waiting, and the
+#waits are reported in the brick statedump.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0;
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M1;
+
+TEST touch $M0/file
+for i in {1..20}
+do
+        dd if=/dev/urandom of=$M0/file bs=4k seek=$((i * 2)) count=1 conv=notrunc 2>/dev/null &
+        dd if=/dev/urandom of=$M1/file bs=4k seek=$((i * 2 + 1)) count=1 conv=notrunc 2>/dev/null &
+done
+wait
+
+EXPECT $(md5sum < $B0/${V0}0/file | awk '{print $1}') echo $(md5sum < $B0/${V0}1/file | awk '{print $1}')
+
+statedump=$(generate_brick_statedump $V0 $H0 $B0/${V0}0)
+EXPECT_NOT "0" echo $(grep -c "^inodelk-granted-at-once=" $statedump)
+rm -f $statedump
+
+cleanup;
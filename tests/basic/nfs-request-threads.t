@@ -0,0 +1,43 @@
+#!/bin/bash
+
+#NFS requests handled by worker threads, with an adaptive window of
+#outstanding requests, must give the same results as handled inline.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+. $(dirname $0)/../nfs.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 nfs.request-threads 4
+TEST $CLI volume set $V0 nfs.outstanding-rpc-limit 16
+TEST $CLI volume set $V0 nfs.outstanding-rpc-window-max 256
+TEST $CLI volume start $V0
+
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "1" is_nfs_export_available;
+TEST mount_nfs $H0:/$V0 $N0 nolock
+
+TEST dd if=/dev/urandom of=$B0/src bs=1024k count=16
+TEST dd if=$B0/src of=$N0/file bs=64k
+TEST mkdir $N0/dir
+for i in {1..50}
+do
+        echo $i > $N0/dir/file$i &
+done
+wait
+EXPECT "50" echo $(ls $N0/dir | wc -l)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" umount_nfs $N0
+EXPECT $(md5sum < $B0/src | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+EXPECT "37" cat $B0/${V0}0/dir/file37
+
+#Back to handling them inline
+TEST $CLI volume set $V0 nfs.request-threads 0
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "1" is_nfs_export_available;
+TEST mount_nfs $H0:/$V0 $N0 nolock
+EXPECT $(md5sum < $B0/src | awk '{print $1}') echo $(md5sum < $N0/file | awk '{print $1}')
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" umount_nfs $N0
+
+cleanup;
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+#UNSTABLE writes gathered into larger writes and the fd cache must not
+#change what ends up on the bricks.
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+. $(dirname $0)/../nfs.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 nfs.write-gather-size 1MB
+TEST $CLI volume set $V0 nfs.fd-cache-limit 4
+TEST $CLI volume start $V0
+
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "1" is_nfs_export_available;
+TEST mount_nfs $H0:/$V0 $N0 nolock,wsize=65536
+
+TEST dd if=/dev/urandom of=$B0/src bs=1024k count=16
+TEST dd if=$B0/src of=$N0/file bs=64k
+for i in {1..8}
+do
+        TEST dd if=/dev/urandom of=$N0/small$i bs=4k count=4
+done
+TEST rm -f $N0/small1
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" umount_nfs $N0
+
+EXPECT $(md5sum < $B0/src | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file | awk '{print $1}')
+TEST ! stat $B0/${V0}0/small1
+
+#Without gathering nor cache
+TEST $CLI volume set $V0 nfs.write-gather-size 0
+TEST $CLI volume set $V0 nfs.fd-cache-limit 0
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "1" is_nfs_export_available;
+TEST mount_nfs $H0:/$V0 $N0 nolock
+TEST dd if=$B0/src of=$N0/file2 bs=64k
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" umount_nfs $N0
+EXPECT $(md5sum < $B0/src | awk '{print $1}') echo $(md5sum < $B0/${V0}0/file2 | awk '{print $1}')
+
+cleanup;
@@ -0,0 +1,38 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 storage.batch-fsync-mode group-commit
+TEST $CLI volume set $V0 storage.batch-fsync-delay-usec 2000
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+## concurrent synchronous writers end up in the same batches
+for i in {1..8}; do
+        dd if=/dev/urandom of=$M0/file$i bs=4k count=64 oflag=sync 2>/dev/null &
+done
+wait
+
+for i in {1..8}; do
+        EXPECT "262144" stat -c %s $M0/file$i
+        EXPECT "$(md5sum < $B0/${V0}0/file$i)" echo "$(md5sum < $B0/${V0}1/file$i)"
+done
+
+## switching back to the old mode at runtime
+TEST $CLI volume set $V0 storage.batch-fsync-mode reverse-fsync
+TEST dd if=/dev/zero of=$M0/file9 bs=4k count=16 conv=fsync
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.handle-cache-size 4
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+## more directories than cached fds, so entries get evicted
+TEST mkdir -p $M0/a/b/c/d/e/f/g/h
+TEST touch $M0/a/b/c/d/e/f/g/h/file
+TEST stat $M0/a/b/c/d/e/f/g/h/file
+
+## renamed directories keep resolving through the cached fd
+TEST mv $M0/a/b/c $M0/a/c
+TEST stat $M0/a/c/d/e/f/g/h/file
+TEST ! stat $M0/a/b/c
+
+## a directory recreated under the same name must not use the old fd
+TEST rm -rf $M0/a/c/d
+TEST mkdir $M0/a/c/d
+TEST touch $M0/a/c/d/new
+TEST stat $M0/a/c/d/new
+TEST ! stat $M0/a/c/d/e
+
+## same with the kernel handles kept for evicted entries
+TEST $CLI volume set $V0 storage.handle-cache-open-by-handle on
+TEST mkdir -p $M0/x/y/z/w/v
+TEST touch $M0/x/y/z/w/v/file
+TEST stat $M0/a/c/d/new
+TEST stat $M0/x/y/z/w/v/file
+
+## disabling the cache at runtime
+TEST $CLI volume set $V0 storage.handle-cache-size 0
+TEST stat $M0/x/y/z/w/v/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
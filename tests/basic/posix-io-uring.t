@@ -0,0 +1,50 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+. $(dirname $0)/../fallocate.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 storage.io-uring on
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+## writev + fsync through the ring
+TEST dd if=/dev/urandom of=$B0/src bs=128k count=16
+TEST dd if=$B0/src of=$M0/file bs=128k conv=fsync
+EXPECT "$(md5sum $B0/src | awk '{print $1}')" echo `md5sum $B0/${V0}0/file | awk '{print $1}'`
+
+## readv through the ring
+EXPECT "$(md5sum $B0/src | awk '{print $1}')" echo `md5sum $M0/file | awk '{print $1}'`
+
+## O_SYNC writes
+TEST dd if=$B0/src of=$M0/sync-file bs=128k oflag=sync
+EXPECT "$(md5sum $B0/src | awk '{print $1}')" echo `md5sum $M0/sync-file | awk '{print $1}'`
+
+## fallocate and discard
+require_fallocate -l 1m $M0/falloc-file
+TEST fallocate -l 1m $M0/falloc-file
+EXPECT "1048576" stat -c %s $M0/falloc-file
+require_fallocate -p -l 512k -n $M0/falloc-file
+TEST fallocate -p -o 0 -l 512k $M0/falloc-file
+EXPECT "1048576" stat -c %s $M0/falloc-file
+
+## switching the engine off at runtime falls back to synchronous IO
+TEST $CLI volume set $V0 storage.io-uring off
+EXPECT "$(md5sum $B0/src | awk '{print $1}')" echo `md5sum $M0/file | awk '{print $1}'`
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
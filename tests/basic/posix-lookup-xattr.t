@@ -0,0 +1,46 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function lookup_xattr_syscalls {
+        local fpath=$(generate_statedump $(get_brick_pid $V0 $H0 $B0/${V0}0))
+        grep -c "xattr_syscalls.LOOKUP" $fpath
+        rm -f $fpath
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file
+TEST setfattr -n user.foo -v bar $M0/dir/file
+
+## values read through the listxattr fast path are unchanged
+TEST stat $M0/dir/file
+EXPECT "bar" getfattr --only-values -n user.foo $M0/dir/file
+
+## a large value does not fit the per-thread buffer
+TEST setfattr -n user.big -v $(printf 'x%.0s' {1..6000}) $M0/dir/file
+TEST stat $M0/dir/file
+EXPECT "6000" echo $(getfattr --only-values -n user.big $M0/dir/file | wc -c)
+
+TEST setfattr -x user.foo $M0/dir/file
+TEST stat $M0/dir/file
+TEST ! getfattr -n user.foo $M0/dir/file
+
+EXPECT "1" lookup_xattr_syscalls
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
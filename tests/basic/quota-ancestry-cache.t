@@ -0,0 +1,44 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 features.quota-ancestry-cache-size 1024
+TEST $CLI volume start $V0
+
+TEST $CLI volume quota $V0 enable
+TEST $CLI volume set $V0 features.soft-timeout 0
+TEST $CLI volume set $V0 features.hard-timeout 0
+TEST glusterfs -s $H0 --volfile-id $V0 $M0
+
+TEST mkdir -p $M0/a/b/c/d/e
+TEST mkdir -p $M0/x/y
+TEST $CLI volume quota $V0 limit-usage /a 20MB
+TEST $CLI volume quota $V0 limit-usage /a/b/c 10MB
+TEST $CLI volume quota $V0 limit-usage /x 4MB
+
+## all the limited ancestors are validated on every write
+TEST dd if=/dev/zero of=$M0/a/b/c/d/e/file1 bs=1M count=6 conv=fdatasync
+TEST ! dd if=/dev/zero of=$M0/a/b/c/d/e/file2 bs=1M count=6 conv=fdatasync
+
+## writes after the inodes are forgotten on the client
+echo 3 > /proc/sys/vm/drop_caches
+TEST ! dd if=/dev/zero of=$M0/a/b/c/d/e/file1 bs=1M count=6 seek=6 conv=fdatasync,notrunc
+
+## a renamed directory is accounted against its new ancestors
+TEST rm -f $M0/a/b/c/d/e/file2
+TEST mv $M0/a/b/c/d $M0/x/y/
+TEST ! dd if=/dev/zero of=$M0/x/y/d/e/file3 bs=1M count=6 conv=fdatasync
+TEST dd if=/dev/zero of=$M0/a/b/c/file4 bs=1M count=8 conv=fdatasync
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
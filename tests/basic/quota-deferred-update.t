@@ -0,0 +1,50 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+function usage()
+{
+        local QUOTA_PATH=$1;
+        $CLI volume quota $V0 list $QUOTA_PATH | grep "$QUOTA_PATH" | awk '{print $4}'
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 features.quota-update-interval 500
+TEST $CLI volume start $V0
+
+TEST $CLI volume quota $V0 enable
+TEST glusterfs -s $H0 --volfile-id $V0 $M0
+
+TEST mkdir -p $M0/a/b/c/d
+TEST $CLI volume quota $V0 limit-usage /a 100MB
+TEST $CLI volume quota $V0 limit-usage /a/b/c 100MB
+
+## concurrent writers below a common ancestor
+for i in {1..4}; do
+        dd if=/dev/zero of=$M0/a/b/c/d/file$i bs=1M count=2 2>/dev/null &
+done
+dd if=/dev/zero of=$M0/a/file bs=1M count=2 2>/dev/null
+wait
+
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "8.0MB" usage "/a/b/c"
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "10.0MB" usage "/a"
+
+TEST rm -f $M0/a/b/c/d/file1
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "6.0MB" usage "/a/b/c"
+
+## back to synchronous updates
+TEST $CLI volume set $V0 features.quota-update-interval 0
+TEST dd if=/dev/zero of=$M0/a/b/c/file bs=1M count=2
+EXPECT_WITHIN $MARKER_UPDATE_TIMEOUT "8.0MB" usage "/a/b/c"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 server.zero-copy-read on
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=4
+
+## whole file, and a read crossing EOF
+EXPECT "$(md5sum < $B0/${V0}0/file)" echo "$(md5sum < $M0/file)"
+EXPECT "1000" echo $(dd if=$M0/file bs=1000 skip=4194 2>/dev/null | wc -c)
+
+## reads past EOF return nothing
+TEST truncate -s 100 $M0/file
+EXPECT "0" echo $(dd if=$M0/file bs=4k skip=1 2>/dev/null | wc -c)
+EXPECT "100" echo $(cat $M0/file | wc -c)
+
+## empty file
+TEST touch $M0/empty
+EXPECT "0" echo $(cat $M0/empty | wc -c)
+
+TEST $CLI volume set $V0 server.zero-copy-read off
+EXPECT "100" echo $(cat $M0/file | wc -c)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
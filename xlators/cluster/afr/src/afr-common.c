@@ -753,6 +753,76 @@ afr_hash_child (inode_t *inode, int32_t child_count, int hashmode)
 }
 
 
+static int64_t
+__afr_read_stat_score (afr_read_stat_t *stat, time_t now)
+{
+	int64_t latency = 0;
+	time_t age = 0;
+
+	latency = stat->latency;
+	if (stat->sampled) {
+		age = (now - stat->sampled) / AFR_READ_LATENCY_AGE;
+		latency = (age > 62) ? 0 : (latency >> age);
+	}
+
+	/* a subvolume not read from yet (or for long) still counts its
+	   reads in flight */
+	if (latency < 1)
+		latency = 1;
+
+	return latency * (stat->outstanding + 1);
+}
+
+
+static int
+afr_read_subvol_least_loaded (xlator_t *this, unsigned char *readable)
+{
+	afr_private_t *priv = NULL;
+	int64_t score = 0;
+	int64_t best_score = 0;
+	int64_t last_score = 0;
+	time_t now = 0;
+	int best = -1;
+	int last = -1;
+	int i = 0;
+
+	priv = this->private;
+	now = time (NULL);
+
+	LOCK (&priv->lock);
+	{
+		for (i = 0; i < priv->child_count; i++) {
+			if (!readable[i])
+				continue;
+			score = __afr_read_stat_score (&priv->read_stats[i],
+						       now);
+			if (i == priv->read_fast_child) {
+				last = i;
+				last_score = score;
+			}
+			if (best == -1 || score < best_score ||
+			    (score == best_score &&
+			     priv->read_stats[i].outstanding <
+			     priv->read_stats[best].outstanding)) {
+				best = i;
+				best_score = score;
+			}
+		}
+
+		/* stay with the last choice unless clearly worse */
+		if (last != -1 && best != last &&
+		    best_score * 100 >= last_score *
+		    (100 - AFR_READ_HYSTERESIS))
+			best = last;
+
+		priv->read_fast_child = best;
+	}
+	UNLOCK (&priv->lock);
+
+	return best;
+}
+
+
 int
 afr_read_subvol_select_by_policy (inode_t *inode, xlator_t *this,
 				  unsigned char *readable)
@@ -767,9 +837,12 @@ afr_read_subvol_select_by_policy (inode_t *inode, xlator_t *this,
 	if (priv->read_child >= 0 && readable[priv->read_child])
 		return priv->read_child;
 
-	/* second preference - use hashed mode */
-	read_subvol = afr_hash_child (inode, priv->child_count,
-				      priv->hash_mode);
+	/* second preference - least loaded, or use hashed mode */
+	if (priv->hash_mode == AFR_READ_HASH_MODE_LATENCY)
+		read_subvol = afr_read_subvol_least_loaded (this, readable);
+	else
+		read_subvol = afr_hash_child (inode, priv->child_count,
+					      priv->hash_mode);
 	if (read_subvol >= 0 && readable[read_subvol])
 		return read_subvol;
 
@@ -889,6 +962,89 @@ afr_replies_wipe (struct afr_reply *replies, int count)
         }
 }
 
+
+static void
+afr_dirty_regions_bits (uint64_t region_size, off_t offset, off_t len,
+                        uint64_t *first, uint64_t *last)
+{
+        *first = offset / region_size;
+        if (len < 0)
+                *last = AFR_DIRTY_REGIONS_BITS - 1;
+        else if (len == 0)
+                *last = *first;
+        else
+                *last = (offset + len - 1) / region_size;
+
+        if (*first >= AFR_DIRTY_REGIONS_BITS)
+                *first = AFR_DIRTY_REGIONS_BITS - 1;
+        if (*last >= AFR_DIRTY_REGIONS_BITS)
+                *last = AFR_DIRTY_REGIONS_BITS - 1;
+}
+
+/* records [offset, offset + len) in @regions, a negative @len meaning
+   up to the end of the file */
+void
+afr_dirty_regions_mark (char *regions, uint64_t region_size, off_t offset,
+                        off_t len)
+{
+        unsigned char *bits  = NULL;
+        uint64_t       hdr   = 0;
+        uint64_t       first = 0;
+        uint64_t       last  = 0;
+        uint64_t       i     = 0;
+
+        hdr = hton64 (region_size);
+        memcpy (regions, &hdr, sizeof (hdr));
+
+        bits = (unsigned char *)regions + AFR_DIRTY_REGIONS_HDR_SIZE;
+        afr_dirty_regions_bits (region_size, offset, len, &first, &last);
+        for (i = first; i <= last; i++)
+                bits[i / 8] |= (1 << (i % 8));
+}
+
+gf_boolean_t
+afr_dirty_regions_test (char *regions, uint64_t region_size, off_t offset,
+                        off_t len)
+{
+        unsigned char *bits  = NULL;
+        uint64_t       first = 0;
+        uint64_t       last  = 0;
+        uint64_t       i     = 0;
+
+        bits = (unsigned char *)regions + AFR_DIRTY_REGIONS_HDR_SIZE;
+        afr_dirty_regions_bits (region_size, offset, len, &first, &last);
+        for (i = first; i <= last; i++)
+                if (bits[i / 8] & (1 << (i % 8)))
+                        return _gf_true;
+
+        return _gf_false;
+}
+
+void
+afr_dirty_regions_poison (char *regions)
+{
+        memset (regions, 0xff, AFR_DIRTY_REGIONS_SIZE);
+}
+
+/* region size of a bitmap read from a brick, 0 if it cannot be trusted */
+uint64_t
+afr_dirty_regions_size (char *regions)
+{
+        uint64_t hdr = 0;
+
+        memcpy (&hdr, regions, sizeof (hdr));
+        hdr = ntoh64 (hdr);
+
+        if (!(hdr & AFR_DIRTY_REGIONS_BASE))
+                return 0;
+
+        hdr &= ~AFR_DIRTY_REGIONS_BASE;
+        if (hdr < AFR_DIRTY_REGION_MIN_SIZE || (hdr & (hdr - 1)))
+                return 0;
+
+        return hdr;
+}
+
 void
 afr_local_replies_wipe (afr_local_t *local, afr_private_t *priv)
 {
@@ -919,6 +1075,8 @@ afr_local_cleanup (afr_local_t *local, xlator_t *this)
         if (!local)
                 return;
 
+	afr_read_stat_end (local, this);
+
 	syncbarrier_destroy (&local->barrier);
 
         if (local->transaction.eager_lock_on &&
@@ -2172,6 +2330,8 @@ afr_cleanup_fd_ctx (xlator_t *this, fd_t *fd)
 
                 GF_FREE (fd_ctx->lock_acquired);
 
+                GF_FREE (fd_ctx->dirty_regions);
+
 		pthread_mutex_destroy (&fd_ctx->delay_lock);
 
                 GF_FREE (fd_ctx);
@@ -3132,6 +3292,18 @@ afr_priv_dump (xlator_t *this)
         gf_proc_dump_write("metadata_change_log", "%d", priv->metadata_change_log);
         gf_proc_dump_write("entry-change_log", "%d", priv->entry_change_log);
         gf_proc_dump_write("read_child", "%d", priv->read_child);
+        if (priv->hash_mode == AFR_READ_HASH_MODE_LATENCY) {
+                for (i = 0; i < priv->child_count; i++) {
+                        sprintf (key, "read_latency[%d]", i);
+                        gf_proc_dump_write(key, "%"PRId64,
+                                           priv->read_stats[i].latency);
+                        sprintf (key, "read_outstanding[%d]", i);
+                        gf_proc_dump_write(key, "%d",
+                                           priv->read_stats[i].outstanding);
+                }
+                gf_proc_dump_write("read_fast_child", "%d",
+                                   priv->read_fast_child);
+        }
         gf_proc_dump_write("favorite_child", "%d", priv->favorite_child);
         gf_proc_dump_write("wait_count", "%u", priv->wait_count);
 
@@ -3180,12 +3352,22 @@ afr_notify (xlator_t *this, int32_t event,
         dict_t          *output             = NULL;
         gf_boolean_t    had_quorum          = _gf_false;
         gf_boolean_t    has_quorum          = _gf_false;
+        struct gf_upcall *upcall            = NULL;
 
         priv = this->private;
 
         if (!priv)
                 return 0;
 
+        /* data is the upcall here, not the child it comes from */
+        if (event == GF_EVENT_UPCALL) {
+                upcall = data;
+                if (upcall &&
+                    upcall->event_type == GF_UPCALL_INODELK_CONTENTION)
+                        afr_inodelk_contention_notify (this, upcall);
+                return 0;
+        }
+
         /*
          * We need to reset this in case children come up in "staggered"
          * fashion, so that we discover a late-arriving local subvolume.  Note
@@ -3232,6 +3414,9 @@ afr_notify (xlator_t *this, int32_t event,
                         if (priv->child_up[idx] != 1) {
                                 priv->up_count++;
 				priv->event_generation++;
+				/* measure it afresh */
+				priv->read_stats[idx].latency = 0;
+				priv->read_stats[idx].sampled = 0;
                         }
                         priv->child_up[idx] = 1;
 
@@ -3642,6 +3827,7 @@ afr_priv_destroy (afr_private_t *priv)
         GF_FREE (priv->pending_key);
         GF_FREE (priv->children);
         GF_FREE (priv->child_up);
+        GF_FREE (priv->read_stats);
         LOCK_DESTROY (&priv->lock);
 
         GF_FREE (priv);
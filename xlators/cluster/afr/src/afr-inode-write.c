@@ -252,6 +252,13 @@ afr_writev_wind_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         {
                 __afr_inode_write_fill (frame, this, child_index, op_ret,
 					op_errno, prebuf, postbuf, xdata);
+
+		/* a brick which did not apply the pre-op (down, or too old
+		   to know of it) is left out of the post-op */
+		if (local->transaction.write_xattrop &&
+		    (!xdata || !dict_get (xdata, GLUSTERFS_WRITE_XATTROP)))
+			local->transaction.pre_op[child_index] = 0;
+
 		if (op_ret == -1 || !xdata)
 			goto unlock;
 
@@ -736,6 +736,9 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
                                         piggyback = 1;
                                 } else {
                                         fd_ctx->lock_acquired[i]--;
+                                        /* released, may be cached again */
+                                        if (!fd_ctx->lock_acquired[i])
+                                                fd_ctx->lock_contended = _gf_false;
                                 }
                         }
                         UNLOCK (&local->fd->lock);
@@ -1490,6 +1493,7 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
         int                 ret        = 0;
         struct              gf_flock flock = {0,};
         struct              gf_flock full_flock = {0,};
+        dict_t             *xdata      = NULL;
         struct              gf_flock *flock_use = NULL;
         int                 piggyback = 0;
 
@@ -1535,6 +1539,19 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                         goto out;
                 }
 
+                /* With lock-caching, ask the bricks to tell when another
+                   owner waits on the eager-lock */
+                if (local->transaction.eager_lock_on && priv->lock_caching) {
+                        xdata = dict_new ();
+                        if (xdata &&
+                            dict_set_int8 (xdata,
+                                           GLUSTERFS_INODELK_CONTENTION_NOTIFY,
+                                           1)) {
+                                dict_unref (xdata);
+                                xdata = NULL;
+                        }
+                }
+
                 /* Send non-blocking inodelk calls only on up children
                    and where the fd has been opened */
                 for (i = 0; i < priv->child_count; i++) {
@@ -1579,7 +1596,9 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                                            priv->children[i],
                                            priv->children[i]->fops->finodelk,
                                            int_lock->domain, local->fd,
-                                           F_SETLK, flock_use, NULL);
+                                           F_SETLK, flock_use,
+                                           (flock_use == &full_flock) ?
+                                           xdata : NULL);
 
                         if (!--call_count)
                                 break;
@@ -1608,9 +1627,65 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                 }
         }
 out:
+        if (xdata)
+                dict_unref (xdata);
+
         return ret;
 }
 
+/* Whether the unlock of the transaction would only drop its share of an
+   eager lock still used by others on the fd. If so, the share is dropped
+   right away, leaving nothing for afr_unlock() to release. */
+gf_boolean_t
+afr_unlock_piggybacked (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t       *priv        = NULL;
+        afr_local_t         *local       = NULL;
+        afr_fd_ctx_t        *fd_ctx      = NULL;
+        afr_inodelk_t       *inodelk     = NULL;
+        gf_boolean_t         piggybacked = _gf_true;
+        int                  i           = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        if (!local->fd || !local->transaction.eager_lock)
+                return _gf_false;
+
+        fd_ctx = afr_fd_ctx_get (local->fd, this);
+        inodelk = afr_get_inodelk (&local->internal_lock,
+                                   local->internal_lock.domain);
+        if (!fd_ctx || !inodelk)
+                return _gf_false;
+
+        LOCK (&local->fd->lock);
+        {
+                for (i = 0; i < priv->child_count; i++) {
+                        if ((inodelk->locked_nodes[i] & LOCKED_YES) !=
+                            LOCKED_YES)
+                                continue;
+                        if (!local->transaction.eager_lock[i] ||
+                            !fd_ctx->lock_piggyback[i]) {
+                                piggybacked = _gf_false;
+                                goto unlock;
+                        }
+                }
+
+                for (i = 0; i < priv->child_count; i++) {
+                        if ((inodelk->locked_nodes[i] & LOCKED_YES) !=
+                            LOCKED_YES)
+                                continue;
+                        fd_ctx->lock_piggyback[i]--;
+                        inodelk->locked_nodes[i] &= LOCKED_NO;
+                        local->transaction.eager_lock[i] = 0;
+                }
+        }
+unlock:
+        UNLOCK (&local->fd->lock);
+
+        return piggybacked;
+}
+
 int32_t
 afr_unlock (call_frame_t *frame, xlator_t *this)
 {
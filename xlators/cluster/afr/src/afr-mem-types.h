@@ -43,6 +43,11 @@ enum gf_afr_mem_types_ {
         gf_afr_mt_pos_data_t,
 	gf_afr_mt_reply_t,
 	gf_afr_mt_subvol_healer_t,
+	gf_afr_mt_shd_heal_worker_t,
+	gf_afr_mt_shd_gfid_t,
+	gf_afr_mt_shd_crawl_dir_t,
+        gf_afr_mt_fd_t,
+        gf_afr_mt_read_stat_t,
         gf_afr_mt_end
 };
 #endif
@@ -11,6 +11,78 @@
 #include "afr.h"
 #include "afr-transaction.h"
 
+/* account the read about to be wound to @subvol, for read-hash-mode 3 */
+static void
+afr_read_stat_begin (call_frame_t *frame, xlator_t *this, int subvol)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+
+	local = frame->local;
+	priv = this->private;
+
+	if (subvol < 0 || priv->hash_mode != AFR_READ_HASH_MODE_LATENCY)
+		return;
+
+	gettimeofday (&local->read_stat_start, NULL);
+
+	LOCK (&priv->lock);
+	{
+		priv->read_stats[subvol].outstanding++;
+	}
+	UNLOCK (&priv->lock);
+
+	local->read_stat_subvol = subvol;
+	local->read_stat_on = _gf_true;
+}
+
+
+void
+afr_read_stat_end (afr_local_t *local, xlator_t *this)
+{
+	afr_private_t *priv = NULL;
+	afr_read_stat_t *stat = NULL;
+	struct timeval now = {0, };
+	int64_t elapsed = 0;
+
+	if (!local->read_stat_on)
+		return;
+
+	local->read_stat_on = _gf_false;
+	priv = this->private;
+
+	gettimeofday (&now, NULL);
+	elapsed = (now.tv_sec - local->read_stat_start.tv_sec) * 1000000 +
+		  (now.tv_usec - local->read_stat_start.tv_usec);
+
+	LOCK (&priv->lock);
+	{
+		stat = &priv->read_stats[local->read_stat_subvol];
+		if (stat->outstanding > 0)
+			stat->outstanding--;
+		if (stat->sampled)
+			stat->latency = (7 * stat->latency + elapsed) / 8;
+		else
+			stat->latency = elapsed;
+		stat->sampled = now.tv_sec;
+	}
+	UNLOCK (&priv->lock);
+}
+
+
+static void
+afr_read_txn_wind (call_frame_t *frame, xlator_t *this, int subvol)
+{
+	afr_local_t *local = NULL;
+
+	local = frame->local;
+
+	afr_read_stat_begin (frame, this, subvol);
+
+	local->readfn (frame, this, subvol);
+}
+
+
 int
 afr_read_txn_next_subvol (call_frame_t *frame, xlator_t *this)
 {
@@ -42,7 +114,7 @@ afr_read_txn_next_subvol (call_frame_t *frame, xlator_t *this)
 	   readable subvols. */
 	if (subvol != -1)
 		local->read_attempted[subvol] = 1;
-	local->readfn (frame, this, subvol);
+	afr_read_txn_wind (frame, this, subvol);
 
 	return 0;
 }
@@ -96,7 +168,7 @@ afr_read_txn_refresh_done (call_frame_t *frame, xlator_t *this, int err)
 
 	local->read_attempted[read_subvol] = 1;
 readfn:
-	local->readfn (frame, this, read_subvol);
+	afr_read_txn_wind (frame, this, read_subvol);
 
 	return 0;
 }
@@ -109,6 +181,9 @@ afr_read_txn_continue (call_frame_t *frame, xlator_t *this, int subvol)
 
 	local = frame->local;
 
+	/* the read on @subvol failed */
+	afr_read_stat_end (local, this);
+
 	if (!local->refreshed) {
 		local->refreshed = _gf_true;
 		afr_inode_refresh (frame, this, local->inode,
@@ -138,6 +213,8 @@ afr_read_txn_wipe (call_frame_t *frame, xlator_t *this)
 	local = frame->local;
 	priv = this->private;
 
+	afr_read_stat_end (local, this);
+
 	local->readfn = NULL;
 
 	if (local->inode)
@@ -229,7 +306,7 @@ afr_read_txn (call_frame_t *frame, xlator_t *this, inode_t *inode,
 
 	local->read_attempted[read_subvol] = 1;
 
-	local->readfn (frame, this, read_subvol);
+	afr_read_txn_wind (frame, this, read_subvol);
 
 	return 0;
 
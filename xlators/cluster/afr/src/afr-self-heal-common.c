@@ -34,8 +34,8 @@ afr_selfheal_post_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
 
 int
-afr_selfheal_post_op (call_frame_t *frame, xlator_t *this, inode_t *inode,
-		      int subvol, dict_t *xattr)
+afr_selfheal_xattrop (call_frame_t *frame, xlator_t *this, inode_t *inode,
+		      int subvol, gf_xattrop_flags_t optype, dict_t *xattr)
 {
 	afr_private_t *priv = NULL;
 	afr_local_t *local = NULL;
@@ -49,7 +49,7 @@ afr_selfheal_post_op (call_frame_t *frame, xlator_t *this, inode_t *inode,
 
 	STACK_WIND (frame, afr_selfheal_post_op_cbk, priv->children[subvol],
 		    priv->children[subvol]->fops->xattrop, &loc,
-		    GF_XATTROP_ADD_ARRAY, xattr, NULL);
+		    optype, xattr, NULL);
 
 	syncbarrier_wait (&local->barrier, 1);
 
@@ -57,6 +57,15 @@ afr_selfheal_post_op (call_frame_t *frame, xlator_t *this, inode_t *inode,
 }
 
 
+int
+afr_selfheal_post_op (call_frame_t *frame, xlator_t *this, inode_t *inode,
+		      int subvol, dict_t *xattr)
+{
+	return afr_selfheal_xattrop (frame, this, inode, subvol,
+				     GF_XATTROP_ADD_ARRAY, xattr);
+}
+
+
 dict_t *
 afr_selfheal_output_xattr (xlator_t *this, afr_transaction_type type,
 			   int *output_dirty, int **output_matrix, int subvol)
@@ -975,12 +984,8 @@ afr_frame_create (xlator_t *this)
 }
 
 
-/*
- * This is the entry point for healing a given GFID
- */
-
-int
-afr_selfheal (xlator_t *this, uuid_t gfid)
+static int
+__afr_selfheal (xlator_t *this, uuid_t gfid, gf_boolean_t *data_pending)
 {
         inode_t *inode = NULL;
 	call_frame_t *frame = NULL;
@@ -1000,8 +1005,12 @@ afr_selfheal (xlator_t *this, uuid_t gfid)
 	if (ret)
 		goto out;
 
-	if (data_selfheal)
-		afr_selfheal_data (frame, this, inode);
+	if (data_selfheal) {
+		if (data_pending)
+			*data_pending = _gf_true;
+		else
+			afr_selfheal_data (frame, this, inode);
+	}
 
 	if (metadata_selfheal)
 		afr_selfheal_metadata (frame, this, inode);
@@ -1017,3 +1026,31 @@ out:
 
 	return ret;
 }
+
+
+/*
+ * This is the entry point for healing a given GFID
+ */
+
+int
+afr_selfheal (xlator_t *this, uuid_t gfid)
+{
+	return __afr_selfheal (this, gfid, NULL);
+}
+
+
+/*
+ * Same as afr_selfheal(), except that a data heal is not performed but
+ * flagged in @data_pending, for the caller to come back with
+ * afr_selfheal() once the (cheaper) metadata and entry heals queued
+ * behind it are done.
+ */
+
+int
+afr_selfheal_defer_data (xlator_t *this, uuid_t gfid,
+			 gf_boolean_t *data_pending)
+{
+	*data_pending = _gf_false;
+
+	return __afr_selfheal (this, gfid, data_pending);
+}
@@ -292,10 +292,16 @@ afr_data_self_heal_type_get (afr_private_t *priv, unsigned char *healed_sinks,
         return type;
 }
 
+/*
+ * Heals the blocks of the file from @source, or only the ones overlapping
+ * the regions set in @regions when the changes are known to be limited to
+ * them.
+ */
 static int
 afr_selfheal_data_do (call_frame_t *frame, xlator_t *this, fd_t *fd,
 		      int source, unsigned char *healed_sinks,
-		      struct afr_reply *replies)
+		      struct afr_reply *replies, char *regions,
+		      uint64_t region_size)
 {
 	afr_private_t *priv = NULL;
 	int i = 0;
@@ -321,6 +327,11 @@ afr_selfheal_data_do (call_frame_t *frame, xlator_t *this, fd_t *fd,
 		"source=%d sinks=%s",
 		uuid_utoa (fd->inode->gfid), source, sinks_str);
 
+	if (regions)
+		gf_log (this->name, GF_LOG_DEBUG, "%s: healing only the dirty "
+			"regions (region size %"PRIu64")",
+			uuid_utoa (fd->inode->gfid), region_size);
+
         type = afr_data_self_heal_type_get (priv, healed_sinks, source,
                                             replies);
 
@@ -329,6 +340,10 @@ afr_selfheal_data_do (call_frame_t *frame, xlator_t *this, fd_t *fd,
 		return -ENOMEM;
 
 	for (off = 0; off < replies[source].poststat.ia_size; off += block) {
+		if (regions &&
+		    !afr_dirty_regions_test (regions, region_size, off, block))
+			continue;
+
 		ret = afr_selfheal_data_block (iter_frame, this, fd, source,
 					       healed_sinks, off, block, type,
 					       replies);
@@ -380,6 +395,184 @@ __afr_selfheal_truncate_sinks (call_frame_t *frame, xlator_t *this,
 	return 0;
 }
 
+static int
+__afr_dirty_regions_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+			 int op_ret, int op_errno, dict_t *dict, dict_t *xdata)
+{
+	afr_local_t *local = NULL;
+	int i = (long) cookie;
+
+	local = frame->local;
+
+	local->replies[i].valid = 1;
+	local->replies[i].op_ret = op_ret;
+	local->replies[i].op_errno = op_errno;
+	if (dict)
+		local->replies[i].xdata = dict_ref (dict);
+
+	syncbarrier_wake (&local->barrier);
+
+	return 0;
+}
+
+
+static int
+__afr_dirty_regions_drop_cbk (call_frame_t *frame, void *cookie,
+			      xlator_t *this, int op_ret, int op_errno,
+			      dict_t *xdata)
+{
+	afr_local_t *local = NULL;
+	int i = (long) cookie;
+
+	local = frame->local;
+
+	local->replies[i].valid = 1;
+	local->replies[i].op_ret = op_ret;
+	local->replies[i].op_errno = op_errno;
+
+	syncbarrier_wake (&local->barrier);
+
+	return 0;
+}
+
+
+/*
+ * Gathers the dirty-region bitmaps of the sources into @regions and
+ * returns their region size, or 0 if the whole file has to be healed: a
+ * source has no usable bitmap, or a brick is dirty (a write which did not
+ * get to its post-op is not accounted for). @present tells whether any
+ * brick has a bitmap to drop once healed.
+ */
+static uint64_t
+__afr_selfheal_data_regions (call_frame_t *frame, xlator_t *this, fd_t *fd,
+			     unsigned char *locked_on, unsigned char *sources,
+			     struct afr_reply *replies, char *regions,
+			     gf_boolean_t *present)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	char *value = NULL;
+	int *dirty = NULL;
+	int len = 0;
+	int idx = 0;
+	int i = 0;
+	int j = 0;
+	uint64_t size = 0;
+	uint64_t region_size = 0;
+	gf_boolean_t usable = _gf_true;
+
+	local = frame->local;
+	priv = this->private;
+	idx = afr_index_for_transaction_type (AFR_DATA_TRANSACTION);
+
+	*present = _gf_false;
+
+	AFR_ONLIST (locked_on, frame, __afr_dirty_regions_cbk, fgetxattr, fd,
+		    AFR_DIRTY_REGIONS, NULL);
+
+	for (i = 0; i < priv->child_count; i++) {
+		if (!locked_on[i])
+			continue;
+
+		value = NULL;
+		if (local->replies[i].valid && local->replies[i].op_ret == 0 &&
+		    dict_get_ptr_and_len (local->replies[i].xdata,
+					  AFR_DIRTY_REGIONS, (void **) &value,
+					  &len) == 0)
+			*present = _gf_true;
+		else
+			value = NULL;
+
+		dirty = NULL;
+		if (replies[i].xdata &&
+		    !dict_get_ptr (replies[i].xdata, AFR_DIRTY,
+				   (void **) &dirty) &&
+		    dirty && ntoh32 (dirty[idx]))
+			usable = _gf_false;
+
+		if (!sources[i])
+			continue;
+
+		if (!value || len != AFR_DIRTY_REGIONS_SIZE) {
+			usable = _gf_false;
+			continue;
+		}
+
+		size = afr_dirty_regions_size (value);
+		if (!size || (region_size && size != region_size)) {
+			usable = _gf_false;
+			continue;
+		}
+		region_size = size;
+
+		for (j = AFR_DIRTY_REGIONS_HDR_SIZE;
+		     j < AFR_DIRTY_REGIONS_SIZE; j++)
+			regions[j] |= value[j];
+	}
+
+	afr_local_replies_wipe (local, priv);
+
+	if (!priv->dirty_region_size || !usable)
+		return 0;
+
+	return region_size;
+}
+
+
+/*
+ * Drops the dirty-region bitmaps once no brick has data pending. This is
+ * done under a full lock, so that no write is recording its range
+ * meanwhile.
+ */
+static int
+__afr_selfheal_data_drop_regions (call_frame_t *frame, xlator_t *this,
+				  fd_t *fd)
+{
+	afr_private_t *priv = NULL;
+	unsigned char *locked_on = NULL;
+	struct afr_reply *replies = NULL;
+	int ret = 0;
+	int i = 0;
+
+	priv = this->private;
+
+	locked_on = alloca0 (priv->child_count);
+	replies = alloca0 (sizeof (*replies) * priv->child_count);
+
+	ret = afr_selfheal_inodelk (frame, this, fd->inode, this->name, 0, 0,
+				    locked_on);
+	{
+		if (ret < priv->child_count) {
+			ret = -ENOTCONN;
+			goto unlock;
+		}
+
+		ret = afr_selfheal_unlocked_discover (frame, fd->inode,
+						      fd->inode->gfid, replies);
+		if (ret)
+			goto unlock;
+
+		for (i = 0; i < priv->child_count; i++) {
+			if (!replies[i].valid || replies[i].op_ret == -1 ||
+			    !replies[i].xdata ||
+			    afr_is_data_set (this, replies[i].xdata)) {
+				ret = -EAGAIN;
+				goto unlock;
+			}
+		}
+
+		AFR_ONLIST (locked_on, frame, __afr_dirty_regions_drop_cbk,
+			    fremovexattr, fd, AFR_DIRTY_REGIONS, NULL);
+	}
+unlock:
+	afr_selfheal_uninodelk (frame, this, fd->inode, this->name, 0, 0,
+				locked_on);
+
+	afr_replies_wipe (replies, priv->child_count);
+
+	return ret;
+}
+
 /*
  * If by chance there are multiple sources with differing sizes, select
  * the largest file as the source.
@@ -495,6 +688,9 @@ __afr_selfheal_data (call_frame_t *frame, xlator_t *this, fd_t *fd,
 	int source = -1;
 	gf_boolean_t compat = _gf_false;
 	unsigned char *compat_lock = NULL;
+	char *regions = NULL;
+	uint64_t region_size = 0;
+	gf_boolean_t drop_regions = _gf_false;
 
 	priv = this->private;
 
@@ -503,6 +699,7 @@ __afr_selfheal_data (call_frame_t *frame, xlator_t *this, fd_t *fd,
 	healed_sinks = alloca0 (priv->child_count);
 	data_lock = alloca0 (priv->child_count);
 	compat_lock = alloca0 (priv->child_count);
+	regions = alloca0 (AFR_DIRTY_REGIONS_SIZE);
 
 	locked_replies = alloca0 (sizeof (*locked_replies) * priv->child_count);
 
@@ -522,6 +719,12 @@ __afr_selfheal_data (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
 		source = ret;
 
+		region_size = __afr_selfheal_data_regions (frame, this, fd,
+							   data_lock, sources,
+							   locked_replies,
+							   regions,
+							   &drop_regions);
+
 		ret = __afr_selfheal_truncate_sinks (frame, this, fd, healed_sinks,
 						     locked_replies,
 						     locked_replies[source].poststat.ia_size);
@@ -546,7 +749,8 @@ unlock:
 		goto out;
 
 	ret = afr_selfheal_data_do (frame, this, fd, source, healed_sinks,
-				    locked_replies);
+				    locked_replies,
+				    region_size ? regions : NULL, region_size);
 	if (ret)
 		goto out;
 
@@ -558,6 +762,9 @@ out:
 		afr_selfheal_uninodelk (frame, this, fd->inode, this->name,
 					LLONG_MAX - 2, 1, compat_lock);
 
+	if (!ret && drop_regions)
+		__afr_selfheal_data_drop_regions (frame, this, fd);
+
         if (locked_replies)
                 afr_replies_wipe (locked_replies, priv->child_count);
 
@@ -149,6 +149,45 @@ out:
 }
 
 
+/* The new entries are empty, a dirty-region bitmap of the sources would
+   not cover what they miss */
+static void
+afr_selfheal_newentry_poison (call_frame_t *frame, xlator_t *this,
+			      inode_t *inode, unsigned char *sources)
+{
+	afr_private_t *priv = NULL;
+	dict_t *xattr = NULL;
+	char *regions = NULL;
+	int i = 0;
+
+	priv = this->private;
+
+	xattr = dict_new ();
+	if (!xattr)
+		return;
+
+	regions = GF_CALLOC (1, AFR_DIRTY_REGIONS_SIZE, gf_afr_mt_char);
+	if (!regions)
+		goto out;
+
+	afr_dirty_regions_poison (regions);
+	if (dict_set_bin (xattr, AFR_DIRTY_REGIONS, regions,
+			  AFR_DIRTY_REGIONS_SIZE)) {
+		GF_FREE (regions);
+		goto out;
+	}
+
+	for (i = 0; i < priv->child_count; i++) {
+		if (!sources[i])
+			continue;
+		afr_selfheal_xattrop (frame, this, inode, i,
+				      GF_XATTROP_OR_ARRAY, xattr);
+	}
+out:
+	dict_unref (xattr);
+}
+
+
 static int
 afr_selfheal_newentry_mark (call_frame_t *frame, xlator_t *this, inode_t *inode,
 			    int source, struct afr_reply *replies,
@@ -188,6 +227,10 @@ afr_selfheal_newentry_mark (call_frame_t *frame, xlator_t *this, inode_t *inode,
 	}
 
 	dict_unref (xattr);
+
+	if (priv->dirty_region_size)
+		afr_selfheal_newentry_poison (frame, this, inode, sources);
+
 	return ret;
 }
 
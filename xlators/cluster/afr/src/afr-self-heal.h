@@ -84,6 +84,19 @@
 int
 afr_selfheal (xlator_t *this, uuid_t gfid);
 
+int
+afr_selfheal_defer_data (xlator_t *this, uuid_t gfid,
+			 gf_boolean_t *data_pending);
+
+gf_boolean_t
+afr_is_data_set (xlator_t *this, dict_t *xdata);
+
+gf_boolean_t
+afr_is_metadata_set (xlator_t *this, dict_t *xdata);
+
+gf_boolean_t
+afr_is_entry_set (xlator_t *this, dict_t *xdata);
+
 int
 afr_selfheal_name (xlator_t *this, uuid_t gfid, const char *name,
                    void *gfid_req);
@@ -155,6 +168,10 @@ afr_selfheal_recreate_entry (call_frame_t *frame, xlator_t *this, int dst,
 			     int source, inode_t *dir, const char *name,
 			     inode_t *inode, struct afr_reply *replies);
 
+int
+afr_selfheal_xattrop (call_frame_t *frame, xlator_t *this, inode_t *inode,
+		      int subvol, gf_xattrop_flags_t optype, dict_t *xattr);
+
 int
 afr_selfheal_post_op (call_frame_t *frame, xlator_t *this, inode_t *inode,
 		      int subvol, dict_t *xattr);
@@ -282,7 +282,8 @@ afr_shd_selfheal_name (struct subvol_healer *healer, int child, uuid_t parent,
 }
 
 int
-afr_shd_selfheal (struct subvol_healer *healer, int child, uuid_t gfid)
+afr_shd_selfheal (struct subvol_healer *healer, int child, uuid_t gfid,
+		  gf_boolean_t *data_pending)
 {
 	int ret = 0;
 	eh_t *eh = NULL;
@@ -306,16 +307,27 @@ afr_shd_selfheal (struct subvol_healer *healer, int child, uuid_t gfid)
         if (ret < 0)
                 return ret;
 
-	ret = afr_selfheal (this, gfid);
+	if (data_pending) {
+		ret = afr_selfheal_defer_data (this, gfid, data_pending);
+		/* accounted for once the data is healed as well */
+		if (ret == 0 && *data_pending)
+			goto out;
+	} else {
+		ret = afr_selfheal (this, gfid);
+	}
 
-	if (ret == -EIO) {
-		eh = shd->split_brain;
-		crawl_event->split_brain_count++;
-	} else if (ret < 0) {
-		crawl_event->heal_failed_count++;
-	} else if (ret == 0) {
-		crawl_event->healed_count++;
+	pthread_mutex_lock (&healer->qlock);
+	{
+		if (ret == -EIO) {
+			eh = shd->split_brain;
+			crawl_event->split_brain_count++;
+		} else if (ret < 0) {
+			crawl_event->heal_failed_count++;
+		} else if (ret == 0) {
+			crawl_event->healed_count++;
+		}
 	}
+	pthread_mutex_unlock (&healer->qlock);
 
 	if (eh) {
 		shd_event = GF_CALLOC (1, sizeof(*shd_event),
@@ -349,6 +361,7 @@ afr_shd_sweep_prepare (struct subvol_healer *healer)
 	event->healed_count = 0;
 	event->split_brain_count = 0;
 	event->heal_failed_count = 0;
+	event->queued = 0;
 
 	time (&event->start_time);
 	event->end_time = 0;
@@ -377,6 +390,177 @@ afr_shd_sweep_done (struct subvol_healer *healer)
 }
 
 
+void *
+afr_shd_heal_worker (void *data)
+{
+	struct shd_heal_worker *worker = NULL;
+	struct subvol_healer *healer = NULL;
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	shd_gfid_t *entry = NULL;
+	gf_boolean_t deferred = _gf_false;
+	gf_boolean_t data_pending = _gf_false;
+	int ret = 0;
+
+	worker = data;
+	healer = worker->healer;
+	THIS = this = healer->this;
+	priv = this->private;
+
+	for (;;) {
+		pthread_mutex_lock (&healer->qlock);
+		{
+			while (list_empty (&worker->pending) &&
+			       list_empty (&worker->deferred))
+				pthread_cond_wait (&worker->cond,
+						   &healer->qlock);
+
+			deferred = list_empty (&worker->pending);
+			if (deferred)
+				entry = list_entry (worker->deferred.next,
+						    shd_gfid_t, list);
+			else
+				entry = list_entry (worker->pending.next,
+						    shd_gfid_t, list);
+			list_del_init (&entry->list);
+		}
+		pthread_mutex_unlock (&healer->qlock);
+
+		data_pending = _gf_false;
+
+		if (!priv->shd.enabled)
+			ret = -EBUSY;
+		else
+			ret = afr_shd_selfheal (healer, healer->subvol,
+						entry->gfid,
+						deferred ? NULL : &data_pending);
+
+		if (ret == -ENOENT || ret == -ESTALE)
+			afr_shd_index_purge (priv->children[healer->subvol],
+					     healer->index_inode,
+					     uuid_utoa (entry->gfid));
+
+		pthread_mutex_lock (&healer->qlock);
+		{
+			if (ret == 0 && data_pending) {
+				list_add_tail (&entry->list, &worker->deferred);
+				entry = NULL;
+			} else {
+				if (ret == 0)
+					healer->healed++;
+				healer->qlength--;
+				healer->crawl_event.queued = healer->qlength;
+				pthread_cond_broadcast (&healer->qcond);
+			}
+		}
+		pthread_mutex_unlock (&healer->qlock);
+
+		GF_FREE (entry);
+	}
+
+	return NULL;
+}
+
+
+/* call with healer->qlock held */
+int
+__afr_shd_heal_workers_spawn (struct subvol_healer *healer)
+{
+	afr_private_t *priv = NULL;
+	struct shd_heal_worker *worker = NULL;
+	int wanted = 0;
+	int ret = 0;
+
+	priv = healer->this->private;
+	wanted = min (priv->shd.max_threads, AFR_SHD_MAX_THREADS);
+
+	if (!healer->workers) {
+		healer->workers = GF_CALLOC (AFR_SHD_MAX_THREADS,
+					     sizeof (*healer->workers),
+					     gf_afr_mt_shd_heal_worker_t);
+		if (!healer->workers)
+			return -ENOMEM;
+	}
+
+	while (healer->nr_workers < wanted) {
+		worker = &healer->workers[healer->nr_workers];
+
+		worker->healer = healer;
+		INIT_LIST_HEAD (&worker->pending);
+		INIT_LIST_HEAD (&worker->deferred);
+
+		ret = pthread_cond_init (&worker->cond, NULL);
+		if (ret)
+			break;
+
+		ret = gf_thread_create (&worker->thread, NULL,
+					afr_shd_heal_worker, worker);
+		if (ret) {
+			pthread_cond_destroy (&worker->cond);
+			break;
+		}
+
+		healer->nr_workers++;
+	}
+
+	/* lowering shd-max-threads only stops feeding the extra threads */
+	healer->nr_shards = min (wanted, healer->nr_workers);
+
+	return healer->nr_shards ? 0 : -EAGAIN;
+}
+
+
+int
+afr_shd_index_queue (struct subvol_healer *healer, uuid_t gfid)
+{
+	shd_gfid_t *entry = NULL;
+	struct shd_heal_worker *worker = NULL;
+
+	entry = GF_CALLOC (1, sizeof (*entry), gf_afr_mt_shd_gfid_t);
+	if (!entry)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD (&entry->list);
+	uuid_copy (entry->gfid, gfid);
+
+	worker = &healer->workers[gfid[15] % healer->nr_shards];
+
+	pthread_mutex_lock (&healer->qlock);
+	{
+		while (healer->qlength >= AFR_SHD_WAIT_QLENGTH)
+			pthread_cond_wait (&healer->qcond, &healer->qlock);
+
+		list_add_tail (&entry->list, &worker->pending);
+		healer->qlength++;
+		healer->crawl_event.queued = healer->qlength;
+
+		pthread_cond_signal (&worker->cond);
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	return 0;
+}
+
+
+int
+afr_shd_index_drain (struct subvol_healer *healer)
+{
+	int healed = 0;
+
+	pthread_mutex_lock (&healer->qlock);
+	{
+		while (healer->qlength)
+			pthread_cond_wait (&healer->qcond, &healer->qlock);
+
+		healed = healer->healed;
+		healer->index_inode = NULL;
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	return healed;
+}
+
+
 int
 afr_shd_index_sweep (struct subvol_healer *healer)
 {
@@ -391,6 +575,7 @@ afr_shd_index_sweep (struct subvol_healer *healer)
 	uuid_t gfid;
 	int ret = 0;
 	int count = 0;
+	dict_t *xattr_req = NULL;
 
 	this = healer->this;
 	child = healer->subvol;
@@ -404,9 +589,49 @@ afr_shd_index_sweep (struct subvol_healer *healer)
 		return -errno;
 	}
 
+	pthread_mutex_lock (&healer->qlock);
+	{
+		ret = __afr_shd_heal_workers_spawn (healer);
+		if (!ret) {
+			healer->index_inode = fd->inode;
+			healer->healed = 0;
+		}
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	if (ret) {
+		gf_log (this->name, GF_LOG_WARNING,
+			"unable to start healer threads for %s", subvol->name);
+		goto out;
+	}
+
 	INIT_LIST_HEAD (&entries.list);
 
-	while ((ret = syncop_readdir (subvol, fd, 131072, offset, &entries))) {
+	/* the index lists the entries along with their pending xattrs on
+	   this brick, so that the ones with nothing pending any more are
+	   not healed */
+	xattr_req = dict_new ();
+	if (xattr_req && afr_xattr_req_prepare (this, xattr_req)) {
+		dict_unref (xattr_req);
+		xattr_req = NULL;
+	}
+
+	for (;;) {
+		if (xattr_req) {
+			ret = syncop_readdirp (subvol, fd, 131072, offset,
+					       xattr_req, &entries);
+			if (ret < 0 && offset == 0) {
+				/* brick without readdirp on the index */
+				dict_unref (xattr_req);
+				xattr_req = NULL;
+				continue;
+			}
+		} else {
+			ret = syncop_readdir (subvol, fd, 131072, offset,
+					      &entries);
+		}
+		if (!ret)
+			break;
 		if (ret > 0)
 			ret = 0;
 		list_for_each_entry (entry, &entries.list, list) {
@@ -428,15 +653,15 @@ afr_shd_index_sweep (struct subvol_healer *healer)
 			if (ret)
 				continue;
 
-			ret = afr_shd_selfheal (healer, child, gfid);
-			if (ret == 0)
-				count++;
+			if (entry->dict &&
+			    !afr_is_data_set (this, entry->dict) &&
+			    !afr_is_metadata_set (this, entry->dict) &&
+			    !afr_is_entry_set (this, entry->dict))
+				continue;
 
-			if (ret == -ENOENT || ret == -ESTALE) {
-				afr_shd_index_purge (subvol, fd->inode,
-						     entry->d_name);
-				ret = 0;
-			}
+			ret = afr_shd_index_queue (healer, gfid);
+			if (ret)
+				break;
 		}
 
 		gf_dirent_free (&entries);
@@ -444,6 +669,11 @@ afr_shd_index_sweep (struct subvol_healer *healer)
 			break;
 	}
 
+	/* healer threads purge stale entries through fd->inode */
+	count = afr_shd_index_drain (healer);
+out:
+	if (xattr_req)
+		dict_unref (xattr_req);
 	if (fd) {
                 if (fd->inode)
                         inode_forget (fd->inode, 1);
@@ -457,7 +687,264 @@ afr_shd_index_sweep (struct subvol_healer *healer)
 
 
 int
-afr_shd_full_sweep (struct subvol_healer *healer, inode_t *inode)
+afr_shd_crawl_xattr_set (struct subvol_healer *healer, inode_t *inode,
+			 const char *key, char *value)
+{
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	loc_t loc = {0, };
+	dict_t *xattr = NULL;
+	int ret = -1;
+
+	this = healer->this;
+	priv = this->private;
+
+	xattr = dict_new ();
+	if (!xattr) {
+		GF_FREE (value);
+		return -ENOMEM;
+	}
+
+	/* stored with its NUL, so that it reads back as a string */
+	ret = dict_set_dynstr (xattr, (char *) key, value);
+	if (ret) {
+		GF_FREE (value);
+		goto out;
+	}
+
+	loc.inode = inode_ref (inode);
+	uuid_copy (loc.gfid, inode->gfid);
+
+	ret = syncop_setxattr (priv->children[healer->subvol], &loc, xattr, 0);
+
+	loc_wipe (&loc);
+out:
+	dict_unref (xattr);
+	return ret;
+}
+
+
+int
+afr_shd_crawl_ckpt_save (struct subvol_healer *healer)
+{
+	shd_crawl_ckpt_t *ckpt = NULL;
+	char *value = NULL;
+	int ret = 0;
+
+	ckpt = &healer->ckpt;
+
+	ret = gf_asprintf (&value, "%"PRIu64":%"PRId64":%"PRIu64":%"PRId64,
+			   ckpt->id, (int64_t) ckpt->start,
+			   ckpt->done_id, (int64_t) ckpt->done_start);
+	if (ret < 0)
+		return -ENOMEM;
+
+	ret = afr_shd_crawl_xattr_set (healer, healer->this->itable->root,
+				       AFR_SHD_CRAWL_CKPT_XATTR, value);
+	if (ret)
+		gf_log (healer->this->name, GF_LOG_WARNING,
+			"unable to save the full crawl checkpoint of %s (%s)",
+			afr_subvol_name (healer->this, healer->subvol),
+			strerror (-ret));
+	return ret;
+}
+
+
+void
+afr_shd_crawl_ckpt_load (struct subvol_healer *healer)
+{
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	shd_crawl_ckpt_t *ckpt = NULL;
+	loc_t rootloc = {0, };
+	dict_t *xattr = NULL;
+	data_t *data = NULL;
+	char value[128] = {0, };
+	int64_t start = 0;
+	int64_t done_start = 0;
+	int ret = 0;
+
+	this = healer->this;
+	priv = this->private;
+	ckpt = &healer->ckpt;
+
+	memset (ckpt, 0, sizeof (*ckpt));
+
+	rootloc.inode = inode_ref (this->itable->root);
+	uuid_copy (rootloc.gfid, rootloc.inode->gfid);
+
+	ret = syncop_getxattr (priv->children[healer->subvol], &rootloc,
+			       &xattr, AFR_SHD_CRAWL_CKPT_XATTR);
+	loc_wipe (&rootloc);
+	if (ret || !xattr)
+		goto out;
+
+	data = dict_get (xattr, AFR_SHD_CRAWL_CKPT_XATTR);
+	if (!data)
+		goto out;
+
+	memcpy (value, data->data, min (data->len, sizeof (value) - 1));
+	ret = sscanf (value, "%"SCNu64":%"SCNd64":%"SCNu64":%"SCNd64,
+		      &ckpt->id, &start, &ckpt->done_id, &done_start);
+	if (ret != 4) {
+		gf_log (this->name, GF_LOG_WARNING,
+			"ignoring malformed full crawl checkpoint of %s",
+			afr_subvol_name (this, healer->subvol));
+		memset (ckpt, 0, sizeof (*ckpt));
+		goto out;
+	}
+
+	ckpt->start = start;
+	ckpt->done_start = done_start;
+out:
+	if (xattr)
+		dict_unref (xattr);
+}
+
+
+int
+afr_shd_full_crawl_mark (struct subvol_healer *healer, inode_t *inode)
+{
+	char *value = NULL;
+
+	if (gf_asprintf (&value, "%"PRIu64":%"PRId64, healer->ckpt.id,
+			 (int64_t) time (NULL)) < 0)
+		return -ENOMEM;
+
+	return afr_shd_crawl_xattr_set (healer, inode,
+					AFR_SHD_CRAWL_MARK_XATTR, value);
+}
+
+
+/*
+ * Whether the subtree of a directory need not be crawled: either it
+ * already was, earlier in the crawl being resumed, or (incremental
+ * crawls) the directory was not modified since the last completed crawl
+ * marked it and has no entry or metadata heal pending.
+ */
+gf_boolean_t
+afr_shd_full_crawl_skip (struct subvol_healer *healer, gf_dirent_t *entry)
+{
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	data_t *data = NULL;
+	char value[64] = {0, };
+	uint64_t id = 0;
+	int64_t marked = 0;
+
+	this = healer->this;
+	priv = this->private;
+
+	if (!entry->dict)
+		return _gf_false;
+
+	data = dict_get (entry->dict, AFR_SHD_CRAWL_MARK_XATTR);
+	if (!data)
+		return _gf_false;
+
+	memcpy (value, data->data, min (data->len, sizeof (value) - 1));
+	if (sscanf (value, "%"SCNu64":%"SCNd64, &id, &marked) != 2)
+		return _gf_false;
+
+	if (id == healer->ckpt.id)
+		return _gf_true;
+
+	if (!priv->shd.full_crawl_incremental || !healer->ckpt.done_id ||
+	    id != healer->ckpt.done_id)
+		return _gf_false;
+
+	if (entry->d_stat.ia_ctime > marked + AFR_SHD_CRAWL_CTIME_SLACK)
+		return _gf_false;
+
+	if (afr_is_entry_set (this, entry->dict) ||
+	    afr_is_metadata_set (this, entry->dict))
+		return _gf_false;
+
+	/* carry the mark over, for the next crawl to skip it as well */
+	afr_shd_full_crawl_mark (healer, entry->inode);
+
+	return _gf_true;
+}
+
+
+int
+afr_shd_full_crawl_queue (struct subvol_healer *healer,
+			  shd_crawl_dir_t *parent, inode_t *inode)
+{
+	shd_crawl_dir_t *dir = NULL;
+
+	dir = GF_CALLOC (1, sizeof (*dir), gf_afr_mt_shd_crawl_dir_t);
+	if (!dir)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD (&dir->list);
+	dir->inode = inode_ref (inode);
+	dir->parent = parent;
+	dir->pending = 1;
+
+	pthread_mutex_lock (&healer->qlock);
+	{
+		if (parent)
+			parent->pending++;
+
+		/* depth first, which keeps the queue short */
+		list_add (&dir->list, &healer->crawl_queue);
+		pthread_cond_signal (&healer->qcond);
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	return 0;
+}
+
+
+/*
+ * A directory is complete (and marked as such) once it has been read
+ * and all its subdirectories are complete. The crawl root is left to
+ * afr_shd_full_sweep().
+ */
+void
+afr_shd_full_crawl_dir_done (struct subvol_healer *healer,
+			     shd_crawl_dir_t *dir, int ret)
+{
+	shd_crawl_dir_t *parent = NULL;
+	gf_boolean_t failed = _gf_false;
+	int pending = 0;
+
+	pthread_mutex_lock (&healer->qlock);
+	{
+		if (ret)
+			dir->failed = _gf_true;
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	while (dir) {
+		pthread_mutex_lock (&healer->qlock);
+		{
+			pending = --dir->pending;
+			failed = dir->failed;
+			parent = dir->parent;
+			if (!pending && failed && parent)
+				parent->failed = _gf_true;
+		}
+		pthread_mutex_unlock (&healer->qlock);
+
+		if (pending || !parent)
+			break;
+
+		if (!failed)
+			afr_shd_full_crawl_mark (healer, dir->inode);
+
+		inode_unref (dir->inode);
+		GF_FREE (dir);
+
+		dir = parent;
+	}
+}
+
+
+int
+afr_shd_full_crawl_dir (struct subvol_healer *healer, shd_crawl_dir_t *dir,
+			dict_t *xattr_req)
 {
 	fd_t *fd = NULL;
 	xlator_t *this = NULL;
@@ -472,13 +959,14 @@ afr_shd_full_sweep (struct subvol_healer *healer, inode_t *inode)
 	priv = this->private;
 	subvol = priv->children[healer->subvol];
 
-	fd = fd_anonymous (inode);
+	fd = fd_anonymous (dir->inode);
 	if (!fd)
 		return -errno;
 
 	INIT_LIST_HEAD (&entries.list);
 
-	while ((ret = syncop_readdirp (subvol, fd, 131072, offset, 0, &entries))) {
+	while ((ret = syncop_readdirp (subvol, fd, 131072, offset, xattr_req,
+				       &entries))) {
 		if (ret < 0)
 			break;
 
@@ -499,16 +987,21 @@ afr_shd_full_sweep (struct subvol_healer *healer, inode_t *inode)
 				continue;
 
 			afr_shd_selfheal_name (healer, healer->subvol,
-					       inode->gfid, entry->d_name);
+					       dir->inode->gfid, entry->d_name);
 
 			afr_shd_selfheal (healer, healer->subvol,
-					  entry->d_stat.ia_gfid);
+					  entry->d_stat.ia_gfid, NULL);
 
-			if (entry->d_stat.ia_type == IA_IFDIR) {
-				ret = afr_shd_full_sweep (healer, entry->inode);
-				if (ret)
-					break;
-			}
+			if (entry->d_stat.ia_type != IA_IFDIR)
+				continue;
+
+			if (afr_shd_full_crawl_skip (healer, entry))
+				continue;
+
+			ret = afr_shd_full_crawl_queue (healer, dir,
+							entry->inode);
+			if (ret)
+				break;
 		}
 
 		gf_dirent_free (&entries);
@@ -522,6 +1015,148 @@ afr_shd_full_sweep (struct subvol_healer *healer, inode_t *inode)
 }
 
 
+void *
+afr_shd_full_crawler (void *data)
+{
+	struct subvol_healer *healer = NULL;
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	shd_crawl_dir_t *dir = NULL;
+	dict_t *xattr_req = NULL;
+	int ret = 0;
+
+	healer = data;
+	THIS = this = healer->this;
+	priv = this->private;
+
+	/* without it nothing gets skipped, which is only slower */
+	xattr_req = dict_new ();
+	if (xattr_req) {
+		afr_xattr_req_prepare (this, xattr_req);
+		ret = dict_set_uint64 (xattr_req, AFR_SHD_CRAWL_MARK_XATTR, 0);
+		if (ret)
+			gf_log (this->name, GF_LOG_DEBUG,
+				"failed to request %s", AFR_SHD_CRAWL_MARK_XATTR);
+	}
+
+	for (;;) {
+		dir = NULL;
+
+		pthread_mutex_lock (&healer->qlock);
+		{
+			while (list_empty (&healer->crawl_queue) &&
+			       healer->crawl_busy)
+				pthread_cond_wait (&healer->qcond,
+						   &healer->qlock);
+
+			if (!list_empty (&healer->crawl_queue)) {
+				dir = list_entry (healer->crawl_queue.next,
+						  shd_crawl_dir_t, list);
+				list_del_init (&dir->list);
+				healer->crawl_busy++;
+			}
+		}
+		pthread_mutex_unlock (&healer->qlock);
+
+		if (!dir)
+			break;
+
+		if (!priv->shd.enabled)
+			ret = -EBUSY;
+		else
+			ret = afr_shd_full_crawl_dir (healer, dir, xattr_req);
+
+		afr_shd_full_crawl_dir_done (healer, dir, ret);
+
+		pthread_mutex_lock (&healer->qlock);
+		{
+			healer->crawl_busy--;
+			pthread_cond_broadcast (&healer->qcond);
+		}
+		pthread_mutex_unlock (&healer->qlock);
+	}
+
+	if (xattr_req)
+		dict_unref (xattr_req);
+
+	return NULL;
+}
+
+
+int
+afr_shd_full_sweep (struct subvol_healer *healer, inode_t *inode)
+{
+	xlator_t *this = NULL;
+	afr_private_t *priv = NULL;
+	shd_crawl_ckpt_t *ckpt = NULL;
+	shd_crawl_dir_t *root = NULL;
+	pthread_t threads[AFR_SHD_MAX_THREADS];
+	int nr_threads = 0;
+	int i = 0;
+	int ret = 0;
+
+	this = healer->this;
+	priv = this->private;
+	ckpt = &healer->ckpt;
+
+	afr_shd_crawl_ckpt_load (healer);
+
+	if (ckpt->id != ckpt->done_id) {
+		gf_log (this->name, GF_LOG_INFO,
+			"resuming full crawl %"PRIu64" on %s", ckpt->id,
+			afr_subvol_name (this, healer->subvol));
+	} else {
+		ckpt->id = ckpt->done_id + 1;
+		ckpt->start = time (NULL);
+		afr_shd_crawl_ckpt_save (healer);
+	}
+
+	root = GF_CALLOC (1, sizeof (*root), gf_afr_mt_shd_crawl_dir_t);
+	if (!root)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD (&root->list);
+	root->inode = inode_ref (inode);
+	root->pending = 1;
+
+	pthread_mutex_lock (&healer->qlock);
+	{
+		healer->crawl_busy = 0;
+		list_add (&root->list, &healer->crawl_queue);
+	}
+	pthread_mutex_unlock (&healer->qlock);
+
+	for (i = 1; i < min (priv->shd.max_threads, AFR_SHD_MAX_THREADS); i++) {
+		if (gf_thread_create (&threads[nr_threads], NULL,
+				      afr_shd_full_crawler, healer))
+			break;
+		nr_threads++;
+	}
+
+	afr_shd_full_crawler (healer);
+
+	for (i = 0; i < nr_threads; i++)
+		pthread_join (threads[i], NULL);
+
+	if (root->failed) {
+		gf_log (this->name, GF_LOG_INFO,
+			"full crawl %"PRIu64" on %s is incomplete, the next "
+			"one resumes it", ckpt->id,
+			afr_subvol_name (this, healer->subvol));
+		ret = -1;
+	} else {
+		ckpt->done_id = ckpt->id;
+		ckpt->done_start = ckpt->start;
+		afr_shd_crawl_ckpt_save (healer);
+	}
+
+	inode_unref (root->inode);
+	GF_FREE (root);
+
+	return ret;
+}
+
+
 void *
 afr_shd_index_healer (void *data)
 {
@@ -627,6 +1262,16 @@ afr_shd_healer_init (xlator_t *this, struct subvol_healer *healer)
 	if (ret)
 		goto out;
 
+	ret = pthread_mutex_init (&healer->qlock, NULL);
+	if (ret)
+		goto out;
+
+	ret = pthread_cond_init (&healer->qcond, NULL);
+	if (ret)
+		goto out;
+
+	INIT_LIST_HEAD (&healer->crawl_queue);
+
 	healer->this = this;
 	healer->running = _gf_false;
 	healer->rerun = _gf_false;
@@ -695,6 +1340,8 @@ afr_shd_dict_add_crawl_event (xlator_t *this, dict_t *output,
         char            *crawl_type = NULL;
         int             progress = -1;
 	int             child = -1;
+        time_t          elapsed = 0;
+        double          heal_rate = 0;
 
 	child = crawl_event->child;
         healed_count = crawl_event->healed_count;
@@ -795,6 +1442,31 @@ afr_shd_dict_add_crawl_event (xlator_t *this, dict_t *output,
                 goto out;
         }
 
+        if (crawl_event->end_time)
+                elapsed = crawl_event->end_time - crawl_event->start_time;
+        else
+                elapsed = time (NULL) - crawl_event->start_time;
+        heal_rate = (elapsed > 0) ? ((double) healed_count / elapsed)
+                                  : healed_count;
+
+        snprintf (key, sizeof (key), "statistics_heal_rate-%d-%d-%"PRIu64,
+                  xl_id, child, count);
+        ret = dict_set_double (output, key, heal_rate);
+	if (ret) {
+                gf_log (this->name, GF_LOG_ERROR,
+			"Could not add statistics_heal_rate to outout");
+                goto out;
+        }
+
+        snprintf (key, sizeof (key), "statistics_queued-%d-%d-%"PRIu64,
+                  xl_id, child, count);
+        ret = dict_set_uint64 (output, key, crawl_event->queued);
+	if (ret) {
+                gf_log (this->name, GF_LOG_ERROR,
+			"Could not add statistics_queued to outout");
+                goto out;
+        }
+
 	snprintf (key, sizeof (key), "statistics-%d-%d-count", xl_id, child);
 	ret = dict_set_uint64 (output, key, count + 1);
 	if (ret) {
@@ -14,6 +14,18 @@
 
 #include <pthread.h>
 
+#include "list.h"
+
+#define AFR_SHD_MAX_THREADS          64
+
+/* entries the index sweep queues ahead of the healer threads */
+#define AFR_SHD_WAIT_QLENGTH       1024
+
+#define AFR_SHD_CRAWL_CKPT_XATTR   "trusted.afr.shd-crawl-ckpt"
+#define AFR_SHD_CRAWL_MARK_XATTR   "trusted.afr.shd-crawl-mark"
+
+/* the ctime of a directory can be a bit ahead of the mark we set on it */
+#define AFR_SHD_CRAWL_CTIME_SLACK     2
 
 typedef struct {
 	int child;
@@ -33,8 +45,52 @@ typedef struct {
 	   cralwer is in progress */
         time_t   end_time;
         char     *crawl_type;
+        /* entries read off the index and not healed yet */
+        uint64_t queued;
 } crawl_event_t;
 
+typedef struct {
+	struct list_head  list;
+	uuid_t            gfid;
+} shd_gfid_t;
+
+struct subvol_healer;
+
+/*
+ * Full crawls of a brick, checkpointed on its root: a crawl is in
+ * progress (and resumed by the next "heal full") while @id != @done_id.
+ * Every directory whose subtree got crawled carries the id of the crawl
+ * in AFR_SHD_CRAWL_MARK_XATTR.
+ */
+typedef struct {
+	uint64_t  id;
+	time_t    start;
+	uint64_t  done_id;
+	time_t    done_start;
+} shd_crawl_ckpt_t;
+
+/* directory of a full crawl, complete once all its subdirectories are */
+typedef struct shd_crawl_dir {
+	struct list_head       list;
+	struct shd_crawl_dir  *parent;
+	inode_t               *inode;
+	int                    pending;
+	gf_boolean_t           failed;
+} shd_crawl_dir_t;
+
+/*
+ * Index entries are sharded by gfid over the healer threads of a
+ * subvol. A thread heals metadata and entries first and only gets to
+ * the data heals (moved to @deferred) when nothing else is pending.
+ */
+struct shd_heal_worker {
+	struct subvol_healer *healer;
+	pthread_t             thread;
+	pthread_cond_t        cond;
+	struct list_head      pending;
+	struct list_head      deferred;
+};
+
 struct subvol_healer {
 	xlator_t        *this;
 	int              subvol;
@@ -45,11 +101,28 @@ struct subvol_healer {
 	pthread_mutex_t  mutex;
 	pthread_cond_t   cond;
 	pthread_t        thread;
+
+	/* index heal threads, all of the below under qlock */
+	pthread_mutex_t          qlock;
+	pthread_cond_t           qcond;
+	struct shd_heal_worker  *workers;
+	int                      nr_workers;
+	int                      nr_shards;
+	uint64_t                 qlength;
+	int                      healed;
+	inode_t                 *index_inode;
+
+	/* full crawl, under qlock as well */
+	struct list_head         crawl_queue;
+	int                      crawl_busy;
+	shd_crawl_ckpt_t         ckpt;
 };
 
 typedef struct {
 	gf_boolean_t            iamshd;
 	gf_boolean_t            enabled;
+	uint32_t                max_threads;
+	gf_boolean_t            full_crawl_incremental;
 	struct subvol_healer   *index_healers;
 	struct subvol_healer   *full_healers;
 
@@ -28,6 +28,19 @@ int
 afr_changelog_do (call_frame_t *frame, xlator_t *this, dict_t *xattr,
 		  afr_changelog_resume_t changelog_resume);
 
+static gf_boolean_t
+afr_dirty_regions_needed (call_frame_t *frame, xlator_t *this);
+
+static int
+afr_dirty_regions_record (call_frame_t *frame, xlator_t *this,
+			  afr_changelog_resume_t resume);
+
+static void
+afr_dirty_regions_forget (call_frame_t *frame, xlator_t *this);
+
+static int
+afr_changelog_unlock (call_frame_t *frame, xlator_t *this);
+
 
 int
 __afr_txn_write_fop (call_frame_t *frame, xlator_t *this)
@@ -142,6 +155,17 @@ afr_transaction_perform_fop (call_frame_t *frame, xlator_t *this)
         local = frame->local;
         fd    = local->fd;
 
+	if (!local->transaction.regions_recorded) {
+		if (!local->transaction.inherited)
+			afr_dirty_regions_forget (frame, this);
+
+		/* a brick is left out of the FOP, its range has to be on
+		   the bitmap of the others before it is written */
+		if (afr_dirty_regions_needed (frame, this))
+			return afr_dirty_regions_record (frame, this,
+						afr_transaction_perform_fop);
+	}
+
         /*  Perform fops with the lk-owner from top xlator.
          *  Eg: lk-owner of posix-lk and flush should be same,
          *  flush cant clear the  posix-lks without that lk-owner.
@@ -304,7 +328,7 @@ afr_changelog_post_op_done (call_frame_t *frame, xlator_t *this)
 		local->transaction.done (frame, this);
 	} else {
 		int_lock->lock_cbk = local->transaction.done;
-		afr_unlock (frame, this);
+		afr_changelog_unlock (frame, this);
 	}
 
 	return 0;
@@ -561,6 +585,632 @@ afr_handle_quorum (call_frame_t *frame)
         local->op_errno = EROFS;
 }
 
+static int
+afr_dirty_regions_range (afr_local_t *local, off_t *offset, off_t *len)
+{
+	switch (local->op) {
+	case GF_FOP_WRITE:
+		*offset = local->cont.writev.offset;
+		*len = iov_length (local->cont.writev.vector,
+				   local->cont.writev.count);
+		break;
+	case GF_FOP_TRUNCATE:
+		*offset = local->cont.truncate.offset;
+		*len = -1;
+		break;
+	case GF_FOP_FTRUNCATE:
+		*offset = local->cont.ftruncate.offset;
+		*len = -1;
+		break;
+	case GF_FOP_FALLOCATE:
+		*offset = local->cont.fallocate.offset;
+		*len = local->cont.fallocate.len;
+		break;
+	case GF_FOP_DISCARD:
+		*offset = local->cont.discard.offset;
+		*len = local->cont.discard.len;
+		break;
+	case GF_FOP_ZEROFILL:
+		*offset = local->cont.zerofill.offset;
+		*len = local->cont.zerofill.len;
+		break;
+	default:
+		return -1;
+	}
+
+	return 0;
+}
+
+
+static gf_boolean_t
+afr_dirty_regions_needed (call_frame_t *frame, xlator_t *this)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+
+	local = frame->local;
+	priv = this->private;
+
+	if (!priv->dirty_region_size)
+		return _gf_false;
+
+	if (local->transaction.type != AFR_DATA_TRANSACTION)
+		return _gf_false;
+
+	if (local->transaction.regions_recorded)
+		return _gf_false;
+
+	if (AFR_COUNT (local->transaction.pre_op, priv->child_count) ==
+	    priv->child_count && afr_txn_nothing_failed (frame, this))
+		return _gf_false;
+
+	return _gf_true;
+}
+
+
+/* The regions cached in the fd only live as long as the transactions on
+   the fd inherit each other's pre-op, i.e. the lock is not let go of (and
+   the bitmap cannot be dropped by self-heal). */
+static void
+afr_dirty_regions_forget (call_frame_t *frame, xlator_t *this)
+{
+	afr_local_t *local = NULL;
+	afr_fd_ctx_t *fd_ctx = NULL;
+
+	local = frame->local;
+
+	if (!local->fd)
+		return;
+
+	fd_ctx = afr_fd_ctx_get (local->fd, this);
+	if (!fd_ctx)
+		return;
+
+	LOCK (&local->fd->lock);
+	{
+		if (fd_ctx->dirty_regions)
+			memset (fd_ctx->dirty_regions, 0,
+				AFR_DIRTY_REGIONS_SIZE);
+	}
+	UNLOCK (&local->fd->lock);
+}
+
+
+/* whether the regions cached in the fd already cover what is to be
+   recorded */
+static gf_boolean_t
+afr_dirty_regions_cached (call_frame_t *frame, xlator_t *this,
+			  gf_boolean_t ranged, off_t offset, off_t len)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	afr_fd_ctx_t *fd_ctx = NULL;
+	uint64_t hdr = 0;
+	uint64_t i = 0;
+	uint64_t first = 0;
+	uint64_t last = 0;
+	gf_boolean_t ret = _gf_false;
+
+	local = frame->local;
+	priv = this->private;
+
+	if (!local->fd)
+		return _gf_false;
+
+	fd_ctx = afr_fd_ctx_get (local->fd, this);
+	if (!fd_ctx)
+		return _gf_false;
+
+	LOCK (&local->fd->lock);
+	{
+		if (!fd_ctx->dirty_regions)
+			goto unlock;
+
+		memcpy (&hdr, fd_ctx->dirty_regions, sizeof (hdr));
+		if (hdr == (uint64_t) -1) {
+			/* poisoned, everything is dirty already */
+			ret = _gf_true;
+			goto unlock;
+		}
+
+		if (!ranged || ntoh64 (hdr) != priv->dirty_region_size)
+			goto unlock;
+
+		first = offset / priv->dirty_region_size;
+		if (len < 0)
+			last = AFR_DIRTY_REGIONS_BITS - 1;
+		else
+			last = (offset + (len ? len : 1) - 1) /
+				priv->dirty_region_size;
+		if (first >= AFR_DIRTY_REGIONS_BITS)
+			first = AFR_DIRTY_REGIONS_BITS - 1;
+		if (last >= AFR_DIRTY_REGIONS_BITS)
+			last = AFR_DIRTY_REGIONS_BITS - 1;
+
+		ret = _gf_true;
+		for (i = first; i <= last; i++) {
+			if (!afr_dirty_regions_test (fd_ctx->dirty_regions,
+						     priv->dirty_region_size,
+						     i * priv->dirty_region_size,
+						     1)) {
+				ret = _gf_false;
+				break;
+			}
+		}
+	}
+unlock:
+	UNLOCK (&local->fd->lock);
+
+	return ret;
+}
+
+
+static void
+afr_dirty_regions_cache (call_frame_t *frame, xlator_t *this,
+			 gf_boolean_t ranged, off_t offset, off_t len)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	afr_fd_ctx_t *fd_ctx = NULL;
+	uint64_t hdr = 0;
+
+	local = frame->local;
+	priv = this->private;
+
+	if (!local->fd)
+		return;
+
+	fd_ctx = afr_fd_ctx_get (local->fd, this);
+	if (!fd_ctx)
+		return;
+
+	LOCK (&local->fd->lock);
+	{
+		if (!fd_ctx->dirty_regions)
+			fd_ctx->dirty_regions =
+				GF_CALLOC (1, AFR_DIRTY_REGIONS_SIZE,
+					   gf_afr_mt_char);
+		if (!fd_ctx->dirty_regions)
+			goto unlock;
+
+		memcpy (&hdr, fd_ctx->dirty_regions, sizeof (hdr));
+		if (hdr == (uint64_t) -1)
+			goto unlock;
+
+		if (!ranged) {
+			afr_dirty_regions_poison (fd_ctx->dirty_regions);
+			goto unlock;
+		}
+
+		if (hdr && ntoh64 (hdr) != priv->dirty_region_size)
+			memset (fd_ctx->dirty_regions, 0,
+				AFR_DIRTY_REGIONS_SIZE);
+
+		afr_dirty_regions_mark (fd_ctx->dirty_regions,
+					priv->dirty_region_size, offset, len);
+	}
+unlock:
+	UNLOCK (&local->fd->lock);
+}
+
+
+static int
+afr_dirty_regions_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+		       int op_ret, int op_errno, dict_t *xattr, dict_t *xdata)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	int child_index = (long) cookie;
+	char *regions = NULL;
+	int *raw = NULL;
+	int idx = 0;
+	int j = 0;
+	int call_count = -1;
+	uint32_t ours = 0;
+	gf_boolean_t based = _gf_false;
+	gf_boolean_t clean = _gf_false;
+	gf_boolean_t pre_op_done = _gf_false;
+
+	local = frame->local;
+	priv = this->private;
+	idx = afr_index_for_transaction_type (AFR_DATA_TRANSACTION);
+
+	/* unless it goes along with the FOP, the pre-op is on disk */
+	pre_op_done = (local->pre_op_compat ||
+		       local->transaction.regions_resume !=
+		       afr_transaction_perform_fop);
+
+	if (op_ret == -1) {
+		afr_transaction_fop_failed (frame, this, child_index);
+		goto out;
+	}
+
+	if (xattr && !dict_get_ptr (xattr, AFR_DIRTY_REGIONS,
+				    (void **) &regions))
+		based = !!afr_dirty_regions_size (regions);
+
+	/* the pending counts came back untouched along with the bitmap,
+	   anything beyond what this transaction added is from before */
+	clean = _gf_true;
+	for (j = 0; xattr && j < priv->child_count; j++) {
+		if (dict_get_ptr (xattr, priv->pending_key[j], (void **) &raw))
+			continue;
+		ours = pre_op_done ? ntoh32 (local->pending[j][idx]) : 0;
+		if (ntoh32 (raw[idx]) > ours)
+			clean = _gf_false;
+	}
+out:
+	LOCK (&frame->lock);
+	{
+		if (!based)
+			local->transaction.regions_based = _gf_false;
+		if (!clean)
+			local->transaction.regions_clean = _gf_false;
+	}
+	UNLOCK (&frame->lock);
+
+	call_count = afr_frame_return (frame);
+
+	if (call_count == 0)
+		local->transaction.changelog_resume (frame, this);
+
+	return 0;
+}
+
+
+static int
+afr_dirty_regions_wind (call_frame_t *frame, xlator_t *this, dict_t *xattr,
+			afr_changelog_resume_t resume)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	int i = 0;
+	int call_count = 0;
+
+	local = frame->local;
+	priv = this->private;
+
+	call_count = AFR_COUNT (local->transaction.pre_op, priv->child_count);
+	if (call_count == 0) {
+		resume (frame, this);
+		return 0;
+	}
+
+	local->call_count = call_count;
+	local->transaction.changelog_resume = resume;
+
+	for (i = 0; i < priv->child_count; i++) {
+		if (!local->transaction.pre_op[i])
+			continue;
+
+		if (local->fd)
+			STACK_WIND_COOKIE (frame, afr_dirty_regions_cbk,
+					   (void *) (long) i,
+					   priv->children[i],
+					   priv->children[i]->fops->fxattrop,
+					   local->fd, GF_XATTROP_OR_ARRAY,
+					   xattr, NULL);
+		else
+			STACK_WIND_COOKIE (frame, afr_dirty_regions_cbk,
+					   (void *) (long) i,
+					   priv->children[i],
+					   priv->children[i]->fops->xattrop,
+					   &local->loc, GF_XATTROP_OR_ARRAY,
+					   xattr, NULL);
+
+		if (!--call_count)
+			break;
+	}
+
+	return 0;
+}
+
+
+static int
+afr_dirty_regions_failed (call_frame_t *frame, xlator_t *this, int op_errno)
+{
+	afr_local_t *local = NULL;
+
+	local = frame->local;
+
+	local->op_ret = -1;
+	local->op_errno = op_errno;
+
+	if (local->transaction.regions_resume == afr_transaction_perform_fop) {
+		/* the FOP is not performed */
+		afr_save_lk_owner (frame);
+		local->transaction.resume (frame, this);
+	} else {
+		local->transaction.regions_resume (frame, this);
+	}
+
+	return 0;
+}
+
+
+static int
+afr_dirty_regions_based (call_frame_t *frame, xlator_t *this)
+{
+	afr_local_t *local = NULL;
+	off_t offset = 0;
+	off_t len = 0;
+	gf_boolean_t ranged = _gf_false;
+
+	local = frame->local;
+
+	if (afr_txn_nothing_failed (frame, this)) {
+		ranged = !afr_dirty_regions_range (local, &offset, &len);
+		afr_dirty_regions_cache (frame, this,
+					 ranged && local->transaction.regions_clean,
+					 offset, len);
+	}
+
+	return local->transaction.regions_resume (frame, this);
+}
+
+
+/* The range is on every bitmap now. A bitmap without the base flag was
+   just started, or was started while earlier changes were pending: the
+   flag is set in the first case, the bitmap is poisoned in the other. */
+static int
+afr_dirty_regions_recorded (call_frame_t *frame, xlator_t *this)
+{
+	afr_local_t *local = NULL;
+	dict_t *xattr = NULL;
+	char *regions = NULL;
+	uint64_t hdr = 0;
+	off_t offset = 0;
+	off_t len = 0;
+	gf_boolean_t ranged = _gf_false;
+
+	local = frame->local;
+
+	if (local->transaction.regions_based) {
+		if (afr_txn_nothing_failed (frame, this)) {
+			ranged = !afr_dirty_regions_range (local, &offset,
+							   &len);
+			afr_dirty_regions_cache (frame, this, ranged, offset,
+						 len);
+		}
+		return local->transaction.regions_resume (frame, this);
+	}
+
+	regions = GF_CALLOC (1, AFR_DIRTY_REGIONS_SIZE, gf_afr_mt_char);
+	if (!regions)
+		goto err;
+
+	if (local->transaction.regions_clean) {
+		hdr = hton64 (AFR_DIRTY_REGIONS_BASE);
+		memcpy (regions, &hdr, sizeof (hdr));
+	} else {
+		afr_dirty_regions_poison (regions);
+	}
+
+	xattr = dict_new ();
+	if (!xattr)
+		goto err;
+
+	if (dict_set_bin (xattr, AFR_DIRTY_REGIONS, regions,
+			  AFR_DIRTY_REGIONS_SIZE))
+		goto err;
+	regions = NULL;
+
+	afr_dirty_regions_wind (frame, this, xattr, afr_dirty_regions_based);
+
+	dict_unref (xattr);
+
+	return 0;
+err:
+	GF_FREE (regions);
+	if (xattr)
+		dict_unref (xattr);
+
+	return afr_dirty_regions_failed (frame, this, ENOMEM);
+}
+
+
+/* Records the range written by the FOP in the dirty-region bitmap of the
+   bricks taking part in it, asking back for their pending counts in the
+   same xattrop (OR-ing zeroes changes nothing) to learn whether the bitmap
+   can account for all of them. */
+static int
+afr_dirty_regions_record (call_frame_t *frame, xlator_t *this,
+			  afr_changelog_resume_t resume)
+{
+	afr_local_t *local = NULL;
+	afr_private_t *priv = NULL;
+	dict_t *xattr = NULL;
+	char *regions = NULL;
+	int *raw = NULL;
+	off_t offset = 0;
+	off_t len = 0;
+	gf_boolean_t ranged = _gf_false;
+	int i = 0;
+
+	local = frame->local;
+	priv = this->private;
+
+	local->transaction.regions_recorded = _gf_true;
+	local->transaction.regions_resume = resume;
+	local->transaction.regions_based = _gf_true;
+	local->transaction.regions_clean = _gf_true;
+
+	ranged = !afr_dirty_regions_range (local, &offset, &len);
+
+	if (afr_dirty_regions_cached (frame, this, ranged, offset, len))
+		return resume (frame, this);
+
+	xattr = dict_new ();
+	if (!xattr)
+		goto err;
+
+	regions = GF_CALLOC (1, AFR_DIRTY_REGIONS_SIZE, gf_afr_mt_char);
+	if (!regions)
+		goto err;
+
+	if (ranged)
+		afr_dirty_regions_mark (regions, priv->dirty_region_size,
+					offset, len);
+	else
+		afr_dirty_regions_poison (regions);
+
+	if (dict_set_bin (xattr, AFR_DIRTY_REGIONS, regions,
+			  AFR_DIRTY_REGIONS_SIZE))
+		goto err;
+	regions = NULL;
+
+	for (i = 0; i < priv->child_count; i++) {
+		raw = GF_CALLOC (AFR_NUM_CHANGE_LOGS, sizeof (int),
+				 gf_afr_mt_int32_t);
+		if (!raw)
+			goto err;
+		if (dict_set_bin (xattr, priv->pending_key[i], raw,
+				  AFR_NUM_CHANGE_LOGS * sizeof (int))) {
+			GF_FREE (raw);
+			goto err;
+		}
+	}
+
+	afr_dirty_regions_wind (frame, this, xattr,
+				afr_dirty_regions_recorded);
+
+	dict_unref (xattr);
+
+	return 0;
+err:
+	GF_FREE (regions);
+	if (xattr)
+		dict_unref (xattr);
+
+	return afr_dirty_regions_failed (frame, this, ENOMEM);
+}
+
+
+/* post-op-piggyback: the undirtying of the writes on an fd is owed until
+   the pre-op of the next write on it takes it along (see
+   afr_write_xattrop_set), or until the data lock they were done under is
+   about to be released (see afr_changelog_unlock). Nobody else can change
+   the dirty flag while the lock is held, so what is owed never ends up
+   subtracted from a flag self-heal has already reset.
+*/
+
+static int
+afr_undirty_owed_take (xlator_t *this, fd_t *fd)
+{
+	afr_fd_ctx_t *fd_ctx = NULL;
+	int owed = 0;
+
+	fd_ctx = afr_fd_ctx_get (fd, this);
+	if (!fd_ctx)
+		return 0;
+
+	pthread_mutex_lock (&fd_ctx->delay_lock);
+	{
+		owed = fd_ctx->undirty_owed;
+		fd_ctx->undirty_owed = 0;
+	}
+	pthread_mutex_unlock (&fd_ctx->delay_lock);
+
+	return owed;
+}
+
+
+/* Releases the locks of the transaction, sending what is owed on its fd
+   first if the data lock is going away with them. */
+static int
+afr_changelog_unlock (call_frame_t *frame, xlator_t *this)
+{
+	afr_private_t *priv = NULL;
+	afr_local_t *local = NULL;
+	dict_t *xattr = NULL;
+	int *dirty = NULL;
+	int owed = 0;
+	int idx = 0;
+
+	priv = this->private;
+	local = frame->local;
+
+	if (local->transaction.type != AFR_DATA_TRANSACTION || !local->fd ||
+	    !AFR_COUNT (local->transaction.pre_op, priv->child_count))
+		goto unlock;
+
+	if (afr_unlock_piggybacked (frame, this))
+		goto unlock;
+
+	owed = afr_undirty_owed_take (this, local->fd);
+	if (!owed)
+		goto unlock;
+
+	idx = afr_index_for_transaction_type (AFR_DATA_TRANSACTION);
+
+	xattr = dict_new ();
+	if (!xattr)
+		goto err;
+
+	dirty = GF_CALLOC (AFR_NUM_CHANGE_LOGS, sizeof (*dirty),
+			   gf_afr_mt_int32_t);
+	if (!dirty)
+		goto err;
+	dirty[idx] = hton32 (-owed);
+
+	if (dict_set_bin (xattr, AFR_DIRTY, dirty,
+			  sizeof (*dirty) * AFR_NUM_CHANGE_LOGS)) {
+		GF_FREE (dirty);
+		goto err;
+	}
+
+	afr_changelog_do (frame, this, xattr, afr_unlock);
+
+	dict_unref (xattr);
+	return 0;
+err:
+	gf_log (this->name, GF_LOG_WARNING, "%s: could not send deferred "
+		"post-op, the file stays dirty until healed",
+		uuid_utoa (local->fd->inode->gfid));
+	if (xattr)
+		dict_unref (xattr);
+unlock:
+	return afr_unlock (frame, this);
+}
+
+
+static gf_boolean_t
+afr_changelog_post_op_defer (call_frame_t *frame, xlator_t *this)
+{
+	afr_private_t *priv = NULL;
+	afr_local_t *local = NULL;
+	afr_fd_ctx_t *fd_ctx = NULL;
+	int i = 0;
+
+	priv = this->private;
+	local = frame->local;
+
+	if (!priv->post_op_piggyback || priv->pre_op_compat)
+		return _gf_false;
+
+	if (local->op != GF_FOP_WRITE || !local->fd)
+		return _gf_false;
+
+	/* only the dirty flag of a write done everywhere can wait */
+	for (i = 0; i < priv->child_count; i++)
+		if (!local->transaction.pre_op[i] ||
+		    local->transaction.failed_subvols[i])
+			return _gf_false;
+
+	fd_ctx = afr_fd_ctx_get (local->fd, this);
+	if (!fd_ctx)
+		return _gf_false;
+
+	pthread_mutex_lock (&fd_ctx->delay_lock);
+	{
+		fd_ctx->undirty_owed++;
+	}
+	pthread_mutex_unlock (&fd_ctx->delay_lock);
+
+	return _gf_true;
+}
+
+
 int
 afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
 {
@@ -573,8 +1223,15 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
         int            nothing_failed = 1;
 	gf_boolean_t   need_undirty = _gf_false;
 
-        afr_handle_quorum (frame);
         local = frame->local;
+
+	/* the FOP failed on some brick, its range has to be on the bitmap
+	   of the others before they stop being dirty */
+	if (local->op_ret >= 0 && afr_dirty_regions_needed (frame, this))
+		return afr_dirty_regions_record (frame, this,
+						 afr_changelog_post_op_now);
+
+        afr_handle_quorum (frame);
 	idx = afr_index_for_transaction_type (local->transaction.type);
 
         nothing_failed = afr_txn_nothing_failed (frame, this);
@@ -597,6 +1254,11 @@ afr_changelog_post_op_now (call_frame_t *frame, xlator_t *this)
                 goto out;
 	}
 
+	if (nothing_failed && afr_changelog_post_op_defer (frame, this)) {
+		afr_changelog_post_op_done (frame, this);
+		goto out;
+	}
+
 	xattr = dict_new ();
 	if (!xattr) {
 		local->op_ret = -1;
@@ -948,6 +1610,51 @@ afr_changelog_do (call_frame_t *frame, xlator_t *this, dict_t *xattr,
 }
 
 
+/* Put the pre-op in the xdata of the writev, along with the undirtying
+   owed by the previous writes on the fd, if any.
+*/
+static int
+afr_write_xattrop_set (call_frame_t *frame, xlator_t *this, dict_t *xattr)
+{
+	afr_local_t *local = NULL;
+	char *buf = NULL;
+	u_int len = 0;
+	int owed = 0;
+	int idx = 0;
+	int ret = -1;
+
+	local = frame->local;
+	idx = afr_index_for_transaction_type (local->transaction.type);
+
+	if (!local->fd || !local->xdata_req)
+		return -1;
+
+	if (local->transaction.dirtied) {
+		owed = afr_undirty_owed_take (this, local->fd);
+		local->dirty[idx] = hton32 (1 - owed);
+	}
+
+	ret = dict_allocate_and_serialize (xattr, &buf, &len);
+	if (ret)
+		goto out;
+
+	ret = dict_set_bin (local->xdata_req, GLUSTERFS_WRITE_XATTROP, buf,
+			    len);
+	if (ret) {
+		GF_FREE (buf);
+		goto out;
+	}
+
+	local->transaction.write_xattrop = _gf_true;
+out:
+	/* the xattrop of its own carries it then */
+	if (ret)
+		gf_log (this->name, GF_LOG_DEBUG, "%s: pre-op not sent along "
+			"with the write", uuid_utoa (local->fd->inode->gfid));
+	return ret;
+}
+
+
 int
 afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
 {
@@ -1046,8 +1753,15 @@ afr_changelog_pre_op (call_frame_t *frame, xlator_t *this)
 		goto next;
 
 	if (!local->pre_op_compat) {
-		dict_copy (xdata_req, local->xdata_req);
-		goto next;
+		/* Only a write with every brick in the transaction takes
+		   its pre-op along, other FOPs do it the old way
+		*/
+		if (local->op == GF_FOP_WRITE &&
+		    call_count == priv->child_count &&
+		    !afr_write_xattrop_set (frame, this, xdata_req))
+			goto next;
+
+		local->pre_op_compat = _gf_true;
 	}
 
 	afr_changelog_do (frame, this, xdata_req, afr_transaction_perform_fop);
@@ -1068,7 +1782,7 @@ err:
 	local->op_ret = -1;
 	local->op_errno = op_errno;
 
-	afr_unlock (frame, this);
+	afr_changelog_unlock (frame, this);
 
 	if (xdata_req)
 		dict_unref (xdata_req);
@@ -1338,7 +2052,10 @@ afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this)
 gf_boolean_t
 afr_are_multiple_fds_opened (fd_t *fd, xlator_t *this)
 {
-        afr_fd_ctx_t *fd_ctx = NULL;
+        afr_fd_ctx_t  *fd_ctx = NULL;
+        afr_private_t *priv   = NULL;
+
+        priv = this->private;
 
         if (!fd) {
                 /* If false is returned, it may keep on taking eager-lock
@@ -1347,6 +2064,15 @@ afr_are_multiple_fds_opened (fd_t *fd, xlator_t *this)
                 gf_log_callingfn (this->name, GF_LOG_ERROR, "Invalid fd");
                 return _gf_true;
         }
+
+        /* With lock-caching, the bricks tell when anyone else waits on
+         * the eager-lock, which is released then (see
+         * afr_inodelk_contention_notify()), so it can be kept whoever
+         * has the file open.
+         */
+        if (priv->lock_caching)
+                return _gf_false;
+
         /* Lets say mount1 has eager-lock(full-lock) and after the eager-lock
          * is taken mount2 opened the same file, it won't be able to
          * perform any data operations until mount1 releases eager-lock.
@@ -1365,6 +2091,19 @@ afr_are_multiple_fds_opened (fd_t *fd, xlator_t *this)
 }
 
 
+static gf_boolean_t
+afr_fd_lock_contended (fd_t *fd, xlator_t *this)
+{
+        afr_fd_ctx_t *fd_ctx = NULL;
+
+        fd_ctx = afr_fd_ctx_get (fd, this);
+        if (!fd_ctx)
+                return _gf_false;
+
+        return fd_ctx->lock_contended;
+}
+
+
 gf_boolean_t
 is_afr_delayed_changelog_post_op_needed (call_frame_t *frame, xlator_t *this)
 {
@@ -1385,6 +2124,9 @@ is_afr_delayed_changelog_post_op_needed (call_frame_t *frame, xlator_t *this)
         if (local->fd && afr_are_multiple_fds_opened (local->fd, this))
                 goto out;
 
+        if (local->fd && afr_fd_lock_contended (local->fd, this))
+                goto out;
+
         res = _gf_true;
 out:
         return res;
@@ -1685,6 +2427,96 @@ afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd)
 }
 
 
+/* A brick tells that another owner waits on an inodelk this client holds
+   in the transaction domain: release the eager-locks held through the fds
+   of the inode now rather than after the post-op delay, and keep them from
+   being taken again until then.
+*/
+void
+afr_inodelk_contention_notify (xlator_t *this, struct gf_upcall *upcall)
+{
+        struct gf_upcall_inodelk_contention *lc     = NULL;
+        afr_private_t                       *priv   = NULL;
+        afr_fd_ctx_t                        *fd_ctx = NULL;
+        inode_t                             *inode  = NULL;
+        fd_t                                *fd     = NULL;
+        fd_t                               **fds    = NULL;
+        uint64_t                             ctx    = 0;
+        gf_boolean_t                         held   = _gf_false;
+        int                                  count  = 0;
+        int                                  i      = 0;
+        int                                  j      = 0;
+
+        priv = this->private;
+        lc = upcall->data;
+
+        if (!lc || !lc->domain || strcmp (lc->domain, this->name))
+                return;
+
+        if (!this->itable)
+                return;
+
+        inode = inode_find (this->itable, upcall->gfid);
+        if (!inode)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (fd, &inode->fd_list, inode_list)
+                        count++;
+        }
+        UNLOCK (&inode->lock);
+
+        if (!count)
+                goto out;
+
+        fds = GF_CALLOC (count, sizeof (*fds), gf_afr_mt_fd_t);
+        if (!fds)
+                goto out;
+
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (fd, &inode->fd_list, inode_list) {
+                        if (i == count)
+                                break;
+                        fds[i++] = __fd_ref (fd);
+                }
+        }
+        UNLOCK (&inode->lock);
+        count = i;
+
+        gf_log (this->name, GF_LOG_DEBUG, "inodelk contention on %s, "
+                "releasing its eager-locks", uuid_utoa (inode->gfid));
+
+        for (i = 0; i < count; i++) {
+                fd = fds[i];
+                held = _gf_false;
+
+                LOCK (&fd->lock);
+                {
+                        if (__fd_ctx_get (fd, this, &ctx) == 0) {
+                                fd_ctx = (afr_fd_ctx_t *)(long) ctx;
+                                for (j = 0; j < priv->child_count; j++)
+                                        if (fd_ctx->lock_acquired[j])
+                                                held = _gf_true;
+                                if (held)
+                                        fd_ctx->lock_contended = _gf_true;
+                        }
+                }
+                UNLOCK (&fd->lock);
+
+                if (held)
+                        afr_delayed_changelog_wake_up (this, fd);
+
+                fd_unref (fd);
+        }
+
+        GF_FREE (fds);
+out:
+        inode_unref (inode);
+}
+
+
 int
 afr_transaction_resume (call_frame_t *frame, xlator_t *this)
 {
@@ -1780,6 +2612,9 @@ afr_transaction_eager_lock_init (afr_local_t *local, xlator_t *this)
 
         if (afr_are_multiple_fds_opened (local->fd, this))
                 return;
+
+        if (fdctx->lock_contended)
+                return;
         /*
          * Once full file lock is acquired in eager-lock phase, overlapping
          * writes do not compete for inode-locks, instead are transferred to the
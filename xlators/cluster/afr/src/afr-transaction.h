@@ -12,6 +12,7 @@
 #define __TRANSACTION_H__
 
 #include "afr.h"
+#include "upcall-utils.h"
 
 void
 afr_transaction_fop_failed (call_frame_t *frame, xlator_t *this,
@@ -35,6 +36,9 @@ afr_set_delayed_post_op (call_frame_t *frame, xlator_t *this);
 void
 afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd);
 
+void
+afr_inodelk_contention_notify (xlator_t *this, struct gf_upcall *upcall);
+
 void
 __mark_all_success (call_frame_t *frame, xlator_t *this);
 
@@ -59,6 +59,22 @@ mem_acct_init (xlator_t *this)
 }
 
 
+/* regions are powers of 2 and no smaller than a self-heal block */
+static uint64_t
+afr_dirty_region_size_fix (uint64_t size)
+{
+        uint64_t fixed = AFR_DIRTY_REGION_MIN_SIZE;
+
+        if (!size)
+                return 0;
+
+        while (fixed * 2 <= size)
+                fixed *= 2;
+
+        return fixed;
+}
+
+
 int
 xlator_subvolume_index (xlator_t *this, xlator_t *subvol)
 {
@@ -174,8 +190,12 @@ reconfigure (xlator_t *this, dict_t *options)
         }
 
         GF_OPTION_RECONF ("pre-op-compat", priv->pre_op_compat, options, bool, out);
+        GF_OPTION_RECONF ("post-op-piggyback", priv->post_op_piggyback,
+                          options, bool, out);
 
         GF_OPTION_RECONF ("eager-lock", priv->eager_lock, options, bool, out);
+        GF_OPTION_RECONF ("lock-caching", priv->lock_caching, options, bool,
+                          out);
         GF_OPTION_RECONF ("quorum-type", qtype, options, str, out);
         GF_OPTION_RECONF ("quorum-count", priv->quorum_count, options,
                           uint32, out);
@@ -194,12 +214,23 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("ensure-durability", priv->ensure_durability, options,
                           bool, out);
 
+        GF_OPTION_RECONF ("dirty-region-size", priv->dirty_region_size,
+                          options, size_uint64, out);
+        priv->dirty_region_size =
+                afr_dirty_region_size_fix (priv->dirty_region_size);
+
 	GF_OPTION_RECONF ("self-heal-daemon", priv->shd.enabled, options,
 			  bool, out);
 
 	GF_OPTION_RECONF ("iam-self-heal-daemon", priv->shd.iamshd, options,
 			  bool, out);
 
+	GF_OPTION_RECONF ("shd-max-threads", priv->shd.max_threads, options,
+			  uint32, out);
+
+	GF_OPTION_RECONF ("shd-full-crawl-incremental",
+			  priv->shd.full_crawl_incremental, options, bool, out);
+
         priv->did_discovery = _gf_false;
 
         ret = 0;
@@ -331,8 +362,11 @@ init (xlator_t *this)
         GF_OPTION_INIT ("entrylk-trace", priv->entrylk_trace, bool, out);
 
         GF_OPTION_INIT ("pre-op-compat", priv->pre_op_compat, bool, out);
+        GF_OPTION_INIT ("post-op-piggyback", priv->post_op_piggyback, bool,
+                        out);
 
         GF_OPTION_INIT ("eager-lock", priv->eager_lock, bool, out);
+        GF_OPTION_INIT ("lock-caching", priv->lock_caching, bool, out);
         GF_OPTION_INIT ("quorum-type", qtype, str, out);
         GF_OPTION_INIT ("quorum-count", priv->quorum_count, uint32, out);
         GF_OPTION_INIT (AFR_SH_READDIR_SIZE_KEY, priv->sh_readdir_size, size_uint64,
@@ -343,10 +377,20 @@ init (xlator_t *this)
         GF_OPTION_INIT ("ensure-durability", priv->ensure_durability, bool,
                         out);
 
+        GF_OPTION_INIT ("dirty-region-size", priv->dirty_region_size,
+                        size_uint64, out);
+        priv->dirty_region_size =
+                afr_dirty_region_size_fix (priv->dirty_region_size);
+
 	GF_OPTION_INIT ("self-heal-daemon", priv->shd.enabled, bool, out);
 
 	GF_OPTION_INIT ("iam-self-heal-daemon", priv->shd.iamshd, bool, out);
 
+	GF_OPTION_INIT ("shd-max-threads", priv->shd.max_threads, uint32, out);
+
+	GF_OPTION_INIT ("shd-full-crawl-incremental",
+			priv->shd.full_crawl_incremental, bool, out);
+
         priv->wait_count = 1;
 
         priv->child_up = GF_CALLOC (sizeof (unsigned char), child_count,
@@ -363,6 +407,14 @@ init (xlator_t *this)
                                            reliably
                                         */
 
+        priv->read_stats = GF_CALLOC (child_count, sizeof (*priv->read_stats),
+                                      gf_afr_mt_read_stat_t);
+        if (!priv->read_stats) {
+                ret = -ENOMEM;
+                goto out;
+        }
+        priv->read_fast_child = -1;
+
         priv->children = GF_CALLOC (sizeof (xlator_t *), child_count,
                                     gf_afr_mt_xlator_t);
         if (!priv->children) {
@@ -534,7 +586,7 @@ struct volume_options options[] = {
         { .key = {"read-hash-mode" },
           .type = GF_OPTION_TYPE_INT,
           .min = 0,
-          .max = 2,
+          .max = 3,
           .default_value = "1",
           .description = "inode-read fops happen only on one of the bricks in "
                          "replicate. AFR will prefer the one computed using "
@@ -542,7 +594,9 @@ struct volume_options options[] = {
                          "0 = first up server, "
                          "1 = hash by GFID of file (all clients use "
                                                     "same subvolume), "
-                         "2 = hash by GFID of file and client PID",
+                         "2 = hash by GFID of file and client PID, "
+                         "3 = brick with the lowest read latency measured "
+                         "by this client times its reads in flight",
         },
         { .key  = {"choose-local" },
           .type = GF_OPTION_TYPE_BOOL,
@@ -654,6 +708,14 @@ struct volume_options options[] = {
 	  .description = "Use separate pre-op xattrop() FOP rather than "
 	                 "overloading xdata of the OP"
 	},
+        { .key = {"post-op-piggyback"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "When all the bricks are up, let the undirtying "
+                         "post-op of a write ride on the next write on the "
+                         "same fd while the eager-lock is held, or be sent "
+                         "before it is released. Needs pre-op-compat off."
+        },
         { .key = {"eager-lock"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
@@ -679,6 +741,16 @@ struct volume_options options[] = {
                          "the last \"optimized\" transaction."
 
         },
+        { .key = {"lock-caching"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Keep the eager-lock of a file even when it is "
+                         "open more than once, on this client or others. "
+                         "The bricks tell the client when another owner "
+                         "waits on it, and it is released then instead of "
+                         "after post-op-delay-secs. All the bricks must "
+                         "support contention notifications."
+        },
         { .key = {"self-heal-daemon"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
@@ -693,6 +765,26 @@ struct volume_options options[] = {
                          "translator is running as part of self-heal-daemon "
                          "or not."
         },
+        { .key = {"shd-max-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 1,
+          .max = 64,
+          .default_value = "1",
+          .description = "Maximum number of files healed in parallel by the "
+                         "self-heal-daemon on each brick during index heal. "
+                         "The index entries are spread over the healer "
+                         "threads by gfid. Full crawls use as many threads "
+                         "on separate directories."
+        },
+        { .key = {"shd-full-crawl-incremental"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "If enabled, a full crawl does not descend into "
+                         "directories left unchanged, and with no pending "
+                         "entry or metadata heal, since the last completed "
+                         "full crawl of the brick. Changes further down "
+                         "such a directory are left to index heal."
+        },
         { .key = {"quorum-type"},
           .type = GF_OPTION_TYPE_STR,
           .value = { "none", "auto", "fixed"},
@@ -741,6 +833,17 @@ struct volume_options options[] = {
                          "written to the disk",
           .default_value = "on",
         },
+        { .key = {"dirty-region-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min = 0,
+          .max = 1 * GF_UNIT_GB,
+          .default_value = "0",
+          .description = "Size of the regions in which byte ranges written "
+                         "while a brick is down are tracked, so that data "
+                         "self-heal copies only those regions. Rounded "
+                         "down to a power of 2, at least 128KB. 0 disables "
+                         "the tracking.",
+        },
 	{ .key = {"afr-dirty-xattr"},
 	  .type = GF_OPTION_TYPE_STR,
 	  .default_value = AFR_DIRTY_DEFAULT,
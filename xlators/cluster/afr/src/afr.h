@@ -35,10 +35,47 @@
 #define AFR_DIRTY_DEFAULT AFR_XATTR_PREFIX ".dirty"
 #define AFR_DIRTY (((afr_private_t *) (THIS->private))->afr_dirty)
 
+/* Byte ranges written while some brick missed them, kept on the bricks
+   which got the writes. The value is a header holding the region size
+   (network order, a power of 2) followed by one bit per region, the last
+   bit standing for everything beyond. Bitmaps are OR-ed on the brick, so
+   a header which is not a single power of 2 along with the base flag (all
+   ones when poisoned) says the ranges are not known and the whole file has
+   to be healed.
+*/
+#define AFR_DIRTY_REGIONS          AFR_XATTR_PREFIX ".dirty-regions"
+#define AFR_DIRTY_REGIONS_SIZE     1024
+#define AFR_DIRTY_REGIONS_HDR_SIZE sizeof (uint64_t)
+#define AFR_DIRTY_REGIONS_BITS     ((AFR_DIRTY_REGIONS_SIZE -             \
+                                     AFR_DIRTY_REGIONS_HDR_SIZE) * 8)
+#define AFR_DIRTY_REGION_MIN_SIZE  (128 * 1024)
+
+/* set in the header of a bitmap started while the file had no data
+   pending, only such bitmaps account for all the pending changes */
+#define AFR_DIRTY_REGIONS_BASE     (1ULL << 63)
+
 #define AFR_LOCKEE_COUNT_MAX    3
 #define AFR_DOM_COUNT_MAX    3
 #define AFR_NUM_CHANGE_LOGS            3 /*data + metadata + entry*/
 
+/* read-hash-mode 3: reads go to the readable subvolume with the lowest
+   read latency (EWMA) times reads in flight. The last choice is kept
+   until another one scores better by AFR_READ_HYSTERESIS percent, and
+   the latency of a subvolume not read from halves every
+   AFR_READ_LATENCY_AGE seconds, so that it gets tried again. A latency
+   not known (or aged out) counts as 1 usec: the reads in flight still
+   tell such subvolumes apart, and break ties.
+*/
+#define AFR_READ_HASH_MODE_LATENCY 3
+#define AFR_READ_HYSTERESIS        25
+#define AFR_READ_LATENCY_AGE       10
+
+typedef struct {
+        int64_t   latency;      /* EWMA of read latency, usec */
+        time_t    sampled;      /* when it was last updated */
+        int32_t   outstanding;  /* reads in flight */
+} afr_read_stat_t;
+
 typedef int (*afr_lock_cbk_t) (call_frame_t *frame, xlator_t *this);
 
 typedef int (*afr_read_txn_wind_t) (call_frame_t *frame, xlator_t *this, int subvol);
@@ -81,6 +118,8 @@ typedef struct _afr_private {
 	gf_boolean_t metadata_splitbrain_forced_heal; /* on/off */
         int read_child;               /* read-subvolume */
         unsigned int hash_mode;       /* for when read_child is not set */
+        afr_read_stat_t *read_stats;  /* per child, under @lock */
+        int read_fast_child;          /* last choice of read-hash-mode 3 */
         int favorite_child;  /* subvolume to be preferred in resolving
                                          split-brain cases */
 
@@ -94,7 +133,9 @@ typedef struct _afr_private {
 
         gf_boolean_t      optimistic_change_log;
         gf_boolean_t      eager_lock;
+        gf_boolean_t      lock_caching;
         gf_boolean_t      pre_op_compat;      /* on/off */
+        gf_boolean_t      post_op_piggyback;
 	uint32_t          post_op_delay_secs;
         unsigned int      quorum_count;
 
@@ -116,6 +157,7 @@ typedef struct _afr_private {
         gf_boolean_t           did_discovery;
         uint64_t               sh_readdir_size;
         gf_boolean_t           ensure_durability;
+        uint64_t               dirty_region_size; /* 0 when not tracked */
         char                   *sh_domain;
 	char                   *afr_dirty;
 
@@ -286,9 +328,28 @@ typedef struct {
 	*/
         uint32_t        open_fd_count;
 
+	/* @lock_contended:
+	   set when a brick tells (lock-caching) that another owner waits on
+	   the eager-lock held through this fd: no new transaction takes or
+	   piggybacks on it until it is released.
+	*/
+	gf_boolean_t    lock_contended;
+
+	/* @undirty_owed: number of post-ops of writes on this fd whose
+	   undirtying was left to ride on the pre-op of the next write
+	   (post-op-piggyback), or to be sent before the data lock is
+	   released. Under @delay_lock.
+	*/
+	int             undirty_owed;
 
 	/* list of frames currently in progress */
 	struct list_head  eager_locked;
+
+	/* @dirty_regions: regions known to be recorded on the bricks since
+	   the last transaction which did not inherit the pre-op, so that
+	   writes under the same lock need not record them again.
+	*/
+	char             *dirty_regions;
 } afr_fd_ctx_t;
 
 
@@ -344,6 +405,18 @@ typedef struct _afr_local {
 
 	afr_read_txn_wind_t readfn;
 
+	/* @read_stat_on:
+	   @read_stat_subvol:
+	   @read_stat_start:
+
+	   the read in flight is accounted in priv->read_stats[] until its
+	   reply, which AFR_STACK_UNWIND() takes before passing it up
+	   (read-hash-mode 3).
+	*/
+	gf_boolean_t read_stat_on;
+	int read_stat_subvol;
+	struct timeval read_stat_start;
+
 	/* @refreshed:
 
 	   the inode was "refreshed" (i.e, pending xattrs from all subvols
@@ -672,6 +745,25 @@ typedef struct _afr_local {
 		gf_boolean_t uninherit_done;
 		gf_boolean_t uninherit_value;
 
+		/* @write_xattrop: the pre-op is sent along with the writev
+		   (GLUSTERFS_WRITE_XATTROP) instead of as an xattrop of its
+		   own.
+		*/
+		gf_boolean_t write_xattrop;
+
+		/* @regions_recorded: the range written by the FOP has been
+		   recorded in the dirty-region bitmap (or need not be).
+		   @regions_based and @regions_clean gather the replies of the
+		   recording: whether every bitmap was started while the file
+		   had no data pending, and whether no pending count other than
+		   the ones of this transaction was found.
+		   @regions_resume: where to go once recorded
+		*/
+		gf_boolean_t regions_recorded;
+		gf_boolean_t regions_based;
+		gf_boolean_t regions_clean;
+		afr_changelog_resume_t regions_resume;
+
 		/* @changelog_resume: function to be called after changlogging
 		   (either pre-op or post-op) is done
 		*/
@@ -742,6 +834,9 @@ int
 afr_read_subvol_select_by_policy (inode_t *inode, xlator_t *this,
 				  unsigned char *readable);
 
+void
+afr_read_stat_end (afr_local_t *local, xlator_t *this);
+
 int
 afr_inode_read_subvol_type_get (inode_t *inode, xlator_t *this,
 				unsigned char *readable, int *event_p,
@@ -817,6 +912,9 @@ afr_build_parent_loc (loc_t *parent, loc_t *child, int32_t *op_errno);
 int
 afr_locked_nodes_count (unsigned char *locked_nodes, int child_count);
 
+gf_boolean_t
+afr_unlock_piggybacked (call_frame_t *frame, xlator_t *this);
+
 int
 afr_replies_interpret (call_frame_t *frame, xlator_t *this, inode_t *inode);
 
@@ -848,6 +946,8 @@ afr_cleanup_fd_ctx (xlator_t *this, fd_t *fd);
                         __this = frame->this;                   \
                         frame->local = NULL;                    \
                 }                                               \
+                if (__local)                                    \
+                        afr_read_stat_end (__local, __this);    \
                 STACK_UNWIND_STRICT (fop, frame, params);       \
                 if (__local) {                                  \
                         afr_local_cleanup (__local, __this);    \
@@ -968,4 +1068,18 @@ afr_remove_eager_lock_stub (afr_local_t *local);
 void
 afr_replies_wipe (struct afr_reply *replies, int count);
 
+void
+afr_dirty_regions_mark (char *regions, uint64_t region_size, off_t offset,
+                        off_t len);
+
+gf_boolean_t
+afr_dirty_regions_test (char *regions, uint64_t region_size, off_t offset,
+                        off_t len);
+
+void
+afr_dirty_regions_poison (char *regions);
+
+uint64_t
+afr_dirty_regions_size (char *regions);
+
 #endif /* __AFR_H__ */
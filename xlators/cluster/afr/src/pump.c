@@ -2277,6 +2277,16 @@ init (xlator_t *this)
 		goto out;
 	}
 
+	priv->read_stats = GF_CALLOC (child_count, sizeof (*priv->read_stats),
+				      gf_afr_mt_read_stat_t);
+	if (!priv->read_stats) {
+		gf_log (this->name, GF_LOG_ERROR,
+			"Out of memory.");
+		op_errno = ENOMEM;
+		goto out;
+	}
+	priv->read_fast_child = -1;
+
 	priv->children = GF_CALLOC (sizeof (xlator_t *), child_count,
                                  gf_afr_mt_xlator_t);
 	if (!priv->children) {
@@ -2388,6 +2398,7 @@ out:
         if (priv) {
                 GF_FREE (priv->child_up);
                 GF_FREE (priv->children);
+                GF_FREE (priv->read_stats);
                 GF_FREE (priv->pending_key);
                 GF_FREE (priv->last_event);
                 LOCK_DESTROY (&priv->lock);
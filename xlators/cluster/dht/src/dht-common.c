@@ -23,6 +23,7 @@
 #include "defaults.h"
 #include "byte-order.h"
 #include "glusterfs-acl.h"
+#include "compound-fop-utils.h"
 
 #include <sys/time.h>
 #include <libgen.h>
@@ -6086,3 +6087,104 @@ dht_log_new_layout_for_dir_selfheal (xlator_t *this, loc_t *loc,
 err:
         GF_FREE (output_string);
 }
+
+
+int32_t
+dht_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, compound_args_t *args,
+                  dict_t *xdata)
+{
+        compound_fop_t *cfop     = NULL;
+        gf_boolean_t    migrated = _gf_false;
+        int             i        = 0;
+
+        for (i = 0; args && i < args->count; i++) {
+                cfop = &args->fops[i];
+
+                if (cfop->rsp.op_ret < 0) {
+                        if (dht_inode_missing (cfop->rsp.op_errno))
+                                migrated = _gf_true;
+                        continue;
+                }
+
+                if (cfop->fop != GF_FOP_READ && cfop->fop != GF_FOP_FSTAT)
+                        continue;
+
+                if (IS_DHT_MIGRATION_PHASE2 (&cfop->rsp.stat))
+                        migrated = _gf_true;
+                else
+                        DHT_STRIP_PHASE1_FLAGS (&cfop->rsp.stat);
+        }
+
+        /* The file moved (or is moving) off the subvolume the compound
+           went to: what it read there may be stale. Fail it as a whole,
+           the caller then runs the fops one by one, each of them going
+           through the rebalance checks. */
+        if (migrated) {
+                gf_msg_debug (this->name, 0, "file under migration, "
+                              "failing compound of %d fops", args->count);
+                compound_args_fail (args, 0, EAGAIN);
+                op_ret = -1;
+                op_errno = EAGAIN;
+        }
+
+        DHT_STACK_UNWIND (compound, frame, op_ret, op_errno, args, xdata);
+        return 0;
+}
+
+
+/* A compound whose fops all work on files already looked up, and held by
+   one subvolume, is sent to it as a whole. Anything else (a lookup or
+   create, which need the layout of the parent, files on different
+   subvolumes, writes and xattrops, or files known to be under migration)
+   is run fop by fop, where every fop gets the usual rebalance checks. */
+int32_t
+dht_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+              dict_t *xdata)
+{
+        xlator_t       *subvol   = NULL;
+        xlator_t       *cached   = NULL;
+        xlator_t       *dst      = NULL;
+        compound_fop_t *cfop     = NULL;
+        inode_t        *inode    = NULL;
+        int             i        = 0;
+
+        for (i = 0; args && i < args->count; i++) {
+                cfop = &args->fops[i];
+
+                switch (cfop->fop) {
+                case GF_FOP_LOOKUP:
+                case GF_FOP_CREATE:
+                case GF_FOP_WRITE:
+                case GF_FOP_FXATTROP:
+                        goto serial;
+                default:
+                        break;
+                }
+
+                inode = cfop->fd ? cfop->fd->inode : cfop->loc.inode;
+                if (!inode)
+                        goto serial;
+
+                dst = NULL;
+                dht_inode_ctx_get1 (this, inode, &dst);
+                if (dst)
+                        goto serial;
+
+                cached = dht_subvol_get_cached (this, inode);
+                if (!cached || (subvol && cached != subvol))
+                        goto serial;
+
+                subvol = cached;
+        }
+
+        if (!subvol)
+                goto serial;
+
+        STACK_WIND (frame, dht_compound_cbk, subvol, subvol->fops->compound,
+                    args, xdata);
+        return 0;
+
+serial:
+        return compound_fop_serial (frame, this, args, xdata);
+}
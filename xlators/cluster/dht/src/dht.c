@@ -73,6 +73,7 @@ struct xlator_fops fops = {
 	.fallocate   = dht_fallocate,
 	.discard     = dht_discard,
         .zerofill    = dht_zerofill,
+        .compound    = dht_compound,
 };
 
 struct xlator_dumpops dumpops = {
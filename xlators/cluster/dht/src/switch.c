@@ -898,6 +898,7 @@ struct xlator_fops fops = {
         .xattrop     = dht_xattrop,
         .fxattrop    = dht_fxattrop,
         .setattr     = dht_setattr,
+        .compound    = dht_compound,
 };
 
 
@@ -1355,6 +1355,9 @@ io_stats_readv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         if (op_ret > 0) {
                 len = iov_length (vector, count);
+                /* zero-copy replies carry the data as a file segment */
+                if (!len && iobref && iobref->fdseg)
+                        len = iobref->fdseg->len;
                 BUMP_READ (fd, len);
         }
 
@@ -1784,6 +1787,16 @@ io_stats_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int
+io_stats_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno,
+                       compound_args_t *args, dict_t *xdata)
+{
+        UPDATE_PROFILE_STATS (frame, COMPOUND);
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args, xdata);
+        return 0;
+}
+
 int
 io_stats_lk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, struct gf_flock *lock, dict_t *xdata)
@@ -2491,6 +2504,20 @@ io_stats_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 }
 
 
+int
+io_stats_compound (call_frame_t *frame, xlator_t *this,
+                   compound_args_t *args, dict_t *xdata)
+{
+        START_FOP_LATENCY (frame);
+
+        STACK_WIND (frame, io_stats_compound_cbk,
+                    FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound,
+                    args, xdata);
+        return 0;
+}
+
+
 int
 io_stats_lk (call_frame_t *frame, xlator_t *this,
              fd_t *fd, int32_t cmd, struct gf_flock *lock, dict_t *xdata)
@@ -3036,6 +3063,7 @@ struct xlator_fops fops = {
 	.fallocate   = io_stats_fallocate,
 	.discard     = io_stats_discard,
         .zerofill    = io_stats_zerofill,
+        .compound    = io_stats_compound,
 };
 
 struct xlator_cbks cbks = {
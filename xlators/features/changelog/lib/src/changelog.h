@@ -28,4 +28,50 @@ gf_changelog_next_change (char *bufptr, size_t maxlen);
 int
 gf_changelog_done (char *file);
 
+/* indexed changelogs (encoding "indexed") mapped in memory */
+
+typedef struct gf_changelog_record {
+        /* 'D', 'M' or 'E' */
+        char                 type;
+        unsigned char        gfid[16];
+
+        /* rest of the binary record (fop, entry details) */
+        const char          *data;
+        size_t               len;
+} gf_changelog_record_t;
+
+typedef struct gf_changelog_map gf_changelog_map_t;
+
+gf_changelog_map_t *
+gf_changelog_map (char *path);
+
+ssize_t
+gf_changelog_map_count (gf_changelog_map_t *map);
+
+int
+gf_changelog_map_record (gf_changelog_map_t *map, size_t index,
+                         gf_changelog_record_t *record);
+
+void
+gf_changelog_unmap (gf_changelog_map_t *map);
+
+/**
+ * streaming: records as they are journalled on the brick (needs the
+ * "streaming" option of the changelog translator), delivered in batches
+ * to @cbk from the library's processing thread. A batch is acknowledged
+ * when @cbk returns; at most @window batches are in flight. Changelogs
+ * whose records have been streamed are not published in the scratch dir.
+ *
+ * @cbk gets no records (@nr zero) when the brick dropped records for a
+ * slow consumer: those are then in the changelogs published in the
+ * scratch dir (gf_changelog_scan ()) until streaming resumes. Records
+ * around the switch may be seen twice.
+ */
+typedef void (*gf_changelog_stream_cbk_t) (gf_changelog_record_t *records,
+                                           size_t nr, void *data);
+
+int
+gf_changelog_stream (gf_changelog_stream_cbk_t cbk, void *data,
+                     unsigned int window);
+
 #endif
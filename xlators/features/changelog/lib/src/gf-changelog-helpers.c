@@ -16,6 +16,23 @@ ssize_t gf_changelog_read_path (int fd, char *buffer, size_t bufsize)
         return read (fd, buffer, bufsize);
 }
 
+int
+gf_changelog_read_full (int fd, char *buffer, size_t len)
+{
+        ssize_t size = 0;
+        size_t  done = 0;
+
+        while (done < len) {
+                size = read (fd, buffer + done, len - done);
+                if (size <= 0)
+                        return -1;
+
+                done += size;
+        }
+
+        return 0;
+}
+
 size_t
 gf_changelog_write (int fd, char *buffer, size_t len)
 {
@@ -18,6 +18,8 @@
 
 #include <xlator.h>
 
+#include "changelog.h"
+
 #define GF_CHANGELOG_TRACKER  "tracker"
 
 #define GF_CHANGELOG_CURRENT_DIR    ".current"
@@ -76,8 +78,28 @@ typedef struct gf_changelog {
 
         /* holds 0 done scanning, 1 keep scanning and -1 error */
         int hist_done;
+
+        /* streaming consumer */
+        gf_changelog_stream_cbk_t gfc_stream_cbk;
+        void                     *gfc_stream_data;
+        unsigned int              gfc_stream_window;
+
+        /* records are streamed, changelogs are not consumed */
+        gf_boolean_t              gfc_streaming;
 } gf_changelog_t;
 
+/* an indexed changelog mapped in memory */
+struct gf_changelog_map {
+        int       fd;
+        char     *base;
+        size_t    size;
+
+        /* record index, from the trailer or built by walking the records */
+        char     *index;
+        uint64_t *walked;
+        uint32_t  nr;
+};
+
 typedef struct gf_changelog_history_data {
         int           len;
 
@@ -121,6 +143,12 @@ gf_changelog_process (void *data);
 ssize_t
 gf_changelog_read_path (int fd, char *buffer, size_t bufsize);
 
+int
+gf_changelog_read_full (int fd, char *buffer, size_t len);
+
+int
+gf_changelog_stream_subscribe (gf_changelog_t *gfc);
+
 void
 gf_rfc3986_encode (unsigned char *s, char *enc, char *estr);
 
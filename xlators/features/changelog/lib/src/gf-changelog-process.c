@@ -16,9 +16,11 @@
 #include "glusterfs.h"
 
 #include "gf-changelog-helpers.h"
+#include "changelog.h"
 
 /* from the changelog translator */
 #include "changelog-misc.h"
+#include "changelog-mem-types.h"
 
 extern int byebye;
 
@@ -387,6 +389,406 @@ gf_changelog_parse_ascii (xlator_t *this,
         return ret;
 }
 
+/**
+ * indexed changelogs: records are length prefixed and (once rolled over)
+ * followed by an index of their offsets, so a mapped changelog can be
+ * iterated, or accessed at random, without parsing it.
+ */
+
+#define GF_CHANGELOG_MAX_HEADER 1024
+
+static int
+gf_changelog_map_header (gf_changelog_map_t *map, size_t *start)
+{
+        int   maj                                 = 0;
+        int   min                                 = 0;
+        int   encoding                            = -1;
+        char *eol                                 = NULL;
+        char  header[GF_CHANGELOG_MAX_HEADER + 1] = {0,};
+
+        eol = memchr (map->base, '\n', (map->size < GF_CHANGELOG_MAX_HEADER)
+                      ? map->size : GF_CHANGELOG_MAX_HEADER);
+        if (!eol)
+                return -1;
+
+        *start = eol - map->base + 1;
+
+        memcpy (header, map->base, *start);
+        if (sscanf (header, CHANGELOG_HEADER, &maj, &min, &encoding) != 3)
+                return -1;
+
+        return (encoding == CHANGELOG_ENCODE_INDEXED) ? 0 : -1;
+}
+
+static int
+gf_changelog_map_trailer (gf_changelog_map_t *map, size_t start)
+{
+        uint64_t                        index_offset = 0;
+        uint32_t                        nr           = 0;
+        struct changelog_index_trailer  trailer      = {{0,},};
+
+        if (map->size < start + sizeof (trailer))
+                return -1;
+
+        memcpy (&trailer, map->base + map->size - sizeof (trailer),
+                sizeof (trailer));
+        if (memcmp (trailer.magic,
+                    CHANGELOG_INDEX_MAGIC, CHANGELOG_INDEX_MAGIC_LEN))
+                return -1;
+
+        index_offset = ntoh64 (trailer.index_offset);
+        nr = ntoh32 (trailer.nr_records);
+
+        if ((index_offset < start)
+            || (index_offset + (uint64_t) nr * sizeof (uint64_t)
+                + sizeof (trailer) != map->size))
+                return -1;
+
+        map->index = map->base + index_offset;
+        map->nr = nr;
+
+        return 0;
+}
+
+/* no trailer: the brick went down before rolling over this changelog */
+static int
+gf_changelog_map_walk (gf_changelog_map_t *map, size_t start)
+{
+        size_t    off     = start;
+        uint32_t  len     = 0;
+        uint32_t  size    = 0;
+        uint64_t *walked  = NULL;
+
+        while (off + sizeof (len) <= map->size) {
+                memcpy (&len, map->base + off, sizeof (len));
+                len = ntoh32 (len);
+                if (off + sizeof (len) + len > map->size)
+                        break; /* torn record at the end */
+
+                if (map->nr == size) {
+                        size = (size) ? size * 2 : 1024;
+                        walked = realloc (map->walked,
+                                          size * sizeof (uint64_t));
+                        if (!walked)
+                                return -1;
+                        map->walked = walked;
+                }
+
+                map->walked[map->nr++] = off;
+                off += sizeof (len) + len;
+        }
+
+        return 0;
+}
+
+static gf_changelog_map_t *
+gf_changelog_map_fd (int fd, size_t size)
+{
+        size_t              start = 0;
+        gf_changelog_map_t *map   = NULL;
+
+        map = calloc (1, sizeof (*map));
+        if (!map)
+                goto err;
+
+        map->fd = -1;
+        map->size = size;
+        map->base = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map->base == MAP_FAILED) {
+                map->base = NULL;
+                goto err;
+        }
+
+        (void) madvise (map->base, size, MADV_SEQUENTIAL);
+
+        if (gf_changelog_map_header (map, &start)) {
+                errno = EINVAL;
+                goto err;
+        }
+
+        if (gf_changelog_map_trailer (map, start)
+            && gf_changelog_map_walk (map, start))
+                goto err;
+
+        return map;
+
+ err:
+        gf_changelog_unmap (map);
+        return NULL;
+}
+
+/**
+ * @API
+ *  gf_changelog_map:
+ *     Map an indexed changelog in memory.
+ *
+ *  RETURN VALUES:
+ *     map : On success.
+ *     NULL: On error (errno set), EINVAL if it is not an indexed changelog.
+ */
+gf_changelog_map_t *
+gf_changelog_map (char *path)
+{
+        int                 fd    = -1;
+        struct stat         stbuf = {0,};
+        gf_changelog_map_t *map   = NULL;
+
+        fd = open (path, O_RDONLY);
+        if (fd < 0)
+                goto out;
+
+        if (fstat (fd, &stbuf))
+                goto out;
+
+        if (!S_ISREG (stbuf.st_mode) || (stbuf.st_size == 0)) {
+                errno = EINVAL;
+                goto out;
+        }
+
+        map = gf_changelog_map_fd (fd, stbuf.st_size);
+        if (map) {
+                map->fd = fd;
+                fd = -1;
+        }
+
+ out:
+        if (fd != -1)
+                close (fd);
+        return map;
+}
+
+ssize_t
+gf_changelog_map_count (gf_changelog_map_t *map)
+{
+        if (!map) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        return map->nr;
+}
+
+/**
+ * fill @record from the length prefixed record at @off of @base. Returns
+ * the size of the record with its prefix, -1 if it does not fit.
+ */
+static ssize_t
+gf_changelog_fill_record (char *base, size_t size, uint64_t off,
+                          gf_changelog_record_t *record)
+{
+        uint32_t  len = 0;
+        char     *rec = NULL;
+
+        if (off + sizeof (len) > size)
+                return -1;
+
+        memcpy (&len, base + off, sizeof (len));
+        len = ntoh32 (len);
+
+        if ((len < 1 + sizeof (uuid_t))
+            || (off + sizeof (len) + len > size))
+                return -1;
+
+        rec = base + off + sizeof (len);
+
+        record->type = rec[0];
+        memcpy (record->gfid, rec + 1, sizeof (uuid_t));
+        record->data = rec + 1 + sizeof (uuid_t);
+        record->len = len - 1 - sizeof (uuid_t);
+
+        return sizeof (len) + len;
+}
+
+int
+gf_changelog_map_record (gf_changelog_map_t *map, size_t index,
+                         gf_changelog_record_t *record)
+{
+        uint64_t  off = 0;
+
+        if (!map || !record || (index >= map->nr))
+                goto err;
+
+        if (map->index) {
+                memcpy (&off, map->index + index * sizeof (uint64_t),
+                        sizeof (off));
+                off = ntoh64 (off);
+        } else {
+                off = map->walked[index];
+        }
+
+        if (gf_changelog_fill_record (map->base, map->size, off, record) < 0)
+                goto err;
+
+        return 0;
+
+ err:
+        errno = EINVAL;
+        return -1;
+}
+
+void
+gf_changelog_unmap (gf_changelog_map_t *map)
+{
+        if (!map)
+                return;
+
+        if (map->base)
+                (void) munmap (map->base, map->size);
+        if (map->fd != -1)
+                close (map->fd);
+
+        free (map->walked);
+        free (map);
+}
+
+/**
+ * indexed decoder: renders the records in the same format as the ascii
+ * decoder, straight from the index.
+ */
+static int
+gf_changelog_record_to_ascii (gf_changelog_t *gfc,
+                              gf_changelog_record_t *rec, char *ascii,
+                              off_t *offp)
+{
+        int          ng                      = 0;
+        off_t        off                     = 0;
+        uint32_t     fop                     = 0;
+        uint32_t     nr                      = 0;
+        size_t       left                    = 0;
+        size_t       blen                    = 0;
+        const char  *p                       = NULL;
+        const char  *bend                    = NULL;
+        const char  *fopname                 = NULL;
+        uuid_t       uuid                    = {0,};
+        char         nbuf[20]                = {0,};
+        char         entry[UUID_CANONICAL_FORM_LEN + NAME_MAX + 2] = {0,};
+        char         enc[3 * (UUID_CANONICAL_FORM_LEN + NAME_MAX + 2)] = {0,};
+
+        GF_CHANGELOG_FILL_BUFFER (&rec->type, ascii, off, 1);
+        GF_CHANGELOG_FILL_BUFFER (" ", ascii, off, 1);
+
+        uuid_copy (uuid, rec->gfid);
+        p = uuid_utoa (uuid);
+        GF_CHANGELOG_FILL_BUFFER (p, ascii, off, strlen (p));
+
+        p = rec->data;
+        left = rec->len;
+
+        switch (rec->type) {
+        case 'D':
+                break;
+
+        case 'M':
+        case 'E':
+                if ((left < 1 + sizeof (fop)) || (*p != '\0'))
+                        return -1;
+                memcpy (&fop, p + 1, sizeof (fop));
+                MOVER_MOVE (p, left, 1 + sizeof (fop));
+
+                if ((fop >= GF_FOP_MAXVALUE)
+                    || ((fopname = gf_fop_list[fop]) == NULL))
+                        return -1;
+
+                GF_CHANGELOG_FILL_BUFFER (" ", ascii, off, 1);
+                GF_CHANGELOG_FILL_BUFFER (fopname, ascii, off,
+                                          strlen (fopname));
+
+                if (rec->type == 'M')
+                        break;
+
+                if (fop >= (sizeof (nr_gfids) / sizeof (nr_gfids[0])))
+                        return -1;
+
+                for (ng = nr_extra_recs[fop]; ng > 0; ng--) {
+                        if ((left < 1 + sizeof (nr)) || (*p != '\0'))
+                                return -1;
+                        memcpy (&nr, p + 1, sizeof (nr));
+                        MOVER_MOVE (p, left, 1 + sizeof (nr));
+
+                        (void) snprintf (nbuf, sizeof (nbuf), " %u", nr);
+                        GF_CHANGELOG_FILL_BUFFER (nbuf, ascii, off,
+                                                  strlen (nbuf));
+                }
+
+                /* pargfid + bname */
+                for (ng = nr_gfids[fop]; ng > 0; ng--) {
+                        if ((left < 2 + sizeof (uuid_t)) || (*p != '\0'))
+                                return -1;
+                        memcpy (uuid, p + 1, sizeof (uuid_t));
+                        MOVER_MOVE (p, left, 1 + sizeof (uuid_t));
+
+                        bend = memchr (p, '\0', left);
+                        blen = (bend) ? (bend - p) : left;
+                        if (blen > NAME_MAX + 1)
+                                return -1;
+
+                        (void) snprintf (entry, sizeof (entry), "%s%.*s",
+                                         uuid_utoa (uuid), (int) blen, p);
+                        MOVER_MOVE (p, left, blen);
+
+                        gf_rfc3986_encode ((unsigned char *) entry,
+                                           enc, gfc->rfc3986);
+                        GF_CHANGELOG_FILL_BUFFER (" ", ascii, off, 1);
+                        GF_CHANGELOG_FILL_BUFFER (enc, ascii, off,
+                                                  strlen (enc));
+                }
+
+                break;
+
+        default:
+                return -1;
+        }
+
+        GF_CHANGELOG_FILL_BUFFER ("\n", ascii, off, 1);
+
+        *offp = off;
+        return 0;
+}
+
+static int
+gf_changelog_parse_indexed (xlator_t *this,
+                            gf_changelog_t *gfc, int from_fd, int to_fd,
+                            size_t start_offset, struct stat *stbuf)
+{
+        int                    ret              = -1;
+        off_t                  off              = 0;
+        size_t                 i                = 0;
+        gf_changelog_map_t    *map              = NULL;
+        gf_changelog_record_t  rec              = {0,};
+        char                   ascii[LINE_BUFSIZE] = {0,};
+
+        map = gf_changelog_map_fd (from_fd, stbuf->st_size);
+        if (!map) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "could not map indexed changelog (reason: %s)",
+                        strerror (errno));
+                goto out;
+        }
+
+        for (i = 0; i < map->nr; i++) {
+                if (gf_changelog_map_record (map, i, &rec)
+                    || gf_changelog_record_to_ascii (gfc, &rec, ascii, &off)) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "bad record %zu in indexed changelog", i);
+                        goto out;
+                }
+
+                if (gf_changelog_write (to_fd, ascii, off) != off) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "processing indexed changelog failed due to "
+                                " error in writing change (reason: %s)",
+                                strerror (errno));
+                        goto out;
+                }
+        }
+
+        ret = 0;
+
+ out:
+        gf_changelog_unmap (map);
+        return ret;
+}
+
 #define COPY_BUFSIZE  8192
 static int
 gf_changelog_copy (xlator_t *this, int from_fd, int to_fd)
@@ -451,6 +853,10 @@ gf_changelog_decode (xlator_t *this, gf_changelog_t *gfc, int from_fd,
                 ret = gf_changelog_parse_ascii (this, gfc, from_fd,
                                                 to_fd, elen, stbuf);
                 break;
+        case CHANGELOG_ENCODE_INDEXED:
+                ret = gf_changelog_parse_indexed (this, gfc, from_fd,
+                                                  to_fd, elen, stbuf);
+                break;
         default:
                 ret = gf_changelog_copy (this, from_fd, to_fd);
         }
@@ -570,6 +976,101 @@ gf_changelog_consume (xlator_t *this,
         return ret;
 }
 
+/**
+ * a streaming frame: @buf holds the first @avail bytes of it (and maybe
+ * more), the rest is read off the socket. Returns the bytes of @buf used.
+ */
+static ssize_t
+gf_changelog_stream_frame (xlator_t *this,
+                           gf_changelog_t *gfc, char *buf, size_t avail)
+{
+        size_t                       i       = 0;
+        size_t                       used    = 0;
+        size_t                       copy    = 0;
+        ssize_t                      rlen    = 0;
+        uint64_t                     off     = 0;
+        uint32_t                     nr      = 0;
+        uint32_t                     len     = 0;
+        char                        *payload = NULL;
+        gf_changelog_record_t       *records = NULL;
+        struct changelog_stream_hdr  hdr     = {0,};
+        struct changelog_stream_req  ack     = {0,};
+
+        used = min (avail, sizeof (hdr));
+        memcpy (&hdr, buf, used);
+        if (gf_changelog_read_full (gfc->gfc_sockfd,
+                                    (char *) &hdr + used, sizeof (hdr) - used))
+                return -1;
+
+        switch (hdr.type) {
+        case CHANGELOG_STREAM_OVERRUN:
+                gf_log (this->name, GF_LOG_WARNING, "streamed records were"
+                        " dropped, consuming changelogs until resumed");
+                gfc->gfc_streaming = _gf_false;
+                if (gfc->gfc_stream_cbk)
+                        gfc->gfc_stream_cbk (NULL, 0, gfc->gfc_stream_data);
+                return used;
+
+        case CHANGELOG_STREAM_RESUME:
+                gf_log (this->name, GF_LOG_INFO, "streaming records");
+                gfc->gfc_streaming = _gf_true;
+                return used;
+
+        case CHANGELOG_STREAM_BATCH:
+                break;
+
+        default:
+                gf_log (this->name, GF_LOG_ERROR,
+                        "unknown stream frame type %d", hdr.type);
+                return -1;
+        }
+
+        nr = ntoh32 (hdr.nr);
+        len = ntoh32 (hdr.len);
+
+        payload = GF_CALLOC (1, len + 1, gf_changelog_mt_stream_buf_t);
+        records = GF_CALLOC (nr ? nr : 1, sizeof (*records),
+                             gf_changelog_mt_stream_buf_t);
+        if (!payload || !records)
+                goto err;
+
+        copy = min (avail - used, len);
+        memcpy (payload, buf + used, copy);
+        used += copy;
+        if (gf_changelog_read_full (gfc->gfc_sockfd,
+                                    payload + copy, len - copy))
+                goto err;
+
+        for (i = 0; i < nr; i++) {
+                rlen = gf_changelog_fill_record (payload, len,
+                                                 off, &records[i]);
+                if (rlen < 0) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "bad record %zu in streamed batch", i);
+                        goto err;
+                }
+                off += rlen;
+        }
+
+        if (gfc->gfc_stream_cbk)
+                gfc->gfc_stream_cbk (records, nr, gfc->gfc_stream_data);
+
+        ack.type = CHANGELOG_STREAM_ACK;
+        ack.count = hton32 (1);
+        if (gf_changelog_write (gfc->gfc_sockfd,
+                                (char *) &ack, sizeof (ack)) != sizeof (ack))
+                goto err;
+
+        GF_FREE (payload);
+        GF_FREE (records);
+        return used;
+
+ err:
+        GF_FREE (payload);
+        GF_FREE (records);
+        return -1;
+}
+
 static char *
 gf_changelog_ext_change (xlator_t *this,
                          gf_changelog_t *gfc, char *path, size_t readlen)
@@ -581,11 +1082,22 @@ gf_changelog_ext_change (xlator_t *this,
 
         buf = path;
         while (len < readlen) {
+                /* stop at a streaming frame */
+                if ((buf == path) && CHANGELOG_STREAM_IS_FRAME (*buf))
+                        break;
+
                 if (*buf == '\0') {
                         alo = 1;
-                        gf_log (this->name, GF_LOG_DEBUG,
-                                "processing changelog: %s", path);
-                        ret = gf_changelog_consume (this, gfc, path, _gf_false);
+                        if (gfc->gfc_streaming) {
+                                gf_log (this->name, GF_LOG_DEBUG,
+                                        "skipping streamed changelog: %s",
+                                        path);
+                        } else {
+                                gf_log (this->name, GF_LOG_DEBUG,
+                                        "processing changelog: %s", path);
+                                ret = gf_changelog_consume (this, gfc,
+                                                            path, _gf_false);
+                        }
                 }
 
                 if (ret)
@@ -606,6 +1118,7 @@ gf_changelog_process (void *data)
 {
         ssize_t         len      = 0;
         ssize_t         offlen   = 0;
+        ssize_t         framelen = 0;
         xlator_t       *this     = NULL;
         char           *sbuf     = NULL;
         gf_changelog_t *gfc      = NULL;
@@ -628,8 +1141,13 @@ gf_changelog_process (void *data)
                                 " notification translator.");
 
                         if (gfc->gfc_connretries != 1) {
-                                if (!gf_changelog_notification_init(this, gfc))
+                                if (!gf_changelog_notification_init(this,
+                                                                    gfc)) {
+                                        offlen = 0;
+                                        (void) gf_changelog_stream_subscribe
+                                                (gfc);
                                         continue;
+                                }
                         }
 
                         byebye = 1;
@@ -637,7 +1155,26 @@ gf_changelog_process (void *data)
                 }
 
                 len += offlen;
-                sbuf = gf_changelog_ext_change (this, gfc, from_path, len);
+                sbuf = from_path;
+                for (;;) {
+                        sbuf = gf_changelog_ext_change (this, gfc, sbuf,
+                                                        from_path + len
+                                                        - sbuf);
+                        if (!sbuf || (sbuf == from_path + len)
+                            || !CHANGELOG_STREAM_IS_FRAME (*sbuf))
+                                break;
+
+                        framelen = gf_changelog_stream_frame
+                                (this, gfc, sbuf, from_path + len - sbuf);
+                        if (framelen < 0) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "could not read streamed records");
+                                sbuf = NULL;
+                                break;
+                        }
+                        sbuf += framelen;
+                }
+
                 if (!sbuf) {
                         gf_log (this->name, GF_LOG_ERROR,
                                 "could not extract changelog filename");
@@ -432,6 +432,63 @@ gf_changelog_scan ()
         return -1;
 }
 
+int
+gf_changelog_stream_subscribe (gf_changelog_t *gfc)
+{
+        struct changelog_stream_req req = {0,};
+
+        if (!gfc->gfc_stream_cbk)
+                return 0;
+
+        /* changelogs are consumed until the brick resumes streaming */
+        gfc->gfc_streaming = _gf_false;
+
+        req.type = CHANGELOG_STREAM_SUBSCRIBE;
+        req.count = hton32 (gfc->gfc_stream_window);
+
+        if (gf_changelog_write (gfc->gfc_sockfd,
+                                (char *) &req, sizeof (req)) != sizeof (req)) {
+                gf_log (gfc->this->name, GF_LOG_ERROR,
+                        "could not subscribe for streaming (reason: %s)",
+                        strerror (errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * @API
+ *  gf_changelog_stream() - get records in memory as they are journalled
+ *  (see changelog.h).
+ */
+int
+gf_changelog_stream (gf_changelog_stream_cbk_t cbk, void *data,
+                     unsigned int window)
+{
+        xlator_t       *this = NULL;
+        gf_changelog_t *gfc  = NULL;
+
+        errno = EINVAL;
+
+        this = THIS;
+        if (!this)
+                goto out;
+
+        gfc = (gf_changelog_t *) this->private;
+        if (!gfc || !cbk || gfc->gfc_stream_cbk)
+                goto out;
+
+        gfc->gfc_stream_data = data;
+        gfc->gfc_stream_window = (window) ? window : 1;
+        gfc->gfc_stream_cbk = cbk;
+
+        return gf_changelog_stream_subscribe (gfc);
+
+ out:
+        return -1;
+}
+
 /**
  * @API
  *  gf_changelog_register() - register a client for updates.
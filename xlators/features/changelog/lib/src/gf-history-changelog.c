@@ -466,6 +466,71 @@ out:
         return -1;
 }
 
+#define HTIME_INDEX_MAX_SCAN 64
+
+/*
+ * Look @value up in the time index of the htime file @dname. The slot of
+ * the time slice @value falls in gives the first changelog rolled over in
+ * that slice, the one wanted is at most a few changelogs further. This
+ * costs two preads no matter how many changelogs the htime file has.
+ *
+ * Returns the index (same as gf_history_b_search) or -1 if the htime file
+ * has no usable time index, in which case a binary search has to be done.
+ */
+long
+gf_history_index_search (const char *htime_dir, const char *dname, int fd,
+                         unsigned long value, unsigned long total, int len)
+{
+        int                        idx_fd             = -1;
+        long                       ret                = -1;
+        int                        i                  = 0;
+        uint32_t                   slot               = 0;
+        unsigned long              idx                = 0;
+        unsigned long              ts                 = 0;
+        unsigned long              min_ts             = 0;
+        unsigned long              granularity        = 0;
+        struct htime_index_header  hdr                = {{0,},};
+        char                       idx_file[PATH_MAX] = {0,};
+
+        (void) snprintf (idx_file, PATH_MAX, "%s/index/%s", htime_dir, dname);
+
+        idx_fd = open (idx_file, O_RDONLY);
+        if (idx_fd < 0)
+                goto out;
+
+        if (pread (idx_fd, &hdr, sizeof (hdr), 0) != sizeof (hdr))
+                goto out;
+
+        if (memcmp (hdr.magic, HTIME_INDEX_MAGIC, HTIME_INDEX_MAGIC_LEN))
+                goto out;
+
+        min_ts = ntoh64 (hdr.min_ts);
+        granularity = ntoh32 (hdr.granularity);
+        if ((granularity == 0) || (value < min_ts))
+                goto out;
+
+        if (pread (idx_fd, &slot, sizeof (slot), sizeof (hdr)
+                   + ((value - min_ts) / granularity) * sizeof (slot))
+            != sizeof (slot))
+                goto out;
+
+        for (idx = ntoh32 (slot);
+             (i < HTIME_INDEX_MAX_SCAN) && (idx < total); i++, idx++) {
+                if (gf_history_get_timestamp (fd, idx, len, &ts))
+                        goto out;
+
+                if (ts >= value) {
+                        ret = idx;
+                        break;
+                }
+        }
+
+ out:
+        if (idx_fd != -1)
+                close (idx_fd);
+        return ret;
+}
+
 void *
 gf_changelog_consume_wrap (void* data)
 {
@@ -745,6 +810,7 @@ gf_history_changelog (char* changelog_dir, unsigned long start,
         unsigned long                   to                      = 0;
         unsigned long                   from                    = 0;
         unsigned long                   total_changelog         = 0;
+        long                            idx                     = -1;
         xlator_t                        *this                   = NULL;
         gf_changelog_t                  *gfc                    = NULL;
         gf_changelog_t                  *hist_gfc               = NULL;
@@ -829,8 +895,13 @@ gf_history_changelog (char* changelog_dir, unsigned long start,
                          * search @start in the htime file returning it's index
                          * (@from)
                          */
-                        from = gf_history_b_search (fd, start, 0,
-                                                   total_changelog - 1, len);
+                        idx = gf_history_index_search (htime_dir, dp->d_name,
+                                                       fd, start,
+                                                       total_changelog, len);
+                        from = (idx >= 0) ? idx
+                                : gf_history_b_search (fd, start, 0,
+                                                       total_changelog - 1,
+                                                       len);
 
                         /* ensuring correctness of gf_b_search */
                         if (gf_history_check (fd, from, start, len) != 0) {
@@ -846,8 +917,13 @@ gf_history_changelog (char* changelog_dir, unsigned long start,
                         /**
                          * search @end2 in htime file returning it's index (@to)
                          */
-                        to = gf_history_b_search (fd, end2,
-                                                  0, total_changelog - 1, len);
+                        idx = gf_history_index_search (htime_dir, dp->d_name,
+                                                       fd, end2,
+                                                       total_changelog, len);
+                        to = (idx >= 0) ? idx
+                                : gf_history_b_search (fd, end2, 0,
+                                                       total_changelog - 1,
+                                                       len);
 
                         if (gf_history_check (fd, to, end2, len) != 0) {
                                 ret = -1;
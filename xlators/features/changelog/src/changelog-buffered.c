@@ -0,0 +1,555 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+#include "defaults.h"
+#include "logging.h"
+
+#include "changelog-buffered.h"
+#include "changelog-notifier.h"
+#include "changelog-mem-types.h"
+
+/**
+ * buffered operation mode: fops encode their records into a per thread
+ * slot (no lock shared between slots, no syscall) and a background
+ * writer merges the slots into the changelog with vectored writes. A
+ * global sequence number, taken under the slot lock, keeps the records
+ * in the order they were journalled: a flush only takes records older
+ * than the sequence number it started with, so that whatever comes
+ * later (even from a slot already drained) goes in the next flush.
+ * Rollover and fsync are run as part of a flush, in the same order.
+ */
+
+static int
+changelog_buffered_reserve (char **buf, size_t *size, size_t len)
+{
+        size_t  nsize = 0;
+        char   *nbuf  = NULL;
+
+        if (len <= *size)
+                return 0;
+
+        nsize = (*size) ? *size : CHANGELOG_BUFFERED_FLUSH_SIZE;
+        while (nsize < len)
+                nsize *= 2;
+
+        if (*buf)
+                nbuf = GF_REALLOC (*buf, nsize);
+        else
+                nbuf = GF_CALLOC (1, nsize, gf_changelog_mt_buffered_buf_t);
+        if (!nbuf)
+                return -1;
+
+        *buf = nbuf;
+        *size = nsize;
+
+        return 0;
+}
+
+static void
+changelog_buffered_tls_free (void *data)
+{
+        GF_FREE (data);
+}
+
+static changelog_buffered_tls_t *
+changelog_buffered_tls (changelog_buffered_t *cb)
+{
+        changelog_buffered_tls_t *tls = NULL;
+
+        tls = pthread_getspecific (cb->key);
+        if (tls)
+                return tls;
+
+        tls = GF_CALLOC (1, sizeof (*tls), gf_changelog_mt_buffered_t);
+        if (!tls)
+                return NULL;
+
+        tls->slot = __sync_fetch_and_add (&cb->next_slot, 1) % cb->nr_slots;
+
+        if (pthread_setspecific (cb->key, tls)) {
+                GF_FREE (tls);
+                return NULL;
+        }
+
+        return tls;
+}
+
+/**
+ * called by the encoders (changelog_write_change ()) for each record:
+ * returns 1 if the record is not being buffered and should be written
+ * out as usual.
+ */
+int
+changelog_buffered_capture (changelog_priv_t *priv,
+                            char *buffer, size_t len, uint32_t flags)
+{
+        changelog_buffered_t          *cb   = NULL;
+        changelog_buffered_tls_t      *tls  = NULL;
+        changelog_buffered_slot_t     *slot = NULL;
+        struct changelog_buffered_rec  rec  = {0,};
+
+        if (!priv->cb || (priv->cb->mode != CHANGELOG_MODE_BUFFERED))
+                return 1;
+
+        cb = priv->cd.cd_data;
+
+        tls = pthread_getspecific (cb->key);
+        if (!tls || !tls->capture)
+                return 1;
+
+        slot = tls->capture;
+
+        if (changelog_buffered_reserve (&slot->buf, &slot->size,
+                                        slot->len + sizeof (rec) + len))
+                return -1;
+
+        rec.seq = __sync_fetch_and_add (&cb->seq, 1);
+        rec.len = len;
+        rec.flags = flags;
+
+        memcpy (slot->buf + slot->len, &rec, sizeof (rec));
+        memcpy (slot->buf + slot->len + sizeof (rec), buffer, len);
+        slot->len += sizeof (rec) + len;
+
+        return 0;
+}
+
+/* take the records of a slot older than @cutoff */
+static int
+changelog_buffered_drain (changelog_buffered_slot_t *slot, uint64_t cutoff)
+{
+        int                            ret  = 0;
+        size_t                         off  = 0;
+        size_t                         size = 0;
+        char                          *buf  = NULL;
+        struct changelog_buffered_rec  rec  = {0,};
+
+        slot->drain_len = slot->cursor = 0;
+
+        LOCK (&slot->lock);
+        {
+                while (off < slot->len) {
+                        memcpy (&rec, slot->buf + off, sizeof (rec));
+                        if (rec.seq >= cutoff)
+                                break;
+                        off += sizeof (rec) + rec.len;
+                }
+
+                if (off && (off == slot->len)) {
+                        /* everything: swap the buffers */
+                        buf = slot->drain;
+                        size = slot->drain_size;
+
+                        slot->drain = slot->buf;
+                        slot->drain_size = slot->size;
+                        slot->drain_len = off;
+
+                        slot->buf = buf;
+                        slot->size = size;
+                        slot->len = 0;
+                } else if (off) {
+                        ret = changelog_buffered_reserve (&slot->drain,
+                                                          &slot->drain_size,
+                                                          off);
+                        if (!ret) {
+                                memcpy (slot->drain, slot->buf, off);
+                                memmove (slot->buf, slot->buf + off,
+                                         slot->len - off);
+                                slot->len -= off;
+                                slot->drain_len = off;
+                        }
+                }
+        }
+        UNLOCK (&slot->lock);
+
+        return ret;
+}
+
+static int
+changelog_buffered_writev (int fd, struct iovec *iov, int count)
+{
+        ssize_t size = 0;
+
+        while (count > 0) {
+                size = writev (fd, iov, count);
+                if (size <= 0)
+                        return -1;
+
+                while (count && (size >= (ssize_t) iov->iov_len)) {
+                        size -= iov->iov_len;
+                        iov++;
+                        count--;
+                }
+
+                if (count) {
+                        iov->iov_base = (char *) iov->iov_base + size;
+                        iov->iov_len -= size;
+                }
+        }
+
+        return 0;
+}
+
+static int
+changelog_buffered_add_pub (changelog_buffered_t *cb, char *data, size_t len)
+{
+        int           size = 0;
+        struct iovec *pub  = NULL;
+
+        if (cb->nr_pub == cb->pub_size) {
+                size = (cb->pub_size) ? cb->pub_size * 2 : IOV_MAX;
+                if (cb->pub)
+                        pub = GF_REALLOC (cb->pub, size * sizeof (*pub));
+                else
+                        pub = GF_CALLOC (size, sizeof (*pub),
+                                         gf_changelog_mt_buffered_buf_t);
+                if (!pub)
+                        return -1;
+
+                cb->pub = pub;
+                cb->pub_size = size;
+        }
+
+        cb->pub[cb->nr_pub].iov_base = data;
+        cb->pub[cb->nr_pub].iov_len = len;
+        cb->nr_pub++;
+
+        return 0;
+}
+
+/* merge the slots into the changelog, in sequence. flush_lock held. */
+static int
+__changelog_buffered_flush (xlator_t *this,
+                            changelog_priv_t *priv, changelog_buffered_t *cb)
+{
+        int                            i      = 0;
+        int                            ret    = 0;
+        int                            best   = 0;
+        int                            nr_iov = 0;
+        uint64_t                       cutoff = 0;
+        uint64_t                       seq    = 0;
+        char                          *data   = NULL;
+        changelog_buffered_slot_t     *slot   = NULL;
+        struct changelog_buffered_rec  rec    = {0,};
+
+        cutoff = __sync_fetch_and_add (&cb->seq, 0);
+
+        for (i = 0; i < cb->nr_slots; i++) {
+                if (changelog_buffered_drain (&cb->slots[i], cutoff))
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "could not take buffered records, they would"
+                                " be written out of order");
+        }
+
+        cb->nr_pub = 0;
+
+        for (;;) {
+                best = -1;
+                for (i = 0; i < cb->nr_slots; i++) {
+                        slot = &cb->slots[i];
+                        if (slot->cursor >= slot->drain_len)
+                                continue;
+
+                        memcpy (&rec, slot->drain + slot->cursor,
+                                sizeof (rec));
+                        if ((best == -1) || (rec.seq < seq)) {
+                                best = i;
+                                seq = rec.seq;
+                        }
+                }
+
+                if (best == -1)
+                        break;
+
+                slot = &cb->slots[best];
+                memcpy (&rec, slot->drain + slot->cursor, sizeof (rec));
+                data = slot->drain + slot->cursor + sizeof (rec);
+                slot->cursor += sizeof (rec) + rec.len;
+
+                if (rec.flags & CHANGELOG_BUFFERED_STREAM) {
+                        if (changelog_buffered_add_pub (cb, data, rec.len))
+                                gf_log (this->name, GF_LOG_WARNING,
+                                        "dropped a record for streaming");
+                        continue;
+                }
+
+                /* changelog disabled meanwhile */
+                if (priv->changelog_fd == -1)
+                        continue;
+
+                if (rec.flags & CHANGELOG_BUFFERED_INDEXED)
+                        changelog_index_record (priv, rec.len);
+
+                cb->iov[nr_iov].iov_base = data;
+                cb->iov[nr_iov].iov_len = rec.len;
+                if (++nr_iov < IOV_MAX)
+                        continue;
+
+                if (changelog_buffered_writev (priv->changelog_fd,
+                                               cb->iov, nr_iov))
+                        ret = -1;
+                nr_iov = 0;
+        }
+
+        if (nr_iov && changelog_buffered_writev (priv->changelog_fd,
+                                                 cb->iov, nr_iov))
+                ret = -1;
+
+        if (ret) {
+                priv->ci.broken = _gf_true;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "error writing changelog to disk (reason: %s)",
+                        strerror (errno));
+        }
+
+        for (i = 0; i < cb->nr_pub; i++)
+                changelog_stream_publish_record (this, priv,
+                                                 cb->pub[i].iov_base,
+                                                 cb->pub[i].iov_len);
+
+        return ret;
+}
+
+static int
+changelog_buffered_flush (xlator_t *this,
+                          changelog_priv_t *priv, changelog_buffered_t *cb)
+{
+        int ret = 0;
+
+        pthread_mutex_lock (&cb->flush_lock);
+        {
+                ret = __changelog_buffered_flush (this, priv, cb);
+        }
+        pthread_mutex_unlock (&cb->flush_lock);
+
+        return ret;
+}
+
+static void
+changelog_buffered_kick (changelog_buffered_t *cb)
+{
+        pthread_mutex_lock (&cb->mutex);
+        {
+                cb->kick = _gf_true;
+                pthread_cond_signal (&cb->cond);
+        }
+        pthread_mutex_unlock (&cb->mutex);
+}
+
+static void *
+changelog_buffered_writer (void *data)
+{
+        int32_t               interval = 0;
+        xlator_t             *this     = NULL;
+        changelog_priv_t     *priv     = NULL;
+        changelog_buffered_t *cb       = NULL;
+        struct timeval        tv       = {0,};
+        struct timespec       ts       = {0,};
+
+        cb = data;
+        this = cb->this;
+
+        pthread_mutex_lock (&cb->mutex);
+        while (!cb->stop) {
+                if (!cb->kick) {
+                        priv = this->private;
+                        interval = (priv) ? priv->buffered_flush_interval
+                                          : 1000;
+
+                        gettimeofday (&tv, NULL);
+                        ts.tv_sec = tv.tv_sec + interval / 1000;
+                        ts.tv_nsec = tv.tv_usec * 1000
+                                     + (interval % 1000) * 1000000;
+                        if (ts.tv_nsec >= 1000000000) {
+                                ts.tv_sec++;
+                                ts.tv_nsec -= 1000000000;
+                        }
+
+                        (void) pthread_cond_timedwait (&cb->cond,
+                                                       &cb->mutex, &ts);
+                }
+
+                cb->kick = _gf_false;
+                pthread_mutex_unlock (&cb->mutex);
+
+                /* private is set once init () is done */
+                priv = this->private;
+                if (priv)
+                        (void) changelog_buffered_flush (this, priv, cb);
+
+                pthread_mutex_lock (&cb->mutex);
+        }
+        pthread_mutex_unlock (&cb->mutex);
+
+        return NULL;
+}
+
+int
+changelog_buffered_init (xlator_t *this, changelog_dispatcher_t *cd)
+{
+        int                   i  = 0;
+        long                  nr = 0;
+        changelog_buffered_t *cb = NULL;
+
+        cb = GF_CALLOC (1, sizeof (*cb), gf_changelog_mt_buffered_t);
+        if (!cb)
+                return -1;
+
+        cb->iov = GF_CALLOC (IOV_MAX, sizeof (*cb->iov),
+                             gf_changelog_mt_buffered_buf_t);
+        if (!cb->iov)
+                goto free_cb;
+
+        if (pthread_key_create (&cb->key, changelog_buffered_tls_free))
+                goto free_iov;
+
+        nr = sysconf (_SC_NPROCESSORS_ONLN);
+        cb->nr_slots = (nr <= 0) ? 1 : min (nr, CHANGELOG_BUFFERED_MAX_SLOTS);
+        for (i = 0; i < cb->nr_slots; i++)
+                LOCK_INIT (&cb->slots[i].lock);
+
+        cb->this = this;
+        pthread_mutex_init (&cb->flush_lock, NULL);
+        pthread_mutex_init (&cb->mutex, NULL);
+        pthread_cond_init (&cb->cond, NULL);
+
+        if (gf_thread_create (&cb->writer, NULL,
+                              changelog_buffered_writer, cb)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "could not start changelog writer thread");
+                goto destroy;
+        }
+
+        cd->cd_data = cb;
+        cd->dispatchfn = &changelog_buffered_enqueue;
+
+        gf_log (this->name, GF_LOG_DEBUG,
+                "buffered changelog with %d slots", cb->nr_slots);
+
+        return 0;
+
+ destroy:
+        pthread_cond_destroy (&cb->cond);
+        pthread_mutex_destroy (&cb->mutex);
+        pthread_mutex_destroy (&cb->flush_lock);
+        for (i = 0; i < cb->nr_slots; i++)
+                LOCK_DESTROY (&cb->slots[i].lock);
+        pthread_key_delete (cb->key);
+ free_iov:
+        GF_FREE (cb->iov);
+ free_cb:
+        GF_FREE (cb);
+        return -1;
+}
+
+int
+changelog_buffered_fini (xlator_t *this, changelog_dispatcher_t *cd)
+{
+        int                   i    = 0;
+        changelog_priv_t     *priv = NULL;
+        changelog_buffered_t *cb   = NULL;
+
+        cb = cd->cd_data;
+
+        pthread_mutex_lock (&cb->mutex);
+        {
+                cb->stop = _gf_true;
+                pthread_cond_signal (&cb->cond);
+        }
+        pthread_mutex_unlock (&cb->mutex);
+
+        pthread_join (cb->writer, NULL);
+
+        /* whatever is left goes to the current changelog */
+        priv = this->private;
+        if (priv)
+                (void) changelog_buffered_flush (this, priv, cb);
+
+        for (i = 0; i < cb->nr_slots; i++) {
+                LOCK_DESTROY (&cb->slots[i].lock);
+                GF_FREE (cb->slots[i].buf);
+                GF_FREE (cb->slots[i].drain);
+        }
+
+        pthread_cond_destroy (&cb->cond);
+        pthread_mutex_destroy (&cb->mutex);
+        pthread_mutex_destroy (&cb->flush_lock);
+        pthread_key_delete (cb->key);
+
+        GF_FREE (cb->pub);
+        GF_FREE (cb->iov);
+        GF_FREE (cb);
+
+        return 0;
+}
+
+int
+changelog_buffered_enqueue (xlator_t *this, changelog_priv_t *priv,
+                            void *cbatch, changelog_log_data_t *cld_0,
+                            changelog_log_data_t *cld_1)
+{
+        int                        ret  = 0;
+        size_t                     len  = 0;
+        changelog_buffered_t      *cb   = NULL;
+        changelog_buffered_tls_t  *tls  = NULL;
+        changelog_buffered_slot_t *slot = NULL;
+
+        cb = (changelog_buffered_t *) cbatch;
+
+        tls = changelog_buffered_tls (cb);
+
+        /**
+         * rollover and fsync go after the records journalled so far
+         * (and so does a record we could not buffer).
+         */
+        if (!tls || CHANGELOG_TYPE_IS_ROLLOVER (cld_0->cld_type)
+            || CHANGELOG_TYPE_IS_FSYNC (cld_0->cld_type)) {
+                pthread_mutex_lock (&cb->flush_lock);
+                {
+                        (void) __changelog_buffered_flush (this, priv, cb);
+
+                        ret = changelog_handle_change (this, priv, cld_0);
+                        if (!ret && cld_1)
+                                ret = changelog_handle_change (this,
+                                                               priv, cld_1);
+                }
+                pthread_mutex_unlock (&cb->flush_lock);
+
+                return ret;
+        }
+
+        slot = &cb->slots[tls->slot];
+
+        LOCK (&slot->lock);
+        {
+                tls->capture = slot;
+
+                ret = changelog_handle_change (this, priv, cld_0);
+                if (!ret && cld_1)
+                        ret = changelog_handle_change (this, priv, cld_1);
+
+                tls->capture = NULL;
+                len = slot->len;
+        }
+        UNLOCK (&slot->lock);
+
+        if (len > CHANGELOG_BUFFERED_MAX_SIZE)
+                (void) changelog_buffered_flush (this, priv, cb);
+        else if (len > CHANGELOG_BUFFERED_FLUSH_SIZE)
+                changelog_buffered_kick (cb);
+
+        return ret;
+}
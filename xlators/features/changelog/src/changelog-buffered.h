@@ -0,0 +1,104 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#ifndef _CHANGELOG_BUFFERED_H
+#define _CHANGELOG_BUFFERED_H
+
+#include <sys/uio.h>
+
+#include "locking.h"
+#include "pthread.h"
+
+#include "changelog-helpers.h"
+
+#define CHANGELOG_BUFFERED_MAX_SLOTS  64
+
+/* a slot grown past this wakes up the writer... */
+#define CHANGELOG_BUFFERED_FLUSH_SIZE (128 * 1024)
+
+/* ...and past this the thread filling it flushes by itself */
+#define CHANGELOG_BUFFERED_MAX_SIZE   (8 * CHANGELOG_BUFFERED_FLUSH_SIZE)
+
+/* record flags */
+#define CHANGELOG_BUFFERED_INDEXED    0x1 /* goes in the record index */
+#define CHANGELOG_BUFFERED_STREAM     0x2 /* for streaming consumers */
+
+/* header of each record in a slot */
+struct changelog_buffered_rec {
+        uint64_t seq;
+        uint32_t len;
+        uint32_t flags;
+};
+
+typedef struct changelog_buffered_slot {
+        gf_lock_t  lock;
+
+        /* records being appended */
+        char      *buf;
+        size_t     len;
+        size_t     size;
+
+        /* records taken by a flush */
+        char      *drain;
+        size_t     drain_len;
+        size_t     drain_size;
+        size_t     cursor;
+} changelog_buffered_slot_t;
+
+/* slot of a thread, and the slot it is encoding into */
+typedef struct changelog_buffered_tls {
+        int                        slot;
+        changelog_buffered_slot_t *capture;
+} changelog_buffered_tls_t;
+
+typedef struct changelog_buffered {
+        xlator_t                  *this;
+
+        /* global order of records, across slots */
+        uint64_t                   seq;
+
+        int                        nr_slots;
+        int                        next_slot;
+        changelog_buffered_slot_t  slots[CHANGELOG_BUFFERED_MAX_SLOTS];
+
+        pthread_key_t              key;
+
+        /**
+         * serialises flushes and the events (rollover, fsync) that have
+         * to be ordered against them. The vectors are only touched under
+         * it.
+         */
+        pthread_mutex_t            flush_lock;
+        struct iovec              *iov;
+        struct iovec              *pub;
+        int                        nr_pub;
+        int                        pub_size;
+
+        /* background writer */
+        pthread_t                  writer;
+        pthread_mutex_t            mutex;
+        pthread_cond_t             cond;
+        gf_boolean_t               kick;
+        gf_boolean_t               stop;
+} changelog_buffered_t;
+
+int
+changelog_buffered_init (xlator_t *this, changelog_dispatcher_t *cd);
+int
+changelog_buffered_fini (xlator_t *this, changelog_dispatcher_t *cd);
+int
+changelog_buffered_enqueue (xlator_t *this, changelog_priv_t *priv,
+                            void *cbatch, changelog_log_data_t *cld_0,
+                            changelog_log_data_t *cld_1);
+int
+changelog_buffered_capture (changelog_priv_t *priv,
+                            char *buffer, size_t len, uint32_t flags);
+
+#endif /* _CHANGELOG_BUFFERED_H */
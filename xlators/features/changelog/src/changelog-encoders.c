@@ -176,6 +176,45 @@ changelog_encode_binary (xlator_t *this, changelog_log_data_t *cld)
         return changelog_write_change (priv, buffer, off);
 }
 
+/**
+ * length prefixed binary record, as written by the indexed encoder and
+ * sent to streaming consumers. @buffer should have room for
+ * CHANGELOG_INDEXED_RECORD_SIZE (cld) bytes.
+ */
+size_t
+changelog_encode_indexed_record (changelog_priv_t *priv,
+                                 changelog_log_data_t *cld, char *buffer)
+{
+        size_t   off = 0;
+        uint32_t len = 0;
+
+        off = sizeof (len);
+        CHANGELOG_STORE_BINARY (priv, buffer, off, cld->cld_gfid, cld);
+
+        if (cld->cld_xtra_records)
+                changelog_encode_write_xtra (cld, buffer, &off, _gf_false);
+
+        len = hton32 (off - sizeof (len));
+        memcpy (buffer, &len, sizeof (len));
+
+        return off;
+}
+
+int
+changelog_encode_indexed (xlator_t *this, changelog_log_data_t *cld)
+{
+        size_t            off    = 0;
+        char             *buffer = NULL;
+        changelog_priv_t *priv   = NULL;
+
+        priv = this->private;
+
+        buffer = alloca (CHANGELOG_INDEXED_RECORD_SIZE (cld));
+        off = changelog_encode_indexed_record (priv, cld, buffer);
+
+        return changelog_write_indexed_change (priv, buffer, off);
+}
+
 static struct changelog_encoder
 cb_encoder[] = {
         [CHANGELOG_ENCODE_BINARY] =
@@ -188,6 +227,11 @@ cb_encoder[] = {
                 .encoder = CHANGELOG_ENCODE_ASCII,
                 .encode = changelog_encode_ascii,
         },
+        [CHANGELOG_ENCODE_INDEXED] =
+        {
+                .encoder = CHANGELOG_ENCODE_INDEXED,
+                .encode = changelog_encode_indexed,
+        },
 };
 
 void
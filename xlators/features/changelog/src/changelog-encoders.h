@@ -30,6 +30,10 @@
                                        off, gfid, sizeof (uuid_t));     \
         } while (0)
 
+/* extra bytes for decorations and the length prefix */
+#define CHANGELOG_INDEXED_RECORD_SIZE(cld)                              \
+        (sizeof (uint32_t) + sizeof (uuid_t) + cld->cld_ptr_len + 10)
+
 size_t
 entry_fn (void *data, char *buffer, gf_boolean_t encode);
 size_t
@@ -42,6 +46,11 @@ int
 changelog_encode_binary (xlator_t *, changelog_log_data_t *);
 int
 changelog_encode_ascii (xlator_t *, changelog_log_data_t *);
+int
+changelog_encode_indexed (xlator_t *, changelog_log_data_t *);
+size_t
+changelog_encode_indexed_record (changelog_priv_t *,
+                                 changelog_log_data_t *, char *);
 void
 changelog_encode_change(changelog_priv_t *);
 
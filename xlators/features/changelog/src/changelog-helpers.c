@@ -23,6 +23,8 @@
 #include "changelog-mem-types.h"
 
 #include "changelog-encoders.h"
+#include "changelog-notifier.h"
+#include "changelog-buffered.h"
 #include <pthread.h>
 
 static inline void
@@ -155,6 +157,104 @@ changelog_write (int fd, char *buffer, size_t len)
         return (written != len);
 }
 
+#define HTIME_INDEX_CHUNK 1024
+
+/* fill the time index slots up to @ts with @index, the position of the
+ * changelog just recorded in the htime file. slots already filled point
+ * to an earlier changelog and are left alone.
+ */
+static int
+htime_index_update (xlator_t *this,
+                    changelog_priv_t *priv, unsigned long ts, int index)
+{
+        uint32_t      slots[HTIME_INDEX_CHUNK];
+        unsigned long last  = 0;
+        unsigned long nr    = 0;
+        unsigned long i     = 0;
+        off_t         off   = 0;
+        ssize_t       size  = 0;
+
+        if (priv->htime_idx_fd == -1)
+                return 0;
+
+        if (ts < priv->htime_idx_min)
+                return 0;
+
+        last = (ts - priv->htime_idx_min) / priv->htime_idx_granularity;
+
+        for (i = 0; i < HTIME_INDEX_CHUNK; i++)
+                slots[i] = hton32 (index);
+
+        while (priv->htime_idx_slots <= last) {
+                nr = last - priv->htime_idx_slots + 1;
+                if (nr > HTIME_INDEX_CHUNK)
+                        nr = HTIME_INDEX_CHUNK;
+
+                off = sizeof (struct htime_index_header)
+                        + priv->htime_idx_slots * sizeof (uint32_t);
+                size = pwrite (priv->htime_idx_fd, slots,
+                               nr * sizeof (uint32_t), off);
+                if (size != nr * sizeof (uint32_t)) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "htime index write failed (reason: %s), "
+                                "history lookups will not use the index",
+                                strerror (errno));
+                        (void) ftruncate (priv->htime_idx_fd, 0);
+                        close (priv->htime_idx_fd);
+                        priv->htime_idx_fd = -1;
+                        return -1;
+                }
+
+                priv->htime_idx_slots += nr;
+        }
+
+        return 0;
+}
+
+static void
+htime_index_open (xlator_t *this, changelog_priv_t *priv, unsigned long ts)
+{
+        int                       fd                     = -1;
+        char                      idx_dir_path[PATH_MAX] = {0,};
+        char                      idx_file_path[PATH_MAX] = {0,};
+        struct htime_index_header hdr                    = {{0,},};
+
+        if (priv->htime_idx_fd != -1) {
+                close (priv->htime_idx_fd);
+                priv->htime_idx_fd = -1;
+        }
+
+        CHANGELOG_FILL_HTIME_INDEX_DIR (priv->changelog_dir, idx_dir_path);
+
+        (void) snprintf (idx_file_path, PATH_MAX, "%s/%s.%lu",
+                         idx_dir_path, HTIME_FILE_NAME, ts);
+
+        fd = open (idx_file_path, O_CREAT | O_RDWR | O_TRUNC,
+                   S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (fd < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "unable to create htime index %s (reason: %s)",
+                        idx_file_path, strerror (errno));
+                return;
+        }
+
+        memcpy (hdr.magic, HTIME_INDEX_MAGIC, HTIME_INDEX_MAGIC_LEN);
+        hdr.min_ts = hton64 (ts);
+        hdr.granularity = hton32 (priv->htime_idx_granularity);
+
+        if (changelog_write (fd, (char *) &hdr, sizeof (hdr))) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "unable to write htime index header %s (reason: %s)",
+                        idx_file_path, strerror (errno));
+                close (fd);
+                return;
+        }
+
+        priv->htime_idx_fd = fd;
+        priv->htime_idx_min = ts;
+        priv->htime_idx_slots = 0;
+}
+
 int
 htime_update (xlator_t *this,
               changelog_priv_t *priv, unsigned long ts,
@@ -193,12 +293,45 @@ htime_update (xlator_t *this,
                 goto out;
         }
 
+        (void) htime_index_update (this, priv, ts, priv->rollover_count - 1);
+
         priv->rollover_count +=1;
 
 out:
         return ret;
 }
 
+/* append the record offsets and the trailer to an indexed changelog */
+static void
+changelog_write_index (xlator_t *this, changelog_priv_t *priv)
+{
+        changelog_index_t              *ci      = NULL;
+        struct changelog_index_trailer  trailer = {{0,},};
+
+        ci = &priv->ci;
+
+        if (!ci->active || ci->broken || (ci->nr == 0))
+                goto out;
+
+        memcpy (trailer.magic, CHANGELOG_INDEX_MAGIC,
+                CHANGELOG_INDEX_MAGIC_LEN);
+        trailer.index_offset = hton64 (ci->off);
+        trailer.nr_records = hton32 (ci->nr);
+
+        if (changelog_write (priv->changelog_fd, (char *) ci->offsets,
+                             ci->nr * sizeof (uint64_t))
+            || changelog_write (priv->changelog_fd, (char *) &trailer,
+                                sizeof (trailer))) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "failed to write changelog index (reason: %s)",
+                        strerror (errno));
+        }
+
+ out:
+        ci->active = _gf_false;
+        ci->nr = 0;
+}
+
 static int
 changelog_rollover_changelog (xlator_t *this,
                               changelog_priv_t *priv, unsigned long ts)
@@ -210,6 +343,8 @@ changelog_rollover_changelog (xlator_t *this,
         char nfile[PATH_MAX] = {0,};
 
         if (priv->changelog_fd != -1) {
+                changelog_write_index (this, priv);
+
                 ret = fsync (priv->changelog_fd);
                 if (ret < 0) {
                         gf_log (this->name, GF_LOG_ERROR,
@@ -259,6 +394,9 @@ changelog_rollover_changelog (xlator_t *this,
                                 "Failed to send file name to notify thread"
                                 " (reason: %s)", strerror (errno));
                 } else {
+                        if (priv->streaming)
+                                changelog_stream_rollover (this, priv, nfile);
+
                         /* If this is explicit rollover initiated by snapshot,
                          * wakeup reconfigure thread waiting for changelog to
                          * rollover
@@ -333,6 +471,12 @@ htime_open (xlator_t *this,
         /* initialize rollover-number in priv to 1 */
         priv->rollover_count = 1;
 
+        /* the time index is an optimization, history lookup falls back to
+         * searching the htime file without it */
+        priv->htime_idx_granularity = (priv->rollover_time > 0)
+                ? priv->rollover_time : 1;
+        htime_index_open (this, priv, ts);
+
 out:
         return ret;
 }
@@ -473,6 +617,11 @@ changelog_open (xlator_t *this,
                 goto out;
         }
 
+        priv->ci.active = (priv->ce->encoder == CHANGELOG_ENCODE_INDEXED);
+        priv->ci.broken = _gf_false;
+        priv->ci.off = strlen (buffer);
+        priv->ci.nr = 0;
+
         ret = 0;
 
  out:
@@ -527,9 +676,72 @@ changelog_snap_write_change (changelog_priv_t *priv, char *buffer, size_t len)
 int
 changelog_write_change (changelog_priv_t *priv, char *buffer, size_t len)
 {
+        int ret = 0;
+
+        /* buffered op-mode: the writer thread does it */
+        ret = changelog_buffered_capture (priv, buffer, len, 0);
+        if (ret <= 0)
+                return ret;
+
         return changelog_write (priv->changelog_fd, buffer, len);
 }
 
+#define CHANGELOG_INDEX_INIT_SIZE 1024
+
+/* account a record of @len bytes appended to the changelog */
+void
+changelog_index_record (changelog_priv_t *priv, size_t len)
+{
+        uint32_t           size    = 0;
+        uint64_t          *offsets = NULL;
+        changelog_index_t *ci      = NULL;
+
+        ci = &priv->ci;
+
+        if (ci->nr == ci->size) {
+                if (ci->offsets) {
+                        size = ci->size * 2;
+                        offsets = GF_REALLOC (ci->offsets,
+                                              size * sizeof (uint64_t));
+                } else {
+                        size = CHANGELOG_INDEX_INIT_SIZE;
+                        offsets = GF_CALLOC (size, sizeof (uint64_t),
+                                             gf_changelog_mt_index_t);
+                }
+                if (!offsets) {
+                        ci->broken = _gf_true;
+                } else {
+                        ci->offsets = offsets;
+                        ci->size = size;
+                }
+        }
+
+        if (!ci->broken)
+                ci->offsets[ci->nr++] = hton64 (ci->off);
+        ci->off += len;
+}
+
+int
+changelog_write_indexed_change (changelog_priv_t *priv,
+                                char *buffer, size_t len)
+{
+        int ret = 0;
+
+        ret = changelog_buffered_capture (priv, buffer, len,
+                                          CHANGELOG_BUFFERED_INDEXED);
+        if (ret <= 0)
+                return ret;
+
+        ret = changelog_write (priv->changelog_fd, buffer, len);
+        if (ret) {
+                priv->ci.broken = _gf_true;
+                return ret;
+        }
+
+        changelog_index_record (priv, len);
+        return 0;
+}
+
 /*
  * Descriptions:
  *      Writes fop details in ascii format to CSNAP.
@@ -623,6 +835,8 @@ changelog_handle_change (xlator_t *this,
         if (ret) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "error writing changelog to disk");
+        } else if (priv->streaming) {
+                changelog_stream_publish (this, priv, cld);
         }
 
  out:
@@ -103,6 +103,22 @@ typedef struct changelog_time_slice {
         unsigned long changelog_version[CHANGELOG_MAX_TYPE];
 } changelog_time_slice_t;
 
+/* record offsets of the current changelog (indexed encoding) */
+typedef struct changelog_index {
+        /* current changelog is written in indexed encoding */
+        gf_boolean_t active;
+
+        /* a short write leaves the offsets unusable */
+        gf_boolean_t broken;
+
+        /* offset of the next record */
+        uint64_t     off;
+
+        uint64_t    *offsets;
+        uint32_t     nr;
+        uint32_t     size;
+} changelog_index_t;
+
 typedef struct changelog_rollover {
         /* rollover thread */
         pthread_t rollover_th;
@@ -121,6 +137,33 @@ typedef struct changelog_fsync {
 } changelog_fsync_t;
 
 # define CHANGELOG_MAX_CLIENTS  5
+
+typedef enum {
+        CHANGELOG_STREAM_OFF = 0,       /* path notifications only */
+        CHANGELOG_STREAM_SYNC,          /* streaming from the next rollover */
+        CHANGELOG_STREAM_ON,            /* records are buffered */
+} changelog_stream_state_t;
+
+/* streaming state of a client (see CHANGELOG_STREAM_BATCH) */
+typedef struct changelog_stream {
+        changelog_stream_state_t state;
+
+        /* batches the client is ready to receive */
+        uint32_t credits;
+
+        /* records not dispatched yet */
+        char     *buf;
+        size_t    len;
+        size_t    size;
+        uint32_t  nr;
+
+        /* OVERRUN frame pending */
+        gf_boolean_t overrun;
+
+        /* send RESUME after notifying this changelog */
+        char resume_at[PATH_MAX];
+} changelog_stream_t;
+
 typedef struct changelog_notify {
         /* reader end of the pipe */
         int rfd;
@@ -140,6 +183,11 @@ typedef struct changelog_notify {
          */
         int client_fd[CHANGELOG_MAX_CLIENTS];
 
+        /* streaming state, indexed as ->client_fd */
+        gf_lock_t          stream_lock;
+        changelog_stream_t stream[CHANGELOG_MAX_CLIENTS];
+        int                nr_streams;
+
         xlator_t *this;
 } changelog_notify_t;
 
@@ -215,6 +263,15 @@ struct changelog_priv {
         /*  c_snap_fd is fd for call-path changelog */
         int c_snap_fd;
 
+        /* time index of the htime file, slots filled so far */
+        int           htime_idx_fd;
+        unsigned long htime_idx_min;
+        uint32_t      htime_idx_granularity;
+        unsigned long htime_idx_slots;
+
+        /* record index of the current changelog */
+        changelog_index_t ci;
+
         /* rollover_count used by htime */
         int  rollover_count;
 
@@ -250,6 +307,15 @@ struct changelog_priv {
         /* context of the notifier thread */
         changelog_notify_t cn;
 
+        /* stream records to subscribed consumers */
+        gf_boolean_t streaming;
+
+        /* bytes buffered per streaming consumer */
+        uint64_t stream_buffer_size;
+
+        /* writer thread flush interval (msecs), buffered op-mode */
+        int32_t buffered_flush_interval;
+
         /* operation mode */
         changelog_mode_t op_mode;
 
@@ -400,6 +466,11 @@ changelog_write (int fd, char *buffer, size_t len);
 int
 changelog_write_change (changelog_priv_t *priv, char *buffer, size_t len);
 int
+changelog_write_indexed_change (changelog_priv_t *priv,
+                                char *buffer, size_t len);
+void
+changelog_index_record (changelog_priv_t *priv, size_t len);
+int
 changelog_handle_change (xlator_t *this,
                          changelog_priv_t *priv, changelog_log_data_t *cld);
 void
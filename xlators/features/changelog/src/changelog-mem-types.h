@@ -24,6 +24,11 @@ enum gf_changelog_mem_types {
         gf_changelog_mt_libgfchangelog_dirent_t = gf_common_mt_end + 8,
         gf_changelog_mt_changelog_buffer_t      = gf_common_mt_end + 9,
         gf_changelog_mt_history_data_t          = gf_common_mt_end + 10,
+        gf_changelog_mt_index_t                 = gf_common_mt_end + 11,
+        gf_changelog_mt_libgfchangelog_map_t    = gf_common_mt_end + 12,
+        gf_changelog_mt_stream_buf_t            = gf_common_mt_end + 13,
+        gf_changelog_mt_buffered_t              = gf_common_mt_end + 14,
+        gf_changelog_mt_buffered_buf_t          = gf_common_mt_end + 15,
         gf_changelog_mt_end
 };
 
@@ -13,6 +13,7 @@
 
 #include "glusterfs.h"
 #include "common-utils.h"
+#include "byte-order.h"
 
 #define CHANGELOG_MAX_TYPE  3
 #define CHANGELOG_FILE_NAME "CHANGELOG"
@@ -22,7 +23,7 @@
 #define HTIME_INITIAL_VALUE "0:0"
 
 #define CHANGELOG_VERSION_MAJOR  1
-#define CHANGELOG_VERSION_MINOR  1
+#define CHANGELOG_VERSION_MINOR  2
 
 #define CHANGELOG_UNIX_SOCK  DEFAULT_VAR_RUN_DIRECTORY"/changelog-%s.sock"
 
@@ -73,10 +74,81 @@
                 strcat (path, "/htime");                        \
         } while(0)
 
+#define CHANGELOG_FILL_HTIME_INDEX_DIR(changelog_dir, path) do {        \
+                strcpy (path, changelog_dir);                           \
+                strcat (path, "/htime/index");                          \
+        } while(0)
+
 #define CHANGELOG_FILL_CSNAP_DIR(changelog_dir, path) do {      \
                 strcpy (path, changelog_dir);                   \
                 strcat (path, "/csnap");                        \
         } while(0)
+
+/**
+ * indexed encoding: each record is a binary record (without the trailing
+ * NUL) prefixed by its length (uint32_t, network order). On rollover, the
+ * offsets of all the records (uint64_t, network order) are appended to the
+ * changelog followed by a trailer, so that consumers can mmap() it and get
+ * to any record without parsing the ones before. A changelog without the
+ * trailer (brick went down before rollover) is walked using the lengths.
+ */
+#define CHANGELOG_INDEX_MAGIC     "GFCLIDX1"
+#define CHANGELOG_INDEX_MAGIC_LEN 8
+
+struct changelog_index_trailer {
+        char     magic[CHANGELOG_INDEX_MAGIC_LEN];
+        uint64_t index_offset;
+        uint32_t nr_records;
+        uint32_t reserved;
+} __attribute__ ((packed));
+
+/**
+ * time index of an HTIME file (htime/index/HTIME.<ts>): after the header,
+ * slot 'n' (uint32_t, network order) holds the position in the HTIME file
+ * of the first changelog rolled over at or after min_ts + n * granularity.
+ * History lookups start from there instead of a binary search.
+ */
+#define HTIME_INDEX_MAGIC     "GFHTIDX1"
+#define HTIME_INDEX_MAGIC_LEN 8
+
+struct htime_index_header {
+        char     magic[HTIME_INDEX_MAGIC_LEN];
+        uint64_t min_ts;
+        uint32_t granularity;
+        uint32_t reserved;
+} __attribute__ ((packed));
+
+/**
+ * streaming: a consumer subscribes on the notification socket and gets
+ * the records as they are journalled, in frames interleaved with the
+ * changelog path notifications (paths are absolute, so a frame never
+ * starts with '/'). A BATCH frame carries @nr records in the indexed
+ * format (length prefixed), OVERRUN means records were dropped for this
+ * consumer and RESUME that every record after the changelog notified
+ * just before it is being streamed. Consumers ACK each batch they are
+ * done with; at most the subscribed window of batches is outstanding.
+ */
+#define CHANGELOG_STREAM_BATCH      0x01
+#define CHANGELOG_STREAM_OVERRUN    0x02
+#define CHANGELOG_STREAM_RESUME     0x03
+
+#define CHANGELOG_STREAM_IS_FRAME(c)                                    \
+        ((c) >= CHANGELOG_STREAM_BATCH && (c) <= CHANGELOG_STREAM_RESUME)
+
+#define CHANGELOG_STREAM_SUBSCRIBE  'S'
+#define CHANGELOG_STREAM_ACK        'A'
+
+struct changelog_stream_hdr {
+        uint8_t  type;
+        uint32_t nr;
+        uint32_t len;
+} __attribute__ ((packed));
+
+struct changelog_stream_req {
+        uint8_t  type;
+        uint32_t count;
+} __attribute__ ((packed));
+
 /**
  * everything after 'CHANGELOG_TYPE_ENTRY' are internal types
  * (ie. none of the fops trigger this type of event), hence
@@ -90,9 +162,10 @@ typedef enum {
         CHANGELOG_TYPE_FSYNC,
 } changelog_log_type;
 
-/* operation modes - RT for now */
+/* operation modes */
 typedef enum {
         CHANGELOG_MODE_RT = 0,
+        CHANGELOG_MODE_BUFFERED,
 } changelog_mode_t;
 
 /* encoder types */
@@ -101,6 +174,7 @@ typedef enum {
         CHANGELOG_ENCODE_MIN = 0,
         CHANGELOG_ENCODE_BINARY,
         CHANGELOG_ENCODE_ASCII,
+        CHANGELOG_ENCODE_INDEXED,
         CHANGELOG_ENCODE_MAX,
 } changelog_encoder_t;
 
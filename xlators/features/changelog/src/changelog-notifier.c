@@ -9,8 +9,12 @@
 */
 
 #include "changelog-notifier.h"
+#include "changelog-encoders.h"
+#include "changelog-buffered.h"
+#include "changelog-mem-types.h"
 
 #include <pthread.h>
+#include <poll.h>
 
 inline static void
 changelog_notify_clear_fd (changelog_notify_t *cn, int i)
@@ -24,6 +28,356 @@ changelog_notify_save_fd (changelog_notify_t *cn, int i, int fd)
         cn->client_fd[i] = fd;
 }
 
+/* streaming */
+
+#define CHANGELOG_STREAM_CHUNK  (64 * 1024)
+
+/* msecs a client has to send the rest of a request */
+#define CHANGELOG_STREAM_REQ_TIMEOUT  5000
+
+static void
+changelog_stream_reset (changelog_notify_t *cn, int i)
+{
+        changelog_stream_t *cs = NULL;
+
+        cs = &cn->stream[i];
+
+        LOCK (&cn->stream_lock);
+        {
+                if (cs->state != CHANGELOG_STREAM_OFF)
+                        cn->nr_streams--;
+
+                GF_FREE (cs->buf);
+                memset (cs, 0, sizeof (*cs));
+        }
+        UNLOCK (&cn->stream_lock);
+}
+
+static int
+__changelog_stream_append (changelog_stream_t *cs,
+                           char *record, size_t len, size_t max)
+{
+        size_t  size = 0;
+        char   *buf  = NULL;
+
+        if (cs->len + len > max)
+                return -1;
+
+        if (cs->len + len > cs->size) {
+                size = (cs->size) ? cs->size : CHANGELOG_STREAM_CHUNK;
+                while (size < cs->len + len)
+                        size *= 2;
+                size = min (size, max);
+
+                if (cs->buf)
+                        buf = GF_REALLOC (cs->buf, size);
+                else
+                        buf = GF_CALLOC (1, size,
+                                         gf_changelog_mt_stream_buf_t);
+                if (!buf)
+                        return -1;
+
+                cs->buf = buf;
+                cs->size = size;
+        }
+
+        memcpy (cs->buf + cs->len, record, len);
+        cs->len += len;
+        cs->nr++;
+
+        return 0;
+}
+
+/**
+ * hand over the buffered records of a client as one batch, if it has
+ * credits left, followed by a pending OVERRUN. Nothing is sent while
+ * a RESUME is due: records after it belong to the next changelog.
+ */
+static int
+changelog_stream_flush (changelog_notify_t *cn, int i)
+{
+        int                          ret     = 0;
+        size_t                       len     = 0;
+        char                        *buf     = NULL;
+        gf_boolean_t                 overrun = _gf_false;
+        changelog_stream_t          *cs      = NULL;
+        struct changelog_stream_hdr  hdr     = {0,};
+
+        cs = &cn->stream[i];
+
+        LOCK (&cn->stream_lock);
+        {
+                if (cs->nr && cs->credits && (cs->resume_at[0] == '\0')) {
+                        hdr.type = CHANGELOG_STREAM_BATCH;
+                        hdr.nr = hton32 (cs->nr);
+                        hdr.len = hton32 (cs->len);
+
+                        buf = cs->buf;
+                        len = cs->len;
+
+                        cs->buf = NULL;
+                        cs->len = cs->size = 0;
+                        cs->nr = 0;
+                        cs->credits--;
+                }
+
+                overrun = cs->overrun;
+                cs->overrun = _gf_false;
+        }
+        UNLOCK (&cn->stream_lock);
+
+        if (buf) {
+                ret = changelog_write (cn->client_fd[i],
+                                       (char *) &hdr, sizeof (hdr));
+                if (!ret)
+                        ret = changelog_write (cn->client_fd[i], buf, len);
+                GF_FREE (buf);
+        }
+
+        if (!ret && overrun) {
+                memset (&hdr, 0, sizeof (hdr));
+                hdr.type = CHANGELOG_STREAM_OVERRUN;
+
+                ret = changelog_write (cn->client_fd[i],
+                                       (char *) &hdr, sizeof (hdr));
+        }
+
+        return ret;
+}
+
+/* after notifying @path: switch the client back to the stream if due */
+static int
+changelog_stream_resume (changelog_notify_t *cn, int i, char *path)
+{
+        gf_boolean_t                 resume = _gf_false;
+        changelog_stream_t          *cs     = NULL;
+        struct changelog_stream_hdr  hdr    = {0,};
+
+        cs = &cn->stream[i];
+
+        LOCK (&cn->stream_lock);
+        {
+                if (cs->resume_at[0] && !strcmp (cs->resume_at, path)) {
+                        cs->resume_at[0] = '\0';
+                        resume = _gf_true;
+                }
+        }
+        UNLOCK (&cn->stream_lock);
+
+        if (!resume)
+                return 0;
+
+        hdr.type = CHANGELOG_STREAM_RESUME;
+        if (changelog_write (cn->client_fd[i], (char *) &hdr, sizeof (hdr)))
+                return -1;
+
+        return changelog_stream_flush (cn, i);
+}
+
+/**
+ * the rest of a request whose type byte was read: a client sending it
+ * piecemeal, or not at all, must not stall the notifier for the others.
+ */
+static int
+changelog_stream_read_req (int fd, char *buf, size_t len)
+{
+        int           ret  = 0;
+        ssize_t       size = 0;
+        size_t        done = 0;
+        struct pollfd pfd  = {0,};
+
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+
+        while (done < len) {
+                ret = poll (&pfd, 1, CHANGELOG_STREAM_REQ_TIMEOUT);
+                if ((ret < 0) && (errno == EINTR))
+                        continue;
+                if (ret <= 0)
+                        return -1;
+
+                size = read (fd, buf + done, len - done);
+                if (size <= 0)
+                        return -1;
+
+                done += size;
+        }
+
+        return 0;
+}
+
+/* SUBSCRIBE or ACK from a client */
+static int
+changelog_stream_request (changelog_notify_t *cn, int i, char type)
+{
+        uint32_t            count = 0;
+        changelog_priv_t   *priv  = NULL;
+        changelog_stream_t *cs    = NULL;
+
+        priv = cn->this->private;
+        cs = &cn->stream[i];
+
+        if (changelog_stream_read_req (cn->client_fd[i], (char *) &count,
+                                       sizeof (count))) {
+                gf_log (cn->this->name, GF_LOG_WARNING,
+                        "incomplete streaming request from client");
+                return -1;
+        }
+        count = ntoh32 (count);
+
+        LOCK (&cn->stream_lock);
+        {
+                if (type == CHANGELOG_STREAM_ACK) {
+                        cs->credits += count;
+                } else if (!priv->streaming) {
+                        gf_log (cn->this->name, GF_LOG_WARNING,
+                                "streaming is disabled, client keeps getting"
+                                " changelog notifications only");
+                } else if (cs->state == CHANGELOG_STREAM_OFF) {
+                        /**
+                         * records of the active changelog are consumed
+                         * from the file, start streaming on rollover.
+                         */
+                        cs->state = CHANGELOG_STREAM_SYNC;
+                        cs->credits = count;
+                        cn->nr_streams++;
+                }
+        }
+        UNLOCK (&cn->stream_lock);
+
+        return changelog_stream_flush (cn, i);
+}
+
+/**
+ * buffer a record for every streaming client. Called with the record
+ * already journalled, under the dispatcher lock (buffered op-mode: by
+ * the writer, in sequence) so that this orders with the rollover
+ * (changelog_stream_rollover ()).
+ */
+void
+changelog_stream_publish (xlator_t *this,
+                          changelog_priv_t *priv, changelog_log_data_t *cld)
+{
+        size_t  len    = 0;
+        char   *record = NULL;
+
+        if (!priv->cn.nr_streams)
+                return;
+
+        record = alloca (CHANGELOG_INDEXED_RECORD_SIZE (cld));
+        len = changelog_encode_indexed_record (priv, cld, record);
+
+        /* buffered op-mode: published when written out */
+        if (changelog_buffered_capture (priv, record, len,
+                                        CHANGELOG_BUFFERED_STREAM) == 0)
+                return;
+
+        changelog_stream_publish_record (this, priv, record, len);
+}
+
+void
+changelog_stream_publish_record (xlator_t *this, changelog_priv_t *priv,
+                                 char *record, size_t len)
+{
+        int                 i      = 0;
+        gf_boolean_t        wakeup = _gf_false;
+        changelog_notify_t *cn     = NULL;
+        changelog_stream_t *cs     = NULL;
+
+        cn = &priv->cn;
+        if (!cn->nr_streams)
+                return;
+
+        LOCK (&cn->stream_lock);
+        {
+                for (; i < CHANGELOG_MAX_CLIENTS; i++) {
+                        cs = &cn->stream[i];
+                        if (cs->state != CHANGELOG_STREAM_ON)
+                                continue;
+
+                        if (__changelog_stream_append (cs, record, len,
+                                                       priv->stream_buffer_size)) {
+                                /* already buffered records are still sent */
+                                cs->state = CHANGELOG_STREAM_SYNC;
+                                cs->overrun = _gf_true;
+                                wakeup = _gf_true;
+                                continue;
+                        }
+
+                        if (cs->nr == 1)
+                                wakeup = _gf_true;
+                }
+        }
+        UNLOCK (&cn->stream_lock);
+
+        /* an empty pathname wakes up the notifier */
+        if (wakeup)
+                (void) changelog_write (priv->wfd, "", 1);
+}
+
+/**
+ * @path was just handed to the notifier: clients waiting to (re)start
+ * streaming that have caught up get the records of the next changelog
+ * and a RESUME right after @path.
+ */
+void
+changelog_stream_rollover (xlator_t *this, changelog_priv_t *priv, char *path)
+{
+        int                 i  = 0;
+        changelog_notify_t *cn = NULL;
+        changelog_stream_t *cs = NULL;
+
+        cn = &priv->cn;
+        if (!cn->nr_streams)
+                return;
+
+        LOCK (&cn->stream_lock);
+        {
+                for (; i < CHANGELOG_MAX_CLIENTS; i++) {
+                        cs = &cn->stream[i];
+                        if ((cs->state != CHANGELOG_STREAM_SYNC)
+                            || !cs->credits || cs->nr)
+                                continue;
+
+                        cs->state = CHANGELOG_STREAM_ON;
+                        (void) strncpy (cs->resume_at, path, PATH_MAX - 1);
+                }
+        }
+        UNLOCK (&cn->stream_lock);
+}
+
+/* streaming turned off: clients go back to consuming changelogs */
+void
+changelog_stream_stop (xlator_t *this, changelog_priv_t *priv)
+{
+        int                 i      = 0;
+        gf_boolean_t        wakeup = _gf_false;
+        changelog_notify_t *cn     = NULL;
+        changelog_stream_t *cs     = NULL;
+
+        cn = &priv->cn;
+
+        LOCK (&cn->stream_lock);
+        {
+                for (; i < CHANGELOG_MAX_CLIENTS; i++) {
+                        cs = &cn->stream[i];
+                        if (cs->state == CHANGELOG_STREAM_OFF)
+                                continue;
+
+                        cs->state = CHANGELOG_STREAM_OFF;
+                        cs->resume_at[0] = '\0';
+                        cs->overrun = _gf_true;
+                        wakeup = _gf_true;
+                }
+
+                cn->nr_streams = 0;
+        }
+        UNLOCK (&cn->stream_lock);
+
+        if (wakeup && (priv->wfd != -1))
+                (void) changelog_write (priv->wfd, "", 1);
+}
+
 static int
 changelog_notify_insert_fd (xlator_t *this, changelog_notify_t *cn, int fd)
 {
@@ -73,6 +427,14 @@ changelog_notify_fill_rset (changelog_notify_t *cn, fd_set *rset, int *maxfd)
         *maxfd = *maxfd + 1;
 }
 
+static void
+changelog_notify_drop_client (changelog_notify_t *cn, int i)
+{
+        close (cn->client_fd[i]);
+        changelog_notify_clear_fd (cn, i);
+        changelog_stream_reset (cn, i);
+}
+
 static int
 changelog_notify_client (changelog_notify_t *cn, char *path, ssize_t len)
 {
@@ -84,17 +446,31 @@ changelog_notify_client (changelog_notify_t *cn, char *path, ssize_t len)
                         continue;
 
                 if (changelog_write (cn->client_fd[i],
-                                     path, len)) {
+                                     path, len)
+                    || changelog_stream_resume (cn, i, path)) {
                         ret = -1;
 
-                        close (cn->client_fd[i]);
-                        changelog_notify_clear_fd (cn, i);
+                        changelog_notify_drop_client (cn, i);
                 }
         }
 
         return ret;
 }
 
+static void
+changelog_notify_stream (changelog_notify_t *cn)
+{
+        int i = 0;
+
+        for (; i < CHANGELOG_MAX_CLIENTS; i++) {
+                if (cn->client_fd[i] == -1)
+                        continue;
+
+                if (changelog_stream_flush (cn, i))
+                        changelog_notify_drop_client (cn, i);
+        }
+}
+
 static void
 changelog_notifier_init (changelog_notify_t *cn)
 {
@@ -116,8 +492,7 @@ changelog_close_client_conn (changelog_notify_t *cn)
                 if (cn->client_fd[i] == -1)
                         continue;
 
-                close (cn->client_fd[i]);
-                changelog_notify_clear_fd (cn, i);
+                changelog_notify_drop_client (cn, i);
         }
 }
 
@@ -273,6 +648,17 @@ changelog_notifier (void *data)
                                 goto process_rest;
                         }
 
+                        /**
+                         * records buffered for streaming clients (an empty
+                         * pathname is just a wakeup). This goes out before
+                         * the changelog is notified so that an OVERRUN is
+                         * seen ahead of the changelog with the dropped
+                         * records.
+                         */
+                        changelog_notify_stream (cn);
+                        if (readlen == 1)
+                                goto process_rest;
+
                         (void) snprintf (abspath, PATH_MAX,
                                          "%s/%s", priv->changelog_dir, path);
                         if (changelog_notify_client (cn, abspath,
@@ -290,12 +676,18 @@ changelog_notifier (void *data)
                         if (FD_ISSET (fd, &rset)) {
                                 /**
                                  * the only data we accept from the client is a
-                                 * disconnect. Anything else is treated as bogus
-                                 * and is silently discarded (also warned!!!).
+                                 * disconnect or a streaming request. Anything
+                                 * else is treated as bogus and is silently
+                                 * discarded (also warned!!!).
                                  */
                                 if ( (readlen = read (fd, &buffer, 1)) <= 0 ) {
-                                        close (fd);
-                                        changelog_notify_clear_fd (cn, i);
+                                        changelog_notify_drop_client (cn, i);
+                                } else if ((buffer == CHANGELOG_STREAM_SUBSCRIBE)
+                                           || (buffer == CHANGELOG_STREAM_ACK)) {
+                                        if (changelog_stream_request (cn, i,
+                                                                      buffer))
+                                                changelog_notify_drop_client
+                                                        (cn, i);
                                 } else {
                                         /* silently discard data and log */
                                         gf_log (this->name, GF_LOG_WARNING,
@@ -16,4 +16,19 @@
 void *
 changelog_notifier (void *data);
 
+void
+changelog_stream_publish (xlator_t *this,
+                          changelog_priv_t *priv, changelog_log_data_t *cld);
+
+void
+changelog_stream_publish_record (xlator_t *this, changelog_priv_t *priv,
+                                 char *record, size_t len);
+
+void
+changelog_stream_rollover (xlator_t *this,
+                           changelog_priv_t *priv, char *path);
+
+void
+changelog_stream_stop (xlator_t *this, changelog_priv_t *priv);
+
 #endif
@@ -19,6 +19,7 @@
 #include "iobuf.h"
 
 #include "changelog-rt.h"
+#include "changelog-buffered.h"
 #include "changelog-helpers.h"
 
 #include "changelog-encoders.h"
@@ -35,6 +36,11 @@ cb_bootstrap[] = {
                 .ctor = changelog_rt_init,
                 .dtor = changelog_rt_fini,
         },
+        {
+                .mode = CHANGELOG_MODE_BUFFERED,
+                .ctor = changelog_buffered_init,
+                .dtor = changelog_buffered_fini,
+        },
 };
 
 /* Entry operations - TYPE III */
@@ -1573,6 +1579,8 @@ changelog_assign_opmode (changelog_priv_t *priv, char *mode)
 {
         if ( strncmp (mode, "realtime", 8) == 0 ) {
                 priv->op_mode = CHANGELOG_MODE_RT;
+        } else if ( strncmp (mode, "buffered", 8) == 0 ) {
+                priv->op_mode = CHANGELOG_MODE_BUFFERED;
         }
 }
 
@@ -1583,6 +1591,8 @@ changelog_assign_encoding (changelog_priv_t *priv, char *enc)
                 priv->encode_mode = CHANGELOG_ENCODE_BINARY;
         } else if ( strncmp (enc, "ascii", 5) == 0 ) {
                 priv->encode_mode = CHANGELOG_ENCODE_ASCII;
+        } else if ( strncmp (enc, "indexed", 7) == 0 ) {
+                priv->encode_mode = CHANGELOG_ENCODE_INDEXED;
         }
 }
 
@@ -2116,6 +2126,7 @@ reconfigure (xlator_t *this, dict_t *options)
         char    csnap_dir[PATH_MAX]            = {0,};
         struct timeval          tv             = {0,};
         uint32_t                timeout        = 0;
+        gf_boolean_t            streaming_earlier = _gf_false;
 
         priv = this->private;
         if (!priv)
@@ -2146,6 +2157,12 @@ reconfigure (xlator_t *this, dict_t *options)
         CHANGELOG_FILL_HTIME_DIR(priv->changelog_dir, htime_dir);
         ret = mkdir_p (htime_dir, 0600, _gf_true);
 
+        if (ret)
+                goto out;
+
+        CHANGELOG_FILL_HTIME_INDEX_DIR(priv->changelog_dir, htime_dir);
+        ret = mkdir_p (htime_dir, 0600, _gf_true);
+
         if (ret)
                 goto out;
 
@@ -2180,6 +2197,15 @@ reconfigure (xlator_t *this, dict_t *options)
                           timeout, options, time, out);
         changelog_assign_barrier_timeout (priv, timeout);
 
+        streaming_earlier = priv->streaming;
+        GF_OPTION_RECONF ("streaming", priv->streaming, options, bool, out);
+        GF_OPTION_RECONF ("stream-buffer-size", priv->stream_buffer_size,
+                          options, size_uint64, out);
+        GF_OPTION_RECONF ("buffered-flush-interval",
+                          priv->buffered_flush_interval, options, int32, out);
+        if (streaming_earlier && !priv->streaming)
+                changelog_stream_stop (this, priv);
+
         if (active_now || active_earlier) {
                 ret = changelog_fill_rollover_data (&cld, !active_now);
                 if (ret)
@@ -2267,6 +2293,7 @@ init (xlator_t *this)
 
         LOCK_INIT (&priv->lock);
         LOCK_INIT (&priv->c_snap_lock);
+        LOCK_INIT (&priv->cn.stream_lock);
 
         GF_OPTION_INIT ("changelog-brick", tmp, str, out);
         if (!tmp) {
@@ -2303,6 +2330,12 @@ init (xlator_t *this)
 
         CHANGELOG_FILL_HTIME_DIR(priv->changelog_dir, htime_dir);
         ret = mkdir_p (htime_dir, 0600, _gf_true);
+
+        if (ret)
+                goto out;
+
+        CHANGELOG_FILL_HTIME_INDEX_DIR(priv->changelog_dir, htime_dir);
+        ret = mkdir_p (htime_dir, 0600, _gf_true);
         if (ret)
                 goto out;
 
@@ -2327,6 +2360,12 @@ init (xlator_t *this)
         GF_OPTION_INIT ("changelog-barrier-timeout", timeout, time, out);
         priv->timeout.tv_sec = timeout;
 
+        GF_OPTION_INIT ("streaming", priv->streaming, bool, out);
+        GF_OPTION_INIT ("stream-buffer-size",
+                        priv->stream_buffer_size, size_uint64, out);
+        GF_OPTION_INIT ("buffered-flush-interval",
+                        priv->buffered_flush_interval, int32, out);
+
         changelog_encode_change(priv);
 
         GF_ASSERT (cb_bootstrap[priv->op_mode].mode == priv->op_mode);
@@ -2338,6 +2377,7 @@ init (xlator_t *this)
                 goto out;
 
         priv->changelog_fd = -1;
+        priv->htime_idx_fd = -1;
 
         /* snap dependency changes */
         priv->dm.black_fop_cnt = 0;
@@ -2406,6 +2446,10 @@ fini (xlator_t *this)
                 mem_pool_destroy (this->local_pool);
                 GF_FREE (priv->changelog_brick);
                 GF_FREE (priv->changelog_dir);
+                GF_FREE (priv->ci.offsets);
+                if (priv->htime_idx_fd != -1)
+                        close (priv->htime_idx_fd);
+                LOCK_DESTROY (&priv->cn.stream_lock);
                 changelog_pthread_destroy (priv);
                 GF_FREE (priv);
         }
@@ -2457,14 +2501,20 @@ struct volume_options options[] = {
         {.key = {"op-mode"},
          .type = GF_OPTION_TYPE_STR,
          .default_value = "realtime",
-         .value = {"realtime"},
-         .description = "operation mode - futuristic operation modes"
+         .value = {"realtime", "buffered"},
+         .description = "operation mode. \"realtime\" writes each record "
+                        "out as the fop completes. \"buffered\" collects "
+                        "records per thread and has a writer thread merge "
+                        "them into the changelog (takes effect on brick "
+                        "restart)"
         },
         {.key = {"encoding"},
          .type = GF_OPTION_TYPE_STR,
          .default_value = "ascii",
-         .value = {"binary", "ascii"},
-         .description = "encoding type for changelogs"
+         .value = {"binary", "ascii", "indexed"},
+         .description = "encoding type for changelogs. \"indexed\" is the "
+                        "binary encoding with length prefixed records and an "
+                        "index of them at the end of each changelog."
         },
         {.key = {"rollover-time"},
          .default_value = "15",
@@ -2485,6 +2535,30 @@ struct volume_options options[] = {
                          "operations are no longer blocked and previously "
                          "blocked fops are allowed to go through"
         },
+        {.key = {"streaming"},
+         .type = GF_OPTION_TYPE_BOOL,
+         .default_value = "off",
+         .description = "send records to consumers subscribed on the "
+                        "notification socket as they are journalled, instead "
+                        "of them waiting for the changelog to roll over"
+        },
+        {.key = {"buffered-flush-interval"},
+         .type = GF_OPTION_TYPE_INT,
+         .min = 1,
+         .max = 10000,
+         .default_value = "50",
+         .description = "interval (in milliseconds) at which buffered records "
+                        "are written out in \"buffered\" op-mode"
+        },
+        {.key = {"stream-buffer-size"},
+         .type = GF_OPTION_TYPE_SIZET,
+         .min = 64 * GF_UNIT_KB,
+         .max = 1 * GF_UNIT_GB,
+         .default_value = "4MB",
+         .description = "records buffered for a streaming consumer that is "
+                        "slow to acknowledge. Beyond this the consumer falls "
+                        "back to changelog files until it catches up"
+        },
         {.key = {NULL}
         },
 };
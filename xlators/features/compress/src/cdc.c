@@ -96,6 +96,9 @@ cdc_readv (call_frame_t *frame, xlator_t *this,
 
 #ifdef HAVE_LIB_Z
         cbk = cdc_readv_cbk;
+        /* compresses the bytes of the reply */
+        if (xdata)
+                dict_del (xdata, GLUSTERFS_ZERO_COPY_READ);
 #else
         cbk = default_readv_cbk;
 #endif
@@ -52,6 +52,192 @@ worker_enqueue (xlator_t *this, call_stub_t *stub)
         pthread_mutex_unlock (&priv->mutex);
 }
 
+static struct list_head *
+__index_unlink_bucket (index_priv_t *priv, uuid_t gfid)
+{
+        uint32_t hash = 0;
+
+        memcpy (&hash, &gfid[12], sizeof (hash));
+        return &priv->unlink_hash[hash & (INDEX_UNLINK_HASH_SIZE - 1)];
+}
+
+static index_unlink_t *
+__index_unlink_find (index_priv_t *priv, uuid_t gfid)
+{
+        struct list_head *bucket = NULL;
+        index_unlink_t   *u = NULL;
+
+        bucket = __index_unlink_bucket (priv, gfid);
+        list_for_each_entry (u, bucket, hash) {
+                if (!uuid_compare (u->gfid, gfid))
+                        return u;
+        }
+
+        return NULL;
+}
+
+static gf_boolean_t
+index_unlink_pending (xlator_t *this, uuid_t gfid)
+{
+        index_priv_t     *priv = NULL;
+        gf_boolean_t      pending = _gf_false;
+
+        priv = this->private;
+        if (!priv->batch_window)
+                return _gf_false;
+
+        pthread_mutex_lock (&priv->mutex);
+        {
+                if (__index_unlink_find (priv, gfid))
+                        pending = _gf_true;
+        }
+        pthread_mutex_unlock (&priv->mutex);
+
+        return pending;
+}
+
+/* Drops the pending unlink of @gfid, if any; the index entry is then
+ * still in place. One already being unlinked is waited for, the entry
+ * being gone when it returns false. */
+static gf_boolean_t
+index_unlink_cancel (xlator_t *this, uuid_t gfid)
+{
+        index_priv_t     *priv = NULL;
+        index_unlink_t   *u = NULL;
+
+        priv = this->private;
+        if (!priv->batch_window)
+                return _gf_false;
+
+        pthread_mutex_lock (&priv->mutex);
+        {
+                while ((u = __index_unlink_find (priv, gfid)) &&
+                       u->unlinking)
+                        pthread_cond_wait (&priv->unlinked, &priv->mutex);
+                if (u) {
+                        list_del (&u->list);
+                        list_del (&u->hash);
+                }
+        }
+        pthread_mutex_unlock (&priv->mutex);
+
+        if (!u)
+                return _gf_false;
+
+        GF_FREE (u);
+        return _gf_true;
+}
+
+int
+index_del (xlator_t *this, uuid_t gfid, const char *subdir);
+
+/* Moves the entries whose window is over to @expired, all of them if
+ * @next is NULL. Returns whether some are left, @next being when the
+ * first one expires. The entries stay hashed, marked as unlinking, until
+ * index_unlinks_do() is done with them: an index_add of the same gfid
+ * waits for the unlink rather than having its link undone by it. */
+static gf_boolean_t
+__index_unlinks_expire (xlator_t *this, struct timespec *next,
+                        struct list_head *expired)
+{
+        index_priv_t     *priv = NULL;
+        index_unlink_t   *u = NULL;
+        struct timespec   now = {0, };
+
+        priv = this->private;
+        clock_gettime (CLOCK_REALTIME, &now);
+
+        while (!list_empty (&priv->unlinks)) {
+                u = list_entry (priv->unlinks.next, index_unlink_t, list);
+                if (next && ((u->expiry.tv_sec > now.tv_sec) ||
+                             ((u->expiry.tv_sec == now.tv_sec) &&
+                              (u->expiry.tv_nsec > now.tv_nsec)))) {
+                        *next = u->expiry;
+                        return _gf_true;
+                }
+
+                u->unlinking = _gf_true;
+                list_move_tail (&u->list, expired);
+        }
+
+        return _gf_false;
+}
+
+/* Unlinks the entries of __index_unlinks_expire(), without priv->mutex. */
+static void
+index_unlinks_do (xlator_t *this, struct list_head *expired)
+{
+        index_priv_t     *priv = NULL;
+        index_unlink_t   *u = NULL;
+        index_unlink_t   *tmp = NULL;
+
+        if (list_empty (expired))
+                return;
+
+        priv = this->private;
+
+        list_for_each_entry (u, expired, list)
+                index_del (this, u->gfid, XATTROP_SUBDIR);
+
+        pthread_mutex_lock (&priv->mutex);
+        {
+                list_for_each_entry_safe (u, tmp, expired, list) {
+                        list_del (&u->list);
+                        list_del (&u->hash);
+                        GF_FREE (u);
+                }
+                pthread_cond_broadcast (&priv->unlinked);
+        }
+        pthread_mutex_unlock (&priv->mutex);
+}
+
+/* Removes @gfid from the index once the batch window is over, unless a
+ * link of it comes in meanwhile: a file written to again and again with
+ * its pending xattrs going back to zero in between then stays linked,
+ * instead of being unlinked and linked once per transaction. */
+static int
+index_del_deferred (xlator_t *this, uuid_t gfid)
+{
+        index_priv_t     *priv = NULL;
+        index_unlink_t   *u = NULL;
+        uint32_t          window = 0;
+
+        priv = this->private;
+        window = priv->batch_window;
+        if (!window || uuid_is_null (gfid))
+                return index_del (this, gfid, XATTROP_SUBDIR);
+
+        u = GF_CALLOC (1, sizeof (*u), gf_index_mt_unlink_t);
+        if (!u)
+                return index_del (this, gfid, XATTROP_SUBDIR);
+
+        uuid_copy (u->gfid, gfid);
+        clock_gettime (CLOCK_REALTIME, &u->expiry);
+        u->expiry.tv_sec += window / 1000;
+        u->expiry.tv_nsec += (window % 1000) * 1000000;
+        if (u->expiry.tv_nsec >= 1000000000) {
+                u->expiry.tv_sec++;
+                u->expiry.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock (&priv->mutex);
+        {
+                if (__index_unlink_find (priv, gfid)) {
+                        GF_FREE (u);
+                        u = NULL;
+                } else {
+                        if (list_empty (&priv->unlinks))
+                                pthread_cond_signal (&priv->cond);
+                        list_add_tail (&u->list, &priv->unlinks);
+                        list_add (&u->hash, __index_unlink_bucket (priv,
+                                                                   gfid));
+                }
+        }
+        pthread_mutex_unlock (&priv->mutex);
+
+        return 0;
+}
+
 void *
 index_worker (void *data)
 {
@@ -59,23 +245,39 @@ index_worker (void *data)
         xlator_t         *this = NULL;
         call_stub_t      *stub = NULL;
         int               ret = 0;
+        gf_boolean_t      pending = _gf_false;
+        struct timespec   next = {0, };
+        struct list_head  expired;
 
         THIS = data;
         this = data;
         priv = this->private;
+        INIT_LIST_HEAD (&expired);
 
         for (;;) {
                 pthread_mutex_lock (&priv->mutex);
                 {
-                        while (list_empty (&priv->callstubs)) {
-                                ret = pthread_cond_wait (&priv->cond,
-                                                         &priv->mutex);
+                        pending = __index_unlinks_expire (this, &next,
+                                                          &expired);
+                        while (list_empty (&priv->callstubs) &&
+                               list_empty (&expired)) {
+                                if (pending)
+                                        ret = pthread_cond_timedwait
+                                                (&priv->cond, &priv->mutex,
+                                                 &next);
+                                else
+                                        ret = pthread_cond_wait (&priv->cond,
+                                                                 &priv->mutex);
+                                pending = __index_unlinks_expire (this, &next,
+                                                                  &expired);
                         }
 
                         stub = __index_dequeue (&priv->callstubs);
                 }
                 pthread_mutex_unlock (&priv->mutex);
 
+                index_unlinks_do (this, &expired);
+
                 if (stub) /* guard against spurious wakeups */
                         call_resume (stub);
         }
@@ -267,6 +469,18 @@ check_delete_stale_index_file (xlator_t *this, char *filename)
                 unlink (filepath);
 }
 
+/* entries on their way out of the index are not listed */
+static gf_boolean_t
+index_name_unlink_pending (xlator_t *this, const char *name)
+{
+        uuid_t gfid = {0, };
+
+        if (uuid_parse (name, gfid))
+                return _gf_false;
+
+        return index_unlink_pending (this, gfid);
+}
+
 static int
 index_fill_readdir (fd_t *fd, DIR *dir, off_t off,
                     size_t size, gf_dirent_t *entries)
@@ -317,6 +531,9 @@ index_fill_readdir (fd_t *fd, DIR *dir, off_t off,
                         continue;
                 }
 
+                if (index_name_unlink_pending (this, entry->d_name))
+                        continue;
+
                 this_size = max (sizeof (gf_dirent_t),
                                  sizeof (gfs3_dirplist))
                         + strlen (entry->d_name) + 1;
@@ -471,13 +688,16 @@ _index_action (xlator_t *this, inode_t *inode, gf_boolean_t zero_xattr)
         if (zero_xattr) {
                 if (ctx->state == NOTIN)
                         goto out;
-                ret = index_del (this, inode->gfid, XATTROP_SUBDIR);
+                ret = index_del_deferred (this, inode->gfid);
                 if (!ret)
                         ctx->state = NOTIN;
         } else {
                 if (ctx->state == IN)
                         goto out;
-                ret = index_add (this, inode->gfid, XATTROP_SUBDIR);
+                if (index_unlink_cancel (this, inode->gfid))
+                        ret = 0;
+                else
+                        ret = index_add (this, inode->gfid, XATTROP_SUBDIR);
                 if (!ret)
                         ctx->state = IN;
         }
@@ -626,6 +846,9 @@ unlock:
                 } else if (new->fop == GF_FOP_FXATTROP) {
                         INDEX_STACK_UNWIND (fxattrop, frame, -1, ENOMEM,
                                             NULL, NULL);
+                } else if (new->fop == GF_FOP_WRITE) {
+                        INDEX_STACK_UNWIND (writev, frame, -1, ENOMEM,
+                                            NULL, NULL, NULL);
                 }
                 call_stub_destroy (new);
         } else if (stub) {
@@ -751,6 +974,83 @@ out:
         return 0;
 }
 
+/* A writev can carry the changelog xattrop of its transaction (see
+   GLUSTERFS_WRITE_XATTROP), applied by posix along with the write: it is
+   tracked just as the fxattrop it stands for.
+*/
+int32_t
+index_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+        inode_t *inode = NULL;
+        data_t  *data  = NULL;
+        dict_t  *xattr = NULL;
+
+        inode = inode_ref (frame->local);
+
+        if (xdata)
+                data = dict_get (xdata, GLUSTERFS_WRITE_XATTROP);
+        if (!data)
+                goto out;
+
+        xattr = dict_new ();
+        if (!xattr)
+                goto out;
+
+        if (!dict_unserialize (data->data, data->len, &xattr))
+                fop_fxattrop_index_action (this, frame->local, xattr);
+
+        dict_unref (xattr);
+out:
+        INDEX_STACK_UNWIND (writev, frame, op_ret, op_errno, prebuf, postbuf,
+                            xdata);
+        index_queue_process (this, inode, NULL);
+        inode_unref (inode);
+
+        return 0;
+}
+
+int
+index_writev_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      struct iovec *vector, int32_t count, off_t offset,
+                      uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        _index_action (this, frame->local, _gf_false);
+        STACK_WIND (frame, index_writev_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->writev, fd, vector, count,
+                    offset, flags, iobref, xdata);
+        return 0;
+}
+
+int32_t
+index_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              struct iovec *vector, int32_t count, off_t offset,
+              uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        call_stub_t    *stub = NULL;
+
+        if (!xdata || !dict_get (xdata, GLUSTERFS_WRITE_XATTROP))
+                goto out;
+
+        frame->local = inode_ref (fd->inode);
+        stub = fop_writev_stub (frame, index_writev_wrapper, fd, vector,
+                                count, offset, flags, iobref, xdata);
+        if (!stub) {
+                INDEX_STACK_UNWIND (writev, frame, -1, ENOMEM, NULL, NULL,
+                                    NULL);
+                return 0;
+        }
+
+        index_queue_process (this, fd->inode, stub);
+        return 0;
+out:
+        STACK_WIND (frame, default_writev_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->writev, fd, vector, count,
+                    offset, flags, iobref, xdata);
+        return 0;
+}
+
 uint64_t
 index_entry_count (xlator_t *this, char *subdir)
 {
@@ -778,6 +1078,8 @@ index_entry_count (xlator_t *this, char *subdir)
 			continue;
                 if (!strncmp (entry->d_name, subdir, strlen (subdir)))
 			continue;
+                if (index_name_unlink_pending (this, entry->d_name))
+                        continue;
 		count++;
 	}
 	closedir (dirp);
@@ -937,6 +1239,135 @@ done:
         return 0;
 }
 
+static void
+index_readdirp_unwind (call_frame_t *frame)
+{
+        index_readdirp_local_t *local = NULL;
+
+        local = frame->local;
+        frame->local = NULL;
+
+        STACK_UNWIND_STRICT (readdirp, frame, local->op_ret, local->op_errno,
+                             &local->entries, NULL);
+
+        gf_dirent_free (&local->entries);
+        LOCK_DESTROY (&local->lock);
+        GF_FREE (local);
+}
+
+int32_t
+index_readdirp_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno, inode_t *inode,
+                           struct iatt *buf, dict_t *xattr,
+                           struct iatt *postparent)
+{
+        index_readdirp_local_t *local = NULL;
+        gf_dirent_t            *entry = NULL;
+        int                     count = 0;
+
+        local = frame->local;
+        entry = cookie;
+
+        /* entries whose file is gone are still listed, without xattrs, so
+           that the self-heal daemon purges them */
+        if (op_ret == 0) {
+                entry->d_stat = *buf;
+                if (xattr)
+                        entry->dict = dict_ref (xattr);
+        }
+
+        LOCK (&local->lock);
+        {
+                count = --local->count;
+        }
+        UNLOCK (&local->lock);
+
+        if (count == 0)
+                index_readdirp_unwind (frame);
+
+        return 0;
+}
+
+/* Lists the index along with the xattrs asked for in @xdata (typically the
+ * pending xattrs) of each entry, which saves the self-heal daemon a lookup
+ * per entry to find out what is still to be healed. */
+int32_t
+index_readdirp_wrapper (call_frame_t *frame, xlator_t *this,
+                        fd_t *fd, size_t size, off_t off, dict_t *xdata)
+{
+        index_readdirp_local_t *local = NULL;
+        index_fd_ctx_t         *fctx = NULL;
+        gf_dirent_t            *entry = NULL;
+        int                     ret = -1;
+        int                     count = 0;
+        loc_t                   loc = {0, };
+
+        local = GF_CALLOC (1, sizeof (*local), gf_index_mt_readdirp_local_t);
+        if (!local) {
+                STACK_UNWIND_STRICT (readdirp, frame, -1, ENOMEM, NULL, NULL);
+                return 0;
+        }
+        LOCK_INIT (&local->lock);
+        INIT_LIST_HEAD (&local->entries.list);
+        frame->local = local;
+
+        ret = index_fd_ctx_get (fd, this, &fctx);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                local->op_ret = -1;
+                local->op_errno = -ret;
+                goto unwind;
+        }
+
+        if (!fctx->dir) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dir is NULL for fd=%p", fd);
+                local->op_ret = -1;
+                local->op_errno = EINVAL;
+                goto unwind;
+        }
+
+        local->op_ret = index_fill_readdir (fd, fctx->dir, off, size,
+                                           &local->entries);
+        /* pick ENOENT to indicate EOF */
+        local->op_errno = errno;
+
+        list_for_each_entry (entry, &local->entries.list, list) {
+                if (!uuid_parse (entry->d_name, entry->d_stat.ia_gfid))
+                        count++;
+        }
+        if (!count)
+                goto unwind;
+
+        /* one more, so that the lookups answered right away don't unwind
+           before all of them are wound */
+        local->count = count + 1;
+        list_for_each_entry (entry, &local->entries.list, list) {
+                if (uuid_is_null (entry->d_stat.ia_gfid))
+                        continue;
+                uuid_copy (loc.gfid, entry->d_stat.ia_gfid);
+                loc.inode = inode_new (fd->inode->table);
+                STACK_WIND_COOKIE (frame, index_readdirp_lookup_cbk, entry,
+                                   FIRST_CHILD (this),
+                                   FIRST_CHILD (this)->fops->lookup, &loc,
+                                   xdata);
+                loc_wipe (&loc);
+        }
+
+        LOCK (&local->lock);
+        {
+                count = --local->count;
+        }
+        UNLOCK (&local->lock);
+
+        if (count)
+                return 0;
+unwind:
+        index_readdirp_unwind (frame);
+        return 0;
+}
+
 int
 index_unlink_wrapper (call_frame_t *frame, xlator_t *this, loc_t *loc, int flag,
                       dict_t *xdata)
@@ -965,6 +1396,7 @@ index_unlink_wrapper (call_frame_t *frame, xlator_t *this, loc_t *loc, int flag,
         uuid_copy (preparent.ia_gfid, priv->xattrop_vgfid);
         preparent.ia_ino = -1;
         uuid_parse (loc->name, gfid);
+        index_unlink_cancel (this, gfid);
         ret = index_del (this, gfid, XATTROP_SUBDIR);
         if (ret < 0) {
                 op_ret = -1;
@@ -1066,6 +1498,30 @@ out:
         return 0;
 }
 
+int32_t
+index_readdirp (call_frame_t *frame, xlator_t *this,
+                fd_t *fd, size_t size, off_t off, dict_t *xdata)
+{
+        call_stub_t     *stub = NULL;
+        index_priv_t    *priv = NULL;
+
+        priv = this->private;
+        if (uuid_compare (fd->inode->gfid, priv->xattrop_vgfid))
+                goto out;
+        stub = fop_readdirp_stub (frame, index_readdirp_wrapper, fd, size, off,
+                                  xdata);
+        if (!stub) {
+                STACK_UNWIND_STRICT (readdirp, frame, -1, ENOMEM, NULL, NULL);
+                return 0;
+        }
+        worker_enqueue (this, stub);
+        return 0;
+out:
+        STACK_WIND (frame, default_readdirp_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->readdirp, fd, size, off, xdata);
+        return 0;
+}
+
 int
 index_unlink (call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
               dict_t *xdata)
@@ -1105,11 +1561,13 @@ int
 init (xlator_t *this)
 {
         int ret = -1;
+        int i = 0;
         index_priv_t *priv = NULL;
         pthread_t thread;
         pthread_attr_t  w_attr;
         gf_boolean_t    mutex_inited = _gf_false;
         gf_boolean_t    cond_inited  = _gf_false;
+        gf_boolean_t    unlinked_inited = _gf_false;
         gf_boolean_t    attr_inited  = _gf_false;
 
 	if (!this->children || this->children->next) {
@@ -1135,6 +1593,13 @@ init (xlator_t *this)
         }
         cond_inited = _gf_true;
 
+        if ((ret = pthread_cond_init(&priv->unlinked, NULL)) != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pthread_cond_init failed (%d)", ret);
+                goto out;
+        }
+        unlinked_inited = _gf_true;
+
         if ((ret = pthread_mutex_init(&priv->mutex, NULL)) != 0) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "pthread_mutex_init failed (%d)", ret);
@@ -1155,9 +1620,13 @@ init (xlator_t *this)
                         "Using default thread stack size");
         }
         GF_OPTION_INIT ("index-base", priv->index_basepath, path, out);
+        GF_OPTION_INIT ("batch-window", priv->batch_window, uint32, out);
         uuid_generate (priv->index);
         uuid_generate (priv->xattrop_vgfid);
         INIT_LIST_HEAD (&priv->callstubs);
+        INIT_LIST_HEAD (&priv->unlinks);
+        for (i = 0; i < INDEX_UNLINK_HASH_SIZE; i++)
+                INIT_LIST_HEAD (&priv->unlink_hash[i]);
 
         this->private = priv;
 
@@ -1177,6 +1646,8 @@ out:
         if (ret) {
                 if (cond_inited)
                         pthread_cond_destroy (&priv->cond);
+                if (unlinked_inited)
+                        pthread_cond_destroy (&priv->unlinked);
                 if (mutex_inited)
                         pthread_mutex_destroy (&priv->mutex);
                 if (priv)
@@ -1192,13 +1663,22 @@ void
 fini (xlator_t *this)
 {
         index_priv_t *priv = NULL;
+        struct list_head expired;
 
         priv = this->private;
         if (!priv)
                 goto out;
+        INIT_LIST_HEAD (&expired);
+        pthread_mutex_lock (&priv->mutex);
+        {
+                __index_unlinks_expire (this, NULL, &expired);
+        }
+        pthread_mutex_unlock (&priv->mutex);
+        index_unlinks_do (this, &expired);
         this->private = NULL;
         LOCK_DESTROY (&priv->lock);
         pthread_cond_destroy (&priv->cond);
+        pthread_cond_destroy (&priv->unlinked);
         pthread_mutex_destroy (&priv->mutex);
         GF_FREE (priv);
 out:
@@ -1263,11 +1743,13 @@ notify (xlator_t *this, int event, void *data, ...)
 struct xlator_fops fops = {
 	.xattrop     = index_xattrop,
 	.fxattrop    = index_fxattrop,
+        .writev      = index_writev,
 
         //interface functions follow
         .getxattr    = index_getxattr,
         .lookup      = index_lookup,
         .readdir     = index_readdir,
+        .readdirp    = index_readdirp,
         .unlink      = index_unlink
 };
 
@@ -1284,5 +1766,16 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_PATH,
           .description = "path where the index files need to be stored",
         },
+        { .key  = {"batch-window"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60000,
+          .default_value = "1000",
+          .description = "time in milliseconds an entry whose pending "
+                         "xattrs went back to zero stays in the index, so "
+                         "that it is not unlinked and linked again by the "
+                         "next transaction on the file. 0 removes it right "
+                         "away."
+        },
         { .key  = {NULL} },
 };
@@ -36,6 +36,28 @@ typedef struct index_fd_ctx {
         DIR *dir;
 } index_fd_ctx_t;
 
+#define INDEX_UNLINK_HASH_SIZE    1024
+
+/* removal of a gfid from the xattrop index held back for the batch window,
+   a link of the same gfid coming in meanwhile cancels it out */
+typedef struct index_unlink {
+        struct list_head list; /* in expiry order */
+        struct list_head hash;
+        uuid_t           gfid;
+        struct timespec  expiry;
+        gf_boolean_t     unlinking; /* being unlinked, out of the mutex */
+} index_unlink_t;
+
+/* readdirp of the xattrop index, waiting for the lookups which fetch the
+   xattrs of the entries */
+typedef struct index_readdirp_local {
+        gf_lock_t    lock;
+        int          count;
+        int32_t      op_ret;
+        int32_t      op_errno;
+        gf_dirent_t  entries;
+} index_readdirp_local_t;
+
 typedef struct index_priv {
         char *index_basepath;
         uuid_t index;
@@ -44,6 +66,10 @@ typedef struct index_priv {
         struct list_head callstubs;
         pthread_mutex_t mutex;
         pthread_cond_t  cond;
+        pthread_cond_t  unlinked; /* an unlinking entry went away */
+        uint32_t batch_window; /* msecs, 0 to unlink right away */
+        struct list_head unlinks; /* under mutex */
+        struct list_head unlink_hash[INDEX_UNLINK_HASH_SIZE];
 } index_priv_t;
 
 #define INDEX_STACK_UNWIND(fop, frame, params ...)      \
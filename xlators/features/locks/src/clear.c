@@ -239,7 +239,7 @@ blkd:
                                 continue;
 
                         bcount++;
-                        list_del_init (&ilock->blocked_locks);
+                        __unblock_inode_lock (dom, ilock);
                         list_add (&ilock->blocked_locks, &released);
                 }
         }
@@ -273,7 +273,7 @@ granted:
                                 continue;
 
                         gcount++;
-                        list_del_init (&ilock->list);
+                        __delete_inode_lock (ilock);
                         list_add (&ilock->list, &released);
                 }
         }
@@ -23,6 +23,7 @@
 #include "inode.h"
 #include "logging.h"
 #include "common-utils.h"
+#include "hashfn.h"
 
 #include "locks.h"
 #include "common.h"
@@ -36,8 +37,69 @@ static int
 pl_send_prelock_unlock (xlator_t *this, pl_inode_t *pl_inode,
                         posix_lock_t *old_lock);
 
+/* Returns the interned copy of @volume, with a ref */
+static pl_domain_name_t *
+pl_domain_name_get (xlator_t *this, const char *volume)
+{
+        posix_locks_private_t *priv    = NULL;
+        pl_domain_name_t      *id      = NULL;
+        struct list_head      *bucket  = NULL;
+        uint32_t               hashval = 0;
+        size_t                 len     = 0;
+
+        priv = this->private;
+
+        len = strlen (volume);
+        hashval = SuperFastHash (volume, len);
+        bucket = &priv->domains[hashval % PL_DOMAIN_HASH_SIZE];
+
+        pthread_mutex_lock (&priv->domain_lock);
+        {
+                list_for_each_entry (id, bucket, hash) {
+                        if ((id->hashval == hashval) &&
+                            (strcmp (id->name, volume) == 0))
+                                goto found;
+                }
+
+                id = GF_CALLOC (1, sizeof (*id) + len + 1,
+                                gf_locks_mt_pl_domain_name_t);
+                if (!id)
+                        goto unlock;
+
+                id->hashval = hashval;
+                memcpy (id->name, volume, len + 1);
+                list_add (&id->hash, bucket);
+found:
+                id->ref++;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->domain_lock);
+
+        return id;
+}
+
+void
+pl_domain_name_put (xlator_t *this, pl_domain_name_t *id)
+{
+        posix_locks_private_t *priv = NULL;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->domain_lock);
+        {
+                if (--id->ref == 0)
+                        list_del_init (&id->hash);
+                else
+                        id = NULL;
+        }
+        pthread_mutex_unlock (&priv->domain_lock);
+
+        GF_FREE (id);
+}
+
+/* The domain takes over the ref on @id */
 static pl_dom_list_t *
-__allocate_domain (const char *volume)
+__allocate_domain (pl_domain_name_t *id)
 {
         pl_dom_list_t *dom = NULL;
 
@@ -46,9 +108,8 @@ __allocate_domain (const char *volume)
         if (!dom)
                 goto out;
 
-        dom->domain = gf_strdup(volume);
-        if (!dom->domain)
-                goto out;
+        dom->id = id;
+        dom->domain = id->name;
 
         gf_log ("posix-locks", GF_LOG_TRACE,
                 "New domain allocated: %s", dom->domain);
@@ -60,11 +121,6 @@ __allocate_domain (const char *volume)
         INIT_LIST_HEAD (&dom->blocked_inodelks);
 
 out:
-        if (dom && (NULL == dom->domain)) {
-                GF_FREE (dom);
-                dom = NULL;
-        }
-
         return dom;
 }
 
@@ -72,26 +128,60 @@ out:
  * allocates a domain and returns it
  */
 pl_dom_list_t *
-get_domain (pl_inode_t *pl_inode, const char *volume)
+get_domain (xlator_t *this, pl_inode_t *pl_inode, const char *volume)
 {
-        pl_dom_list_t *dom = NULL;
+        pl_dom_list_t    *dom   = NULL;
+        pl_dom_list_t    *tmp   = NULL;
+        pl_domain_name_t *id    = NULL;
 
         GF_VALIDATE_OR_GOTO ("posix-locks", pl_inode, out);
         GF_VALIDATE_OR_GOTO ("posix-locks", volume, out);
 
+        /* a domain the inode already has is found without interning
+           @volume: by address if it is the interned name itself (as held
+           by the locks), by name otherwise (as sent by the clients) */
+        pthread_mutex_lock (&pl_inode->mutex);
+        {
+                list_for_each_entry (tmp, &pl_inode->dom_list, inode_list) {
+                        if (tmp->domain == volume ||
+                            strcmp (tmp->domain, volume) == 0) {
+                                dom = tmp;
+                                break;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&pl_inode->mutex);
+        if (dom)
+                goto out;
+
+        id = pl_domain_name_get (this, volume);
+        if (!id)
+                goto out;
+
         pthread_mutex_lock (&pl_inode->mutex);
         {
-                list_for_each_entry (dom, &pl_inode->dom_list, inode_list) {
-                        if (strcmp (dom->domain, volume) == 0)
+                list_for_each_entry (tmp, &pl_inode->dom_list, inode_list) {
+                        if (tmp->id == id) {
+                                dom = tmp;
+                                /* most recently used first */
+                                list_move (&dom->inode_list,
+                                           &pl_inode->dom_list);
                                 goto unlock;
+                        }
                 }
 
-                dom = __allocate_domain (volume);
-                if (dom)
+                dom = __allocate_domain (id);
+                if (dom) {
                         list_add (&dom->inode_list, &pl_inode->dom_list);
+                        id = NULL;
+                }
         }
 unlock:
         pthread_mutex_unlock (&pl_inode->mutex);
+
+        if (id)
+                pl_domain_name_put (this, id);
+
         if (dom) {
                 gf_log ("posix-locks", GF_LOG_TRACE, "Domain %s found", volume);
         } else {
@@ -101,6 +191,34 @@ out:
         return dom;
 }
 
+/* Account a granted lock in @histogram: @blkd_time is NULL if it was
+ * granted without waiting */
+void
+pl_update_latency (xlator_t *this, uint64_t *histogram,
+                   struct timeval *blkd_time, struct timeval *granted_time)
+{
+        posix_locks_private_t *priv   = NULL;
+        int64_t                usec   = 0;
+        int                    bucket = 0;
+
+        priv = this->private;
+
+        if (blkd_time) {
+                usec = (granted_time->tv_sec - blkd_time->tv_sec) * 1000000
+                       + (granted_time->tv_usec - blkd_time->tv_usec);
+
+                for (bucket = 1; (usec >= 2) &&
+                             (bucket < PL_LATENCY_BUCKETS - 1); bucket++)
+                        usec >>= 1;
+        }
+
+        pthread_mutex_lock (&priv->latency_lock);
+        {
+                histogram[bucket]++;
+        }
+        pthread_mutex_unlock (&priv->latency_lock);
+}
+
 unsigned long
 fd_to_fdnum (fd_t *fd)
 {
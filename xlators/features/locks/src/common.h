@@ -64,7 +64,14 @@ void __delete_lock (pl_inode_t *, posix_lock_t *);
 void __destroy_lock (posix_lock_t *);
 
 pl_dom_list_t *
-get_domain (pl_inode_t *pl_inode, const char *volume);
+get_domain (xlator_t *this, pl_inode_t *pl_inode, const char *volume);
+
+void
+pl_domain_name_put (xlator_t *this, pl_domain_name_t *id);
+
+void
+pl_update_latency (xlator_t *this, uint64_t *histogram,
+                   struct timeval *blkd_time, struct timeval *granted_time);
 
 void
 grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
@@ -73,6 +80,9 @@ grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
 void
 __delete_inode_lock (pl_inode_lock_t *lock);
 
+void
+__unblock_inode_lock (pl_dom_list_t *dom, pl_inode_lock_t *lock);
+
 void
 __pl_inodelk_unref (pl_inode_lock_t *lock);
 
@@ -336,13 +336,19 @@ __lock_entrylk (xlator_t *this, pl_inode_t *pinode, pl_entry_lock_t *lock,
         pl_entry_lock_t *conf = NULL;
         int              ret  = -EAGAIN;
 
+        /* Nothing granted nor waiting in the domain: grant it */
+        if (list_empty (&dom->entrylk_list) &&
+            list_empty (&dom->blocked_entrylks))
+                goto grant;
+
         conf = __entrylk_grantable (dom, lock);
         if (conf) {
                 ret = -EAGAIN;
                 if (nonblock)
                         goto out;
 
-                gettimeofday (&lock->blkd_time, NULL);
+                if (!lock->blkd_time.tv_sec)
+                        gettimeofday (&lock->blkd_time, NULL);
                 list_add_tail (&lock->blocked_locks, &dom->blocked_entrylks);
 
                 gf_log (this->name, GF_LOG_TRACE,
@@ -357,7 +363,8 @@ __lock_entrylk (xlator_t *this, pl_inode_t *pinode, pl_entry_lock_t *lock,
                 if (nonblock)
                         goto out;
 
-                gettimeofday (&lock->blkd_time, NULL);
+                if (!lock->blkd_time.tv_sec)
+                        gettimeofday (&lock->blkd_time, NULL);
                 list_add_tail (&lock->blocked_locks, &dom->blocked_entrylks);
 
                 gf_log (this->name, GF_LOG_DEBUG,
@@ -369,6 +376,7 @@ __lock_entrylk (xlator_t *this, pl_inode_t *pinode, pl_entry_lock_t *lock,
                 goto out;
         }
 
+grant:
         __pl_entrylk_ref (lock);
         gettimeofday (&lock->granted_time, NULL);
         list_add (&lock->domain_list, &dom->entrylk_list);
@@ -474,9 +482,12 @@ void
 grant_blocked_entry_locks (xlator_t *this, pl_inode_t *pl_inode,
 			   pl_dom_list_t *dom)
 {
-        struct list_head  granted_list;
-        pl_entry_lock_t  *tmp = NULL;
-        pl_entry_lock_t  *lock = NULL;
+        struct list_head       granted_list;
+        pl_entry_lock_t       *tmp = NULL;
+        pl_entry_lock_t       *lock = NULL;
+        posix_locks_private_t *priv = NULL;
+
+        priv = this->private;
 
         INIT_LIST_HEAD (&granted_list);
 
@@ -492,6 +503,9 @@ grant_blocked_entry_locks (xlator_t *this, pl_inode_t *pl_inode,
                                    lock->basename, ENTRYLK_LOCK, lock->type,
                                    0, 0);
 
+                pl_update_latency (this, priv->entrylk_latency,
+                                   &lock->blkd_time, &lock->granted_time);
+
                 STACK_UNWIND_STRICT (entrylk, lock->frame, 0, 0, NULL);
 		lock->frame = NULL;
 	}
@@ -530,6 +544,9 @@ pl_common_entrylk (call_frame_t *frame, xlator_t *this,
         pl_ctx_t        *ctx              =  NULL;
 	int              nonblock         =  0;
         gf_boolean_t     need_inode_unref =  _gf_false;
+        posix_locks_private_t *priv       =  NULL;
+
+        priv = this->private;
 
         if (xdata)
                 dict_ret = dict_get_str (xdata, "connection-id", &conn_id);
@@ -549,7 +566,7 @@ pl_common_entrylk (call_frame_t *frame, xlator_t *this,
 		}
 	}
 
-        dom = get_domain (pinode, volume);
+        dom = get_domain (this, pinode, volume);
         if (!dom){
                 op_errno = ENOMEM;
                 goto out;
@@ -624,6 +641,10 @@ pl_common_entrylk (call_frame_t *frame, xlator_t *this,
                 pthread_mutex_unlock (&pinode->mutex);
 		if (ctx)
 			pthread_mutex_unlock (&ctx->lock);
+
+                if (op_ret == 0)
+                        pl_update_latency (this, priv->entrylk_latency,
+                                           NULL, NULL);
 		break;
 
         case ENTRYLK_UNLOCK:
@@ -823,7 +844,7 @@ pl_entrylk_client_cleanup (xlator_t *this, pl_ctx_t *ctx)
 
 		pinode = l->pinode;
 
-		dom = get_domain (pinode, l->volume);
+		dom = get_domain (this, pinode, l->volume);
 
 		grant_blocked_entry_locks (this, pinode, dom);
 
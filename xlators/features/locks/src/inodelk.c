@@ -19,6 +19,8 @@
 #include "logging.h"
 #include "common-utils.h"
 #include "list.h"
+#include "defaults.h"
+#include "upcall-utils.h"
 
 #include "locks.h"
 #include "common.h"
@@ -26,9 +28,37 @@
 inline void
 __delete_inode_lock (pl_inode_lock_t *lock)
 {
+        if (lock->dom && !list_empty (&lock->list))
+                pl_itree_remove (&lock->dom->inodelk_tree, &lock->node);
         list_del_init (&lock->list);
 }
 
+static void
+__insert_inode_lock (pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+        list_add (&lock->list, &dom->inodelk_list);
+        pl_itree_insert (&dom->inodelk_tree, &lock->node, lock->fl_start,
+                         lock->fl_end);
+}
+
+static void
+__block_inode_lock (pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+        /* keep the time it first blocked, if granting it failed again */
+        if (!lock->blkd_time.tv_sec)
+                gettimeofday (&lock->blkd_time, NULL);
+        list_add_tail (&lock->blocked_locks, &dom->blocked_inodelks);
+        pl_itree_insert (&dom->blocked_tree, &lock->blocked_node,
+                         lock->fl_start, lock->fl_end);
+}
+
+void
+__unblock_inode_lock (pl_dom_list_t *dom, pl_inode_lock_t *lock)
+{
+        pl_itree_remove (&dom->blocked_tree, &lock->blocked_node);
+        list_del_init (&lock->blocked_locks);
+}
+
 static inline void
 __pl_inodelk_ref (pl_inode_lock_t *lock)
 {
@@ -41,7 +71,7 @@ __pl_inodelk_unref (pl_inode_lock_t *lock)
         lock->ref--;
         if (!lock->ref) {
                 GF_FREE (lock->connection_id);
-                GF_FREE (lock);
+                mem_put (lock);
         }
 }
 
@@ -111,14 +141,6 @@ pl_print_inodelk (char *str, int size, int cmd, struct gf_flock *flock, const ch
                   (unsigned long long) flock->l_pid);
 }
 
-/* Determine if the two inodelks overlap reach other's lock regions */
-static int
-inodelk_overlap (pl_inode_lock_t *l1, pl_inode_lock_t *l2)
-{
-        return ((l1->fl_end >= l2->fl_start) &&
-                (l2->fl_end >= l1->fl_start));
-}
-
 /* Returns true if the 2 inodelks have the same owner */
 static inline int
 same_inodelk_owner (pl_inode_lock_t *l1, pl_inode_lock_t *l2)
@@ -127,51 +149,57 @@ same_inodelk_owner (pl_inode_lock_t *l1, pl_inode_lock_t *l2)
                 (l1->client == l2->client));
 }
 
-/* Returns true if the 2 inodelks conflict with each other */
+/* The searches in the trees only get overlapping locks */
+static int
+__granted_inodelk_conflict (pl_itree_node_t *node, void *data)
+{
+        pl_inode_lock_t *l    = NULL;
+        pl_inode_lock_t *lock = data;
+
+        l = pl_itree_entry (node, pl_inode_lock_t, node);
+
+        return (inodelk_type_conflict (lock, l) &&
+                !same_inodelk_owner (lock, l));
+}
+
 static int
-inodelk_conflict (pl_inode_lock_t *l1, pl_inode_lock_t *l2)
+__blocked_inodelk_conflict (pl_itree_node_t *node, void *data)
 {
-        return (inodelk_overlap (l1, l2) &&
-                inodelk_type_conflict (l1, l2));
+        pl_inode_lock_t *l    = NULL;
+        pl_inode_lock_t *lock = data;
+
+        l = pl_itree_entry (node, pl_inode_lock_t, blocked_node);
+
+        return inodelk_type_conflict (lock, l);
 }
 
 /* Determine if lock is grantable or not */
 static pl_inode_lock_t *
 __inodelk_grantable (pl_dom_list_t *dom, pl_inode_lock_t *lock)
 {
-        pl_inode_lock_t *l = NULL;
-        pl_inode_lock_t *ret = NULL;
-        if (list_empty (&dom->inodelk_list))
-                goto out;
-        list_for_each_entry (l, &dom->inodelk_list, list){
-                if (inodelk_conflict (lock, l) &&
-                    !same_inodelk_owner (lock, l)) {
-                        ret = l;
-                        goto out;
-                }
-        }
-out:
-        return ret;
+        pl_itree_node_t *node = NULL;
+
+        node = pl_itree_search (dom->inodelk_tree, lock->fl_start,
+                                lock->fl_end, __granted_inodelk_conflict,
+                                lock);
+        if (!node)
+                return NULL;
+
+        return pl_itree_entry (node, pl_inode_lock_t, node);
 }
 
 static pl_inode_lock_t *
 __blocked_lock_conflict (pl_dom_list_t *dom, pl_inode_lock_t *lock)
 {
-        pl_inode_lock_t *l   = NULL;
-        pl_inode_lock_t *ret = NULL;
+        pl_itree_node_t *node = NULL;
 
-        if (list_empty (&dom->blocked_inodelks))
+        node = pl_itree_search (dom->blocked_tree, lock->fl_start,
+                                lock->fl_end, __blocked_inodelk_conflict,
+                                lock);
+        if (!node)
                 return NULL;
 
-        list_for_each_entry (l, &dom->blocked_inodelks, blocked_locks) {
-                if (inodelk_conflict (lock, l)) {
-                        ret = l;
-                        goto out;
-                }
-        }
-
-out:
-        return ret;
+        return pl_itree_entry (node, pl_inode_lock_t, blocked_node);
 }
 
 static int
@@ -193,24 +221,112 @@ __owner_has_lock (pl_dom_list_t *dom, pl_inode_lock_t *newlock)
 }
 
 
+/* Queue a contention upcall to the holder of @conf, which @lock conflicts
+ * with, if it asked for one and was not told in the last
+ * notify-contention-delay seconds. */
+static void
+__inodelk_contention_check (xlator_t *this, pl_inode_lock_t *conf,
+                            struct list_head *contend)
+{
+        posix_locks_private_t *priv       = NULL;
+        pl_contention_t       *contention = NULL;
+        client_t              *client     = NULL;
+        struct timeval         now        = {0,};
+
+        priv = this->private;
+        client = conf->client;
+
+        if (!contend || !conf->contention_notify || !client ||
+            !client->client_uid)
+                return;
+
+        gettimeofday (&now, NULL);
+        if (conf->contention_time.tv_sec &&
+            (now.tv_sec - conf->contention_time.tv_sec <
+             priv->notify_contention_delay))
+                return;
+
+        contention = GF_CALLOC (1, sizeof (*contention),
+                                gf_locks_mt_pl_contention_t);
+        if (!contention)
+                return;
+
+        contention->client_uid = gf_strdup (client->client_uid);
+        contention->domain = gf_strdup (conf->volume);
+        if (!contention->client_uid || !contention->domain) {
+                GF_FREE (contention->client_uid);
+                GF_FREE (contention->domain);
+                GF_FREE (contention);
+                return;
+        }
+
+        uuid_copy (contention->gfid, conf->pl_inode->gfid);
+        contention->flock = conf->user_flock;
+        contention->flock.l_owner = conf->owner;
+
+        conf->contention_time = now;
+        list_add_tail (&contention->list, contend);
+}
+
+/* Send the upcalls queued by __inodelk_contention_check() */
+static void
+inodelk_contention_notify (xlator_t *this, struct list_head *contend)
+{
+        pl_contention_t                     *contention = NULL;
+        pl_contention_t                     *tmp        = NULL;
+        struct gf_upcall                     upcall     = {0,};
+        struct gf_upcall_inodelk_contention  lc         = {{0,},};
+
+        list_for_each_entry_safe (contention, tmp, contend, list) {
+                list_del_init (&contention->list);
+
+                gf_log (this->name, GF_LOG_DEBUG, "notifying %s of "
+                        "contention on %s (domain %s) %"PRId64" - %"PRId64,
+                        contention->client_uid, uuid_utoa (contention->gfid),
+                        contention->domain, contention->flock.l_start,
+                        contention->flock.l_len);
+
+                lc.flock = contention->flock;
+                lc.domain = contention->domain;
+
+                upcall.client_uid = contention->client_uid;
+                uuid_copy (upcall.gfid, contention->gfid);
+                upcall.event_type = GF_UPCALL_INODELK_CONTENTION;
+                upcall.data = &lc;
+
+                default_notify (this, GF_EVENT_UPCALL, &upcall);
+
+                GF_FREE (contention->client_uid);
+                GF_FREE (contention->domain);
+                GF_FREE (contention);
+        }
+}
+
 /* Determines if lock can be granted and adds the lock. If the lock
  * is blocking, adds it to the blocked_inodelks list of the domain.
+ * Contention upcalls to send are queued in @contend.
  */
 static int
 __lock_inodelk (xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
-                int can_block,  pl_dom_list_t *dom)
+                int can_block,  pl_dom_list_t *dom, struct list_head *contend)
 {
         pl_inode_lock_t *conf = NULL;
         int ret = -EINVAL;
 
+        /* Nothing granted nor waiting in the domain, as when a single
+         * client locks the whole file again and again: grant it. */
+        if (list_empty (&dom->inodelk_list) &&
+            list_empty (&dom->blocked_inodelks))
+                goto grant;
+
         conf = __inodelk_grantable (dom, lock);
         if (conf) {
                 ret = -EAGAIN;
+                __inodelk_contention_check (this, conf, contend);
                 if (can_block == 0)
                         goto out;
 
-                gettimeofday (&lock->blkd_time, NULL);
-                list_add_tail (&lock->blocked_locks, &dom->blocked_inodelks);
+                __block_inode_lock (dom, lock);
 
                 gf_log (this->name, GF_LOG_TRACE,
                         "%s (pid=%d) lk-owner:%s %"PRId64" - %"PRId64" => Blocked",
@@ -229,8 +345,7 @@ __lock_inodelk (xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
                 if (can_block == 0)
                         goto out;
 
-                gettimeofday (&lock->blkd_time, NULL);
-                list_add_tail (&lock->blocked_locks, &dom->blocked_inodelks);
+                __block_inode_lock (dom, lock);
 
                 gf_log (this->name, GF_LOG_DEBUG,
                         "Lock is grantable, but blocking to prevent starvation");
@@ -245,9 +360,10 @@ __lock_inodelk (xlator_t *this, pl_inode_t *pl_inode, pl_inode_lock_t *lock,
 
                 goto out;
         }
+grant:
         __pl_inodelk_ref (lock);
         gettimeofday (&lock->granted_time, NULL);
-        list_add (&lock->list, &dom->inodelk_list);
+        __insert_inode_lock (dom, lock);
 
         ret = 0;
 
@@ -267,16 +383,28 @@ inodelks_equal (pl_inode_lock_t *l1, pl_inode_lock_t *l2)
 }
 
 
+static int
+__matching_inodelk (pl_itree_node_t *node, void *data)
+{
+        pl_inode_lock_t *l    = NULL;
+        pl_inode_lock_t *lock = data;
+
+        l = pl_itree_entry (node, pl_inode_lock_t, node);
+
+        return (inodelks_equal (l, lock) && same_inodelk_owner (l, lock));
+}
+
 static pl_inode_lock_t *
 find_matching_inodelk (pl_inode_lock_t *lock, pl_dom_list_t *dom)
 {
-        pl_inode_lock_t *l = NULL;
-        list_for_each_entry (l, &dom->inodelk_list, list) {
-                if (inodelks_equal (l, lock) &&
-                    same_inodelk_owner (l, lock))
-                        return l;
-        }
-        return NULL;
+        pl_itree_node_t *node = NULL;
+
+        node = pl_itree_search (dom->inodelk_tree, lock->fl_start,
+                                lock->fl_end, __matching_inodelk, lock);
+        if (!node)
+                return NULL;
+
+        return pl_itree_entry (node, pl_inode_lock_t, node);
 }
 
 /* Set F_UNLCK removes a lock which has the exact same lock boundaries
@@ -311,7 +439,8 @@ out:
 
 static void
 __grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
-                             struct list_head *granted, pl_dom_list_t *dom)
+                             struct list_head *granted, pl_dom_list_t *dom,
+                             struct list_head *contend)
 {
         int              bl_ret = 0;
         pl_inode_lock_t *bl = NULL;
@@ -321,12 +450,13 @@ __grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
 
         INIT_LIST_HEAD (&blocked_list);
         list_splice_init (&dom->blocked_inodelks, &blocked_list);
+        dom->blocked_tree = NULL;
 
         list_for_each_entry_safe (bl, tmp, &blocked_list, blocked_locks) {
 
                 list_del_init (&bl->blocked_locks);
 
-                bl_ret = __lock_inodelk (this, pl_inode, bl, 1, dom);
+                bl_ret = __lock_inodelk (this, pl_inode, bl, 1, dom, contend);
 
                 if (bl_ret == 0) {
                         list_add (&bl->blocked_locks, granted);
@@ -340,18 +470,26 @@ void
 grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
                            pl_dom_list_t *dom)
 {
-        struct list_head granted;
-        pl_inode_lock_t *lock;
-        pl_inode_lock_t *tmp;
+        struct list_head       granted;
+        struct list_head       contend;
+        pl_inode_lock_t       *lock;
+        pl_inode_lock_t       *tmp;
+        posix_locks_private_t *priv = NULL;
+
+        priv = this->private;
 
         INIT_LIST_HEAD (&granted);
+        INIT_LIST_HEAD (&contend);
 
         pthread_mutex_lock (&pl_inode->mutex);
         {
-                __grant_blocked_inode_locks (this, pl_inode, &granted, dom);
+                __grant_blocked_inode_locks (this, pl_inode, &granted, dom,
+                                             &contend);
         }
         pthread_mutex_unlock (&pl_inode->mutex);
 
+        inodelk_contention_notify (this, &contend);
+
         list_for_each_entry_safe (lock, tmp, &granted, blocked_locks) {
                 gf_log (this->name, GF_LOG_TRACE,
                         "%s (pid=%d) (lk-owner=%s) %"PRId64" - %"PRId64" => Granted",
@@ -364,6 +502,9 @@ grant_blocked_inode_locks (xlator_t *this, pl_inode_t *pl_inode,
                 pl_trace_out (this, lock->frame, NULL, NULL, F_SETLKW,
                               &lock->user_flock, 0, 0, lock->volume);
 
+                pl_update_latency (this, priv->inodelk_latency,
+                                   &lock->blkd_time, &lock->granted_time);
+
                 STACK_UNWIND_STRICT (inodelk, lock->frame, 0, 0, NULL);
 		lock->frame = NULL;
         }
@@ -456,7 +597,7 @@ pl_inodelk_client_cleanup (xlator_t *this, pl_ctx_t *ctx)
                                         list_add_tail (&l->client_list,
                                                        &released);
                                 } else {
-                                        list_del_init(&l->blocked_locks);
+                                        __unblock_inode_lock (l->dom, l);
                                         list_add_tail (&l->client_list,
                                                        &unwind);
                                 }
@@ -481,7 +622,7 @@ pl_inodelk_client_cleanup (xlator_t *this, pl_ctx_t *ctx)
 
 		pl_inode = l->pl_inode;
 
-		dom = get_domain (pl_inode, l->volume);
+		dom = l->dom;
 
 		grant_blocked_inode_locks (this, pl_inode, dom);
 
@@ -507,8 +648,14 @@ pl_inode_setlk (xlator_t *this, pl_ctx_t *ctx, pl_inode_t *pl_inode,
         gf_boolean_t      unref            =  _gf_true;
         gf_boolean_t      need_inode_unref =  _gf_false;
         short             fl_type;
+        posix_locks_private_t *priv        =  NULL;
+        struct list_head  contend;
+
+        priv = this->private;
+        INIT_LIST_HEAD (&contend);
 
 	lock->pl_inode = pl_inode;
+        lock->dom = dom;
         fl_type = lock->fl_type;
 
         /* Ideally, AFTER a successful lock (both blocking and non-blocking) or
@@ -535,7 +682,8 @@ pl_inode_setlk (xlator_t *this, pl_ctx_t *ctx, pl_inode_t *pl_inode,
         pthread_mutex_lock (&pl_inode->mutex);
         {
                 if (lock->fl_type != F_UNLCK) {
-                        ret = __lock_inodelk (this, pl_inode, lock, can_block, dom);
+                        ret = __lock_inodelk (this, pl_inode, lock, can_block,
+                                              dom, &contend);
                         if (ret == 0) {
 				lock->frame = NULL;
                                 gf_log (this->name, GF_LOG_TRACE,
@@ -593,9 +741,14 @@ out:
 	if (ctx)
 		pthread_mutex_unlock (&ctx->lock);
 
+        inodelk_contention_notify (this, &contend);
+
         if (need_inode_unref)
                 inode_unref (pl_inode->inode);
 
+        if ((fl_type != F_UNLCK) && (ret == 0))
+                pl_update_latency (this, priv->inodelk_latency, NULL, NULL);
+
         /* The following (extra) unref corresponds to the ref that
          * was done at the time the lock was granted.
          */
@@ -614,10 +767,12 @@ new_inode_lock (struct gf_flock *flock, client_t *client, pid_t client_pid,
                 char *conn_id)
 
 {
-        pl_inode_lock_t *lock = NULL;
+        posix_locks_private_t *priv = NULL;
+        pl_inode_lock_t       *lock = NULL;
 
-        lock = GF_CALLOC (1, sizeof (*lock),
-                          gf_locks_mt_pl_inode_lock_t);
+        priv = this->private;
+
+        lock = mem_get0 (priv->inodelk_pool);
         if (!lock) {
                 return NULL;
         }
@@ -734,7 +889,7 @@ pl_common_inodelk (call_frame_t *frame, xlator_t *this,
                 goto unwind;
         }
 
-        dom = get_domain (pinode, volume);
+        dom = get_domain (this, pinode, volume);
         if (!dom) {
                 op_errno = ENOMEM;
                 goto unwind;
@@ -749,6 +904,9 @@ pl_common_inodelk (call_frame_t *frame, xlator_t *this,
                 goto unwind;
         }
 
+        if (xdata && dict_get (xdata, GLUSTERFS_INODELK_CONTENTION_NOTIFY))
+                reqlock->contention_notify = _gf_true;
+
 
         switch (cmd) {
         case F_SETLKW:
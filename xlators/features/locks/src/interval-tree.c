@@ -0,0 +1,209 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "interval-tree.h"
+
+static inline int
+itree_height (pl_itree_node_t *node)
+{
+        return node ? node->height : 0;
+}
+
+static void
+itree_update (pl_itree_node_t *node)
+{
+        int lheight = itree_height (node->left);
+        int rheight = itree_height (node->right);
+
+        node->height = 1 + (lheight > rheight ? lheight : rheight);
+
+        node->max_end = node->end;
+        if (node->left && node->left->max_end > node->max_end)
+                node->max_end = node->left->max_end;
+        if (node->right && node->right->max_end > node->max_end)
+                node->max_end = node->right->max_end;
+}
+
+static pl_itree_node_t *
+itree_rotate_right (pl_itree_node_t *node)
+{
+        pl_itree_node_t *left = node->left;
+
+        node->left = left->right;
+        left->right = node;
+
+        itree_update (node);
+        itree_update (left);
+
+        return left;
+}
+
+static pl_itree_node_t *
+itree_rotate_left (pl_itree_node_t *node)
+{
+        pl_itree_node_t *right = node->right;
+
+        node->right = right->left;
+        right->left = node;
+
+        itree_update (node);
+        itree_update (right);
+
+        return right;
+}
+
+static pl_itree_node_t *
+itree_balance (pl_itree_node_t *node)
+{
+        int balance = 0;
+
+        itree_update (node);
+
+        balance = itree_height (node->left) - itree_height (node->right);
+
+        if (balance > 1) {
+                if (itree_height (node->left->left) <
+                    itree_height (node->left->right))
+                        node->left = itree_rotate_left (node->left);
+                return itree_rotate_right (node);
+        }
+
+        if (balance < -1) {
+                if (itree_height (node->right->right) <
+                    itree_height (node->right->left))
+                        node->right = itree_rotate_right (node->right);
+                return itree_rotate_left (node);
+        }
+
+        return node;
+}
+
+/* Nodes are ordered on their start, then on their address so that ranges
+ * starting at the same offset can all be in the tree. */
+static int
+itree_cmp (pl_itree_node_t *a, pl_itree_node_t *b)
+{
+        if (a->start != b->start)
+                return (a->start < b->start) ? -1 : 1;
+
+        if (a == b)
+                return 0;
+
+        return ((uintptr_t) a < (uintptr_t) b) ? -1 : 1;
+}
+
+static pl_itree_node_t *
+itree_insert (pl_itree_node_t *root, pl_itree_node_t *node)
+{
+        if (!root)
+                return node;
+
+        if (itree_cmp (node, root) < 0)
+                root->left = itree_insert (root->left, node);
+        else
+                root->right = itree_insert (root->right, node);
+
+        return itree_balance (root);
+}
+
+static pl_itree_node_t *
+itree_remove_min (pl_itree_node_t *root, pl_itree_node_t **min)
+{
+        if (!root->left) {
+                *min = root;
+                return root->right;
+        }
+
+        root->left = itree_remove_min (root->left, min);
+
+        return itree_balance (root);
+}
+
+static pl_itree_node_t *
+itree_remove (pl_itree_node_t *root, pl_itree_node_t *node)
+{
+        pl_itree_node_t *min   = NULL;
+        pl_itree_node_t *right = NULL;
+        int              cmp   = 0;
+
+        if (!root)
+                return NULL;
+
+        cmp = itree_cmp (node, root);
+        if (cmp < 0) {
+                root->left = itree_remove (root->left, node);
+        } else if (cmp > 0) {
+                root->right = itree_remove (root->right, node);
+        } else {
+                if (!root->right)
+                        return root->left;
+
+                right = itree_remove_min (root->right, &min);
+                min->left = root->left;
+                min->right = right;
+                root = min;
+        }
+
+        return itree_balance (root);
+}
+
+void
+pl_itree_insert (pl_itree_node_t **root, pl_itree_node_t *node,
+                 off_t start, off_t end)
+{
+        node->left = NULL;
+        node->right = NULL;
+        node->start = start;
+        node->end = end;
+        node->max_end = end;
+        node->height = 1;
+
+        *root = itree_insert (*root, node);
+}
+
+void
+pl_itree_remove (pl_itree_node_t **root, pl_itree_node_t *node)
+{
+        *root = itree_remove (*root, node);
+
+        node->left = NULL;
+        node->right = NULL;
+}
+
+pl_itree_node_t *
+pl_itree_search (pl_itree_node_t *root, off_t start, off_t end,
+                 pl_itree_match_t match, void *data)
+{
+        pl_itree_node_t *found = NULL;
+
+        /* nothing in this subtree reaches @start */
+        if (!root || root->max_end < start)
+                return NULL;
+
+        found = pl_itree_search (root->left, start, end, match, data);
+        if (found)
+                return found;
+
+        /* this node and all on its right start after @end */
+        if (root->start > end)
+                return NULL;
+
+        if (root->end >= start && (!match || match (root, data)))
+                return root;
+
+        return pl_itree_search (root->right, start, end, match, data);
+}
@@ -0,0 +1,54 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef __PL_INTERVAL_TREE_H__
+#define __PL_INTERVAL_TREE_H__
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+
+/* An interval tree of byte ranges: an AVL tree ordered on the start of the
+ * ranges, each node also keeping the highest end found in its subtree, so
+ * that the ranges overlapping a given one are found without looking at the
+ * others. Nodes are embedded in the structures they index and are never
+ * allocated nor freed here; an empty tree is a NULL root.
+ */
+typedef struct pl_itree_node {
+        struct pl_itree_node *left;
+        struct pl_itree_node *right;
+        off_t                 start;
+        off_t                 end;     /* inclusive */
+        off_t                 max_end; /* highest end in this subtree */
+        int                   height;
+} pl_itree_node_t;
+
+#define pl_itree_entry(node, type, member)                              \
+        ((type *)((char *)(node) - (unsigned long)(&((type *)0)->member)))
+
+/* Return non-zero to stop the search on @node */
+typedef int (*pl_itree_match_t) (pl_itree_node_t *node, void *data);
+
+void
+pl_itree_insert (pl_itree_node_t **root, pl_itree_node_t *node,
+                 off_t start, off_t end);
+
+void
+pl_itree_remove (pl_itree_node_t **root, pl_itree_node_t *node);
+
+/* First node (in start order) overlapping [start, end] accepted by @match,
+ * any overlapping node if @match is NULL */
+pl_itree_node_t *
+pl_itree_search (pl_itree_node_t *root, off_t start, off_t end,
+                 pl_itree_match_t match, void *data);
+
+#endif /* __PL_INTERVAL_TREE_H__ */
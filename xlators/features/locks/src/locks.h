@@ -22,8 +22,10 @@
 #include "client_t.h"
 
 #include "lkowner.h"
+#include "interval-tree.h"
 
 struct __pl_fd;
+struct __pl_dom_list_t;
 
 struct __posix_lock {
         struct list_head   list;
@@ -82,9 +84,29 @@ struct __pl_inode_lock {
         char              *connection_id; /* stores the client connection id */
 
 	struct list_head   client_list; /* list of all locks from a client */
+
+        struct __pl_dom_list_t *dom;
+        pl_itree_node_t    node;         /* in the domain's inodelk_tree */
+        pl_itree_node_t    blocked_node; /* in the domain's blocked_tree */
+
+        /* the holder asked to be told when others wait on it
+           (GLUSTERFS_INODELK_CONTENTION_NOTIFY), last told then */
+        gf_boolean_t       contention_notify;
+        struct timeval     contention_time;
 };
 typedef struct __pl_inode_lock pl_inode_lock_t;
 
+/* A contention upcall to send, queued under the inode mutex and sent once
+ * it is released */
+struct __pl_contention {
+        struct list_head   list;
+        char              *client_uid;
+        uuid_t             gfid;
+        struct gf_flock    flock;
+        char              *domain;
+};
+typedef struct __pl_contention pl_contention_t;
+
 struct __pl_rw_req_t {
         struct list_head      list;
         call_stub_t          *stub;
@@ -92,13 +114,29 @@ struct __pl_rw_req_t {
 };
 typedef struct __pl_rw_req_t pl_rw_req_t;
 
+/* Domain names are interned: all the domains of a name, whatever the
+ * inode, share a single copy of it, found through the hash table in the
+ * private of the xlator, and are told apart by comparing its address.
+ */
+struct __pl_domain_name {
+        struct list_head   hash;
+        uint32_t           hashval;
+        int                ref;
+        char               name[];
+};
+typedef struct __pl_domain_name pl_domain_name_t;
+
 struct __pl_dom_list_t {
         struct list_head   inode_list;       /* list_head back to pl_inode_t */
         const char        *domain;
+        pl_domain_name_t  *id;
         struct list_head   entrylk_list;     /* List of entry locks */
         struct list_head   blocked_entrylks; /* List of all blocked entrylks */
         struct list_head   inodelk_list;     /* List of inode locks */
         struct list_head   blocked_inodelks; /* List of all blocked inodelks */
+        /* the locks of inodelk_list and blocked_inodelks by range */
+        pl_itree_node_t   *inodelk_tree;
+        pl_itree_node_t   *blocked_tree;
 };
 typedef struct __pl_dom_list_t pl_dom_list_t;
 
@@ -154,10 +192,28 @@ struct __pl_inode {
 typedef struct __pl_inode pl_inode_t;
 
 
+#define PL_DOMAIN_HASH_SIZE   64
+
+/* Wait before grant: bucket 0 counts the locks granted right away, bucket
+ * n the ones granted after less than 2^n microseconds, the last one all
+ * the longer waits. */
+#define PL_LATENCY_BUCKETS    32
+
 typedef struct {
         gf_boolean_t    mandatory;      /* if mandatory locking is enabled */
         gf_boolean_t    trace;          /* trace lock requests in and out */
         char           *brickname;
+
+        pthread_mutex_t   domain_lock;
+        struct list_head  domains[PL_DOMAIN_HASH_SIZE];
+
+        struct mem_pool  *inodelk_pool;
+
+        pthread_mutex_t   latency_lock;
+        uint64_t          inodelk_latency[PL_LATENCY_BUCKETS];
+        uint64_t          entrylk_latency[PL_LATENCY_BUCKETS];
+
+        uint32_t          notify_contention_delay;
 } posix_locks_private_t;
 
 
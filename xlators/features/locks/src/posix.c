@@ -1771,7 +1771,7 @@ pl_forget (xlator_t *this,
                         list_del (&dom->inode_list);
                         gf_log ("posix-locks", GF_LOG_TRACE,
                                 " Cleaning up domain: %s", dom->domain);
-                        GF_FREE ((char *)(dom->domain));
+                        pl_domain_name_put (this, dom->id);
                         GF_FREE (dom);
                 }
 
@@ -2416,6 +2416,60 @@ dump_posixlks (pl_inode_t *pl_inode)
 
 }
 
+static void
+pl_dump_latency (const char *fop, uint64_t *histogram)
+{
+        char key[GF_DUMP_MAX_BUF_LEN];
+        int  i = 0;
+
+        for (i = 0; i < PL_LATENCY_BUCKETS; i++) {
+                if (!histogram[i])
+                        continue;
+
+                if (i == 0)
+                        snprintf (key, sizeof (key), "%s-granted-at-once",
+                                  fop);
+                else if (i == PL_LATENCY_BUCKETS - 1)
+                        snprintf (key, sizeof (key), "%s-waited-%"PRIu64"us-"
+                                  "or-more", fop, (uint64_t) 1 << (i - 1));
+                else
+                        snprintf (key, sizeof (key), "%s-waited-under-"
+                                  "%"PRIu64"us", fop, (uint64_t) 1 << i);
+
+                gf_proc_dump_write (key, "%"PRIu64, histogram[i]);
+        }
+}
+
+int32_t
+pl_dump_priv (xlator_t *this)
+{
+        posix_locks_private_t *priv                            = NULL;
+        uint64_t               inodelk[PL_LATENCY_BUCKETS]     = {0,};
+        uint64_t               entrylk[PL_LATENCY_BUCKETS]     = {0,};
+
+        priv = this->private;
+        if (!priv)
+                return 0;
+
+        pthread_mutex_lock (&priv->latency_lock);
+        {
+                memcpy (inodelk, priv->inodelk_latency, sizeof (inodelk));
+                memcpy (entrylk, priv->entrylk_latency, sizeof (entrylk));
+        }
+        pthread_mutex_unlock (&priv->latency_lock);
+
+        gf_proc_dump_add_section ("xlator.features.locks.%s.priv",
+                                  this->name);
+
+        gf_proc_dump_write ("trace", "%d", priv->trace);
+        gf_proc_dump_write ("notify-contention-delay", "%u",
+                            priv->notify_contention_delay);
+        pl_dump_latency ("inodelk", inodelk);
+        pl_dump_latency ("entrylk", entrylk);
+
+        return 0;
+}
+
 int32_t
 pl_dump_inode_priv (xlator_t *this, inode_t *inode)
 {
@@ -2601,6 +2655,7 @@ init (xlator_t *this)
         data_t                *mandatory = NULL;
         data_t                *trace = NULL;
         int                   ret = -1;
+        int                   i = 0;
 
         if (!this->children || this->children->next) {
                 gf_log (this->name, GF_LOG_CRITICAL,
@@ -2626,6 +2681,13 @@ init (xlator_t *this)
 
         priv = GF_CALLOC (1, sizeof (*priv),
                           gf_locks_mt_posix_locks_private_t);
+        if (!priv)
+                goto out;
+
+        pthread_mutex_init (&priv->domain_lock, NULL);
+        for (i = 0; i < PL_DOMAIN_HASH_SIZE; i++)
+                INIT_LIST_HEAD (&priv->domains[i]);
+        pthread_mutex_init (&priv->latency_lock, NULL);
 
         mandatory = dict_get (this->options, "mandatory-locks");
         if (mandatory)
@@ -2642,6 +2704,9 @@ init (xlator_t *this)
                 }
         }
 
+        GF_OPTION_INIT ("notify-contention-delay",
+                        priv->notify_contention_delay, uint32, out);
+
         this->local_pool = mem_pool_new (pl_local_t, 32);
         if (!this->local_pool) {
                 ret = -1;
@@ -2650,6 +2715,14 @@ init (xlator_t *this)
                 goto out;
         }
 
+        priv->inodelk_pool = mem_pool_new (pl_inode_lock_t, 1024);
+        if (!priv->inodelk_pool) {
+                ret = -1;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "failed to create inodelk memory pool");
+                goto out;
+        }
+
         this->private = priv;
         ret = 0;
 
@@ -2661,15 +2734,48 @@ out:
 }
 
 
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        posix_locks_private_t *priv = NULL;
+        int                    ret  = -1;
+
+        priv = this->private;
+
+        GF_OPTION_RECONF ("notify-contention-delay",
+                          priv->notify_contention_delay, options, uint32, out);
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
 int
 fini (xlator_t *this)
 {
         posix_locks_private_t *priv = NULL;
+        pl_domain_name_t      *id   = NULL;
+        pl_domain_name_t      *tmp  = NULL;
+        int                    i    = 0;
 
         priv = this->private;
         if (!priv)
                 return 0;
         this->private = NULL;
+
+        for (i = 0; i < PL_DOMAIN_HASH_SIZE; i++) {
+                list_for_each_entry_safe (id, tmp, &priv->domains[i], hash) {
+                        list_del_init (&id->hash);
+                        GF_FREE (id);
+                }
+        }
+        pthread_mutex_destroy (&priv->domain_lock);
+        pthread_mutex_destroy (&priv->latency_lock);
+
+        if (priv->inodelk_pool)
+                mem_pool_destroy (priv->inodelk_pool);
+
         GF_FREE (priv->brickname);
         GF_FREE (priv);
 
@@ -2720,6 +2826,7 @@ struct xlator_fops fops = {
 
 struct xlator_dumpops dumpops = {
         .inodectx    = pl_dump_inode_priv,
+        .priv        = pl_dump_priv,
 };
 
 struct xlator_cbks cbks = {
@@ -2738,5 +2845,15 @@ struct volume_options options[] = {
         { .key  = { "trace" },
           .type = GF_OPTION_TYPE_BOOL
         },
+        { .key  = { "notify-contention-delay" },
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "5",
+          .description = "Least number of seconds between two contention "
+                         "notifications sent to the holder of the same "
+                         "inodelk. Only the clients asking for them when "
+                         "taking the lock are notified."
+        },
         { .key = {NULL} },
 };
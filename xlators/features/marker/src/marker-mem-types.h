@@ -20,6 +20,7 @@ enum gf_marker_mem_types_ {
         gf_marker_mt_quota_inode_ctx_t,
         gf_marker_mt_marker_inode_ctx_t,
         gf_marker_mt_inode_contribution_t,
+        gf_marker_mt_mq_deferred_txn_t,
         gf_marker_mt_end
 };
 #endif
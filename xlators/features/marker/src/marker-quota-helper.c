@@ -384,6 +384,10 @@ mq_local_unref (xlator_t *this, quota_local_t *local)
 
         loc_wipe (&local->parent_loc);
 
+        /* the transaction ended before the update was written */
+        if (local->deferred)
+                mq_deferred_txn_done (this, local->deferred);
+
         LOCK_DESTROY (&local->lock);
 
         mem_put (local);
@@ -1374,6 +1374,11 @@ mq_inodelk_cbk (call_frame_t *frame, void *cookie,
         if ((strcmp (local->parent_loc.path, "/") == 0)
             || (local->delta == 0)) {
                 mq_xattr_updation_done (frame, NULL, this, 0, 0, NULL, NULL);
+        } else if (((marker_conf_t *)this->private)->quota_update_interval) {
+                /* queue the parent, so that updates from all its children
+                   in this interval travel further up as one */
+                mq_initiate_quota_txn (this, &local->parent_loc);
+                mq_xattr_updation_done (frame, NULL, this, 0, 0, NULL, NULL);
         } else {
                 ret = mq_get_parent_inode_local (this, local);
                 if (ret < 0) {
@@ -1456,6 +1461,28 @@ err:
 }
 
 
+static int8_t
+mq_has_deferred_children (xlator_t *this, inode_t *inode)
+{
+        marker_conf_t     *priv = NULL;
+        quota_inode_ctx_t *ctx  = NULL;
+        int8_t             ret  = 0;
+
+        priv = this->private;
+
+        if (!inode || mq_inode_ctx_get (inode, this, &ctx) < 0)
+                return 0;
+
+        pthread_mutex_lock (&priv->quota_defer_mutex);
+        {
+                ret = (ctx->nr_deferred > 0);
+        }
+        pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+        return ret;
+}
+
+
 int32_t
 mq_mark_undirty (call_frame_t *frame,
                  void *cookie,
@@ -1469,6 +1496,7 @@ mq_mark_undirty (call_frame_t *frame,
         dict_t            *newdict      = NULL;
         quota_local_t     *local        = NULL;
         quota_inode_ctx_t *ctx          = NULL;
+        int8_t             dirty        = 0;
 
         local = frame->local;
 
@@ -1510,7 +1538,17 @@ mq_mark_undirty (call_frame_t *frame,
                 goto err;
         }
 
-        ret = dict_set_int8 (newdict, QUOTA_DIRTY_KEY, 0);
+        /* stays dirty while deferred updates of its children are pending;
+           the update of this one is written now */
+        if (local->deferred) {
+                dirty = mq_deferred_txn_done (this, local->deferred);
+                local->deferred = NULL;
+        } else {
+                dirty = mq_has_deferred_children (this,
+                                                  local->parent_loc.inode);
+        }
+
+        ret = dict_set_int8 (newdict, QUOTA_DIRTY_KEY, dirty);
 
         if (ret == -1) {
                 op_errno = -ret;
@@ -2000,10 +2038,12 @@ err:
         return ret;
 }
 
+/* @deferred, if any, is released by the transaction from here on */
 int
 mq_start_quota_txn (xlator_t *this, loc_t *loc,
                     quota_inode_ctx_t *ctx,
-                    inode_contribution_t *contri)
+                    inode_contribution_t *contri,
+                    mq_deferred_txn_t *deferred)
 {
         int32_t        ret      = -1;
         call_frame_t  *frame    = NULL;
@@ -2013,6 +2053,9 @@ mq_start_quota_txn (xlator_t *this, loc_t *loc,
         if (ret)
                 goto err;
 
+        ((quota_local_t *)frame->local)->deferred = deferred;
+        deferred = NULL;
+
         ret = mq_get_lock_on_parent (frame, this);
         if (ret == -1)
                 goto err;
@@ -2020,14 +2063,16 @@ mq_start_quota_txn (xlator_t *this, loc_t *loc,
         return 0;
 
 err:
+        mq_deferred_txn_done (this, deferred);
         mq_set_ctx_updation_status (ctx, _gf_false);
 
         return -1;
 }
 
 
-int
-mq_initiate_quota_txn (xlator_t *this, loc_t *loc)
+static int
+_mq_initiate_quota_txn (xlator_t *this, loc_t *loc,
+                        mq_deferred_txn_t *deferred)
 {
         int32_t               ret          = -1;
         gf_boolean_t          status       = _gf_false;
@@ -2095,15 +2140,284 @@ mq_initiate_quota_txn (xlator_t *this, loc_t *loc)
                 goto out;
 
         if (status == _gf_false) {
-                mq_start_quota_txn (this, loc, ctx, contribution);
+                mq_start_quota_txn (this, loc, ctx, contribution, deferred);
+                deferred = NULL;
         }
 
         ret = 0;
 out:
+        mq_deferred_txn_done (this, deferred);
+
         return ret;
 }
 
 
+/*
+ * Deferred accounting: instead of walking up to the root on every write,
+ * an inode is queued once per interval per parent, and the flusher starts
+ * the usual transaction for it, which reads the current size from disk.
+ * Every step up queues the next parent again, so updates from children of
+ * the same directory are merged before they travel further up.
+ *
+ * Until the update reaches it, the parent's size on disk is stale, so it
+ * is marked dirty when its first child is queued; after a crash the dirty
+ * inode lookup path recomputes it.
+ */
+static int32_t
+mq_deferred_dirty_done (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, dict_t *xdata)
+{
+        if (op_ret == -1)
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "marking parent dirty failed (%s)",
+                        strerror (op_errno));
+
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+static void
+mq_deferred_mark_dirty (xlator_t *this, loc_t *loc)
+{
+        call_frame_t *frame      = NULL;
+        dict_t       *dict       = NULL;
+        loc_t         parent_loc = {0, };
+        int32_t       ret        = -1;
+
+        ret = mq_inode_loc_fill (NULL, loc->parent, &parent_loc);
+        if (ret < 0)
+                goto out;
+
+        dict = dict_new ();
+        if (!dict)
+                goto out;
+
+        ret = dict_set_int8 (dict, QUOTA_DIRTY_KEY, 1);
+        if (ret < 0)
+                goto out;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame)
+                goto out;
+
+        uuid_copy (parent_loc.gfid, parent_loc.inode->gfid);
+
+        STACK_WIND (frame, mq_deferred_dirty_done, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->setxattr, &parent_loc, dict, 0,
+                    NULL);
+out:
+        if (dict)
+                dict_unref (dict);
+        loc_wipe (&parent_loc);
+}
+
+static int
+mq_defer_quota_txn (xlator_t *this, loc_t *loc)
+{
+        int32_t               ret          = -1;
+        marker_conf_t        *priv         = NULL;
+        quota_inode_ctx_t    *ctx          = NULL;
+        quota_inode_ctx_t    *parent_ctx   = NULL;
+        inode_contribution_t *contribution = NULL;
+        mq_deferred_txn_t    *txn          = NULL;
+        gf_boolean_t          first        = _gf_false;
+
+        priv = this->private;
+
+        ret = mq_inode_ctx_get (loc->inode, this, &ctx);
+        if (ret < 0)
+                goto out;
+
+        ret = mq_inode_ctx_get (loc->parent, this, &parent_ctx);
+        if (ret < 0)
+                goto out;
+
+        contribution = mq_get_contribution_node (loc->parent, ctx);
+        if (!contribution)
+                contribution = mq_add_new_contribution_node (this, ctx, loc);
+        if (!contribution) {
+                ret = -1;
+                goto out;
+        }
+
+        QUOTA_ALLOC_OR_GOTO (txn, mq_deferred_txn_t, ret, out);
+        INIT_LIST_HEAD (&txn->list);
+
+        ret = mq_loc_copy (&txn->loc, loc);
+        if (ret < 0)
+                goto out;
+
+        txn->contri = contribution;
+        txn->parent_ctx = parent_ctx;
+
+        pthread_mutex_lock (&priv->quota_defer_mutex);
+        {
+                if (contribution->deferred) {
+                        /* one already started may have read the size
+                           before this change, it goes once more */
+                        if (contribution->deferred->started)
+                                contribution->deferred->again = _gf_true;
+                        priv->quota_nr_merged++;
+                } else {
+                        contribution->deferred = txn;
+                        first = (parent_ctx->nr_deferred++ == 0);
+                        list_add_tail (&txn->list, &priv->quota_deferred);
+                        priv->quota_nr_deferred++;
+                        txn = NULL;
+                }
+        }
+        pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+        if (first)
+                mq_deferred_mark_dirty (this, loc);
+
+        ret = 0;
+out:
+        if (txn) {
+                loc_wipe (&txn->loc);
+                GF_FREE (txn);
+        }
+
+        return ret;
+}
+
+/*
+ * Called once the parent's size reflects @txn, or when its transaction
+ * ends without getting there. Drops it from the parent's count, or queues
+ * it again if the inode changed after its transaction started. Returns
+ * whether the parent still has deferred updates pending.
+ */
+int8_t
+mq_deferred_txn_done (xlator_t *this, mq_deferred_txn_t *txn)
+{
+        marker_conf_t *priv    = NULL;
+        int8_t         pending = 0;
+        gf_boolean_t   requeue = _gf_false;
+
+        if (!txn)
+                return 0;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->quota_defer_mutex);
+        {
+                if (txn->again && !priv->quota_defer_fini) {
+                        txn->started = _gf_false;
+                        txn->again = _gf_false;
+                        list_add_tail (&txn->list, &priv->quota_deferred);
+                        priv->quota_nr_deferred++;
+                        requeue = _gf_true;
+                } else {
+                        txn->contri->deferred = NULL;
+                        txn->parent_ctx->nr_deferred--;
+                }
+                pending = (txn->parent_ctx->nr_deferred > 0);
+        }
+        pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+        if (!requeue) {
+                loc_wipe (&txn->loc);
+                GF_FREE (txn);
+        }
+
+        return pending;
+}
+
+static void *
+mq_deferred_flusher (void *data)
+{
+        xlator_t          *this  = data;
+        marker_conf_t     *priv  = NULL;
+        mq_deferred_txn_t *txn   = NULL;
+        mq_deferred_txn_t *tmp   = NULL;
+        struct list_head   batch;
+        struct timespec    ts    = {0, };
+        struct timeval     tv    = {0, };
+        uint64_t           count = 0;
+        uint64_t           merged = 0;
+        gf_boolean_t       fini  = _gf_false;
+
+        THIS = this;
+        priv = this->private;
+
+        while (!fini) {
+                INIT_LIST_HEAD (&batch);
+
+                pthread_mutex_lock (&priv->quota_defer_mutex);
+                {
+                        if (priv->quota_update_interval &&
+                            !priv->quota_defer_fini) {
+                                gettimeofday (&tv, NULL);
+                                ts.tv_sec = tv.tv_sec +
+                                        priv->quota_update_interval / 1000;
+                                ts.tv_nsec = tv.tv_usec * 1000 +
+                                        (priv->quota_update_interval % 1000)
+                                        * 1000000;
+                                if (ts.tv_nsec >= 1000000000) {
+                                        ts.tv_sec++;
+                                        ts.tv_nsec -= 1000000000;
+                                }
+                                pthread_cond_timedwait (&priv->quota_defer_cond,
+                                                        &priv->quota_defer_mutex,
+                                                        &ts);
+                        } else if (!priv->quota_defer_fini &&
+                                   list_empty (&priv->quota_deferred)) {
+                                pthread_cond_wait (&priv->quota_defer_cond,
+                                                   &priv->quota_defer_mutex);
+                        }
+
+                        list_splice_init (&priv->quota_deferred, &batch);
+                        count = priv->quota_nr_deferred;
+                        merged = priv->quota_nr_merged;
+                        priv->quota_nr_deferred = 0;
+                        priv->quota_nr_merged = 0;
+
+                        /* the counts stay until the updates are
+                           written, see mq_deferred_txn_done() */
+                        list_for_each_entry (txn, &batch, list)
+                                txn->started = _gf_true;
+
+                        fini = priv->quota_defer_fini;
+                }
+                pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+                if (count)
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "flushing %"PRIu64" deferred quota updates "
+                                "(%"PRIu64" merged)", count, merged);
+
+                list_for_each_entry_safe (txn, tmp, &batch, list) {
+                        list_del_init (&txn->list);
+                        if (!fini)
+                                _mq_initiate_quota_txn (this, &txn->loc, txn);
+                        else
+                                mq_deferred_txn_done (this, txn);
+                }
+        }
+
+        return NULL;
+}
+
+
+int
+mq_initiate_quota_txn (xlator_t *this, loc_t *loc)
+{
+        marker_conf_t *priv = NULL;
+
+        GF_VALIDATE_OR_GOTO ("marker", this, out);
+        GF_VALIDATE_OR_GOTO ("marker", loc, out);
+
+        priv = this->private;
+
+        if (priv->quota_update_interval && priv->quota_defer_running &&
+            loc->inode && loc->parent &&
+            mq_defer_quota_txn (this, loc) == 0)
+                return 0;
+
+        return _mq_initiate_quota_txn (this, loc, NULL);
+out:
+        return -1;
+}
 
 
 
@@ -2447,7 +2761,8 @@ _mq_inode_remove_done (call_frame_t *frame, void *cookie, xlator_t *this,
                 if (ret < 0)
                         goto out;
 
-                mq_start_quota_txn (this, &local->loc, local->ctx, local->contri);
+                mq_start_quota_txn (this, &local->loc, local->ctx,
+                                    local->contri, NULL);
         }
 out:
         mq_local_unref (this, local);
@@ -2663,9 +2978,68 @@ out:
 
 
 int32_t
-init_quota_priv (xlator_t *this)
+init_quota_priv (xlator_t *this, dict_t *options)
 {
-        return 0;
+        marker_conf_t *priv     = NULL;
+        data_t        *data     = NULL;
+        uint32_t       interval = 0;
+        int32_t        ret      = -1;
+
+        priv = this->private;
+
+        data = dict_get (options, "quota-update-interval");
+        if (data && gf_string2uint32 (data->data, &interval) != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "invalid quota-update-interval %s", data->data);
+                goto out;
+        }
+
+        pthread_mutex_lock (&priv->quota_defer_mutex);
+        {
+                priv->quota_update_interval = interval;
+                /* flush what is queued if deferral got switched off */
+                pthread_cond_signal (&priv->quota_defer_cond);
+        }
+        pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+        if (interval && !priv->quota_defer_running) {
+                ret = gf_thread_create (&priv->quota_defer_thread, NULL,
+                                        mq_deferred_flusher, this);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to start deferred quota flusher, "
+                                "updating synchronously");
+                        priv->quota_update_interval = 0;
+                        goto done;
+                }
+                priv->quota_defer_running = _gf_true;
+        }
+done:
+        ret = 0;
+out:
+        return ret;
+}
+
+
+void
+mq_defer_cleanup (xlator_t *this)
+{
+        marker_conf_t *priv = NULL;
+
+        priv = this->private;
+
+        if (!priv->quota_defer_running)
+                return;
+
+        pthread_mutex_lock (&priv->quota_defer_mutex);
+        {
+                priv->quota_defer_fini = _gf_true;
+                pthread_cond_signal (&priv->quota_defer_cond);
+        }
+        pthread_mutex_unlock (&priv->quota_defer_mutex);
+
+        pthread_join (priv->quota_defer_thread, NULL);
+        priv->quota_defer_running = _gf_false;
 }
 
 
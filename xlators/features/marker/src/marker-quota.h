@@ -88,17 +88,32 @@ struct quota_inode_ctx {
         gf_boolean_t           updation_status;
         gf_lock_t              lock;
         struct list_head       contribution_head;
+        int32_t                nr_deferred; /* children with queued updates */
 };
 typedef struct quota_inode_ctx quota_inode_ctx_t;
 
+struct mq_deferred_txn;
+
 struct inode_contribution {
         struct list_head contri_list;
         int64_t          contribution;
         uuid_t           gfid;
   gf_lock_t lock;
+        struct mq_deferred_txn *deferred; /* queued update to this parent */
 };
 typedef struct inode_contribution inode_contribution_t;
 
+/* an inode whose contribution to loc.parent is to be brought up to date */
+struct mq_deferred_txn {
+        struct list_head      list;
+        loc_t                 loc;
+        inode_contribution_t *contri;
+        quota_inode_ctx_t    *parent_ctx;
+        gf_boolean_t          started;  /* handed to a quota transaction */
+        gf_boolean_t          again;    /* changed since it was started */
+};
+typedef struct mq_deferred_txn mq_deferred_txn_t;
+
 int32_t
 mq_get_lock_on_parent (call_frame_t *, xlator_t *);
 
@@ -106,7 +121,10 @@ int32_t
 mq_req_xattr (xlator_t *, loc_t *, dict_t *);
 
 int32_t
-init_quota_priv (xlator_t *);
+init_quota_priv (xlator_t *, dict_t *);
+
+void
+mq_defer_cleanup (xlator_t *);
 
 int32_t
 mq_xattr_state (xlator_t *, loc_t *, dict_t *, struct iatt);
@@ -117,6 +135,9 @@ mq_set_inode_xattr (xlator_t *, loc_t *);
 int
 mq_initiate_quota_txn (xlator_t *, loc_t *);
 
+int8_t
+mq_deferred_txn_done (xlator_t *, mq_deferred_txn_t *);
+
 int32_t
 mq_dirty_inode_readdir (call_frame_t *, void *, xlator_t *,
                         int32_t, int32_t, fd_t *, dict_t *);
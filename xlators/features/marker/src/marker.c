@@ -2929,7 +2929,11 @@ marker_priv_cleanup (xlator_t *this)
 
         marker_xtime_priv_cleanup (this);
 
+        mq_defer_cleanup (this);
+
         LOCK_DESTROY (&priv->lock);
+        pthread_mutex_destroy (&priv->quota_defer_mutex);
+        pthread_cond_destroy (&priv->quota_defer_cond);
 
         GF_FREE (priv);
 out:
@@ -2957,7 +2961,7 @@ reconfigure (xlator_t *this, dict_t *options)
         if (data) {
                 ret = gf_string2boolean (data->data, &flag);
                 if (ret == 0 && flag == _gf_true) {
-                        ret = init_quota_priv (this);
+                        ret = init_quota_priv (this, options);
                         if (ret < 0) {
                                 gf_log (this->name, GF_LOG_WARNING,
                                         "failed to initialize quota private");
@@ -3024,12 +3028,15 @@ init (xlator_t *this)
         priv->feature_enabled = 0;
 
         LOCK_INIT (&priv->lock);
+        pthread_mutex_init (&priv->quota_defer_mutex, NULL);
+        pthread_cond_init (&priv->quota_defer_cond, NULL);
+        INIT_LIST_HEAD (&priv->quota_deferred);
 
         data = dict_get (options, "quota");
         if (data) {
                 ret = gf_string2boolean (data->data, &flag);
                 if (ret == 0 && flag == _gf_true) {
-                        ret = init_quota_priv (this);
+                        ret = init_quota_priv (this, options);
                         if (ret < 0)
                                 goto err;
 
@@ -3132,5 +3139,14 @@ struct volume_options options[] = {
         {.key = {"quota"}},
         {.key = {"xtime"}},
         {.key = {"gsync-force-xtime"}},
+        {.key = {"quota-update-interval"},
+         .type = GF_OPTION_TYPE_INT,
+         .min = 0,
+         .max = 60000,
+         .default_value = "0",
+         .description = "Interval in msecs at which size changes are "
+                        "propagated to the ancestors, merging updates of "
+                        "the same directories. 0 updates on every change."
+        },
         {.key = {NULL}}
 };
@@ -113,6 +113,7 @@ struct marker_local{
         int xflag;
         dict_t *xdata;
         gf_boolean_t skip_txn;
+        mq_deferred_txn_t *deferred;
 };
 typedef struct marker_local marker_local_t;
 
@@ -133,6 +134,17 @@ struct marker_conf{
         char        *marker_xattr;
         uint64_t     quota_lk_owner;
         gf_lock_t    lock;
+
+        /* deferred quota accounting, see mq_defer_quota_txn() */
+        uint32_t          quota_update_interval; /* msec, 0: synchronous */
+        struct list_head  quota_deferred;
+        uint64_t          quota_nr_deferred;
+        uint64_t          quota_nr_merged;
+        pthread_mutex_t   quota_defer_mutex;
+        pthread_cond_t    quota_defer_cond;
+        pthread_t         quota_defer_thread;
+        gf_boolean_t      quota_defer_running;
+        gf_boolean_t      quota_defer_fini;
 };
 typedef struct marker_conf marker_conf_t;
 
@@ -251,6 +251,211 @@ out:
         return;
 }
 
+static inline int
+quota_ancestry_hash (uuid_t gfid)
+{
+        return (gfid[15] + (gfid[14] << 8)) % QUOTA_ANCESTRY_HASH_SIZE;
+}
+
+static quota_ancestry_t *
+__quota_ancestry_find (quota_priv_t *priv, uuid_t gfid)
+{
+        quota_ancestry_t *entry = NULL;
+
+        list_for_each_entry (entry,
+                             &priv->ancestry_hash[quota_ancestry_hash (gfid)],
+                             hash) {
+                if (uuid_compare (entry->gfid, gfid) == 0)
+                        return entry;
+        }
+
+        return NULL;
+}
+
+static void
+__quota_ancestry_free (quota_priv_t *priv, quota_ancestry_t *entry)
+{
+        list_del (&entry->hash);
+        list_del (&entry->lru);
+        priv->ancestry_count--;
+
+        GF_FREE (entry);
+}
+
+static void
+__quota_ancestry_trim (quota_priv_t *priv, uint32_t limit)
+{
+        quota_ancestry_t *entry = NULL;
+
+        while (priv->ancestry_count > limit) {
+                entry = list_entry (priv->ancestry_lru.prev, quota_ancestry_t,
+                                    lru);
+                __quota_ancestry_free (priv, entry);
+        }
+}
+
+int
+quota_ancestry_cache_init (quota_priv_t *priv)
+{
+        int i = 0;
+
+        priv->ancestry_hash = GF_CALLOC (QUOTA_ANCESTRY_HASH_SIZE,
+                                         sizeof (struct list_head),
+                                         gf_quota_mt_quota_ancestry_t);
+        if (priv->ancestry_hash == NULL)
+                return -1;
+
+        for (i = 0; i < QUOTA_ANCESTRY_HASH_SIZE; i++)
+                INIT_LIST_HEAD (&priv->ancestry_hash[i]);
+
+        INIT_LIST_HEAD (&priv->ancestry_lru);
+        LOCK_INIT (&priv->ancestry_lock);
+
+        return 0;
+}
+
+void
+quota_ancestry_cache_fini (quota_priv_t *priv)
+{
+        if (priv->ancestry_hash == NULL)
+                return;
+
+        LOCK (&priv->ancestry_lock);
+        {
+                __quota_ancestry_trim (priv, 0);
+        }
+        UNLOCK (&priv->ancestry_lock);
+
+        LOCK_DESTROY (&priv->ancestry_lock);
+
+        GF_FREE (priv->ancestry_hash);
+        priv->ancestry_hash = NULL;
+}
+
+/* Remember the parent of a directory (or of a file with a single link) by
+ * gfid. Unlike the dentries in the inode table, this outlives the inode, so
+ * that a write on an inode resolved without a name (nameless lookup, anonymous
+ * fd) does not need an ancestry crawl on the brick to find its parent.
+ */
+void
+quota_ancestry_cache_set (xlator_t *this, uuid_t gfid, uuid_t par)
+{
+        quota_priv_t     *priv  = NULL;
+        quota_ancestry_t *entry = NULL;
+
+        priv = this->private;
+
+        if ((priv->ancestry_cache_size == 0) || uuid_is_null (par))
+                return;
+
+        LOCK (&priv->ancestry_lock);
+        {
+                entry = __quota_ancestry_find (priv, gfid);
+                if (entry == NULL) {
+                        entry = GF_CALLOC (1, sizeof (*entry),
+                                           gf_quota_mt_quota_ancestry_t);
+                        if (entry == NULL)
+                                goto unlock;
+
+                        uuid_copy (entry->gfid, gfid);
+                        list_add (&entry->hash,
+                                  &priv->ancestry_hash[quota_ancestry_hash (gfid)]);
+                        INIT_LIST_HEAD (&entry->lru);
+                        priv->ancestry_count++;
+                }
+
+                uuid_copy (entry->par, par);
+                list_move (&entry->lru, &priv->ancestry_lru);
+
+                __quota_ancestry_trim (priv, priv->ancestry_cache_size);
+        }
+unlock:
+        UNLOCK (&priv->ancestry_lock);
+}
+
+int
+quota_ancestry_cache_get (xlator_t *this, uuid_t gfid, uuid_t par)
+{
+        quota_priv_t     *priv  = NULL;
+        quota_ancestry_t *entry = NULL;
+        int               ret   = -1;
+
+        priv = this->private;
+
+        if (priv->ancestry_cache_size == 0)
+                return -1;
+
+        LOCK (&priv->ancestry_lock);
+        {
+                entry = __quota_ancestry_find (priv, gfid);
+                if (entry != NULL) {
+                        uuid_copy (par, entry->par);
+                        list_move (&entry->lru, &priv->ancestry_lru);
+                        priv->ancestry_hits++;
+                        ret = 0;
+                } else {
+                        priv->ancestry_misses++;
+                }
+        }
+        UNLOCK (&priv->ancestry_lock);
+
+        return ret;
+}
+
+void
+quota_ancestry_cache_del (xlator_t *this, uuid_t gfid)
+{
+        quota_priv_t     *priv  = NULL;
+        quota_ancestry_t *entry = NULL;
+
+        priv = this->private;
+
+        if (priv->ancestry_hash == NULL)
+                return;
+
+        LOCK (&priv->ancestry_lock);
+        {
+                entry = __quota_ancestry_find (priv, gfid);
+                if (entry != NULL)
+                        __quota_ancestry_free (priv, entry);
+        }
+        UNLOCK (&priv->ancestry_lock);
+}
+
+/* Find the parent of an inode which has no dentry in the inode table, from
+ * either its only quota dentry or the ancestry cache. Returns NULL if the
+ * parent is unknown or not in the inode table, in which case the ancestry has
+ * to be built by the brick.
+ */
+inode_t *
+quota_ancestry_parent (xlator_t *this, inode_t *inode, quota_inode_ctx_t *ctx)
+{
+        quota_dentry_t *dentry = NULL;
+        uuid_t          par    = {0, };
+        int             count  = 0;
+
+        if (ctx != NULL) {
+                LOCK (&ctx->lock);
+                {
+                        list_for_each_entry (dentry, &ctx->parents, next) {
+                                if (count++ == 0)
+                                        uuid_copy (par, dentry->par);
+                        }
+                }
+                UNLOCK (&ctx->lock);
+
+                /* hardlinks need all the paths to root to be checked */
+                if (count > 1)
+                        return NULL;
+        }
+
+        if (uuid_is_null (par)
+            && (quota_ancestry_cache_get (this, inode->gfid, par) < 0))
+                return NULL;
+
+        return inode_find (inode->table, par);
+}
+
 static inline void
 quota_link_count_decrement (quota_local_t *local)
 {
@@ -299,6 +504,61 @@ out:
         return;
 }
 
+/* Refresh the ancestors validated along with validate_loc from the sizes
+ * quotad sent back. Ancestors missing from the reply (quotad could not look
+ * them up, or does not know about batches) are dropped from local->validated
+ * so that they get validated on their own.
+ */
+static void
+quota_validate_batch_update (xlator_t *this, quota_local_t *local,
+                             dict_t *xdata)
+{
+        inode_t           *inode = NULL;
+        quota_inode_ctx_t *ctx   = NULL;
+        char               key[512];
+        int64_t            size  = 0;
+        uint64_t           value = 0;
+        int32_t            i     = 0, count = 0;
+
+        LOCK (&local->lock);
+        {
+                for (i = 0; i < local->nr_validated; i++) {
+                        snprintf (key, sizeof (key), "%s.%s",
+                                  QUOTA_VALIDATE_SIZE_KEY,
+                                  uuid_utoa (local->validated[i]));
+                        if (dict_get_int64 (xdata, key, &size) < 0)
+                                continue;
+
+                        inode = inode_find (local->validate_loc.inode->table,
+                                            local->validated[i]);
+                        if (inode == NULL)
+                                continue;
+
+                        value = 0;
+                        inode_ctx_get (inode, this, &value);
+                        ctx = (quota_inode_ctx_t *)(unsigned long)value;
+                        if (ctx != NULL) {
+                                LOCK (&ctx->lock);
+                                {
+                                        ctx->size = size;
+                                        gettimeofday (&ctx->tv, NULL);
+                                }
+                                UNLOCK (&ctx->lock);
+
+                                if (count != i)
+                                        uuid_copy (local->validated[count],
+                                                   local->validated[i]);
+                                count++;
+                        }
+
+                        inode_unref (inode);
+                }
+
+                local->nr_validated = count;
+        }
+        UNLOCK (&local->lock);
+}
+
 int32_t
 quota_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -353,10 +613,20 @@ quota_validate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         }
         UNLOCK (&ctx->lock);
 
+        quota_validate_batch_update (this, local, xdata);
+
         quota_check_limit (frame, local->validate_loc.inode, this, NULL, NULL);
         return 0;
 
 unwind:
+        if (local != NULL) {
+                LOCK (&local->lock);
+                {
+                        local->nr_validated = 0;
+                }
+                UNLOCK (&local->lock);
+        }
+
         quota_handle_validate_error (local, op_ret, op_errno);
         return 0;
 }
@@ -649,9 +919,13 @@ err:
         return 0;
 }
 
+/* Validate @inode through quotad. Sizes of the @count ancestors in @batch
+ * are fetched in the same request, and remembered in local->validated so that
+ * the walk restarted from quota_validate_cbk does not revalidate them.
+ */
 int
-quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
-                fop_lookup_cbk_t cbk_fn)
+quota_validate_batch (call_frame_t *frame, inode_t *inode, xlator_t *this,
+                      fop_lookup_cbk_t cbk_fn, uuid_t *batch, int32_t count)
 {
         quota_local_t     *local = NULL;
         int                ret   = 0;
@@ -665,6 +939,11 @@ quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
         {
                 loc_wipe (&local->validate_loc);
 
+                if (count > 0)
+                        memcpy (local->validated, batch,
+                                count * sizeof (uuid_t));
+                local->nr_validated = count;
+
                 ret = quota_inode_loc_fill (inode, &local->validate_loc);
                 if (ret < 0) {
                         gf_log (this->name, GF_LOG_WARNING,
@@ -700,6 +979,23 @@ quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
                 goto err;
         }
 
+        if (count > 0) {
+                ret = dict_set_static_bin (xdata, QUOTA_VALIDATE_BATCH_KEY,
+                                           local->validated,
+                                           count * sizeof (uuid_t));
+                if (ret < 0) {
+                        gf_log (this->name, GF_LOG_WARNING, "dict set failed");
+                        ret = -ENOMEM;
+                        goto err;
+                }
+
+                LOCK (&priv->lock);
+                {
+                        priv->batched_validations++;
+                }
+                UNLOCK (&priv->lock);
+        }
+
         ret = quota_enforcer_lookup (frame, this, &local->validate_loc, xdata,
                                      cbk_fn);
         if (ret < 0) {
@@ -715,6 +1011,13 @@ err:
         return ret;
 }
 
+int
+quota_validate (call_frame_t *frame, inode_t *inode, xlator_t *this,
+                fop_lookup_cbk_t cbk_fn)
+{
+        return quota_validate_batch (frame, inode, this, cbk_fn, NULL, 0);
+}
+
 void
 quota_check_limit_continuation (struct list_head *parents, inode_t *inode,
                                 int32_t op_ret, int32_t op_errno, void *data)
@@ -765,12 +1068,26 @@ out:
         return;
 }
 
+static inline gf_boolean_t
+quota_gfid_in (uuid_t gfid, uuid_t *list, int32_t count)
+{
+        int32_t i = 0;
+
+        for (i = 0; i < count; i++) {
+                if (uuid_compare (gfid, list[i]) == 0)
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
 int32_t
 quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                    char *name, uuid_t par)
 {
         int32_t            ret                 = -1, op_errno = EINVAL;
         inode_t           *_inode              = NULL, *parent = NULL;
+        inode_t           *validate_inode      = NULL;
         quota_inode_ctx_t *ctx                 = NULL;
         quota_priv_t      *priv                = NULL;
         quota_local_t     *local               = NULL;
@@ -782,6 +1099,10 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
         char               just_validated      = 0;
         uuid_t             trav_uuid           = {0,};
         uint32_t           timeout             = 0;
+        uuid_t             validated[QUOTA_VALIDATE_BATCH_MAX];
+        int32_t            nr_validated        = 0;
+        uuid_t             batch[QUOTA_VALIDATE_BATCH_MAX];
+        int32_t            nr_batch            = 0;
 
         GF_VALIDATE_OR_GOTO ("quota", this, err);
         GF_VALIDATE_OR_GOTO (this->name, frame, err);
@@ -818,6 +1139,12 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
         {
                 just_validated = local->just_validated;
                 local->just_validated = 0;
+
+                nr_validated = local->nr_validated;
+                if (nr_validated > 0)
+                        memcpy (validated, local->validated,
+                                nr_validated * sizeof (uuid_t));
+                local->nr_validated = 0;
         }
         UNLOCK (&local->lock);
 
@@ -825,9 +1152,16 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                 uuid_copy (trav_uuid, par);
         }
 
+        /* Ancestors whose cached size has timed out are not validated one
+         * at a time. The walk goes on till root collecting them, and they
+         * are all validated in a single request to quotad, after which the
+         * walk is restarted from the first of them.
+         */
         do {
                 if (ctx != NULL && (ctx->hard_lim > 0 || ctx->soft_lim > 0)) {
                         wouldbe_size = ctx->size + delta;
+                        need_validate = 0;
+                        hard_limit_exceeded = 0;
 
                         LOCK (&ctx->lock);
                         {
@@ -839,6 +1173,8 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                                 }
 
                                 if (!just_validated
+                                    && !quota_gfid_in (_inode->gfid, validated,
+                                                       nr_validated)
                                     && quota_timeout (&ctx->tv, timeout)) {
                                         need_validate = 1;
                                 } else if (wouldbe_size >= ctx->hard_lim) {
@@ -848,14 +1184,15 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                         UNLOCK (&ctx->lock);
 
                         if (need_validate) {
-                                ret = quota_validate (frame, _inode, this,
-                                                      quota_validate_cbk);
-                                if (ret < 0) {
-                                        op_errno = -ret;
-                                        goto err;
+                                if (validate_inode == NULL) {
+                                        validate_inode = inode_ref (_inode);
+                                } else {
+                                        uuid_copy (batch[nr_batch++],
+                                                   _inode->gfid);
+                                        if (nr_batch
+                                            == QUOTA_VALIDATE_BATCH_MAX)
+                                                break;
                                 }
-
-                                break;
                         }
 
                         if (hard_limit_exceeded) {
@@ -883,11 +1220,13 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
 
                         /* We log usage only if quota limit is configured on
                            that inode. */
-                        quota_log_usage (this, ctx, _inode, delta);
+                        if (!need_validate)
+                                quota_log_usage (this, ctx, _inode, delta);
                 }
 
                 if (__is_root_gfid (_inode->gfid)) {
-                        quota_link_count_decrement (local);
+                        if (validate_inode == NULL)
+                                quota_link_count_decrement (local);
                         break;
                 }
 
@@ -898,7 +1237,16 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                         uuid_clear (trav_uuid);
                 }
 
+                if (parent == NULL)
+                        parent = quota_ancestry_parent (this, _inode, ctx);
+
                 if (parent == NULL) {
+                        /* validate what has been collected so far, the
+                         * ancestry is built when the walk gets here again.
+                         */
+                        if (validate_inode != NULL)
+                                break;
+
                         ret = quota_build_ancestry (_inode,
                                                     quota_check_limit_continuation,
                                                     frame);
@@ -928,13 +1276,29 @@ quota_check_limit (call_frame_t *frame, inode_t *inode, xlator_t *this,
                 _inode = NULL;
         }
 
+        if (validate_inode != NULL) {
+                ret = quota_validate_batch (frame, validate_inode, this,
+                                            quota_validate_cbk, batch,
+                                            nr_batch);
+                inode_unref (validate_inode);
+                validate_inode = NULL;
+
+                if (ret < 0) {
+                        op_errno = -ret;
+                        goto err;
+                }
+        }
+
 done:
         return 0;
 
 err:
         quota_handle_validate_error (local, -1, op_errno);
 
-        inode_unref (_inode);
+        if (_inode != NULL)
+                inode_unref (_inode);
+        if (validate_inode != NULL)
+                inode_unref (validate_inode);
         return 0;
 }
 
@@ -986,6 +1350,14 @@ quota_fill_inodectx (xlator_t *this, inode_t *inode, dict_t *dict,
 
         quota_get_limits (this, dict, &hard_lim, &soft_lim);
 
+        if ((loc->parent != NULL) && !__is_root_gfid (buf->ia_gfid)) {
+                if (IA_ISDIR (buf->ia_type) || (buf->ia_nlink == 1))
+                        quota_ancestry_cache_set (this, buf->ia_gfid,
+                                                  loc->parent->gfid);
+                else
+                        quota_ancestry_cache_del (this, buf->ia_gfid);
+        }
+
         inode_ctx_get (inode, this, &value);
         ctx = (quota_inode_ctx_t *)(unsigned long)value;
 
@@ -1606,6 +1978,8 @@ quota_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         local = (quota_local_t *) frame->local;
 
+        quota_ancestry_cache_del (this, local->loc.inode->gfid);
+
         inode_ctx_get (local->loc.inode, this, &value);
         ctx = (quota_inode_ctx_t *)(unsigned long)value;
 
@@ -1704,6 +2078,9 @@ quota_link_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         local = (quota_local_t *) frame->local;
 
+        /* the inode has more than one parent now */
+        quota_ancestry_cache_del (this, inode->gfid);
+
         if (local->skip_check)
                 goto out;
 
@@ -1891,6 +2268,10 @@ quota_rename_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 goto out;
         }
 
+        quota_ancestry_cache_del (this, local->oldloc.inode->gfid);
+        if (local->newloc.inode != NULL)
+                quota_ancestry_cache_del (this, local->newloc.inode->gfid);
+
         if (QUOTA_REG_OR_LNK_FILE (local->oldloc.inode->ia_type)) {
                 size = buf->ia_blocks * 512;
         }
@@ -4302,6 +4683,15 @@ init (xlator_t *this)
         GF_OPTION_INIT ("hard-timeout", priv->hard_timeout, time, err);
         GF_OPTION_INIT ("alert-time", priv->log_timeout, time, err);
         GF_OPTION_INIT ("volume-uuid", priv->volume_uuid, str, err);
+        GF_OPTION_INIT ("ancestry-cache-size", priv->ancestry_cache_size,
+                        uint32, err);
+
+        if (quota_ancestry_cache_init (priv) < 0) {
+                ret = -1;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "failed to create the ancestry cache");
+                goto err;
+        }
 
         this->local_pool = mem_pool_new (quota_local_t, 64);
         if (!this->local_pool) {
@@ -4354,6 +4744,14 @@ reconfigure (xlator_t *this, dict_t *options)
                           time, out);
         GF_OPTION_RECONF ("hard-timeout", priv->hard_timeout, options,
                           time, out);
+        GF_OPTION_RECONF ("ancestry-cache-size", priv->ancestry_cache_size,
+                          options, uint32, out);
+
+        LOCK (&priv->ancestry_lock);
+        {
+                __quota_ancestry_trim (priv, priv->ancestry_cache_size);
+        }
+        UNLOCK (&priv->ancestry_lock);
 
         if (quota_on) {
                 priv->rpc_clnt = quota_enforcer_init (this,
@@ -4415,6 +4813,16 @@ quota_priv_dump (xlator_t *this)
                 gf_proc_dump_write("volume-uuid", "%s", priv->volume_uuid);
                 gf_proc_dump_write("validation-count", "%ld",
                                     priv->validation_count);
+                gf_proc_dump_write("batched-validations", "%"PRIu64,
+                                    priv->batched_validations);
+                gf_proc_dump_write("ancestry-cache-size", "%u",
+                                    priv->ancestry_cache_size);
+                gf_proc_dump_write("ancestry-cache-count", "%u",
+                                    priv->ancestry_count);
+                gf_proc_dump_write("ancestry-cache-hits", "%"PRIu64,
+                                    priv->ancestry_hits);
+                gf_proc_dump_write("ancestry-cache-misses", "%"PRIu64,
+                                    priv->ancestry_misses);
         }
         UNLOCK (&priv->lock);
 
@@ -4425,6 +4833,14 @@ out:
 void
 fini (xlator_t *this)
 {
+        quota_priv_t *priv = NULL;
+
+        priv = this->private;
+        if (priv == NULL)
+                return;
+
+        quota_ancestry_cache_fini (priv);
+
         return;
 }
 
@@ -4530,5 +4946,14 @@ struct volume_options options[] = {
           .max = 7*86400,
           .default_value = "86400",
         },
+        { .key  = {"ancestry-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 1048576,
+          .default_value = "65536",
+          .description = "Number of parent gfids of directories and files "
+                         "the brick remembers to find the ancestors of an "
+                         "inode without crawling them. 0 disables the cache."
+        },
         {.key = {NULL}}
 };
@@ -150,6 +150,15 @@
 #define QUOTA_REG_OR_LNK_FILE(ia_type)  \
     (IA_ISREG (ia_type) || IA_ISLNK (ia_type))
 
+/* gfids of further ancestors to be validated along with the inode of a
+ * quotad lookup, and the per-gfid sizes quotad sends back for them.
+ */
+#define QUOTA_VALIDATE_BATCH_KEY "glusterfs.quota.validate-batch"
+#define QUOTA_VALIDATE_SIZE_KEY  "glusterfs.quota.validate-size"
+#define QUOTA_VALIDATE_BATCH_MAX 32
+
+#define QUOTA_ANCESTRY_HASH_SIZE 1024
+
 
 
 struct quota_dentry {
@@ -159,6 +168,14 @@ struct quota_dentry {
 };
 typedef struct quota_dentry quota_dentry_t;
 
+struct quota_ancestry {
+        uuid_t           gfid;
+        uuid_t           par;
+        struct list_head hash;
+        struct list_head lru;
+};
+typedef struct quota_ancestry quota_ancestry_t;
+
 struct quota_inode_ctx {
         int64_t          size;
         int64_t          hard_lim;
@@ -195,6 +212,8 @@ struct quota_local {
         int64_t                 size;
         gf_boolean_t            skip_check;
         char                    just_validated;
+        uuid_t                  validated[QUOTA_VALIDATE_BATCH_MAX];
+        int32_t                 nr_validated;
         fop_lookup_cbk_t        validate_cbk;
         inode_t                *inode;
         call_stub_t            *stub;
@@ -222,6 +241,14 @@ struct quota_priv {
         inode_table_t         *itable;
         char                  *volume_uuid;
         uint64_t               validation_count;
+        uint64_t               batched_validations;
+        gf_lock_t              ancestry_lock;
+        struct list_head      *ancestry_hash;
+        struct list_head       ancestry_lru;
+        uint32_t               ancestry_cache_size;
+        uint32_t               ancestry_count;
+        uint64_t               ancestry_hits;
+        uint64_t               ancestry_misses;
 };
 typedef struct quota_priv      quota_priv_t;
 
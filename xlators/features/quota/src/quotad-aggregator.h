@@ -16,18 +16,36 @@
 #include "glusterfs3-xdr.h"
 #include "inode.h"
 
-typedef struct {
-        void          *pool;
-        xlator_t      *this;
-	xlator_t      *active_subvol;
-        inode_table_t *itable;
-        loc_t          loc;
-        dict_t        *xdata;
-} quotad_aggregator_state_t;
-
 typedef int (*quotad_aggregator_lookup_cbk_t) (xlator_t *this,
                                                call_frame_t *frame,
                                                void *rsp);
+
+/* lookup of an inode along with a batch of its ancestors, whose sizes are
+ * merged into the reply of the inode.
+ */
+typedef struct {
+        gf_lock_t                       lock;
+        int32_t                         call_count;
+        uuid_t                         *gfids;
+        int32_t                         count;
+        int32_t                         op_ret;
+        int32_t                         op_errno;
+        struct iatt                     stat;
+        struct iatt                     postparent;
+        dict_t                         *xdata;
+        dict_t                         *sizes;
+        quotad_aggregator_lookup_cbk_t  lookup_cbk;
+} qd_batch_lookup_t;
+
+typedef struct {
+        void              *pool;
+        xlator_t          *this;
+	xlator_t          *active_subvol;
+        inode_table_t     *itable;
+        loc_t              loc;
+        dict_t            *xdata;
+        qd_batch_lookup_t *batch;
+} quotad_aggregator_state_t;
 int
 qd_nameless_lookup (xlator_t *this, call_frame_t *frame, gfs3_lookup_req *req,
                     dict_t *xdata, quotad_aggregator_lookup_cbk_t lookup_cbk);
@@ -86,6 +86,184 @@ out:
         return subvol;
 }
 
+static void
+qd_batch_lookup_free (qd_batch_lookup_t *batch)
+{
+        if (batch == NULL)
+                return;
+
+        if (batch->xdata)
+                dict_unref (batch->xdata);
+
+        if (batch->sizes)
+                dict_unref (batch->sizes);
+
+        LOCK_DESTROY (&batch->lock);
+
+        GF_FREE (batch->gfids);
+        GF_FREE (batch);
+}
+
+static void
+qd_batch_lookup_done (xlator_t *this, call_frame_t *frame,
+                      qd_batch_lookup_t *batch)
+{
+        gfs3_lookup_rsp  rsp   = {0, };
+        dict_t          *xdata = NULL;
+
+        rsp.op_ret = batch->op_ret;
+        rsp.op_errno = batch->op_errno;
+
+        gf_stat_from_iatt (&rsp.postparent, &batch->postparent);
+
+        xdata = batch->xdata;
+        if (rsp.op_ret == 0) {
+                if (xdata == NULL)
+                        xdata = batch->sizes;
+                else
+                        dict_copy (batch->sizes, xdata);
+        }
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, (&rsp.xdata.xdata_val),
+                                    rsp.xdata.xdata_len, rsp.op_errno, out);
+
+        gf_stat_from_iatt (&rsp.stat, &batch->stat);
+
+out:
+        /* frame and state are gone once the reply is submitted */
+        batch->lookup_cbk (this, frame, &rsp);
+
+        GF_FREE (rsp.xdata.xdata_val);
+
+        qd_batch_lookup_free (batch);
+}
+
+int32_t
+qd_batch_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, inode_t *inode,
+                     struct iatt *buf, dict_t *xdata, struct iatt *postparent)
+{
+        quotad_aggregator_state_t *state      = NULL;
+        qd_batch_lookup_t         *batch      = NULL;
+        long                       index      = 0;
+        int64_t                   *size       = NULL;
+        int32_t                    call_count = 0;
+        char                       key[512];
+        int                        ret        = 0;
+
+        state = frame->root->state;
+        batch = state->batch;
+        index = (long) cookie;
+
+        if (index == 0) {
+                batch->op_ret = op_ret;
+                batch->op_errno = op_errno;
+
+                if (op_ret == 0)
+                        batch->stat = *buf;
+                if (postparent)
+                        batch->postparent = *postparent;
+                if (xdata)
+                        batch->xdata = dict_ref (xdata);
+        } else if ((op_ret == 0) && (xdata != NULL)
+                   && (dict_get_bin (xdata, QUOTA_SIZE_KEY,
+                                     (void **) &size) == 0)) {
+                snprintf (key, sizeof (key), "%s.%s", QUOTA_VALIDATE_SIZE_KEY,
+                          uuid_utoa (batch->gfids[index - 1]));
+
+                ret = dict_set_int64 (batch->sizes, key, ntoh64 (*size));
+                if (ret < 0)
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "failed to set size of %s in the reply",
+                                uuid_utoa (batch->gfids[index - 1]));
+        }
+
+        inode_unref (inode);
+
+        LOCK (&batch->lock);
+        {
+                call_count = --batch->call_count;
+        }
+        UNLOCK (&batch->lock);
+
+        if (call_count == 0) {
+                state->batch = NULL;
+                qd_batch_lookup_done (this, frame, batch);
+        }
+
+        return 0;
+}
+
+/* Look up the inode of @loc and the ancestors listed in @gfids in parallel.
+ * Returns non-zero without winding anything if the batch could not be set
+ * up, so that the caller can fall back to looking up the inode alone.
+ */
+static int
+qd_batch_lookup (xlator_t *this, call_frame_t *frame, loc_t *loc,
+                 uuid_t *gfids, int32_t count, dict_t *xdata,
+                 xlator_t *subvol, quotad_aggregator_lookup_cbk_t lookup_cbk)
+{
+        quotad_aggregator_state_t  *state  = NULL;
+        qd_batch_lookup_t          *batch  = NULL;
+        loc_t                      *locs   = NULL;
+        int32_t                     i      = 0;
+        int                         ret    = -1;
+
+        state = frame->root->state;
+
+        batch = GF_CALLOC (1, sizeof (*batch), gf_quota_mt_qd_batch_lookup_t);
+        if (batch == NULL)
+                goto err;
+
+        LOCK_INIT (&batch->lock);
+
+        batch->gfids = GF_CALLOC (count, sizeof (uuid_t),
+                                  gf_quota_mt_qd_batch_lookup_t);
+        locs = GF_CALLOC (count, sizeof (*locs), gf_quota_mt_loc_t);
+        batch->sizes = dict_new ();
+        if ((batch->gfids == NULL) || (locs == NULL) || (batch->sizes == NULL))
+                goto err;
+
+        memcpy (batch->gfids, gfids, count * sizeof (uuid_t));
+        batch->count = count;
+        batch->lookup_cbk = lookup_cbk;
+        batch->call_count = count + 1;
+
+        for (i = 0; i < count; i++) {
+                locs[i].inode = inode_new (state->itable);
+                if (locs[i].inode == NULL)
+                        goto err;
+
+                uuid_copy (locs[i].gfid, batch->gfids[i]);
+        }
+
+        state->batch = batch;
+
+        STACK_WIND_COOKIE (frame, qd_batch_lookup_cbk, (void *)(long) 0,
+                           subvol, subvol->fops->lookup, loc, xdata);
+
+        for (i = 0; i < count; i++) {
+                STACK_WIND_COOKIE (frame, qd_batch_lookup_cbk,
+                                   (void *)(long) (i + 1), subvol,
+                                   subvol->fops->lookup, &locs[i], xdata);
+        }
+
+        GF_FREE (locs);
+        return 0;
+
+err:
+        if (locs != NULL) {
+                for (i = 0; i < count; i++) {
+                        if (locs[i].inode)
+                                inode_unref (locs[i].inode);
+                }
+                GF_FREE (locs);
+        }
+
+        qd_batch_lookup_free (batch);
+        return ret;
+}
+
 int
 qd_nameless_lookup (xlator_t *this, call_frame_t *frame, gfs3_lookup_req *req,
                     dict_t *xdata, quotad_aggregator_lookup_cbk_t lookup_cbk)
@@ -97,6 +275,9 @@ qd_nameless_lookup (xlator_t *this, call_frame_t *frame, gfs3_lookup_req *req,
         quota_priv_t              *priv        = NULL;
         xlator_t                  *subvol      = NULL;
         char                      *volume_uuid = NULL;
+        data_t                    *data        = NULL;
+        uuid_t                     gfids[QUOTA_VALIDATE_BATCH_MAX];
+        int32_t                    count       = 0;
 
         priv = this->private;
         state = frame->root->state;
@@ -123,6 +304,22 @@ qd_nameless_lookup (xlator_t *this, call_frame_t *frame, gfs3_lookup_req *req,
                 goto out;
         }
 
+        data = dict_get (xdata, QUOTA_VALIDATE_BATCH_KEY);
+        if (data != NULL) {
+                count = data->len / sizeof (uuid_t);
+                if (count > QUOTA_VALIDATE_BATCH_MAX)
+                        count = QUOTA_VALIDATE_BATCH_MAX;
+                memcpy (gfids, data->data, count * sizeof (uuid_t));
+
+                /* not to be passed on as an xattr request */
+                dict_del (xdata, QUOTA_VALIDATE_BATCH_KEY);
+        }
+
+        if ((count > 0)
+            && (qd_batch_lookup (this, frame, &loc, gfids, count, xdata,
+                                 subvol, lookup_cbk) == 0))
+                return 0;
+
         STACK_WIND_COOKIE (frame, qd_lookup_cbk, lookup_cbk, subvol,
                            subvol->fops->lookup, &loc, xdata);
         return 0;
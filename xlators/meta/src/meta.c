@@ -15,6 +15,7 @@
 
 #include "xlator.h"
 #include "defaults.h"
+#include "compound-fop-utils.h"
 
 #include "meta-mem-types.h"
 #include "meta.h"
@@ -169,6 +170,39 @@ meta_ftruncate (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 	return 0;
 }
 
+/* compounds of fops on regular files go down as they are, those touching
+   anything under the meta directory are run here one by one */
+int
+meta_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+	       dict_t *xdata)
+{
+	compound_fop_t *cfop = NULL;
+	inode_t *inode = NULL;
+	int i = 0;
+
+	for (i = 0; i < args->count; i++) {
+		cfop = &args->fops[i];
+
+		if (cfop->fd) {
+			inode = cfop->fd->inode;
+		} else {
+			if ((cfop->loc.name && META_HOOK ((&cfop->loc))) ||
+			    IS_META_ROOT_GFID (cfop->loc.gfid))
+				goto serial;
+			inode = cfop->loc.parent ? cfop->loc.parent :
+				cfop->loc.inode;
+		}
+
+		if (meta_ops_get (inode, this))
+			goto serial;
+	}
+
+	return default_compound (frame, this, args, xdata);
+serial:
+	return compound_fop_serial (frame, this, args, xdata);
+}
+
+
 int
 meta_forget (xlator_t *this, inode_t *inode)
 {
@@ -247,7 +281,8 @@ struct xlator_fops fops = {
 	.readlink = meta_readlink,
 	.writev = meta_writev,
 	.truncate = meta_truncate,
-	.ftruncate = meta_ftruncate
+	.ftruncate = meta_ftruncate,
+	.compound = meta_compound
 };
 
 
@@ -2948,6 +2948,8 @@ build_client_graph (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
 char *gd_shd_options[] = {
         "!self-heal-daemon",
         "!heal-timeout",
+        "!shd-max-threads",
+        "!shd-full-crawl-incremental",
         NULL
 };
 
@@ -493,6 +493,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 2,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.shd-max-threads",
+          .voltype    = "cluster/replicate",
+          .option     = "!shd-max-threads",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.shd-full-crawl-incremental",
+          .voltype    = "cluster/replicate",
+          .option     = "!shd-full-crawl-incremental",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
         { .key        = "cluster.strict-readdir",
           .voltype    = "cluster/replicate",
           .type       = NO_DOC,
@@ -564,6 +576,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .op_version = 3,
           .flags      = OPT_FLAG_CLIENT_OPT
         },
+        { .key        = "cluster.dirty-region-size",
+          .voltype    = "cluster/replicate",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.lock-caching",
+          .voltype    = "cluster/replicate",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.pre-op-compat",
+          .voltype    = "cluster/replicate",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
+        { .key        = "cluster.post-op-piggyback",
+          .voltype    = "cluster/replicate",
+          .op_version = GD_OP_VERSION_3_7_0,
+          .flags      = OPT_FLAG_CLIENT_OPT
+        },
 
         /* Stripe xlator options */
         { .key         = "cluster.stripe-block-size",
@@ -973,6 +1005,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .voltype     = "protocol/server",
           .op_version  = GD_OP_VERSION_3_6_0,
         },
+        { .key         = "server.zero-copy-read",
+          .voltype     = "protocol/server",
+          .op_version  = GD_OP_VERSION_3_7_0,
+        },
 
         /* Generic transport options */
         { .key         = SSL_CERT_DEPTH_OPT,
@@ -1219,6 +1255,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type          = NO_DOC,
           .op_version    = 3,
         },
+        { .key           = "features.quota-ancestry-cache-size",
+          .voltype       = "features/quota",
+          .option        = "ancestry-cache-size",
+          .op_version    = GD_OP_VERSION_3_7_0,
+        },
         { .key           = "features.quota-deem-statfs",
           .voltype       = "features/quota",
           .option        = "deem-statfs",
@@ -1229,6 +1270,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         },
 
         /* Marker xlator options */
+        { .key         = "features.quota-update-interval",
+          .voltype     = "features/marker",
+          .option      = "quota-update-interval",
+          .op_version  = GD_OP_VERSION_3_7_0,
+        },
         { .key         = VKEY_MARKER_XTIME,
           .voltype     = "features/marker",
           .option      = "xtime",
@@ -1386,6 +1432,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = GLOBAL_DOC,
           .op_version  = 3
         },
+        { .key         = "nfs.outstanding-rpc-window-max",
+          .voltype     = "nfs/server",
+          .option      = "rpc.outstanding-rpc-window-max",
+          .type        = GLOBAL_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "nfs.request-threads",
+          .voltype     = "nfs/server",
+          .option      = "rpc.request-threads",
+          .type        = GLOBAL_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
         { .key         = "nfs.port",
           .voltype     = "nfs/server",
           .option      = "nfs.port",
@@ -1532,6 +1590,23 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .type        = GLOBAL_DOC,
           .op_version  = 3
         },
+        { .key         = "nfs.fd-cache-limit",
+          .voltype     = "nfs/server",
+          .option      = "!nfs3.*.fd-cache-limit",
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "nfs.fd-cache-timeout",
+          .voltype     = "nfs/server",
+          .option      = "nfs3.fd-cache-timeout",
+          .type        = GLOBAL_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "nfs.write-gather-size",
+          .voltype     = "nfs/server",
+          .option      = "nfs3.write-gather-size",
+          .type        = GLOBAL_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
 
         /* Other options which don't fit any place above */
         { .key        = "features.read-only",
@@ -1552,6 +1627,22 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .voltype     = "storage/posix",
           .op_version  = 1
         },
+        { .key         = "storage.io-uring",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "storage.io-uring-sqpoll",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "storage.handle-cache-size",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "storage.handle-cache-open-by-handle",
+          .voltype     = "storage/posix",
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
         { .key         = "storage.batch-fsync-mode",
           .voltype     = "storage/posix",
           .op_version  = 3
@@ -1612,6 +1703,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .value       = "0",
           .op_version  = 2
         },
+        /* locks translator options */
+        { .key         = "features.locks-notify-contention-delay",
+          .voltype     = "features/locks",
+          .option      = "notify-contention-delay",
+          .op_version  = GD_OP_VERSION_3_7_0,
+        },
+        /* index translator options */
+        { .key         = "features.index-batch-window",
+          .voltype     = "features/index",
+          .option      = "batch-window",
+          .op_version  = GD_OP_VERSION_3_7_0,
+        },
         /* changelog translator - global tunables */
         { .key         = "changelog.changelog",
           .voltype     = "features/changelog",
@@ -1643,6 +1746,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
           .value       = BARRIER_TIMEOUT,
           .op_version  = GD_OP_VERSION_3_6_0,
         },
+        { .key         = "changelog.op-mode",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "changelog.buffered-flush-interval",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "changelog.streaming",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
+        { .key         = "changelog.stream-buffer-size",
+          .voltype     = "features/changelog",
+          .type        = NO_DOC,
+          .op_version  = GD_OP_VERSION_3_7_0
+        },
         { .key         = "features.barrier",
           .voltype     = "features/barrier",
           .value       = "disable",
@@ -1376,7 +1376,8 @@ nfs_fop_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 int
 nfs_fop_write (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
                struct iobref *srciobref, struct iovec *vector, int32_t count,
-               off_t offset, fop_writev_cbk_t cbk, void *local)
+               off_t offset, int32_t flags, fop_writev_cbk_t cbk,
+               void *local)
 {
         call_frame_t            *frame = NULL;
         int                     ret = -EFAULT;
@@ -1399,7 +1400,7 @@ nfs_fop_write (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
         iobref_add (nfl->iobref, srciob);
 */
         STACK_WIND_COOKIE (frame, nfs_fop_writev_cbk, xl, xl,xl->fops->writev,
-                           fd, vector, count, offset, fd->flags, srciobref, NULL);
+                           fd, vector, count, offset, flags, srciobref, NULL);
         ret = 0;
 err:
         if (ret < 0) {
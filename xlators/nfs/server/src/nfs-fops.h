@@ -176,7 +176,8 @@ nfs_fop_fsync (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
 extern int
 nfs_fop_write (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
                struct iobref *srciobref, struct iovec *vector, int32_t count,
-               off_t offset, fop_writev_cbk_t cbk, void *local);
+               off_t offset, int32_t flags, fop_writev_cbk_t cbk,
+               void *local);
 
 extern int
 nfs_fop_open (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, loc_t *loc,
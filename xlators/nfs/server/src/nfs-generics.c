@@ -183,10 +183,11 @@ nfs_fsync (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
 int
 nfs_write (xlator_t *nfsx, xlator_t *xl, nfs_user_t *nfu, fd_t *fd,
            struct iobref *srciobref, struct iovec *vector, int32_t count,
-           off_t offset, fop_writev_cbk_t cbk, void *local)
+           off_t offset, int32_t flags, fop_writev_cbk_t cbk,
+           void *local)
 {
         return nfs_fop_write (nfsx, xl, nfu, fd, srciobref, vector, count,
-                              offset, cbk, local);
+                              offset, flags, cbk, local);
 }
 
 
@@ -987,6 +987,23 @@ nfs_init_state (xlator_t *this)
                 goto free_foppool;
         }
 
+        ret = rpcsvc_set_outstanding_rpc_window_max (nfs->rpcsvc,
+                                this->options,
+                                RPCSVC_DEF_NFS_OUTSTANDING_RPC_WINDOW_MAX);
+        if (ret < 0) {
+                gf_log (GF_NFS, GF_LOG_ERROR,
+                        "Failed to configure outstanding-rpc-window-max");
+                goto free_foppool;
+        }
+
+        ret = rpcsvc_set_request_threads (nfs->rpcsvc, this->options,
+                                          RPCSVC_DEF_NFS_REQUEST_THREADS);
+        if (ret < 0) {
+                gf_log (GF_NFS, GF_LOG_ERROR,
+                        "Failed to configure request-threads");
+                goto free_foppool;
+        }
+
         nfs->register_portmap = rpcsvc_register_portmap_enabled (nfs->rpcsvc);
 
         this->private = (void *)nfs;
@@ -1259,6 +1276,22 @@ reconfigure (xlator_t *this, dict_t *options)
                 return (-1);
         }
 
+        ret = rpcsvc_set_outstanding_rpc_window_max (nfs->rpcsvc, options,
+                                RPCSVC_DEF_NFS_OUTSTANDING_RPC_WINDOW_MAX);
+        if (ret < 0) {
+                gf_log (GF_NFS, GF_LOG_ERROR,
+                        "Failed to reconfigure outstanding-rpc-window-max");
+                return (-1);
+        }
+
+        ret = rpcsvc_set_request_threads (nfs->rpcsvc, options,
+                                          RPCSVC_DEF_NFS_REQUEST_THREADS);
+        if (ret < 0) {
+                gf_log (GF_NFS, GF_LOG_ERROR,
+                        "Failed to reconfigure request-threads");
+                return (-1);
+        }
+
         regpmap = rpcsvc_register_portmap_enabled(nfs->rpcsvc);
         if (nfs->register_portmap != regpmap) {
                 nfs->register_portmap = regpmap;
@@ -1608,6 +1641,35 @@ struct volume_options options[] = {
                          " trusted-write behaviour. Off by default."
 
         },
+        { .key  = {"nfs3.*.fd-cache-limit"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 65536,
+          .default_value = "512",
+          .description = "Number of files of this subvolume whose fd is kept "
+                         "cached between READ, WRITE and COMMIT requests. "
+                         "The least recently used ones are dropped first. "
+                         "0 disables the cache and with it write gathering."
+        },
+        { .key  = {"nfs3.fd-cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 3600,
+          .default_value = "60",
+          .description = "Time in seconds after which a cached fd that was "
+                         "not used is dropped. 0 keeps them till they are "
+                         "pushed out by the fd-cache-limit."
+        },
+        { .key  = {"nfs3.write-gather-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .min  = 0,
+          .max  = 16 * GF_UNIT_MB,
+          .default_value = "1MB",
+          .description = "UNSTABLE writes following each other on a file "
+                         "while a write on it is in progress are sent to the "
+                         "volume as a single write of up to this size. "
+                         "0 disables write gathering."
+        },
         { .key  = {"nfs3.*.export-dir"},
           .type = GF_OPTION_TYPE_PATH,
           .default_value = "",
@@ -1795,6 +1857,30 @@ struct volume_options options[] = {
                          "requests from a client. 0 means no limit (can "
                          "potentially run out of memory)"
         },
+        { .key  = {"rpc.outstanding-rpc-window-max"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = RPCSVC_MIN_OUTSTANDING_RPC_LIMIT,
+          .max  = RPCSVC_MAX_OUTSTANDING_RPC_LIMIT,
+          .default_value = TOSTRING(RPCSVC_DEF_NFS_OUTSTANDING_RPC_WINDOW_MAX),
+          .description = "A client starts with rpc.outstanding-rpc-limit "
+                         "requests in flight. If its requests are answered "
+                         "quickly enough that it keeps being throttled, "
+                         "the number is doubled, up to this value, and "
+                         "halved back when the volume cannot keep up. A "
+                         "value not above rpc.outstanding-rpc-limit keeps "
+                         "it fixed."
+        },
+        { .key  = {"rpc.request-threads"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = RPCSVC_MAX_REQUEST_THREADS,
+          .default_value = TOSTRING(RPCSVC_DEF_NFS_REQUEST_THREADS),
+          .description = "Number of threads decoding NFS requests, resolving "
+                         "their file handles and encoding the replies. "
+                         "Requests of a client which depend on their order "
+                         "(NLM) are always handled by the same thread. 0 "
+                         "handles them in the thread reading the network."
+        },
         { .key  = {"nfs.port"},
           .type = GF_OPTION_TYPE_INT,
           .min  = 1,
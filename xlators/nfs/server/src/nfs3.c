@@ -383,6 +383,171 @@ err:
         return ret;
 }
 
+
+static struct nfs3_fd_entry *
+__nfs3_fdcache_lookup (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_fd_entry    *entry = NULL;
+        struct list_head        *head = NULL;
+
+        head = &nfs3->fdhash[inode->gfid[15] % GF_NFS3_FDCACHE_HASH];
+        list_for_each_entry (entry, head, hash) {
+                if (uuid_compare (entry->cachedfd->inode->gfid,
+                                  inode->gfid) == 0)
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+static void
+__nfs3_fdcache_remove (struct nfs3_state *nfs3, struct nfs3_fd_entry *entry,
+                       struct list_head *purge)
+{
+        list_del_init (&entry->hash);
+        list_move_tail (&entry->list, purge);
+        entry->exp->fdcount--;
+        nfs3->fdcount--;
+}
+
+
+/* Drops the entries idle for longer than the timeout and, least recently
+ * used first, those of @exp beyond its limit. Entries with writes in flight
+ * are kept.
+ */
+static void
+__nfs3_fdcache_prune (struct nfs3_state *nfs3, struct nfs3_export *exp,
+                      struct list_head *purge)
+{
+        struct nfs3_fd_entry    *entry = NULL;
+        struct nfs3_fd_entry    *tmp = NULL;
+        time_t                  now = 0;
+        int                     expired = 0;
+
+        now = time (NULL);
+        list_for_each_entry_safe (entry, tmp, &nfs3->fdlru, list) {
+                expired = (nfs3->fdtimeout &&
+                           (now - entry->lastused) >= nfs3->fdtimeout);
+                if (!expired && (exp->fdcount <= exp->fdlimit))
+                        break;
+
+                if (entry->writing)
+                        continue;
+
+                if (expired || (entry->exp == exp))
+                        __nfs3_fdcache_remove (nfs3, entry, purge);
+        }
+}
+
+
+static void
+nfs3_fdcache_purge (struct list_head *purge)
+{
+        struct nfs3_fd_entry    *entry = NULL;
+        struct nfs3_fd_entry    *tmp = NULL;
+
+        list_for_each_entry_safe (entry, tmp, purge, list) {
+                list_del_init (&entry->list);
+                gf_log (GF_NFS3, GF_LOG_TRACE, "fd cache drop: %s",
+                        uuid_utoa (entry->cachedfd->inode->gfid));
+                fd_unref (entry->cachedfd);
+                GF_FREE (entry);
+        }
+}
+
+
+/* Returns a ref on the (anonymous) fd to use for I/O on @inode, cached for
+ * the next requests on it unless the export's fd cache is disabled.
+ */
+fd_t *
+nfs3_fdcache_get (struct nfs3_state *nfs3, struct nfs3_fh *fh,
+                  inode_t *inode)
+{
+        struct nfs3_export      *exp = NULL;
+        struct nfs3_fd_entry    *entry = NULL;
+        fd_t                    *fd = NULL;
+        struct list_head        purge;
+
+        GF_VALIDATE_OR_GOTO (GF_NFS3, nfs3, out);
+        GF_VALIDATE_OR_GOTO (GF_NFS3, inode, out);
+
+        INIT_LIST_HEAD (&purge);
+        exp = __nfs3_get_export_by_exportid (nfs3, fh->exportid);
+        if (!exp)
+                goto anon;
+
+        LOCK (&nfs3->fdlrulock);
+        {
+                if (exp->fdlimit <= 0)
+                        goto prune;
+
+                entry = __nfs3_fdcache_lookup (nfs3, inode);
+                if (entry) {
+                        list_move_tail (&entry->list, &nfs3->fdlru);
+                        entry->lastused = time (NULL);
+                        fd = fd_ref (entry->cachedfd);
+                        goto prune;
+                }
+
+                entry = GF_CALLOC (1, sizeof (*entry),
+                                   gf_nfs_mt_nfs3_fd_entry);
+                if (!entry)
+                        goto prune;
+
+                entry->cachedfd = fd_anonymous (inode);
+                if (!entry->cachedfd) {
+                        GF_FREE (entry);
+                        goto prune;
+                }
+
+                INIT_LIST_HEAD (&entry->hash);
+                INIT_LIST_HEAD (&entry->gatherq);
+                entry->exp = exp;
+                entry->lastused = time (NULL);
+                list_add_tail (&entry->list, &nfs3->fdlru);
+                list_add (&entry->hash,
+                          &nfs3->fdhash[inode->gfid[15] %
+                                        GF_NFS3_FDCACHE_HASH]);
+                exp->fdcount++;
+                nfs3->fdcount++;
+                fd = fd_ref (entry->cachedfd);
+prune:
+                __nfs3_fdcache_prune (nfs3, exp, &purge);
+        }
+        UNLOCK (&nfs3->fdlrulock);
+
+        nfs3_fdcache_purge (&purge);
+anon:
+        if (!fd)
+                fd = fd_anonymous (inode);
+out:
+        return fd;
+}
+
+
+/* The file is gone, no point in keeping its fd around. */
+void
+nfs3_fdcache_remove (struct nfs3_state *nfs3, inode_t *inode)
+{
+        struct nfs3_fd_entry    *entry = NULL;
+        struct list_head        purge;
+
+        if ((!nfs3) || (!inode))
+                return;
+
+        INIT_LIST_HEAD (&purge);
+        LOCK (&nfs3->fdlrulock);
+        {
+                entry = __nfs3_fdcache_lookup (nfs3, inode);
+                if (entry && !entry->writing)
+                        __nfs3_fdcache_remove (nfs3, entry, &purge);
+        }
+        UNLOCK (&nfs3->fdlrulock);
+
+        nfs3_fdcache_purge (&purge);
+}
+
 int
 nfs3_solaris_zerolen_fh (struct nfs3_fh *fh, int fhlen)
 {
@@ -423,6 +588,7 @@ nfs3_call_state_init (struct nfs3_state *s, rpcsvc_request_t *req, xlator_t *v)
         memset (cs, 0, sizeof (*cs));
         INIT_LIST_HEAD (&cs->entries.list);
         INIT_LIST_HEAD (&cs->openwait_q);
+        INIT_LIST_HEAD (&cs->gather_q);
         cs->operrno = EINVAL;
         cs->req = req;
         cs->vol = v;
@@ -1899,7 +2065,8 @@ nfs3_read_resume (void *carg)
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
-        fd = fd_anonymous (cs->resolvedloc.inode);
+        fd = nfs3_fdcache_get (cs->nfs3state, &cs->resolvefh,
+                               cs->resolvedloc.inode);
         if (!fd) {
                 gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to create anonymous fd");
                 goto nfs3err;
@@ -2103,6 +2270,28 @@ err:
 }
 
 
+
+static int32_t
+nfs3_write_flags (int writetype)
+{
+/*
+  enum stable_how {
+  UNSTABLE = 0,
+  DATA_SYNC = 1,
+  FILE_SYNC = 2,
+  };
+*/
+        switch (writetype) {
+        case DATA_SYNC:
+                return O_DSYNC;
+        case FILE_SYNC:
+                return O_SYNC;
+        default:
+                return 0;
+        }
+}
+
+
 int
 __nfs3_write_resume (nfs3_call_state_t *cs)
 {
@@ -2126,13 +2315,298 @@ __nfs3_write_resume (nfs3_call_state_t *cs)
          */
         cs->datavec.iov_len = cs->datacount;
         ret = nfs_write (cs->nfsx, cs->vol, &nfu, cs->fd, cs->iobref,
-                         &cs->datavec, 1, cs->dataoffset, nfs3svc_write_cbk,
+                         &cs->datavec, 1, cs->dataoffset,
+                         nfs3_write_flags (cs->writetype), nfs3svc_write_cbk,
                          cs);
 
         return ret;
 }
 
 
+/*
+ * Write gathering: while an UNSTABLE write on a file is in flight, the
+ * UNSTABLE writes following it back to back are queued on the file's fd
+ * cache entry instead of being sent, and go down as one writev once it
+ * returns. Each of them is replied to when the writev returns, so nothing
+ * is acknowledged before it went down to the volume. The writev is sent
+ * with the credentials of the first write: only writes of the same user
+ * (uid, gid and groups) are gathered behind it.
+ */
+static void nfs3_write_gather_next (struct nfs3_state *nfs3, fd_t *fd);
+
+static void
+nfs3_write_gather_reply (nfs3_call_state_t *cs, int32_t op_ret,
+                         int32_t op_errno, off_t start, struct iatt *prebuf,
+                         struct iatt *postbuf)
+{
+        nfsstat3                stat = NFS3ERR_SERVERFAULT;
+        struct nfs3_state       *nfs3 = NULL;
+        int64_t                 written = 0;
+
+        nfs3 = rpcsvc_request_program_private (cs->req);
+        if (op_ret == -1) {
+                gf_log (GF_NFS, GF_LOG_WARNING,
+                        "%x: %s => -1 (%s)", rpcsvc_request_xid (cs->req),
+                        cs->resolvedloc.path, strerror (op_errno));
+                stat = nfs3_cbk_errno_status (op_ret, op_errno);
+                goto err;
+        }
+
+        /* a short writev leaves the tail of the run unwritten */
+        written = op_ret - (cs->dataoffset - start);
+        if (written < 0)
+                written = 0;
+        if (written > cs->datacount)
+                written = cs->datacount;
+
+        stat = NFS3_OK;
+        cs->maxcount = written;
+
+err:
+        nfs3_log_write_res (rpcsvc_request_xid (cs->req), stat,
+                            op_errno, cs->maxcount, cs->writetype,
+                            nfs3->serverstart);
+        nfs3_write_reply (cs->req, stat, cs->maxcount,
+                          cs->writetype, nfs3->serverstart, prebuf,
+                          postbuf);
+        nfs3_call_state_wipe (cs);
+}
+
+
+int32_t
+nfs3svc_write_gather_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int32_t op_ret, int32_t op_errno,
+                          struct iatt *prebuf, struct iatt *postbuf,
+                          dict_t *xdata)
+{
+        nfs3_call_state_t       *cs = NULL;
+        nfs3_call_state_t       *tmp = NULL;
+        nfs3_call_state_t       *next = NULL;
+        struct nfs3_state       *nfs3 = NULL;
+        fd_t                    *fd = NULL;
+        off_t                   start = 0;
+        struct list_head        gathered;
+
+        cs = frame->local;
+        nfs3 = cs->nfs3state;
+        fd = fd_ref (cs->fd);
+        start = cs->dataoffset;
+
+        INIT_LIST_HEAD (&gathered);
+        list_splice_init (&cs->gather_q, &gathered);
+
+        nfs3_write_gather_reply (cs, op_ret, op_errno, start, prebuf,
+                                 postbuf);
+        /* only the first write of the run gets the pre-op attributes */
+        list_for_each_entry_safe (tmp, next, &gathered, gather_q) {
+                list_del_init (&tmp->gather_q);
+                nfs3_write_gather_reply (tmp, op_ret, op_errno, start, NULL,
+                                         postbuf);
+        }
+
+        nfs3_write_gather_next (nfs3, fd);
+        fd_unref (fd);
+
+        return 0;
+}
+
+
+/* Sends @cs and the writes gathered behind it as one writev. */
+static void
+nfs3_write_gather_send (nfs3_call_state_t *cs)
+{
+        struct iovec            vector[GF_NFS3_WRITE_GATHER_MAXVEC];
+        nfs3_call_state_t       *tmp = NULL;
+        nfs3_call_state_t       *next = NULL;
+        struct nfs3_state       *nfs3 = NULL;
+        struct iobref           *iobref = NULL;
+        nfs_user_t              nfu = {0, };
+        fd_t                    *fd = NULL;
+        int                     count = 0;
+        int                     ret = -ENOMEM;
+
+        nfs3 = cs->nfs3state;
+
+        iobref = iobref_new ();
+        if (!iobref)
+                goto err;
+
+        cs->datavec.iov_len = cs->datacount;
+        vector[count++] = cs->datavec;
+        iobref_merge (iobref, cs->iobref);
+        list_for_each_entry (tmp, &cs->gather_q, gather_q) {
+                tmp->datavec.iov_len = tmp->datacount;
+                vector[count++] = tmp->datavec;
+                iobref_merge (iobref, tmp->iobref);
+        }
+
+        if (count > 1)
+                gf_log (GF_NFS3, GF_LOG_TRACE, "%s: %d writes gathered at "
+                        "%"PRIu64, uuid_utoa (cs->fd->inode->gfid), count,
+                        cs->dataoffset);
+
+        nfs_request_user_init (&nfu, cs->req);
+        ret = nfs_write (cs->nfsx, cs->vol, &nfu, cs->fd, iobref, vector,
+                         count, cs->dataoffset, 0, nfs3svc_write_gather_cbk,
+                         cs);
+        iobref_unref (iobref);
+err:
+        if (ret < 0) {
+                fd = fd_ref (cs->fd);
+                list_for_each_entry_safe (tmp, next, &cs->gather_q,
+                                          gather_q) {
+                        list_del_init (&tmp->gather_q);
+                        nfs3_write_gather_reply (tmp, -1, -ret, 0, NULL,
+                                                 NULL);
+                }
+                nfs3_write_gather_reply (cs, -1, -ret, 0, NULL, NULL);
+                nfs3_write_gather_next (nfs3, fd);
+                fd_unref (fd);
+        }
+}
+
+
+/* Takes the writes gathered on @entry off it, the first one heading the
+   others. */
+static nfs3_call_state_t *
+__nfs3_write_gather_detach (struct nfs3_fd_entry *entry)
+{
+        nfs3_call_state_t       *cs = NULL;
+
+        cs = list_entry (entry->gatherq.next, nfs3_call_state_t, gather_q);
+        list_del_init (&cs->gather_q);
+        list_splice_init (&entry->gatherq, &cs->gather_q);
+        entry->gathersize = 0;
+        entry->gathercount = 0;
+
+        return cs;
+}
+
+
+static gf_boolean_t
+nfs3_write_gather_same_user (nfs3_call_state_t *cs1, nfs3_call_state_t *cs2)
+{
+        gid_t                   *gids1 = NULL;
+        gid_t                   *gids2 = NULL;
+        int                     count1 = 0;
+        int                     count2 = 0;
+
+        if ((rpcsvc_request_uid (cs1->req) != rpcsvc_request_uid (cs2->req)) ||
+            (rpcsvc_request_gid (cs1->req) != rpcsvc_request_gid (cs2->req)))
+                return _gf_false;
+
+        gids1 = rpcsvc_auth_unix_auxgids (cs1->req, &count1);
+        gids2 = rpcsvc_auth_unix_auxgids (cs2->req, &count2);
+        if (count1 != count2)
+                return _gf_false;
+
+        if (count1 && memcmp (gids1, gids2, count1 * sizeof (gid_t)))
+                return _gf_false;
+
+        return _gf_true;
+}
+
+
+/* The write on @fd returned, send what got gathered meanwhile if any. */
+static void
+nfs3_write_gather_next (struct nfs3_state *nfs3, fd_t *fd)
+{
+        struct nfs3_fd_entry    *entry = NULL;
+        nfs3_call_state_t       *cs = NULL;
+
+        LOCK (&nfs3->fdlrulock);
+        {
+                entry = __nfs3_fdcache_lookup (nfs3, fd->inode);
+                if (!entry)
+                        goto unlock;
+
+                entry->writing--;
+                if (list_empty (&entry->gatherq))
+                        goto unlock;
+
+                cs = __nfs3_write_gather_detach (entry);
+                entry->writing++;
+        }
+unlock:
+        UNLOCK (&nfs3->fdlrulock);
+
+        if (cs)
+                nfs3_write_gather_send (cs);
+}
+
+
+static int
+nfs3_write_gather (nfs3_call_state_t *cs)
+{
+        struct nfs3_state       *nfs3 = NULL;
+        struct nfs3_fd_entry    *entry = NULL;
+        nfs3_call_state_t       *head = NULL;
+        nfs3_call_state_t       *flush = NULL;
+        int                     send = 0;
+        int                     queued = 0;
+
+        nfs3 = cs->nfs3state;
+        if (!nfs3->gathersize)
+                goto direct;
+
+        LOCK (&nfs3->fdlrulock);
+        {
+                entry = __nfs3_fdcache_lookup (nfs3, cs->fd->inode);
+                if (!entry)
+                        goto unlock;
+
+                if (!entry->writing) {
+                        entry->writing++;
+                        send = 1;
+                        goto unlock;
+                }
+
+                if (!list_empty (&entry->gatherq)) {
+                        head = list_entry (entry->gatherq.next,
+                                           nfs3_call_state_t, gather_q);
+                        /* another user: what got gathered goes down now,
+                           this write starts a new run */
+                        if (!nfs3_write_gather_same_user (head, cs)) {
+                                flush = __nfs3_write_gather_detach (entry);
+                                entry->writing++;
+                        }
+                }
+
+                if (list_empty (&entry->gatherq)) {
+                        entry->gathersize = 0;
+                        entry->gathercount = 0;
+                } else if ((entry->gatherend != cs->dataoffset) ||
+                           (entry->gathersize + cs->datacount >
+                            nfs3->gathersize) ||
+                           (entry->gathercount >=
+                            GF_NFS3_WRITE_GATHER_MAXVEC)) {
+                        goto unlock;
+                }
+
+                list_add_tail (&cs->gather_q, &entry->gatherq);
+                entry->gatherend = cs->dataoffset + cs->datacount;
+                entry->gathersize += cs->datacount;
+                entry->gathercount++;
+                queued = 1;
+        }
+unlock:
+        UNLOCK (&nfs3->fdlrulock);
+
+        if (flush)
+                nfs3_write_gather_send (flush);
+
+        if (send) {
+                nfs3_write_gather_send (cs);
+                return 0;
+        }
+
+        if (queued)
+                return 0;
+direct:
+        return __nfs3_write_resume (cs);
+}
+
+
 int
 nfs3_write_resume (void *carg)
 {
@@ -2146,7 +2620,8 @@ nfs3_write_resume (void *carg)
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
-        fd = fd_anonymous (cs->resolvedloc.inode);
+        fd = nfs3_fdcache_get (cs->nfs3state, &cs->resolvefh,
+                               cs->resolvedloc.inode);
         if (!fd) {
                 gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to create anonymous fd");
                 goto nfs3err;
@@ -2154,25 +2629,13 @@ nfs3_write_resume (void *carg)
 
         cs->fd = fd;    /* Gets unrefd when the call state is wiped. */
 
-/*
-  enum stable_how {
-  UNSTABLE = 0,
-  DATA_SYNC = 1,
-  FILE_SYNC = 2,
-  };
-*/
-	switch (cs->writetype) {
-	case UNSTABLE:
-		break;
-	case DATA_SYNC:
-		fd->flags |= O_DSYNC;
-		break;
-	case FILE_SYNC:
-		fd->flags |= O_SYNC;
-		break;
-	}
-
-        ret = __nfs3_write_resume (cs);
+        /* The fd is shared with the other requests on the file, the sync
+         * flags of STABLE writes go with the writev only.
+         */
+        if (cs->writetype == UNSTABLE)
+                ret = nfs3_write_gather (cs);
+        else
+                ret = __nfs3_write_resume (cs);
         if (ret < 0)
                 stat = nfs3_errno_to_nfsstat3 (-ret);
 nfs3err:
@@ -3353,8 +3816,10 @@ nfs3svc_remove_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                 stat = nfs3_cbk_errno_status (op_ret, op_errno);
         }
 
-        if (op_ret == 0)
+        if (op_ret == 0) {
                 stat = NFS3_OK;
+                nfs3_fdcache_remove (cs->nfs3state, cs->resolvedloc.inode);
+        }
 
         nfs3_log_common_res (rpcsvc_request_xid (cs->req), NFS3_REMOVE, stat,
                              op_errno);
@@ -5007,7 +5472,8 @@ nfs3_commit_open_resume (void *carg)
 
         cs = (nfs3_call_state_t *)carg;
         nfs3_check_fh_resolve_status (cs, stat, nfs3err);
-        cs->fd = fd_anonymous (cs->resolvedloc.inode);
+        cs->fd = nfs3_fdcache_get (cs->nfs3state, &cs->resolvefh,
+                                   cs->resolvedloc.inode);
         if (!cs->fd) {
                 gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to create anonymous fd.");
                 goto nfs3err;
@@ -5248,6 +5714,50 @@ nfs3_init_options (struct nfs3_state *nfs3, dict_t *options)
                 nfs3->readdirsize = size64;
         }
 
+        /* nfs3.fd-cache-timeout */
+        nfs3->fdtimeout = GF_NFS3_FDCACHE_TIMEOUT;
+        if (dict_get (options, "nfs3.fd-cache-timeout")) {
+                ret = dict_get_str (options, "nfs3.fd-cache-timeout",
+                                    &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read"
+                                " option: nfs3.fd-cache-timeout");
+                        ret = -1;
+                        goto err;
+                }
+
+                ret = gf_string2uint32 (optstr, &nfs3->fdtimeout);
+                if (ret == -1) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to format"
+                                " option: nfs3.fd-cache-timeout");
+                        ret = -1;
+                        goto err;
+                }
+        }
+
+        /* nfs3.write-gather-size */
+        nfs3->gathersize = GF_NFS3_WRITE_GATHER_SIZE;
+        if (dict_get (options, "nfs3.write-gather-size")) {
+                ret = dict_get_str (options, "nfs3.write-gather-size",
+                                    &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read"
+                                " option: nfs3.write-gather-size");
+                        ret = -1;
+                        goto err;
+                }
+
+                ret = gf_string2bytesize (optstr, &size64);
+                if (ret == -1) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to format"
+                                " option: nfs3.write-gather-size");
+                        ret = -1;
+                        goto err;
+                }
+
+                nfs3->gathersize = size64;
+        }
+
         /* We want to use the size of the biggest param for the io buffer size.
          */
         nfs3->iobsize = nfs3->readsize;
@@ -5424,6 +5934,32 @@ no_dvm:
                         exp->trusted_write = 1;
         }
 
+        exp->fdlimit = GF_NFS3_FDCACHE_SIZE;
+        ret = snprintf (searchkey, 1024, "nfs3.%s.fd-cache-limit", name);
+        if (ret < 0) {
+                gf_log (GF_NFS3, GF_LOG_ERROR, "snprintf failed");
+                ret = -1;
+                goto err;
+        }
+
+        if (dict_get (options, searchkey)) {
+                ret = dict_get_str (options, searchkey, &optstr);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to read "
+                                " option: %s", searchkey);
+                        ret = -1;
+                        goto err;
+                }
+
+                ret = gf_string2int (optstr, &exp->fdlimit);
+                if (ret < 0) {
+                        gf_log (GF_NFS3, GF_LOG_ERROR, "Failed to convert str "
+                                "to int");
+                        ret = -1;
+                        goto err;
+                }
+        }
+
         /* If trusted-sync is on, then we also switch on trusted-write because
          * tw is included in ts. In write logic, we're then only checking for
          * tw.
@@ -5508,6 +6044,7 @@ nfs3_init_state (xlator_t *nfsx)
         int                     ret = -1;
         unsigned int            localpool = 0;
         struct nfs_state        *nfs = NULL;
+        int                     i = 0;
 
         if ((!nfsx) || (!nfsx->private))
                 return NULL;
@@ -5549,6 +6086,8 @@ nfs3_init_state (xlator_t *nfsx)
 
         nfs3->serverstart = (uint64_t)time (NULL);
         INIT_LIST_HEAD (&nfs3->fdlru);
+        for (i = 0; i < GF_NFS3_FDCACHE_HASH; i++)
+                INIT_LIST_HEAD (&nfs3->fdhash[i]);
         LOCK_INIT (&nfs3->fdlrulock);
         nfs3->fdcount = 0;
 
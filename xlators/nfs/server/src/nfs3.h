@@ -87,12 +87,36 @@
 
 
 #define GF_NFS3_FDCACHE_SIZE    512
+#define GF_NFS3_FDCACHE_HASH    256
+#define GF_NFS3_FDCACHE_TIMEOUT 60      /* seconds */
+
+/* Largest run of adjacent UNSTABLE writes sent down as a single writev. */
+#define GF_NFS3_WRITE_GATHER_SIZE       GF_NFS3_WTMAX
+#define GF_NFS3_WRITE_GATHER_MAXVEC     64
+
 /* This should probably be moved to a more generic layer so that if needed
  * different versions of NFS protocol can use the same thing.
+ *
+ * The anonymous fds used for READ, WRITE and COMMIT are kept around, hashed
+ * by gfid, so that the inode stays in the table and successive requests on
+ * a file do not set up a new fd each. Entries idle for longer than the
+ * timeout, or beyond the export's limit, are dropped least recently used
+ * first. An entry also gathers the UNSTABLE writes arriving while a write
+ * on the file is in flight.
  */
 struct nfs3_fd_entry {
         fd_t                    *cachedfd;
-        struct list_head        list;
+        struct list_head        list;           /* LRU */
+        struct list_head        hash;
+        struct nfs3_export      *exp;
+        time_t                  lastused;
+
+        /* write gathering, under nfs3_state->fdlrulock */
+        int                     writing;        /* writevs in flight */
+        struct list_head        gatherq;
+        off_t                   gatherend;
+        size_t                  gathersize;
+        int                     gathercount;
 };
 
 /* Per subvolume nfs3 specific state */
@@ -104,6 +128,8 @@ struct nfs3_export {
         int                     trusted_sync;
         int                     trusted_write;
         int                     rootlookedup;
+        int                     fdlimit;
+        int                     fdcount;
 };
 
 #define GF_NFS3_DEFAULT_VOLACCESS       (GF_NFS3_VOLACCESS_RW)
@@ -144,8 +170,11 @@ typedef struct nfs3_state {
         uint64_t                iobsize;
 
         struct list_head        fdlru;
+        struct list_head        fdhash[GF_NFS3_FDCACHE_HASH];
         gf_lock_t               fdlrulock;
         int                     fdcount;
+        uint32_t                fdtimeout;
+        uint64_t                gathersize;
         uint32_t                occ_logger;
 } nfs3_state_t;
 
@@ -200,6 +229,11 @@ struct nfs3_local {
          */
         struct list_head        openwait_q;
 
+        /* UNSTABLE writes gathered behind this one, or the hook into the
+         * gathering entry's queue.
+         */
+        struct list_head        gather_q;
+
         /* Per-NFSv3 Op state */
         struct nfs3_fh          parent;
         struct nfs3_fh          fh;
@@ -2334,6 +2334,7 @@ rpcsvc_program_t        nlm4prog = {
         .actors         = nlm4svc_actors,
         .numactors      = NLM4_PROC_COUNT,
         .min_auth       = AUTH_NULL,
+        .ordered        = _gf_true,
 };
 
 
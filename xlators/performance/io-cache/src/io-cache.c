@@ -17,6 +17,8 @@
 #include "logging.h"
 #include "dict.h"
 #include "xlator.h"
+#include "defaults.h"
+#include "compound-fop-utils.h"
 #include "io-cache.h"
 #include "ioc-mem-types.h"
 #include "statedump.h"
@@ -1482,6 +1484,39 @@ ioc_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 }
 
 
+/* reads of a compound are not served from (nor kept in) the cache, its
+   writes flush it as ioc_writev() does; lookups, which validate the cache,
+   are run one by one */
+int32_t
+ioc_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+              dict_t *xdata)
+{
+        compound_fop_t *cfop      = NULL;
+        uint64_t        ioc_inode = 0;
+        int             i         = 0;
+
+        for (i = 0; i < args->count; i++) {
+                if (args->fops[i].fop == GF_FOP_LOOKUP)
+                        return compound_fop_serial (frame, this, args, xdata);
+        }
+
+        for (i = 0; i < args->count; i++) {
+                cfop = &args->fops[i];
+                if (cfop->fop != GF_FOP_WRITE || !cfop->fd)
+                        continue;
+
+                ioc_inode = 0;
+                inode_ctx_get (cfop->fd->inode, this, &ioc_inode);
+                if (ioc_inode)
+                        ioc_inode_flush ((ioc_inode_t *)(long)ioc_inode);
+        }
+
+        STACK_WIND (frame, default_compound_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound, args, xdata);
+        return 0;
+}
+
+
 int32_t
 ioc_get_priority_list (const char *opt_str, struct list_head *first)
 {
@@ -2109,6 +2144,7 @@ struct xlator_fops fops = {
         .readdirp    = ioc_readdirp,
 	.discard     = ioc_discard,
         .zerofill    = ioc_zerofill,
+        .compound    = ioc_compound,
 };
 
 
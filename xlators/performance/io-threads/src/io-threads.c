@@ -318,6 +318,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FSETXATTR:
         case GF_FOP_REMOVEXATTR:
         case GF_FOP_FREMOVEXATTR:
+        case GF_FOP_COMPOUND:
                 pri = IOT_PRI_NORMAL;
                 break;
 
@@ -741,6 +742,15 @@ iot_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 }
 
 
+int
+iot_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+              dict_t *xdata)
+{
+        IOT_FOP (compound, frame, this, args, xdata);
+        return 0;
+}
+
+
 int
 __iot_workers_scale (iot_conf_t *conf)
 {
@@ -1073,6 +1083,7 @@ struct xlator_fops fops = {
 	.fallocate   = iot_fallocate,
 	.discard     = iot_discard,
         .zerofill    = iot_zerofill,
+        .compound    = iot_compound,
 };
 
 struct xlator_cbks cbks;
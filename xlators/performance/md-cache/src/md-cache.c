@@ -20,6 +20,7 @@
 #include "md-cache-mem-types.h"
 #include "compat-errno.h"
 #include "glusterfs-acl.h"
+#include "compound-fop-utils.h"
 #include <assert.h>
 #include <sys/time.h>
 
@@ -2157,6 +2158,60 @@ int mdc_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 }
 
 
+/* nothing is served from the cache for a compound, the iatts its fops
+   bring back are cached as those of the single fops are */
+int
+mdc_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, compound_args_t *args,
+                  dict_t *xdata)
+{
+        compound_fop_t *cfop  = NULL;
+        inode_t        *inode = NULL;
+        int             i     = 0;
+
+        for (i = 0; args && i < args->count; i++) {
+                cfop = &args->fops[i];
+                if (cfop->rsp.op_ret < 0)
+                        continue;
+
+                inode = cfop->fd ? cfop->fd->inode : cfop->rsp.inode;
+                if (!inode)
+                        continue;
+
+                switch (cfop->fop) {
+                case GF_FOP_LOOKUP:
+                case GF_FOP_CREATE:
+                case GF_FOP_READ:
+                case GF_FOP_FSTAT:
+                        mdc_inode_iatt_set (this, inode, &cfop->rsp.stat);
+                        break;
+                case GF_FOP_WRITE:
+                        mdc_inode_iatt_set_validate (this, inode,
+                                                     &cfop->rsp.prestat,
+                                                     &cfop->rsp.stat);
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        STACK_UNWIND_STRICT (compound, frame, op_ret, op_errno, args, xdata);
+
+        return 0;
+}
+
+
+int
+mdc_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+              dict_t *xdata)
+{
+        STACK_WIND (frame, mdc_compound_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound, args, xdata);
+
+        return 0;
+}
+
+
 int
 mdc_forget (xlator_t *this, inode_t *inode)
 {
@@ -2290,6 +2345,7 @@ struct xlator_fops fops = {
 	.fallocate   = mdc_fallocate,
 	.discard     = mdc_discard,
         .zerofill    = mdc_zerofill,
+        .compound    = mdc_compound,
 };
 
 
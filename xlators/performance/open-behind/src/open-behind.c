@@ -13,6 +13,7 @@
 #include "statedump.h"
 #include "call-stub.h"
 #include "defaults.h"
+#include "compound-fop-utils.h"
 
 typedef struct ob_conf {
 	gf_boolean_t  use_anonymous_fd; /* use anonymous FDs wherever safe
@@ -802,6 +803,49 @@ err:
 }
 
 
+static gf_boolean_t
+ob_inode_open_pending (xlator_t *this, inode_t *inode)
+{
+	fd_t         *iter_fd = NULL;
+	gf_boolean_t  pending = _gf_false;
+
+	LOCK (&inode->lock);
+	{
+		list_for_each_entry (iter_fd, &inode->fd_list, inode_list) {
+			if (ob_fd_ctx_get (this, iter_fd)) {
+				pending = _gf_true;
+				break;
+			}
+		}
+	}
+	UNLOCK (&inode->lock);
+
+	return pending;
+}
+
+
+/* the opens of a compound are real ones; with no open held back on the
+   files it works on there is nothing to do before it goes down. Else it
+   is run fop by fop, which opens them first */
+int
+ob_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+	     dict_t *xdata)
+{
+	compound_fop_t *cfop = NULL;
+	int             i    = 0;
+
+	for (i = 0; i < args->count; i++) {
+		cfop = &args->fops[i];
+		if (cfop->fd && ob_inode_open_pending (this, cfop->fd->inode))
+			return compound_fop_serial (frame, this, args, xdata);
+	}
+
+	STACK_WIND (frame, default_compound_cbk, FIRST_CHILD (this),
+		    FIRST_CHILD (this)->fops->compound, args, xdata);
+	return 0;
+}
+
+
 int
 ob_release (xlator_t *this, fd_t *fd)
 {
@@ -983,6 +1027,7 @@ struct xlator_fops fops = {
 	.unlink      = ob_unlink,
 	.rename      = ob_rename,
 	.lk          = ob_lk,
+	.compound    = ob_compound,
 };
 
 struct xlator_cbks cbks = {
@@ -10,6 +10,7 @@
 
 #include "quick-read.h"
 #include "statedump.h"
+#include "compound-fop-utils.h"
 
 qr_inode_t *qr_inode_ctx_get (xlator_t *this, inode_t *inode);
 void __qr_inode_prune (qr_inode_table_t *table, qr_inode_t *qr_inode);
@@ -674,6 +675,34 @@ qr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
 	return 0;
 }
 
+/* reads of a compound go to the server, its writes prune the cache as
+   qr_writev() does; lookups, which fill and validate it, are run one by
+   one */
+int
+qr_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+	     dict_t *xdata)
+{
+	compound_fop_t *cfop = NULL;
+	int             i    = 0;
+
+	for (i = 0; i < args->count; i++) {
+		if (args->fops[i].fop == GF_FOP_LOOKUP)
+			return compound_fop_serial (frame, this, args, xdata);
+	}
+
+	for (i = 0; i < args->count; i++) {
+		cfop = &args->fops[i];
+		if (cfop->fop == GF_FOP_WRITE && cfop->fd)
+			qr_inode_prune (this, cfop->fd->inode);
+	}
+
+	STACK_WIND (frame, default_compound_cbk,
+		    FIRST_CHILD (this), FIRST_CHILD (this)->fops->compound,
+		    args, xdata);
+	return 0;
+}
+
+
 int
 qr_forget (xlator_t *this, inode_t *inode)
 {
@@ -1109,7 +1138,8 @@ struct xlator_fops fops = {
         .readv       = qr_readv,
 	.writev      = qr_writev,
 	.truncate    = qr_truncate,
-	.ftruncate   = qr_ftruncate
+	.ftruncate   = qr_ftruncate,
+	.compound    = qr_compound
 };
 
 struct xlator_cbks cbks = {
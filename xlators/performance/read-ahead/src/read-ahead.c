@@ -24,6 +24,8 @@
 #include "logging.h"
 #include "dict.h"
 #include "xlator.h"
+#include "defaults.h"
+#include "compound-fop-utils.h"
 #include "read-ahead.h"
 #include "statedump.h"
 #include <assert.h>
@@ -1043,6 +1045,68 @@ unwind:
         return 0;
 }
 
+
+static gf_boolean_t
+ra_inode_cached (xlator_t *this, inode_t *inode)
+{
+        fd_t         *iter_fd  = NULL;
+        uint64_t      tmp_file = 0;
+        gf_boolean_t  cached   = _gf_false;
+
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (iter_fd, &inode->fd_list, inode_list) {
+                        if (fd_ctx_get (iter_fd, this, &tmp_file) == 0 &&
+                            tmp_file) {
+                                cached = _gf_true;
+                                break;
+                        }
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        return cached;
+}
+
+
+/* pages are only kept for fds opened through ra_open(): a compound on
+   other fds (such as those it opens itself) has no pages to use or flush
+   and goes down as it is */
+int
+ra_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+             dict_t *xdata)
+{
+        compound_fop_t *cfop     = NULL;
+        uint64_t        tmp_file = 0;
+        int             i        = 0;
+
+        for (i = 0; i < args->count; i++) {
+                cfop = &args->fops[i];
+                if (!cfop->fd)
+                        continue;
+
+                switch (cfop->fop) {
+                case GF_FOP_WRITE:
+                case GF_FOP_FSTAT:
+                        if (ra_inode_cached (this, cfop->fd->inode))
+                                goto serial;
+                        break;
+                default:
+                        if (fd_ctx_get (cfop->fd, this, &tmp_file) == 0 &&
+                            tmp_file)
+                                goto serial;
+                        break;
+                }
+        }
+
+        STACK_WIND (frame, default_compound_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->compound, args, xdata);
+        return 0;
+
+serial:
+        return compound_fop_serial (frame, this, args, xdata);
+}
+
 int
 ra_priv_dump (xlator_t *this)
 {
@@ -1226,6 +1290,7 @@ struct xlator_fops fops = {
         .fstat       = ra_fstat,
 	.discard     = ra_discard,
         .zerofill    = ra_zerofill,
+        .compound    = ra_compound,
 };
 
 struct xlator_cbks cbks = {
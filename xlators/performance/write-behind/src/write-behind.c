@@ -25,6 +25,7 @@
 #include "call-stub.h"
 #include "statedump.h"
 #include "defaults.h"
+#include "compound-fop-utils.h"
 #include "write-behind-mem-types.h"
 
 #define MAX_VECTOR_COUNT          8
@@ -1920,6 +1921,37 @@ wb_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc,
 }
 
 
+/* a compound without writes, on files this client has never written to,
+   has nothing to be ordered against: it goes down as it is. Others are
+   queued fop by fop */
+int
+wb_compound (call_frame_t *frame, xlator_t *this, compound_args_t *args,
+             dict_t *xdata)
+{
+        compound_fop_t *cfop  = NULL;
+        inode_t        *inode = NULL;
+        int             i     = 0;
+
+        for (i = 0; i < args->count; i++) {
+                cfop = &args->fops[i];
+
+                if (cfop->fop == GF_FOP_WRITE)
+                        goto serial;
+
+                inode = cfop->fd ? cfop->fd->inode : cfop->loc.inode;
+                if (inode && wb_inode_ctx_get (this, inode))
+                        goto serial;
+        }
+
+        STACK_WIND (frame, default_compound_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->compound, args, xdata);
+        return 0;
+
+serial:
+        return compound_fop_serial (frame, this, args, xdata);
+}
+
+
 int
 wb_forget (xlator_t *this, inode_t *inode)
 {
@@ -2233,6 +2265,7 @@ struct xlator_fops fops = {
         .ftruncate   = wb_ftruncate,
         .setattr     = wb_setattr,
         .fsetattr    = wb_fsetattr,
+        .compound    = wb_compound,
 };
 
 
@@ -15,6 +15,8 @@
 
 #include "client.h"
 #include "rpc-clnt.h"
+#include "defaults.h"
+#include "upcall-utils.h"
 
 int
 client_cbk_null (struct rpc_clnt *rpc, void *mydata, void *data)
@@ -40,10 +42,70 @@ client_cbk_ino_flush (struct rpc_clnt *rpc, void *mydata, void *data)
         return 0;
 }
 
+/* Pass the contention upcall of the brick up to the translators holding
+ * the inodelk */
+int
+client_cbk_inodelk_contention (struct rpc_clnt *rpc, void *mydata, void *data)
+{
+        int                                  ret      = -1;
+        GF_UNUSED int                        op_errno = 0;
+        xlator_t                            *this     = NULL;
+        struct iovec                        *iov      = NULL;
+        gfs3_cbk_inodelk_contention_req      req      = {{0,},};
+        struct gf_upcall                     upcall   = {0,};
+        struct gf_upcall_inodelk_contention  lc       = {{0,},};
+        dict_t                              *xdata    = NULL;
+
+        this = mydata;
+        iov = data;
+
+        GF_VALIDATE_OR_GOTO (THIS->name, this, out);
+        GF_VALIDATE_OR_GOTO (this->name, iov, out);
+
+        ret = xdr_to_generic (*iov, &req, (xdrproc_t)
+                              xdr_gfs3_cbk_inodelk_contention_req);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "failed to decode inodelk contention upcall");
+                goto out;
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (req.xdata.xdata_val),
+                                      (req.xdata.xdata_len), ret,
+                                      op_errno, out);
+
+        gf_proto_flock_to_flock (&req.flock, &lc.flock);
+        lc.domain = req.domain;
+        lc.xdata = xdata;
+
+        memcpy (upcall.gfid, req.gfid, 16);
+        upcall.event_type = GF_UPCALL_INODELK_CONTENTION;
+        upcall.data = &lc;
+
+        gf_log (this->name, GF_LOG_DEBUG, "inodelk contention on %s "
+                "(domain %s)", uuid_utoa (upcall.gfid), lc.domain);
+
+        default_notify (this, GF_EVENT_UPCALL, &upcall);
+
+        ret = 0;
+out:
+        free (req.flock.lk_owner.lk_owner_val);
+        free (req.domain);
+        free (req.xdata.xdata_val);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return ret;
+}
+
 rpcclnt_cb_actor_t gluster_cbk_actors[GF_CBK_MAXVALUE] = {
         [GF_CBK_NULL]      = {"NULL",      GF_CBK_NULL,      client_cbk_null },
         [GF_CBK_FETCHSPEC] = {"FETCHSPEC", GF_CBK_FETCHSPEC, client_cbk_fetchspec },
         [GF_CBK_INO_FLUSH] = {"INO_FLUSH", GF_CBK_INO_FLUSH, client_cbk_ino_flush },
+        [GF_CBK_INODELK_CONTENTION] = {"INODELK_CONTENTION",
+                                       GF_CBK_INODELK_CONTENTION,
+                                       client_cbk_inodelk_contention },
 };
 
 
@@ -1083,6 +1083,7 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
         int32_t               op_errno      = 0;
         gf_boolean_t          auth_fail     = _gf_false;
         uint32_t              lk_ver        = 0;
+        int32_t               compound      = 0;
 
         frame = myframe;
         this  = frame->this;
@@ -1207,6 +1208,11 @@ client_setvolume_cbk (struct rpc_req *req, struct iovec *iov, int count, void *m
 
         conf->need_different_port = 0;
 
+        /* older servers do not know compound fops: their members are sent
+           to them one by one */
+        ret = dict_get_int32 (reply, "compound-fops", &compound);
+        conf->compound_fops = (ret == 0 && compound);
+
         if (lk_ver != client_get_lk_ver (conf)) {
                 gf_log (this->name, GF_LOG_INFO, "Server and Client "
                         "lk-version numbers are not same, reopening the fds");
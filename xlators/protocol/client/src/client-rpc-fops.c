@@ -18,6 +18,7 @@
 #include "glusterfs3-xdr.h"
 #include "glusterfs3.h"
 #include "compat-errno.h"
+#include "compound-fop-utils.h"
 
 int32_t client3_getspec (call_frame_t *frame, xlator_t *this, void *data);
 rpc_clnt_prog_t clnt3_3_fop_prog;
@@ -6085,6 +6086,657 @@ unwind:
         return 0;
 }
 
+/* fd of the @i'th fop of a compound: the fd opened by an earlier fop of
+   the same compound, which has no remote fd yet, or a known remote fd */
+static int
+client_compound_fd (xlator_t *this, compound_args_t *cargs, int i,
+                    int64_t *remote_fd, int *fd_link)
+{
+        compound_fop_t *cfop = &cargs->fops[i];
+        int             j    = 0;
+        int             ret  = 0;
+
+        for (j = i - 1; j >= 0; j--) {
+                if (cargs->fops[j].fd != cfop->fd)
+                        continue;
+                if (cargs->fops[j].fop != GF_FOP_OPEN &&
+                    cargs->fops[j].fop != GF_FOP_CREATE)
+                        continue;
+                *fd_link = j;
+                *remote_fd = -1;
+                return 0;
+        }
+
+        ret = client_get_remote_fd (this, cfop->fd, DEFAULT_REMOTE_FD,
+                                    remote_fd);
+        if (ret < 0)
+                return -errno;
+
+        if (*remote_fd == -1) {
+                gf_log (this->name, GF_LOG_WARNING, " (%s) "
+                        "remote_fd is -1. EBADFD",
+                        uuid_utoa (cfop->fd->inode->gfid));
+                return -EBADFD;
+        }
+
+        return 0;
+}
+
+
+static void
+client_compound_loc_gfid (loc_t *loc, char *gfid)
+{
+        if (loc->inode && !uuid_is_null (loc->inode->gfid))
+                memcpy (gfid, loc->inode->gfid, 16);
+        else
+                memcpy (gfid, loc->gfid, 16);
+}
+
+
+static int
+client_compound_fop_pack (xlator_t *this, compound_args_t *cargs, int i,
+                          gfs3_compound_fop_req *creq)
+{
+        compound_fop_t *cfop      = &cargs->fops[i];
+        union {
+                gfs3_lookup_req   lookup;
+                gfs3_open_req     open;
+                gfs3_create_req   create;
+                gfs3_read_req     read;
+                gfs3_write_req    write;
+                gfs3_flush_req    flush;
+                gfs3_fstat_req    fstat;
+                gfs3_getxattr_req getxattr;
+                gfs3_fxattrop_req fxattrop;
+        } req;
+        xdrproc_t       proc      = NULL;
+        char           *xdata_val = NULL;
+        u_int           xdata_len = 0;
+        char           *dict_val  = NULL;
+        u_int           dict_len  = 0;
+        int64_t         remote_fd = -1;
+        size_t          size      = 0;
+        struct iovec    iov       = {0, };
+        ssize_t         len       = 0;
+        int             ret       = 0;
+
+        memset (&req, 0, sizeof (req));
+        creq->fop = cfop->fop;
+        creq->fd_link = -1;
+
+        if (cfop->xdata) {
+                ret = dict_allocate_and_serialize (cfop->xdata, &xdata_val,
+                                                   &xdata_len);
+                if (ret) {
+                        ret = -EINVAL;
+                        goto out;
+                }
+        }
+
+        if (cfop->fd && cfop->fop != GF_FOP_OPEN &&
+            cfop->fop != GF_FOP_CREATE) {
+                ret = client_compound_fd (this, cargs, i, &remote_fd,
+                                          &creq->fd_link);
+                if (ret)
+                        goto out;
+        }
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                if (cfop->loc.parent) {
+                        if (!uuid_is_null (cfop->loc.parent->gfid))
+                                memcpy (req.lookup.pargfid,
+                                        cfop->loc.parent->gfid, 16);
+                        else
+                                memcpy (req.lookup.pargfid,
+                                        cfop->loc.pargfid, 16);
+                } else {
+                        client_compound_loc_gfid (&cfop->loc,
+                                                  req.lookup.gfid);
+                }
+                req.lookup.bname = cfop->loc.name ?
+                                   (char *)cfop->loc.name : "";
+                req.lookup.xdata.xdata_val = xdata_val;
+                req.lookup.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_lookup_req;
+                break;
+        case GF_FOP_OPEN:
+                client_compound_loc_gfid (&cfop->loc, req.open.gfid);
+                req.open.flags = gf_flags_from_flags (cfop->flags);
+                req.open.xdata.xdata_val = xdata_val;
+                req.open.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_open_req;
+                break;
+        case GF_FOP_CREATE:
+                if (cfop->loc.parent)
+                        memcpy (req.create.pargfid, cfop->loc.parent->gfid,
+                                16);
+                else
+                        memcpy (req.create.pargfid, cfop->loc.pargfid, 16);
+                req.create.bname = (char *)cfop->loc.name;
+                req.create.mode = cfop->mode;
+                req.create.umask = cfop->umask;
+                req.create.flags = gf_flags_from_flags (cfop->flags);
+                req.create.xdata.xdata_val = xdata_val;
+                req.create.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_create_req;
+                break;
+        case GF_FOP_READ:
+                req.read.size = cfop->size;
+                req.read.offset = cfop->offset;
+                req.read.fd = remote_fd;
+                req.read.flag = cfop->flags;
+                memcpy (req.read.gfid, cfop->fd->inode->gfid, 16);
+                req.read.xdata.xdata_val = xdata_val;
+                req.read.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_read_req;
+                break;
+        case GF_FOP_WRITE:
+                size = iov_length (cfop->vector, cfop->count);
+                if (size) {
+                        creq->data.data_val = GF_MALLOC (size,
+                                                         gf_common_mt_char);
+                        if (!creq->data.data_val) {
+                                ret = -ENOMEM;
+                                goto out;
+                        }
+                        iov_unload (creq->data.data_val, cfop->vector,
+                                    cfop->count);
+                        creq->data.data_len = size;
+                }
+                req.write.size = size;
+                req.write.offset = cfop->offset;
+                req.write.fd = remote_fd;
+                req.write.flag = cfop->flags;
+                memcpy (req.write.gfid, cfop->fd->inode->gfid, 16);
+                req.write.xdata.xdata_val = xdata_val;
+                req.write.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_write_req;
+                break;
+        case GF_FOP_FLUSH:
+                req.flush.fd = remote_fd;
+                memcpy (req.flush.gfid, cfop->fd->inode->gfid, 16);
+                req.flush.xdata.xdata_val = xdata_val;
+                req.flush.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_flush_req;
+                break;
+        case GF_FOP_FSTAT:
+                req.fstat.fd = remote_fd;
+                memcpy (req.fstat.gfid, cfop->fd->inode->gfid, 16);
+                req.fstat.xdata.xdata_val = xdata_val;
+                req.fstat.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_fstat_req;
+                break;
+        case GF_FOP_GETXATTR:
+                client_compound_loc_gfid (&cfop->loc, req.getxattr.gfid);
+                req.getxattr.namelen = 1; /* Use it as a flag */
+                req.getxattr.name = cfop->name ? cfop->name : "";
+                req.getxattr.xdata.xdata_val = xdata_val;
+                req.getxattr.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_getxattr_req;
+                break;
+        case GF_FOP_FXATTROP:
+                if (cfop->xattr) {
+                        ret = dict_allocate_and_serialize (cfop->xattr,
+                                                           &dict_val,
+                                                           &dict_len);
+                        if (ret) {
+                                ret = -EINVAL;
+                                goto out;
+                        }
+                }
+                req.fxattrop.fd = remote_fd;
+                req.fxattrop.flags = cfop->optype;
+                memcpy (req.fxattrop.gfid, cfop->fd->inode->gfid, 16);
+                req.fxattrop.dict.dict_val = dict_val;
+                req.fxattrop.dict.dict_len = dict_len;
+                req.fxattrop.xdata.xdata_val = xdata_val;
+                req.fxattrop.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_fxattrop_req;
+                break;
+        default:
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s cannot be part of a compound fop",
+                        gf_fop_list[cfop->fop]);
+                ret = -ENOTSUP;
+                goto out;
+        }
+
+        len = xdr_sizeof (proc, &req);
+        iov.iov_base = GF_MALLOC (len, gf_common_mt_char);
+        if (!iov.iov_base) {
+                ret = -ENOMEM;
+                goto out;
+        }
+        iov.iov_len = len;
+
+        len = xdr_serialize_generic (iov, &req, proc);
+        if (len < 0) {
+                GF_FREE (iov.iov_base);
+                ret = -EINVAL;
+                goto out;
+        }
+
+        creq->args.args_val = iov.iov_base;
+        creq->args.args_len = len;
+        ret = 0;
+out:
+        GF_FREE (xdata_val);
+        GF_FREE (dict_val);
+
+        return ret;
+}
+
+
+static void
+client_compound_req_free (gfs3_compound_req *req)
+{
+        int i = 0;
+
+        for (i = 0; req->fops.fops_val && i < req->fops.fops_len; i++) {
+                GF_FREE (req->fops.fops_val[i].args.args_val);
+                GF_FREE (req->fops.fops_val[i].data.data_val);
+        }
+
+        GF_FREE (req->fops.fops_val);
+        GF_FREE (req->xdata.xdata_val);
+}
+
+
+static int
+client_compound_dict (xlator_t *this, char *buf, u_int len, dict_t **dict)
+{
+        int ret      = 0;
+        int op_errno = ENOMEM;
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, *dict, buf, len, ret, op_errno,
+                                      out);
+        return 0;
+out:
+        if (*dict) {
+                dict_unref (*dict);
+                *dict = NULL;
+        }
+        return -op_errno;
+}
+
+
+static int
+client_compound_fop_unpack (xlator_t *this, call_frame_t *frame,
+                            compound_args_t *cargs, int i,
+                            int32_t compound_ret,
+                            gfs3_compound_fop_rsp *crsp)
+{
+        compound_fop_t *cfop      = &cargs->fops[i];
+        union {
+                gf_common_rsp     common;
+                gfs3_lookup_rsp   lookup;
+                gfs3_open_rsp     open;
+                gfs3_create_rsp   create;
+                gfs3_read_rsp     read;
+                gfs3_write_rsp    write;
+                gfs3_fstat_rsp    fstat;
+                gfs3_getxattr_rsp getxattr;
+                gfs3_fxattrop_rsp fxattrop;
+        } rsp;
+        xdrproc_t       proc      = NULL;
+        struct iovec    iov       = {0, };
+        char           *xdata_val = NULL;
+        u_int           xdata_len = 0;
+        struct iobuf   *iobuf     = NULL;
+        int             ret       = 0;
+
+        memset (&rsp, 0, sizeof (rsp));
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                proc = (xdrproc_t)xdr_gfs3_lookup_rsp;
+                break;
+        case GF_FOP_OPEN:
+                proc = (xdrproc_t)xdr_gfs3_open_rsp;
+                break;
+        case GF_FOP_CREATE:
+                proc = (xdrproc_t)xdr_gfs3_create_rsp;
+                break;
+        case GF_FOP_READ:
+                proc = (xdrproc_t)xdr_gfs3_read_rsp;
+                break;
+        case GF_FOP_WRITE:
+                proc = (xdrproc_t)xdr_gfs3_write_rsp;
+                break;
+        case GF_FOP_FLUSH:
+                proc = (xdrproc_t)xdr_gf_common_rsp;
+                break;
+        case GF_FOP_FSTAT:
+                proc = (xdrproc_t)xdr_gfs3_fstat_rsp;
+                break;
+        case GF_FOP_GETXATTR:
+                proc = (xdrproc_t)xdr_gfs3_getxattr_rsp;
+                break;
+        case GF_FOP_FXATTROP:
+                proc = (xdrproc_t)xdr_gfs3_fxattrop_rsp;
+                break;
+        default:
+                return -EINVAL;
+        }
+
+        if (crsp->fop != cfop->fop)
+                return -EINVAL;
+
+        iov.iov_base = crsp->rsp.rsp_val;
+        iov.iov_len = crsp->rsp.rsp_len;
+        ret = xdr_to_generic (iov, &rsp, proc);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding of %s failed",
+                        gf_fop_list[cfop->fop]);
+                return -EINVAL;
+        }
+
+        /* all the replies start with op_ret and op_errno */
+        cfop->rsp.op_ret = rsp.common.op_ret;
+        cfop->rsp.op_errno = gf_error_to_errno (rsp.common.op_errno);
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                xdata_val = rsp.lookup.xdata.xdata_val;
+                xdata_len = rsp.lookup.xdata.xdata_len;
+                gf_stat_to_iatt (&rsp.lookup.postparent,
+                                 &cfop->rsp.postparent);
+                if (rsp.lookup.op_ret < 0)
+                        break;
+                gf_stat_to_iatt (&rsp.lookup.stat, &cfop->rsp.stat);
+                if (!uuid_is_null (cfop->loc.inode->gfid) &&
+                    uuid_compare (cfop->rsp.stat.ia_gfid,
+                                  cfop->loc.inode->gfid)) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = ESTALE;
+                        break;
+                }
+                cfop->rsp.inode = inode_ref (cfop->loc.inode);
+                break;
+        case GF_FOP_OPEN:
+                xdata_val = rsp.open.xdata.xdata_val;
+                xdata_len = rsp.open.xdata.xdata_len;
+                if (rsp.open.op_ret < 0)
+                        break;
+                /* the server drops the fds of a failed compound */
+                if (compound_ret < 0) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = ECANCELED;
+                        break;
+                }
+                ret = client_add_fd_to_saved_fds (this, cfop->fd, &cfop->loc,
+                                                  cfop->flags, rsp.open.fd, 0);
+                if (ret) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = -ret;
+                }
+                break;
+        case GF_FOP_CREATE:
+                xdata_val = rsp.create.xdata.xdata_val;
+                xdata_len = rsp.create.xdata.xdata_len;
+                if (rsp.create.op_ret < 0)
+                        break;
+                gf_stat_to_iatt (&rsp.create.stat, &cfop->rsp.stat);
+                gf_stat_to_iatt (&rsp.create.preparent, &cfop->rsp.preparent);
+                gf_stat_to_iatt (&rsp.create.postparent,
+                                 &cfop->rsp.postparent);
+                cfop->rsp.inode = inode_ref (cfop->loc.inode);
+                if (compound_ret < 0) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = ECANCELED;
+                        break;
+                }
+                ret = client_add_fd_to_saved_fds (this, cfop->fd, &cfop->loc,
+                                                  cfop->flags, rsp.create.fd,
+                                                  0);
+                if (ret) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = -ret;
+                }
+                break;
+        case GF_FOP_READ:
+                xdata_val = rsp.read.xdata.xdata_val;
+                xdata_len = rsp.read.xdata.xdata_len;
+                if (rsp.read.op_ret < 0)
+                        break;
+                gf_stat_to_iatt (&rsp.read.stat, &cfop->rsp.stat);
+                if (!crsp->data.data_len)
+                        break;
+                /* data is copied out of the reply, which is freed once
+                   unwound */
+                iobuf = iobuf_get2 (this->ctx->iobuf_pool,
+                                    crsp->data.data_len);
+                cfop->rsp.iobref = iobref_new ();
+                cfop->rsp.vector = GF_CALLOC (1, sizeof (struct iovec),
+                                              gf_common_mt_iovec);
+                if (!iobuf || !cfop->rsp.iobref || !cfop->rsp.vector) {
+                        if (iobuf)
+                                iobuf_unref (iobuf);
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = ENOMEM;
+                        break;
+                }
+                memcpy (iobuf_ptr (iobuf), crsp->data.data_val,
+                        crsp->data.data_len);
+                iobref_add (cfop->rsp.iobref, iobuf);
+                iobuf_unref (iobuf);
+                cfop->rsp.vector[0].iov_base = iobuf_ptr (iobuf);
+                cfop->rsp.vector[0].iov_len = crsp->data.data_len;
+                cfop->rsp.count = 1;
+                break;
+        case GF_FOP_WRITE:
+                xdata_val = rsp.write.xdata.xdata_val;
+                xdata_len = rsp.write.xdata.xdata_len;
+                if (rsp.write.op_ret < 0)
+                        break;
+                gf_stat_to_iatt (&rsp.write.prestat, &cfop->rsp.prestat);
+                gf_stat_to_iatt (&rsp.write.poststat, &cfop->rsp.stat);
+                break;
+        case GF_FOP_FLUSH:
+                xdata_val = rsp.common.xdata.xdata_val;
+                xdata_len = rsp.common.xdata.xdata_len;
+                if (rsp.common.op_ret < 0 || fd_is_anonymous (cfop->fd))
+                        break;
+                /* Delete all saved locks of the owner issuing flush */
+                delete_granted_locks_owner (cfop->fd,
+                                            &frame->root->lk_owner);
+                break;
+        case GF_FOP_FSTAT:
+                xdata_val = rsp.fstat.xdata.xdata_val;
+                xdata_len = rsp.fstat.xdata.xdata_len;
+                if (rsp.fstat.op_ret < 0)
+                        break;
+                gf_stat_to_iatt (&rsp.fstat.stat, &cfop->rsp.stat);
+                break;
+        case GF_FOP_GETXATTR:
+                xdata_val = rsp.getxattr.xdata.xdata_val;
+                xdata_len = rsp.getxattr.xdata.xdata_len;
+                if (rsp.getxattr.op_ret < 0)
+                        break;
+                ret = client_compound_dict (this, rsp.getxattr.dict.dict_val,
+                                            rsp.getxattr.dict.dict_len,
+                                            &cfop->rsp.xattr);
+                if (ret) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = -ret;
+                }
+                break;
+        case GF_FOP_FXATTROP:
+                xdata_val = rsp.fxattrop.xdata.xdata_val;
+                xdata_len = rsp.fxattrop.xdata.xdata_len;
+                if (rsp.fxattrop.op_ret < 0)
+                        break;
+                ret = client_compound_dict (this, rsp.fxattrop.dict.dict_val,
+                                            rsp.fxattrop.dict.dict_len,
+                                            &cfop->rsp.xattr);
+                if (ret) {
+                        cfop->rsp.op_ret = -1;
+                        cfop->rsp.op_errno = -ret;
+                }
+                break;
+        default:
+                break;
+        }
+
+        client_compound_dict (this, xdata_val, xdata_len, &cfop->rsp.xdata);
+
+        xdr_free (proc, (char *)&rsp);
+
+        return 0;
+}
+
+
+int
+client3_3_compound_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        call_frame_t      *frame    = NULL;
+        clnt_local_t      *local    = NULL;
+        compound_args_t   *cargs    = NULL;
+        gfs3_compound_rsp  rsp      = {0,};
+        dict_t            *xdata    = NULL;
+        xlator_t          *this     = NULL;
+        int                op_errno = 0;
+        int                ret      = 0;
+        int                i        = 0;
+
+        this = THIS;
+
+        frame = myframe;
+        local = frame->local;
+        cargs = local->compound_args;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret = -1;
+                op_errno = ENOTCONN;
+                compound_args_fail (cargs, 0, op_errno);
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_compound_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret = -1;
+                op_errno = EINVAL;
+                compound_args_fail (cargs, 0, op_errno);
+                goto out;
+        }
+
+        op_errno = gf_error_to_errno (rsp.op_errno);
+
+        for (i = 0; i < cargs->count; i++) {
+                if (i >= rsp.fops.fops_len) {
+                        compound_args_fail (cargs, i, ECANCELED);
+                        break;
+                }
+
+                ret = client_compound_fop_unpack (this, frame, cargs, i,
+                                                  rsp.op_ret,
+                                                  &rsp.fops.fops_val[i]);
+                if (ret) {
+                        cargs->fops[i].rsp.op_ret = -1;
+                        cargs->fops[i].rsp.op_errno = -ret;
+                }
+        }
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, xdata, (rsp.xdata.xdata_val),
+                                      (rsp.xdata.xdata_len), ret,
+                                      op_errno, out);
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "remote operation failed: %s",
+                        strerror (op_errno));
+        }
+
+        CLIENT_STACK_UNWIND (compound, frame, rsp.op_ret, op_errno, cargs,
+                             xdata);
+
+        xdr_free ((xdrproc_t)xdr_gfs3_compound_rsp, (char *)&rsp);
+
+        if (xdata)
+                dict_unref (xdata);
+
+        return 0;
+}
+
+
+int32_t
+client3_3_compound (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t       *args     = NULL;
+        clnt_conf_t       *conf     = NULL;
+        clnt_local_t      *local    = NULL;
+        compound_args_t   *cargs    = NULL;
+        gfs3_compound_req  req      = {{0,},};
+        int                op_errno = ESTALE;
+        int                ret      = 0;
+        int                i        = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+        cargs = args->compound_args;
+
+        if (!cargs || !cargs->count) {
+                op_errno = EINVAL;
+                goto unwind;
+        }
+
+        local = mem_get0 (this->local_pool);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        local->compound_args = cargs;
+        frame->local = local;
+
+        req.fops.fops_val = GF_CALLOC (cargs->count,
+                                       sizeof (gfs3_compound_fop_req),
+                                       gf_client_mt_compound_req_t);
+        if (!req.fops.fops_val) {
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+        req.fops.fops_len = cargs->count;
+
+        for (i = 0; i < cargs->count; i++) {
+                ret = client_compound_fop_pack (this, cargs, i,
+                                                &req.fops.fops_val[i]);
+                if (ret) {
+                        op_errno = -ret;
+                        goto unwind;
+                }
+        }
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, args->xdata, (&req.xdata.xdata_val),
+                                    req.xdata.xdata_len, op_errno, unwind);
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_COMPOUND, client3_3_compound_cbk,
+                                     NULL, NULL, 0, NULL, 0, NULL,
+                                     (xdrproc_t)xdr_gfs3_compound_req);
+        if (ret)
+                gf_log (this->name, GF_LOG_WARNING, "failed to send the fop");
+
+        client_compound_req_free (&req);
+
+        return 0;
+unwind:
+        if (cargs)
+                compound_args_fail (cargs, 0, op_errno);
+
+        CLIENT_STACK_UNWIND (compound, frame, -1, op_errno, cargs, NULL);
+
+        client_compound_req_free (&req);
+
+        return 0;
+}
+
 /* Table Specific to FOPS */
 
 
@@ -6133,6 +6785,7 @@ rpc_clnt_procedure_t clnt3_3_fop_actors[GF_FOP_MAXVALUE] = {
 	[GF_FOP_FALLOCATE]   = { "FALLOCATE",	client3_3_fallocate },
 	[GF_FOP_DISCARD]     = { "DISCARD",	client3_3_discard },
         [GF_FOP_ZEROFILL]    = { "ZEROFILL",    client3_3_zerofill},
+        [GF_FOP_COMPOUND]    = { "COMPOUND",    client3_3_compound },
         [GF_FOP_RELEASE]     = { "RELEASE",     client3_3_release },
         [GF_FOP_RELEASEDIR]  = { "RELEASEDIR",  client3_3_releasedir },
         [GF_FOP_GETSPEC]     = { "GETSPEC",     client3_getspec },
@@ -6188,6 +6841,7 @@ char *clnt3_3_fop_names[GFS3_OP_MAXVALUE] = {
 	[GFS3_OP_FALLOCATE]   = "FALLOCATE",
 	[GFS3_OP_DISCARD]     = "DISCARD",
         [GFS3_OP_ZEROFILL]    = "ZEROFILL",
+        [GFS3_OP_COMPOUND]    = "COMPOUND",
 
 };
 
@@ -2073,6 +2073,42 @@ out:
         return 0;
 }
 
+int32_t
+client_compound (call_frame_t *frame, xlator_t *this, compound_args_t *cargs,
+                 dict_t *xdata)
+{
+        int          ret              = -1;
+        clnt_conf_t *conf             = NULL;
+        rpc_clnt_procedure_t *proc    = NULL;
+        clnt_args_t  args             = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        if (!conf->compound_fops)
+                return compound_fop_serial (frame, this, cargs, xdata);
+
+        args.compound_args = cargs;
+        args.xdata = xdata;
+
+        proc = &conf->fops->proctable[GF_FOP_COMPOUND];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_COMPOUND]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT(compound, frame, -1, ENOTCONN,
+                                    cargs, NULL);
+
+        return 0;
+}
+
 
 int32_t
 client_getspec (call_frame_t *frame, xlator_t *this, const char *key,
@@ -2846,6 +2882,7 @@ struct xlator_fops fops = {
 	.fallocate   = client_fallocate,
 	.discard     = client_discard,
         .zerofill    = client_zerofill,
+        .compound    = client_compound,
         .getspec     = client_getspec,
 };
 
@@ -127,6 +127,8 @@ typedef struct clnt_conf {
         uint64_t               setvol_count;
 
         gf_boolean_t           send_gids; /* let the server resolve gids */
+        gf_boolean_t           compound_fops; /* the server takes
+                                                  GFS3_OP_COMPOUND */
 } clnt_conf_t;
 
 typedef struct _client_fd_ctx {
@@ -173,6 +175,7 @@ typedef struct client_local {
         pthread_mutex_t      mutex;
         char                *name;
         gf_boolean_t         attempt_reopen;
+        compound_args_t     *compound_args;
 } clnt_local_t;
 
 typedef struct client_args {
@@ -206,6 +209,7 @@ typedef struct client_args {
 
         mode_t              umask;
         dict_t             *xdata;
+        compound_args_t    *compound_args;
 } clnt_args_t;
 
 typedef ssize_t (*gfs_serialize_t) (struct iovec outmsg, void *args);
@@ -16,6 +16,7 @@
 #include "server.h"
 #include "server-helpers.h"
 #include "gidcache.h"
+#include "compound-fop-utils.h"
 
 #include <fnmatch.h>
 #include <pwd.h>
@@ -184,6 +185,8 @@ server_resolve_wipe (server_resolve_t *resolve)
 void
 free_state (server_state_t *state)
 {
+        int i = 0;
+
         if (state->xprt) {
                 rpc_transport_unref (state->xprt);
                 state->xprt = NULL;
@@ -228,6 +231,11 @@ free_state (server_state_t *state)
         server_resolve_wipe (&state->resolve);
         server_resolve_wipe (&state->resolve2);
 
+        compound_args_destroy (state->compound_args);
+        for (i = 0; i < state->compound_count; i++)
+                server_resolve_wipe (&state->compound_fops[i].resolve);
+        GF_FREE (state->compound_fops);
+
         GF_FREE (state);
 }
 
@@ -32,6 +32,7 @@
 void free_state (server_state_t *state);
 
 void server_loc_wipe (loc_t *loc);
+void server_resolve_wipe (server_resolve_t *resolve);
 
 void
 server_print_request (call_frame_t *frame);
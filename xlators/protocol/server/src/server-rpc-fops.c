@@ -22,6 +22,7 @@
 #include "glusterfs3-xdr.h"
 #include "glusterfs3.h"
 #include "compat-errno.h"
+#include "compound-fop-utils.h"
 
 #include "xdr-nfs3.h"
 
@@ -2847,12 +2848,35 @@ int
 server_readv_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
         server_state_t    *state = NULL;
+        server_conf_t     *conf  = NULL;
+        rpcsvc_request_t  *req   = NULL;
 
         state = CALL_STATE (frame);
+        conf = frame->this->private;
+        req = frame->local;
 
         if (state->resolve.op_ret != 0)
                 goto err;
 
+        /* only ask for a file segment if the transport can send one */
+        if (conf->zero_copy_read && req->trans->zero_copy) {
+                if (!state->xdata)
+                        state->xdata = dict_new ();
+                if (!state->xdata ||
+                    dict_set_int8 (state->xdata, GLUSTERFS_ZERO_COPY_READ,
+                                   1)) {
+                        /* the read is answered from an iobuf then */
+                        gf_log (frame->this->name, GF_LOG_DEBUG,
+                                "%"PRId64": could not ask for a zero-copy "
+                                "read", frame->root->unique);
+                        if (state->xdata)
+                                dict_del (state->xdata,
+                                          GLUSTERFS_ZERO_COPY_READ);
+                }
+        } else if (state->xdata) {
+                dict_del (state->xdata, GLUSTERFS_ZERO_COPY_READ);
+        }
+
         STACK_WIND (frame, server_readv_cbk,
                     bound_xl, bound_xl->fops->readv,
                     state->fd, state->size, state->offset, state->flags, state->xdata);
@@ -3464,6 +3488,779 @@ out:
         return ret;
 }
 
+
+/* Compound fops: the members are decoded and resolved one after the other
+   (reusing state->resolve), then wound down as a single compound fop */
+
+static int
+server_compound_dict (xlator_t *this, char *buf, u_int len, dict_t **dict)
+{
+        int ret      = 0;
+        int op_errno = 0;
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (this, *dict, buf, len, ret, op_errno,
+                                      out);
+        return 0;
+out:
+        if (*dict) {
+                dict_unref (*dict);
+                *dict = NULL;
+        }
+        return -(op_errno ? op_errno : ENOMEM);
+}
+
+
+static int
+server_compound_fop_decode (call_frame_t *frame, compound_args_t *cargs,
+                            int i, gfs3_compound_fop_req *creq)
+{
+        server_state_t        *state     = NULL;
+        compound_fop_t        *cfop      = NULL;
+        server_compound_fop_t *sfop      = NULL;
+        xlator_t              *bound_xl  = NULL;
+        union {
+                gfs3_lookup_req   lookup;
+                gfs3_open_req     open;
+                gfs3_create_req   create;
+                gfs3_read_req     read;
+                gfs3_write_req    write;
+                gfs3_flush_req    flush;
+                gfs3_fstat_req    fstat;
+                gfs3_getxattr_req getxattr;
+                gfs3_fxattrop_req fxattrop;
+        } args;
+        xdrproc_t              proc      = NULL;
+        struct iovec           iov       = {0, };
+        struct iobuf          *iobuf     = NULL;
+        char                  *xdata_val = NULL;
+        u_int                  xdata_len = 0;
+        int                    ret       = 0;
+
+        state = CALL_STATE (frame);
+        bound_xl = frame->root->client->bound_xl;
+        cfop = &cargs->fops[i];
+        sfop = &state->compound_fops[i];
+
+        memset (&args, 0, sizeof (args));
+        cfop->fop = creq->fop;
+        sfop->resolve.type = RESOLVE_MUST;
+        sfop->resolve.fd_no = -1;
+        sfop->fd_link = -1;
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                proc = (xdrproc_t)xdr_gfs3_lookup_req;
+                break;
+        case GF_FOP_OPEN:
+                proc = (xdrproc_t)xdr_gfs3_open_req;
+                break;
+        case GF_FOP_CREATE:
+                proc = (xdrproc_t)xdr_gfs3_create_req;
+                break;
+        case GF_FOP_READ:
+                proc = (xdrproc_t)xdr_gfs3_read_req;
+                break;
+        case GF_FOP_WRITE:
+                proc = (xdrproc_t)xdr_gfs3_write_req;
+                break;
+        case GF_FOP_FLUSH:
+                proc = (xdrproc_t)xdr_gfs3_flush_req;
+                break;
+        case GF_FOP_FSTAT:
+                proc = (xdrproc_t)xdr_gfs3_fstat_req;
+                break;
+        case GF_FOP_GETXATTR:
+                proc = (xdrproc_t)xdr_gfs3_getxattr_req;
+                break;
+        case GF_FOP_FXATTROP:
+                proc = (xdrproc_t)xdr_gfs3_fxattrop_req;
+                break;
+        default:
+                return -ENOTSUP;
+        }
+
+        /* an fd opened or created by an earlier member */
+        if (creq->fd_link >= 0) {
+                if (creq->fd_link >= i ||
+                    (cargs->fops[creq->fd_link].fop != GF_FOP_OPEN &&
+                     cargs->fops[creq->fd_link].fop != GF_FOP_CREATE))
+                        return -EINVAL;
+                sfop->fd_link = creq->fd_link;
+        }
+
+        iov.iov_base = creq->args.args_val;
+        iov.iov_len = creq->args.args_len;
+        ret = xdr_to_generic (iov, &args, proc);
+        if (ret < 0)
+                return -EINVAL;
+        ret = 0;
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                sfop->resolve.type = RESOLVE_DONTCARE;
+                if (args.lookup.bname && strcmp (args.lookup.bname, "")) {
+                        memcpy (sfop->resolve.pargfid, args.lookup.pargfid,
+                                16);
+                        sfop->resolve.bname = gf_strdup (args.lookup.bname);
+                } else {
+                        memcpy (sfop->resolve.gfid, args.lookup.gfid, 16);
+                }
+                xdata_val = args.lookup.xdata.xdata_val;
+                xdata_len = args.lookup.xdata.xdata_len;
+                free (args.lookup.bname);
+                break;
+        case GF_FOP_OPEN:
+                memcpy (sfop->resolve.gfid, args.open.gfid, 16);
+                cfop->flags = gf_flags_to_flags (args.open.flags);
+                xdata_val = args.open.xdata.xdata_val;
+                xdata_len = args.open.xdata.xdata_len;
+                break;
+        case GF_FOP_CREATE:
+                sfop->resolve.type = RESOLVE_NOT;
+                memcpy (sfop->resolve.pargfid, args.create.pargfid, 16);
+                sfop->resolve.bname = gf_strdup (args.create.bname);
+                cfop->mode = args.create.mode;
+                cfop->umask = args.create.umask;
+                cfop->flags = gf_flags_to_flags (args.create.flags);
+                xdata_val = args.create.xdata.xdata_val;
+                xdata_len = args.create.xdata.xdata_len;
+                free (args.create.bname);
+                break;
+        case GF_FOP_READ:
+                sfop->resolve.fd_no = args.read.fd;
+                memcpy (sfop->resolve.gfid, args.read.gfid, 16);
+                cfop->size = args.read.size;
+                cfop->offset = args.read.offset;
+                cfop->flags = args.read.flag;
+                xdata_val = args.read.xdata.xdata_val;
+                xdata_len = args.read.xdata.xdata_len;
+                break;
+        case GF_FOP_WRITE:
+                sfop->resolve.fd_no = args.write.fd;
+                memcpy (sfop->resolve.gfid, args.write.gfid, 16);
+                cfop->offset = args.write.offset;
+                cfop->flags = args.write.flag;
+                xdata_val = args.write.xdata.xdata_val;
+                xdata_len = args.write.xdata.xdata_len;
+
+                cfop->vector = GF_CALLOC (1, sizeof (struct iovec),
+                                          gf_common_mt_iovec);
+                cfop->iobref = iobref_new ();
+                if (creq->data.data_len)
+                        iobuf = iobuf_get2 (bound_xl->ctx->iobuf_pool,
+                                            creq->data.data_len);
+                if (!cfop->vector || !cfop->iobref ||
+                    (creq->data.data_len && !iobuf)) {
+                        ret = -ENOMEM;
+                        break;
+                }
+                if (iobuf) {
+                        memcpy (iobuf_ptr (iobuf), creq->data.data_val,
+                                creq->data.data_len);
+                        iobref_add (cfop->iobref, iobuf);
+                        cfop->vector[0].iov_base = iobuf_ptr (iobuf);
+                        iobuf_unref (iobuf);
+                }
+                cfop->vector[0].iov_len = creq->data.data_len;
+                cfop->count = 1;
+                break;
+        case GF_FOP_FLUSH:
+                sfop->resolve.fd_no = args.flush.fd;
+                memcpy (sfop->resolve.gfid, args.flush.gfid, 16);
+                xdata_val = args.flush.xdata.xdata_val;
+                xdata_len = args.flush.xdata.xdata_len;
+                break;
+        case GF_FOP_FSTAT:
+                sfop->resolve.fd_no = args.fstat.fd;
+                memcpy (sfop->resolve.gfid, args.fstat.gfid, 16);
+                xdata_val = args.fstat.xdata.xdata_val;
+                xdata_len = args.fstat.xdata.xdata_len;
+                break;
+        case GF_FOP_GETXATTR:
+                memcpy (sfop->resolve.gfid, args.getxattr.gfid, 16);
+                if (args.getxattr.namelen && args.getxattr.name &&
+                    strcmp (args.getxattr.name, ""))
+                        cfop->name = gf_strdup (args.getxattr.name);
+                xdata_val = args.getxattr.xdata.xdata_val;
+                xdata_len = args.getxattr.xdata.xdata_len;
+                free (args.getxattr.name);
+                break;
+        case GF_FOP_FXATTROP:
+                sfop->resolve.fd_no = args.fxattrop.fd;
+                memcpy (sfop->resolve.gfid, args.fxattrop.gfid, 16);
+                cfop->optype = args.fxattrop.flags;
+                ret = server_compound_dict (bound_xl,
+                                            args.fxattrop.dict.dict_val,
+                                            args.fxattrop.dict.dict_len,
+                                            &cfop->xattr);
+                xdata_val = args.fxattrop.xdata.xdata_val;
+                xdata_len = args.fxattrop.xdata.xdata_len;
+                free (args.fxattrop.dict.dict_val);
+                break;
+        default:
+                break;
+        }
+
+        if (!ret)
+                ret = server_compound_dict (bound_xl, xdata_val, xdata_len,
+                                            &cfop->xdata);
+
+        free (xdata_val);
+
+        return ret;
+}
+
+
+static int
+server_compound_fop_encode (call_frame_t *frame, xlator_t *this,
+                            compound_fop_t *cfop, int32_t compound_ret,
+                            gfs3_compound_fop_rsp *crsp, int64_t *bound_fd)
+{
+        server_ctx_t   *serv_ctx   = NULL;
+        inode_t        *root_inode = NULL;
+        inode_t        *link_inode = NULL;
+        union {
+                gf_common_rsp     common;
+                gfs3_lookup_rsp   lookup;
+                gfs3_open_rsp     open;
+                gfs3_create_rsp   create;
+                gfs3_read_rsp     read;
+                gfs3_write_rsp    write;
+                gfs3_fstat_rsp    fstat;
+                gfs3_getxattr_rsp getxattr;
+                gfs3_fxattrop_rsp fxattrop;
+        } rsp;
+        xdrproc_t       proc       = NULL;
+        struct iovec    iov        = {0, };
+        char           *xdata_val  = NULL;
+        u_int           xdata_len  = 0;
+        char           *dict_val   = NULL;
+        u_int           dict_len   = 0;
+        uint64_t        fd_no      = 0;
+        int32_t         op_ret     = 0;
+        int32_t         op_errno   = 0;
+        ssize_t         len        = 0;
+        size_t          size       = 0;
+        int             ret        = 0;
+
+        memset (&rsp, 0, sizeof (rsp));
+        *bound_fd = -1;
+        crsp->fop = cfop->fop;
+        op_ret = cfop->rsp.op_ret;
+        op_errno = cfop->rsp.op_errno;
+
+        if (cfop->rsp.xdata) {
+                ret = dict_allocate_and_serialize (cfop->rsp.xdata,
+                                                   &xdata_val, &xdata_len);
+                if (ret) {
+                        op_ret = -1;
+                        op_errno = EINVAL;
+                }
+        }
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                gf_stat_from_iatt (&rsp.lookup.postparent,
+                                   &cfop->rsp.postparent);
+                if (op_ret < 0 || !cfop->rsp.inode)
+                        break;
+
+                root_inode = frame->root->client->bound_xl->itable->root;
+                if (cfop->rsp.inode == root_inode) {
+                        /* we just looked up root ("/") */
+                        cfop->rsp.stat.ia_ino = 1;
+                        memset (cfop->rsp.stat.ia_gfid, 0, 16);
+                        cfop->rsp.stat.ia_gfid[15] = 1;
+                        if (root_inode->ia_type == 0)
+                                root_inode->ia_type = cfop->rsp.stat.ia_type;
+                }
+                gf_stat_from_iatt (&rsp.lookup.stat, &cfop->rsp.stat);
+
+                if (!__is_root_gfid (cfop->rsp.inode->gfid)) {
+                        link_inode = inode_link (cfop->rsp.inode,
+                                                 cfop->loc.parent,
+                                                 cfop->loc.name,
+                                                 &cfop->rsp.stat);
+                        if (link_inode) {
+                                inode_lookup (link_inode);
+                                inode_unref (link_inode);
+                        }
+                }
+                break;
+        case GF_FOP_OPEN:
+        case GF_FOP_CREATE:
+                if (op_ret < 0)
+                        break;
+                if (!cfop->fd) {
+                        op_ret = -1;
+                        op_errno = EINVAL;
+                        break;
+                }
+
+                if (cfop->fop == GF_FOP_CREATE) {
+                        link_inode = inode_link (cfop->rsp.inode,
+                                                 cfop->loc.parent,
+                                                 cfop->loc.name,
+                                                 &cfop->rsp.stat);
+                        if (!link_inode) {
+                                op_ret = -1;
+                                op_errno = ENOENT;
+                                break;
+                        }
+                        if (link_inode != cfop->fd->inode) {
+                                inode_unref (cfop->fd->inode);
+                                cfop->fd->inode = inode_ref (link_inode);
+                        }
+                        inode_lookup (link_inode);
+                        inode_unref (link_inode);
+                }
+
+                serv_ctx = server_ctx_get (frame->root->client, this);
+                if (serv_ctx == NULL) {
+                        gf_log (this->name, GF_LOG_INFO,
+                                "server_ctx_get() failed");
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        break;
+                }
+
+                /* the client does not keep the fds of a failed compound,
+                   they go with its args */
+                if (compound_ret >= 0) {
+                        fd_bind (cfop->fd);
+                        fd_no = gf_fd_unused_get (serv_ctx->fdtable,
+                                                  cfop->fd);
+                        fd_ref (cfop->fd);
+                        *bound_fd = fd_no;
+                }
+
+                if (cfop->fop == GF_FOP_OPEN) {
+                        rsp.open.fd = fd_no;
+                        break;
+                }
+                rsp.create.fd = fd_no;
+                gf_stat_from_iatt (&rsp.create.stat, &cfop->rsp.stat);
+                gf_stat_from_iatt (&rsp.create.preparent,
+                                   &cfop->rsp.preparent);
+                gf_stat_from_iatt (&rsp.create.postparent,
+                                   &cfop->rsp.postparent);
+                break;
+        case GF_FOP_READ:
+                if (op_ret < 0)
+                        break;
+                gf_stat_from_iatt (&rsp.read.stat, &cfop->rsp.stat);
+                rsp.read.size = op_ret;
+                size = iov_length (cfop->rsp.vector, cfop->rsp.count);
+                if (!size)
+                        break;
+                crsp->data.data_val = GF_MALLOC (size, gf_common_mt_char);
+                if (!crsp->data.data_val) {
+                        op_ret = -1;
+                        op_errno = ENOMEM;
+                        break;
+                }
+                iov_unload (crsp->data.data_val, cfop->rsp.vector,
+                            cfop->rsp.count);
+                crsp->data.data_len = size;
+                break;
+        case GF_FOP_WRITE:
+                if (op_ret < 0)
+                        break;
+                gf_stat_from_iatt (&rsp.write.prestat, &cfop->rsp.prestat);
+                gf_stat_from_iatt (&rsp.write.poststat, &cfop->rsp.stat);
+                break;
+        case GF_FOP_FSTAT:
+                if (op_ret < 0)
+                        break;
+                gf_stat_from_iatt (&rsp.fstat.stat, &cfop->rsp.stat);
+                break;
+        case GF_FOP_GETXATTR:
+        case GF_FOP_FXATTROP:
+                if (op_ret < 0 || !cfop->rsp.xattr)
+                        break;
+                ret = dict_allocate_and_serialize (cfop->rsp.xattr,
+                                                   &dict_val, &dict_len);
+                if (ret) {
+                        op_ret = -1;
+                        op_errno = EINVAL;
+                        break;
+                }
+                if (cfop->fop == GF_FOP_GETXATTR) {
+                        rsp.getxattr.dict.dict_val = dict_val;
+                        rsp.getxattr.dict.dict_len = dict_len;
+                } else {
+                        rsp.fxattrop.dict.dict_val = dict_val;
+                        rsp.fxattrop.dict.dict_len = dict_len;
+                }
+                break;
+        default:
+                break;
+        }
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                rsp.lookup.xdata.xdata_val = xdata_val;
+                rsp.lookup.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_lookup_rsp;
+                break;
+        case GF_FOP_OPEN:
+                rsp.open.xdata.xdata_val = xdata_val;
+                rsp.open.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_open_rsp;
+                break;
+        case GF_FOP_CREATE:
+                rsp.create.xdata.xdata_val = xdata_val;
+                rsp.create.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_create_rsp;
+                break;
+        case GF_FOP_READ:
+                rsp.read.xdata.xdata_val = xdata_val;
+                rsp.read.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_read_rsp;
+                break;
+        case GF_FOP_WRITE:
+                rsp.write.xdata.xdata_val = xdata_val;
+                rsp.write.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_write_rsp;
+                break;
+        case GF_FOP_FLUSH:
+                rsp.common.xdata.xdata_val = xdata_val;
+                rsp.common.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gf_common_rsp;
+                break;
+        case GF_FOP_FSTAT:
+                rsp.fstat.xdata.xdata_val = xdata_val;
+                rsp.fstat.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_fstat_rsp;
+                break;
+        case GF_FOP_GETXATTR:
+                rsp.getxattr.xdata.xdata_val = xdata_val;
+                rsp.getxattr.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_getxattr_rsp;
+                break;
+        case GF_FOP_FXATTROP:
+                rsp.fxattrop.xdata.xdata_val = xdata_val;
+                rsp.fxattrop.xdata.xdata_len = xdata_len;
+                proc = (xdrproc_t)xdr_gfs3_fxattrop_rsp;
+                break;
+        default:
+                ret = -EINVAL;
+                goto out;
+        }
+
+        /* all the replies start with op_ret and op_errno */
+        rsp.common.op_ret = op_ret;
+        rsp.common.op_errno = gf_errno_to_error (op_errno);
+
+        len = xdr_sizeof (proc, &rsp);
+        iov.iov_base = GF_MALLOC (len, gf_common_mt_char);
+        if (!iov.iov_base) {
+                ret = -ENOMEM;
+                goto out;
+        }
+        iov.iov_len = len;
+
+        len = xdr_serialize_generic (iov, &rsp, proc);
+        if (len < 0) {
+                GF_FREE (iov.iov_base);
+                ret = -EINVAL;
+                goto out;
+        }
+
+        crsp->rsp.rsp_val = iov.iov_base;
+        crsp->rsp.rsp_len = len;
+        ret = 0;
+out:
+        GF_FREE (xdata_val);
+        GF_FREE (dict_val);
+
+        return ret;
+}
+
+
+int
+server_compound_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno,
+                     compound_args_t *cargs, dict_t *xdata)
+{
+        gfs3_compound_rsp    rsp   = {0,};
+        server_state_t      *state = NULL;
+        server_ctx_t        *serv_ctx = NULL;
+        rpcsvc_request_t    *req   = NULL;
+        int64_t              bound_fds[GF_COMPOUND_MAX_FOPS];
+        int                  ret   = 0;
+        int                  i     = 0;
+        int                  j     = 0;
+
+        state = CALL_STATE (frame);
+
+        GF_PROTOCOL_DICT_SERIALIZE (this, xdata, &rsp.xdata.xdata_val,
+                                    rsp.xdata.xdata_len, op_errno, out);
+
+        if (!cargs)
+                goto out;
+
+        rsp.fops.fops_val = GF_CALLOC (cargs->count,
+                                       sizeof (gfs3_compound_fop_rsp),
+                                       gf_server_mt_compound_rsp_t);
+        if (!rsp.fops.fops_val) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        for (i = 0; i < cargs->count; i++) {
+                ret = server_compound_fop_encode (frame, this,
+                                                  &cargs->fops[i], op_ret,
+                                                  &rsp.fops.fops_val[i],
+                                                  &bound_fds[i]);
+                if (ret) {
+                        op_ret = -1;
+                        op_errno = -ret;
+                        break;
+                }
+        }
+
+        /* the compound fails now: the client will not know of the fds
+           bound so far */
+        if (ret) {
+                serv_ctx = server_ctx_get (frame->root->client, this);
+                for (j = 0; serv_ctx && j < i; j++) {
+                        if (bound_fds[j] >= 0)
+                                gf_fd_put (serv_ctx->fdtable, bound_fds[j]);
+                }
+        }
+        /* the replies of the fops after a failed encoding are left out,
+           the client fails them */
+        rsp.fops.fops_len = i;
+
+out:
+        if (op_ret < 0)
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": COMPOUND (%d fops) ==> (%s)",
+                        frame->root->unique,
+                        state->compound_args ? state->compound_args->count
+                                             : 0,
+                        strerror (op_errno));
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        req = frame->local;
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_compound_rsp);
+
+        for (i = 0; i < rsp.fops.fops_len; i++) {
+                GF_FREE (rsp.fops.fops_val[i].rsp.rsp_val);
+                GF_FREE (rsp.fops.fops_val[i].data.data_val);
+        }
+        GF_FREE (rsp.fops.fops_val);
+        GF_FREE (rsp.xdata.xdata_val);
+
+        return 0;
+}
+
+
+int
+server_compound_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        STACK_WIND (frame, server_compound_cbk,
+                    bound_xl, bound_xl->fops->compound,
+                    state->compound_args, state->xdata);
+
+        return 0;
+}
+
+
+static int server_compound_resolve_next (call_frame_t *frame);
+
+static int
+server_compound_resolved (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t  *state = NULL;
+        compound_args_t *cargs = NULL;
+        compound_fop_t  *cfop  = NULL;
+        int              i     = 0;
+
+        state = CALL_STATE (frame);
+        cargs = state->compound_args;
+        i = state->compound_index;
+        cfop = &cargs->fops[i];
+
+        if (state->resolve.op_ret != 0) {
+                state->resolve.bname = NULL;
+                compound_args_cancel (cargs, i, state->resolve.op_errno);
+                server_compound_cbk (frame, NULL, frame->this, -1,
+                                     state->resolve.op_errno, cargs, NULL);
+                return 0;
+        }
+
+        loc_copy (&cfop->loc, &state->loc);
+        cfop->fd = state->fd;
+        state->fd = NULL;
+
+        switch (cfop->fop) {
+        case GF_FOP_LOOKUP:
+                if (!cfop->loc.inode)
+                        cfop->loc.inode = inode_new (state->itable);
+                break;
+        case GF_FOP_CREATE:
+                cfop->loc.inode = inode_new (state->itable);
+                /* fall through */
+        case GF_FOP_OPEN:
+                cfop->fd = fd_create (cfop->loc.inode, frame->root->pid);
+                if (!cfop->fd) {
+                        gf_log ("server", GF_LOG_ERROR, "fd creation for the "
+                                "inode %s failed", cfop->loc.inode ?
+                                uuid_utoa (cfop->loc.inode->gfid) : NULL);
+                        compound_args_cancel (cargs, i, ENOMEM);
+                        server_compound_cbk (frame, NULL, frame->this, -1,
+                                             ENOMEM, cargs, NULL);
+                        return 0;
+                }
+                cfop->fd->flags = cfop->flags;
+                break;
+        default:
+                break;
+        }
+
+        /* the basename is owned by state->compound_fops */
+        state->resolve.bname = NULL;
+        server_resolve_wipe (&state->resolve);
+        server_resolve_wipe (&state->resolve2);
+        memset (&state->resolve, 0, sizeof (state->resolve));
+        memset (&state->resolve2, 0, sizeof (state->resolve2));
+        state->resolve2.fd_no = -1;
+        loc_wipe (&state->loc);
+        loc_wipe (&state->loc2);
+        state->resolve_now = NULL;
+        state->loc_now = NULL;
+
+        state->compound_index++;
+
+        return server_compound_resolve_next (frame);
+}
+
+
+static int
+server_compound_resolve_next (call_frame_t *frame)
+{
+        server_state_t        *state = NULL;
+        compound_args_t       *cargs = NULL;
+        server_compound_fop_t *sfop  = NULL;
+
+        state = CALL_STATE (frame);
+        cargs = state->compound_args;
+
+        while (state->compound_index < cargs->count) {
+                sfop = &state->compound_fops[state->compound_index];
+
+                if (sfop->fd_link >= 0) {
+                        cargs->fops[state->compound_index].fd =
+                                fd_ref (cargs->fops[sfop->fd_link].fd);
+                        state->compound_index++;
+                        continue;
+                }
+
+                state->resolve = sfop->resolve;
+                resolve_and_resume (frame, server_compound_resolved);
+                return 0;
+        }
+
+        server_compound_resume (frame, frame->root->client->bound_xl);
+
+        return 0;
+}
+
+
+int
+server3_3_compound (rpcsvc_request_t *req)
+{
+        server_state_t    *state    = NULL;
+        call_frame_t      *frame    = NULL;
+        compound_args_t   *cargs    = NULL;
+        gfs3_compound_req  args     = {{0,},};
+        int                ret      = -1;
+        int                op_errno = 0;
+        int                i        = 0;
+
+        if (!req)
+                return ret;
+
+        ret = xdr_to_generic (req->msg[0], &args,
+                              (xdrproc_t)xdr_gfs3_compound_req);
+        if (ret < 0) {
+                /*failed to decode msg*/;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                /* something wrong, mostly insufficient memory*/
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_COMPOUND;
+
+        state = CALL_STATE (frame);
+        if (!frame->root->client->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        cargs = compound_args_new (args.fops.fops_len);
+        if (!cargs) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+        state->compound_args = cargs;
+
+        state->compound_fops = GF_CALLOC (cargs->count,
+                                          sizeof (server_compound_fop_t),
+                                          gf_server_mt_compound_fop_t);
+        if (!state->compound_fops) {
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+        state->compound_count = cargs->count;
+
+        GF_PROTOCOL_DICT_UNSERIALIZE (frame->root->client->bound_xl,
+                                      state->xdata,
+                                      args.xdata.xdata_val,
+                                      args.xdata.xdata_len, ret,
+                                      op_errno, out);
+
+        for (i = 0; i < cargs->count; i++) {
+                ret = server_compound_fop_decode (frame, cargs, i,
+                                                  &args.fops.fops_val[i]);
+                if (ret) {
+                        compound_args_cancel (cargs, i, -ret);
+                        server_compound_cbk (frame, NULL, frame->this, -1,
+                                             -ret, cargs, NULL);
+                        ret = 0;
+                        goto out;
+                }
+        }
+
+        ret = 0;
+        server_compound_resolve_next (frame);
+
+out:
+        xdr_free ((xdrproc_t)xdr_gfs3_compound_req, (char *)&args);
+
+        if (op_errno)
+                req->rpc_err = GARBAGE_ARGS;
+
+        return ret;
+}
+
+
 int
 server3_3_readlink (rpcsvc_request_t *req)
 {
@@ -6185,6 +6982,7 @@ rpcsvc_actor_t glusterfs3_3_fop_actors[GLUSTER_FOP_PROCCNT] = {
         [GFS3_OP_FALLOCATE]    = {"FALLOCATE",    GFS3_OP_FALLOCATE,    server3_3_fallocate,    NULL, 0, DRC_NA},
         [GFS3_OP_DISCARD]      = {"DISCARD",      GFS3_OP_DISCARD,      server3_3_discard,      NULL, 0, DRC_NA},
         [GFS3_OP_ZEROFILL]    =  {"ZEROFILL",     GFS3_OP_ZEROFILL,     server3_3_zerofill,     NULL, 0, DRC_NA},
+        [GFS3_OP_COMPOUND]    =  {"COMPOUND",     GFS3_OP_COMPOUND,     server3_3_compound,     NULL, 0, DRC_NA},
 };
 
 
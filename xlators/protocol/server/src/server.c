@@ -25,6 +25,7 @@
 #include "statedump.h"
 #include "defaults.h"
 #include "authenticate.h"
+#include "upcall-utils.h"
 
 void
 grace_time_handler (void *data)
@@ -750,6 +751,9 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("gid-timeout", conf->gid_cache_timeout, options,
                           int32, out);
+
+        GF_OPTION_RECONF ("zero-copy-read", conf->zero_copy_read, options,
+                          bool, out);
         if (gid_cache_reconf (&conf->gid_cache, conf->gid_cache_timeout) < 0) {
                 gf_log(this->name, GF_LOG_ERROR, "Failed to reconfigure group "
                         "cache.");
@@ -889,6 +893,8 @@ init (xlator_t *this)
         else
                 conf->server_manage_gids = ret;
 
+        GF_OPTION_INIT ("zero-copy-read", conf->zero_copy_read, bool, out);
+
         GF_OPTION_INIT("gid-timeout", conf->gid_cache_timeout, int32, out);
         if (gid_cache_init (&conf->gid_cache, conf->gid_cache_timeout) < 0) {
                 gf_log(this->name, GF_LOG_ERROR, "Failed to initialize "
@@ -1032,6 +1038,95 @@ fini (xlator_t *this)
         return;
 }
 
+rpcsvc_cbk_program_t server_cbk_prog = {
+        .progname  = "Gluster Callback",
+        .prognum   = GLUSTER_CBK_PROGRAM,
+        .progver   = GLUSTER_CBK_VERSION,
+};
+
+/* Send an upcall of the bricks to the client it is meant for, over all
+ * its connections to this server */
+int
+server_process_event_upcall (xlator_t *this, void *data)
+{
+        int                                  ret     = -1;
+        GF_UNUSED int                        op_errno = 0;
+        server_conf_t                       *conf    = NULL;
+        client_t                            *client  = NULL;
+        rpc_transport_t                     *xprt    = NULL;
+        struct gf_upcall                    *upcall  = NULL;
+        struct gf_upcall_inodelk_contention *lc      = NULL;
+        gfs3_cbk_inodelk_contention_req      req     = {{0,},};
+        struct iovec                         iov     = {0,};
+        ssize_t                              len     = 0;
+        char                                *buf     = NULL;
+
+        conf = this->private;
+        upcall = data;
+
+        GF_VALIDATE_OR_GOTO (this->name, conf, out);
+        GF_VALIDATE_OR_GOTO (this->name, upcall, out);
+        GF_VALIDATE_OR_GOTO (this->name, upcall->client_uid, out);
+
+        switch (upcall->event_type) {
+        case GF_UPCALL_INODELK_CONTENTION:
+                lc = upcall->data;
+                GF_VALIDATE_OR_GOTO (this->name, lc, out);
+
+                memcpy (req.gfid, upcall->gfid, 16);
+                gf_proto_flock_from_flock (&req.flock, &lc->flock);
+                req.domain = (char *)lc->domain;
+                GF_PROTOCOL_DICT_SERIALIZE (this, lc->xdata,
+                                            (&req.xdata.xdata_val),
+                                            req.xdata.xdata_len, op_errno,
+                                            out);
+                break;
+        default:
+                gf_log (this->name, GF_LOG_WARNING, "unknown upcall event "
+                        "type %d", upcall->event_type);
+                goto out;
+        }
+
+        len = xdr_sizeof ((xdrproc_t) xdr_gfs3_cbk_inodelk_contention_req,
+                          &req);
+        buf = GF_CALLOC (1, len, gf_common_mt_char);
+        if (!buf)
+                goto out;
+
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        len = xdr_serialize_generic (iov, &req, (xdrproc_t)
+                                     xdr_gfs3_cbk_inodelk_contention_req);
+        if (len == -1) {
+                gf_log (this->name, GF_LOG_ERROR, "failed to encode upcall");
+                goto out;
+        }
+        iov.iov_len = len;
+
+        pthread_mutex_lock (&conf->mutex);
+        {
+                list_for_each_entry (xprt, &conf->xprt_list, list) {
+                        client = xprt->xl_private;
+                        if (!client || !client->client_uid ||
+                            strcmp (client->client_uid, upcall->client_uid))
+                                continue;
+
+                        rpcsvc_callback_submit (conf->rpc, xprt,
+                                                &server_cbk_prog,
+                                                GF_CBK_INODELK_CONTENTION,
+                                                &iov, 1);
+                }
+        }
+        pthread_mutex_unlock (&conf->mutex);
+
+        ret = 0;
+out:
+        GF_FREE (buf);
+        GF_FREE (req.xdata.xdata_val);
+
+        return ret;
+}
+
 int
 notify (xlator_t *this, int32_t event, void *data, ...)
 {
@@ -1047,6 +1142,9 @@ notify (xlator_t *this, int32_t event, void *data, ...)
         va_end (ap);
 
         switch (event) {
+        case GF_EVENT_UPCALL:
+                ret = server_process_event_upcall (this, data);
+                break;
         default:
                 default_notify (this, event, data);
                 break;
@@ -1191,6 +1289,13 @@ struct volume_options options[] = {
           .default_value = "2",
           .description = "Timeout in seconds for the cached groups to expire."
         },
+        { .key   = {"zero-copy-read"},
+          .type  = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Send read replies from the brick's page cache "
+                         "with sendfile() instead of copying them through "
+                         "user space. Not used on SSL connections."
+        },
 
         { .key   = {NULL} },
 };
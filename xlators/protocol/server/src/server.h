@@ -63,6 +63,7 @@ struct server_conf {
         gf_boolean_t            server_manage_gids; /* resolve gids on brick */
         gid_cache_t             gid_cache;
         int32_t                 gid_cache_timeout;
+        gf_boolean_t            zero_copy_read;
 };
 typedef struct server_conf server_conf_t;
 
@@ -94,6 +95,13 @@ typedef struct {
 } server_resolve_t;
 
 
+/* how a member of a compound fop is resolved */
+typedef struct {
+        server_resolve_t       resolve;
+        int                    fd_link;
+} server_compound_fop_t;
+
+
 typedef int (*server_resume_fn_t) (call_frame_t *frame, xlator_t *bound_xl);
 
 int
@@ -145,6 +153,11 @@ struct _server_state {
 
         dict_t           *xdata;
         mode_t            umask;
+
+        compound_args_t       *compound_args;
+        server_compound_fop_t *compound_fops;
+        int                    compound_count;
+        int                    compound_index;
 };
 
 
@@ -179,6 +179,11 @@ posix_aio_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         priv = this->private;
 
+        /* nothing to read for a zero-copy reply */
+        if (xdata && dict_get (xdata, GLUSTERFS_ZERO_COPY_READ))
+                return posix_readv (frame, this, fd, size, offset, flags,
+                                    xdata);
+
         ret = posix_fd_ctx_get (fd, this, &pfd);
         if (ret < 0) {
                 op_errno = -ret;
@@ -90,7 +90,8 @@ posix_make_ancestral_node (const char *priv_base_path, char *path, int pathsize,
                 uuid_copy (loc.gfid, inode->gfid);
 
                 entry->dict = posix_lookup_xattr_fill (THIS, real_path, &loc,
-                                                       xdata, iabuf);
+                                                       xdata, iabuf,
+                                                       GF_FOP_GETXATTR);
                 loc_wipe (&loc);
         }
 
@@ -827,6 +828,8 @@ posix_handle_unset_gfid (xlator_t *this, uuid_t gfid)
         }
 
 out:
+        posix_hcache_invalidate (this, gfid);
+
         return ret;
 }
 
@@ -876,3 +879,425 @@ posix_create_link_if_gfid_exists (xlator_t *this, uuid_t gfid,
 
         return ret;
 }
+
+
+/*
+ * Directory handle cache.
+ *
+ * Resolving a gfid through .glusterfs/xx/yy/<gfid> costs an lstat() and, for
+ * directories, a readlink() per level of the symlink chain. The cache keeps
+ * an O_PATH fd per directory gfid so that posix_istat() can do a single
+ * fstatat() relative to it. Entries whose fd got evicted may keep their
+ * kernel file handle (name_to_handle_at), which is reopened with one
+ * open_by_handle_at() instead of walking the symlink chain again.
+ *
+ * Entries are invalidated when the gfid handle is removed (rmdir, rename
+ * over a directory) and on forget. A cached fd of a directory that got
+ * removed behind our back is detected through st_nlink == 0.
+ */
+
+#define POSIX_HCACHE_BUCKETS 4096
+
+struct posix_hcache_entry {
+        struct list_head    hash;
+        struct list_head    lru;
+        uuid_t              gfid;
+        int                 fd;    /* O_PATH fd, -1 if only fh is kept */
+        int                 ref;
+        gf_boolean_t        dead;  /* unhashed, close on last unref */
+        struct file_handle *fh;
+};
+
+
+static struct list_head *
+__posix_hcache_bucket (struct posix_private *priv, uuid_t gfid)
+{
+        uint32_t hash = 0;
+
+        memcpy (&hash, &gfid[12], sizeof (hash));
+
+        return &priv->hcache_table[hash % POSIX_HCACHE_BUCKETS];
+}
+
+
+static void
+posix_hcache_entry_destroy (struct posix_hcache_entry *entry)
+{
+        if (entry->fd >= 0)
+                close (entry->fd);
+        GF_FREE (entry->fh);
+        GF_FREE (entry);
+}
+
+
+static void
+__posix_hcache_unhash (struct posix_private *priv,
+                       struct posix_hcache_entry *entry)
+{
+        list_del_init (&entry->hash);
+        list_del_init (&entry->lru);
+
+        if (entry->fd >= 0)
+                priv->hcache_nr_fds--;
+        else
+                priv->hcache_nr_handles--;
+
+        entry->dead = _gf_true;
+}
+
+
+/* close the fd of the least recently used entry, keeping its handle */
+static struct posix_hcache_entry *
+__posix_hcache_evict (struct posix_private *priv)
+{
+        struct posix_hcache_entry *entry  = NULL;
+        struct posix_hcache_entry *victim = NULL;
+
+        list_for_each_entry_reverse (entry, &priv->hcache_lru, lru) {
+                if (entry->ref == 0) {
+                        victim = entry;
+                        break;
+                }
+        }
+
+        if (!victim)
+                return NULL;
+
+        if (!victim->fh || priv->hcache_nr_handles >= 4 * priv->hcache_size) {
+                __posix_hcache_unhash (priv, victim);
+                return victim;
+        }
+
+        close (victim->fd);
+        victim->fd = -1;
+        priv->hcache_nr_fds--;
+        priv->hcache_nr_handles++;
+
+        list_del_init (&victim->lru);
+        list_add (&victim->lru, &priv->hcache_handles);
+
+        return NULL;
+}
+
+
+static struct posix_hcache_entry *
+__posix_hcache_find (struct posix_private *priv, uuid_t gfid)
+{
+        struct posix_hcache_entry *entry = NULL;
+
+        list_for_each_entry (entry, __posix_hcache_bucket (priv, gfid), hash) {
+                if (uuid_compare (entry->gfid, gfid) == 0)
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+int
+posix_hcache_init (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   i    = 0;
+
+        priv = this->private;
+
+        priv->hcache_table = GF_CALLOC (POSIX_HCACHE_BUCKETS,
+                                        sizeof (struct list_head),
+                                        gf_posix_mt_hcache_table);
+        if (!priv->hcache_table)
+                return -1;
+
+        for (i = 0; i < POSIX_HCACHE_BUCKETS; i++)
+                INIT_LIST_HEAD (&priv->hcache_table[i]);
+
+        INIT_LIST_HEAD (&priv->hcache_lru);
+        INIT_LIST_HEAD (&priv->hcache_handles);
+        pthread_mutex_init (&priv->hcache_lock, NULL);
+
+        return 0;
+}
+
+
+void
+posix_hcache_fini (xlator_t *this)
+{
+        struct posix_private      *priv  = NULL;
+        struct posix_hcache_entry *entry = NULL;
+        struct posix_hcache_entry *tmp   = NULL;
+
+        priv = this->private;
+        if (!priv->hcache_table)
+                return;
+
+        list_for_each_entry_safe (entry, tmp, &priv->hcache_lru, lru) {
+                __posix_hcache_unhash (priv, entry);
+                posix_hcache_entry_destroy (entry);
+        }
+        list_for_each_entry_safe (entry, tmp, &priv->hcache_handles, lru) {
+                __posix_hcache_unhash (priv, entry);
+                posix_hcache_entry_destroy (entry);
+        }
+
+        GF_FREE (priv->hcache_table);
+        priv->hcache_table = NULL;
+        pthread_mutex_destroy (&priv->hcache_lock);
+}
+
+
+static struct file_handle *
+posix_hcache_name_to_handle (xlator_t *this, int fd)
+{
+#ifdef MAX_HANDLE_SZ
+        struct file_handle *fh       = NULL;
+        int                 mount_id = 0;
+
+        fh = GF_CALLOC (1, sizeof (*fh) + MAX_HANDLE_SZ,
+                        gf_posix_mt_hcache_handle);
+        if (!fh)
+                return NULL;
+
+        fh->handle_bytes = MAX_HANDLE_SZ;
+        if (name_to_handle_at (fd, "", fh, &mount_id, AT_EMPTY_PATH) == -1) {
+                GF_FREE (fh);
+                return NULL;
+        }
+
+        return fh;
+#else
+        return NULL;
+#endif
+}
+
+
+static int
+posix_hcache_open_by_handle (xlator_t *this, struct file_handle *fh)
+{
+#ifdef MAX_HANDLE_SZ
+        struct posix_private *priv = NULL;
+        int                   fd   = -1;
+
+        priv = this->private;
+
+        fd = open_by_handle_at (dirfd (priv->mount_lock), fh,
+                                O_PATH | O_DIRECTORY);
+        if (fd == -1 && errno == EPERM) {
+                /* needs CAP_DAC_READ_SEARCH, don't bother again */
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open_by_handle_at() not permitted, disabling "
+                        "handle-cache-open-by-handle");
+                priv->hcache_by_handle = _gf_false;
+        }
+
+        return fd;
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+}
+
+
+/*
+ * Returns a referenced entry with a usable O_PATH fd for the directory
+ * @gfid, or NULL if it is not cached. Release it with posix_hcache_put().
+ */
+struct posix_hcache_entry *
+posix_hcache_get (xlator_t *this, uuid_t gfid)
+{
+        struct posix_private      *priv  = NULL;
+        struct posix_hcache_entry *entry = NULL;
+        struct posix_hcache_entry *dead  = NULL;
+        int                        fd    = -1;
+
+        priv = this->private;
+        if (!priv->hcache_size)
+                return NULL;
+
+        pthread_mutex_lock (&priv->hcache_lock);
+        {
+                entry = __posix_hcache_find (priv, gfid);
+                if (!entry) {
+                        priv->hcache_misses++;
+                        goto unlock;
+                }
+
+                if (entry->fd < 0) {
+                        /* only the kernel handle is left */
+                        if (entry->ref || !priv->hcache_by_handle) {
+                                entry = NULL;
+                                priv->hcache_misses++;
+                                goto unlock;
+                        }
+                        fd = posix_hcache_open_by_handle (this, entry->fh);
+                        if (fd == -1) {
+                                __posix_hcache_unhash (priv, entry);
+                                dead = entry;
+                                entry = NULL;
+                                priv->hcache_misses++;
+                                goto unlock;
+                        }
+                        entry->fd = fd;
+                        priv->hcache_nr_handles--;
+                        priv->hcache_nr_fds++;
+                        priv->hcache_reopens++;
+                        if (priv->hcache_nr_fds > priv->hcache_size)
+                                dead = __posix_hcache_evict (priv);
+                }
+
+                list_del (&entry->lru);
+                list_add (&entry->lru, &priv->hcache_lru);
+                entry->ref++;
+                priv->hcache_hits++;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->hcache_lock);
+
+        if (dead)
+                posix_hcache_entry_destroy (dead);
+
+        return entry;
+}
+
+
+void
+posix_hcache_put (xlator_t *this, struct posix_hcache_entry *entry)
+{
+        struct posix_private *priv    = NULL;
+        gf_boolean_t          destroy = _gf_false;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->hcache_lock);
+        {
+                entry->ref--;
+                if (entry->dead && entry->ref == 0)
+                        destroy = _gf_true;
+        }
+        pthread_mutex_unlock (&priv->hcache_lock);
+
+        if (destroy)
+                posix_hcache_entry_destroy (entry);
+}
+
+
+int
+posix_hcache_fd (struct posix_hcache_entry *entry)
+{
+        return entry->fd;
+}
+
+
+/* cache the directory at @path (the resolved handle of @gfid) */
+void
+posix_hcache_add (xlator_t *this, uuid_t gfid, const char *path)
+{
+        struct posix_private      *priv  = NULL;
+        struct posix_hcache_entry *entry = NULL;
+        struct posix_hcache_entry *dead  = NULL;
+        int                        fd    = -1;
+
+        priv = this->private;
+        if (!priv->hcache_size)
+                return;
+
+#ifdef O_PATH
+        fd = open (path, O_PATH | O_DIRECTORY | O_NOFOLLOW);
+#endif
+        if (fd == -1)
+                return;
+
+        entry = GF_CALLOC (1, sizeof (*entry), gf_posix_mt_hcache_entry);
+        if (!entry) {
+                close (fd);
+                return;
+        }
+
+        INIT_LIST_HEAD (&entry->hash);
+        INIT_LIST_HEAD (&entry->lru);
+        uuid_copy (entry->gfid, gfid);
+        entry->fd = fd;
+        if (priv->hcache_by_handle)
+                entry->fh = posix_hcache_name_to_handle (this, fd);
+
+        pthread_mutex_lock (&priv->hcache_lock);
+        {
+                if (__posix_hcache_find (priv, gfid)) {
+                        /* raced with another lookup */
+                        dead = entry;
+                        goto unlock;
+                }
+
+                list_add (&entry->hash, __posix_hcache_bucket (priv, gfid));
+                list_add (&entry->lru, &priv->hcache_lru);
+                priv->hcache_nr_fds++;
+
+                if (priv->hcache_nr_fds > priv->hcache_size)
+                        dead = __posix_hcache_evict (priv);
+        }
+unlock:
+        pthread_mutex_unlock (&priv->hcache_lock);
+
+        if (dead)
+                posix_hcache_entry_destroy (dead);
+}
+
+
+/* drop fds until the cache fits in handle-cache-size again */
+void
+posix_hcache_shrink (xlator_t *this)
+{
+        struct posix_private      *priv     = NULL;
+        struct posix_hcache_entry *dead     = NULL;
+        gf_boolean_t               progress = _gf_false;
+
+        priv = this->private;
+        if (!priv->hcache_table)
+                return;
+
+        do {
+                progress = _gf_false;
+
+                pthread_mutex_lock (&priv->hcache_lock);
+                {
+                        if (priv->hcache_nr_fds > priv->hcache_size) {
+                                uint32_t nr_fds = priv->hcache_nr_fds;
+
+                                dead = __posix_hcache_evict (priv);
+                                /* no progress if all entries are in use */
+                                progress = (priv->hcache_nr_fds < nr_fds);
+                        }
+                }
+                pthread_mutex_unlock (&priv->hcache_lock);
+
+                if (dead) {
+                        posix_hcache_entry_destroy (dead);
+                        dead = NULL;
+                }
+        } while (progress);
+}
+
+
+void
+posix_hcache_invalidate (xlator_t *this, uuid_t gfid)
+{
+        struct posix_private      *priv  = NULL;
+        struct posix_hcache_entry *entry = NULL;
+
+        priv = this->private;
+        if (!priv->hcache_table)
+                return;
+
+        pthread_mutex_lock (&priv->hcache_lock);
+        {
+                entry = __posix_hcache_find (priv, gfid);
+                if (entry) {
+                        __posix_hcache_unhash (priv, entry);
+                        if (entry->ref)
+                                entry = NULL;
+                }
+        }
+        pthread_mutex_unlock (&priv->hcache_lock);
+
+        if (entry)
+                posix_hcache_entry_destroy (entry);
+}
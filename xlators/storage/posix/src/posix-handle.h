@@ -238,4 +238,23 @@ int posix_create_link_if_gfid_exists (xlator_t *this, uuid_t gfid,
 
 int
 posix_handle_trash_init (xlator_t *this);
+
+struct posix_hcache_entry;
+
+int posix_hcache_init (xlator_t *this);
+
+void posix_hcache_fini (xlator_t *this);
+
+struct posix_hcache_entry *
+posix_hcache_get (xlator_t *this, uuid_t gfid);
+
+void posix_hcache_put (xlator_t *this, struct posix_hcache_entry *entry);
+
+int posix_hcache_fd (struct posix_hcache_entry *entry);
+
+void posix_hcache_add (xlator_t *this, uuid_t gfid, const char *path);
+
+void posix_hcache_shrink (xlator_t *this);
+
+void posix_hcache_invalidate (xlator_t *this, uuid_t gfid);
 #endif /* !_POSIX_HANDLE_H */
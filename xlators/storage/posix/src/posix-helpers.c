@@ -121,6 +121,167 @@ out:
         return ignore;
 }
 
+/*
+ * Per-thread buffers for the lookup xattr fast path: one llistxattr() tells
+ * which of the requested keys exist, so absent keys cost no syscall and
+ * present ones are read with a single lgetxattr() into @value.
+ */
+struct posix_xattr_tsd {
+        char         *list;
+        size_t        list_size;
+        char         *value;
+        size_t        value_size;
+        gf_boolean_t  busy;  /* lookup fills nest through get-ancestry */
+};
+
+#define POSIX_XATTR_LIST_SIZE  4096
+#define POSIX_XATTR_VALUE_SIZE 4096
+
+static pthread_key_t  posix_xattr_tsd_key;
+static pthread_once_t posix_xattr_tsd_once = PTHREAD_ONCE_INIT;
+
+static void
+posix_xattr_tsd_destroy (void *ptr)
+{
+        struct posix_xattr_tsd *tsd = ptr;
+
+        FREE (tsd->list);
+        FREE (tsd->value);
+        FREE (tsd);
+}
+
+static void
+posix_xattr_tsd_key_create (void)
+{
+        pthread_key_create (&posix_xattr_tsd_key, posix_xattr_tsd_destroy);
+}
+
+static struct posix_xattr_tsd *
+posix_xattr_tsd_get (void)
+{
+        struct posix_xattr_tsd *tsd = NULL;
+
+        if (pthread_once (&posix_xattr_tsd_once,
+                          posix_xattr_tsd_key_create) != 0)
+                return NULL;
+
+        tsd = pthread_getspecific (posix_xattr_tsd_key);
+        if (tsd)
+                return tsd;
+
+        tsd = CALLOC (1, sizeof (*tsd));
+        if (!tsd)
+                return NULL;
+
+        tsd->list = MALLOC (POSIX_XATTR_LIST_SIZE);
+        tsd->value = MALLOC (POSIX_XATTR_VALUE_SIZE);
+        if (!tsd->list || !tsd->value)
+                goto err;
+        tsd->list_size = POSIX_XATTR_LIST_SIZE;
+        tsd->value_size = POSIX_XATTR_VALUE_SIZE;
+
+        if (pthread_setspecific (posix_xattr_tsd_key, tsd) != 0)
+                goto err;
+
+        return tsd;
+err:
+        posix_xattr_tsd_destroy (tsd);
+        return NULL;
+}
+
+/* fetch the names of all xattrs of filler->real_path into @tsd->list */
+static int
+posix_xattr_list_fetch (posix_xattr_filler_t *filler,
+                        struct posix_xattr_tsd *tsd)
+{
+        ssize_t  size = -1;
+        char    *list = NULL;
+
+        size = sys_llistxattr (filler->real_path, tsd->list, tsd->list_size);
+        filler->nr_syscalls++;
+
+        if (size == -1 && errno == ERANGE) {
+                size = sys_llistxattr (filler->real_path, NULL, 0);
+                filler->nr_syscalls++;
+                if (size <= 0)
+                        return -1;
+
+                list = REALLOC (tsd->list, size);
+                if (!list)
+                        return -1;
+                tsd->list = list;
+                tsd->list_size = size;
+
+                size = sys_llistxattr (filler->real_path, tsd->list,
+                                       tsd->list_size);
+                filler->nr_syscalls++;
+        }
+
+        if (size < 0)
+                return -1;
+
+        filler->list = tsd->list;
+        filler->list_size = size;
+        filler->value = tsd->value;
+        filler->value_size = tsd->value_size;
+
+        return 0;
+}
+
+static gf_boolean_t
+posix_xattr_list_has (posix_xattr_filler_t *filler, const char *key)
+{
+        ssize_t offset = 0;
+
+        while (offset < filler->list_size) {
+                if (strcmp (filler->list + offset, key) == 0)
+                        return _gf_true;
+                offset += strlen (filler->list + offset) + 1;
+        }
+
+        return _gf_false;
+}
+
+/*
+ * Answers @key from the xattr list fetched for this lookup. Returns 1 if
+ * the key was handled, 0 if the caller has to go to the backend.
+ */
+static int
+posix_xattr_get_set_from_list (posix_xattr_filler_t *filler, char *key)
+{
+        ssize_t  xattr_size = -1;
+        char    *value      = NULL;
+
+        if (!posix_xattr_list_has (filler, key)) {
+                filler->nr_avoided++;
+                return 1;
+        }
+
+        xattr_size = sys_lgetxattr (filler->real_path, key, filler->value,
+                                    filler->value_size);
+        filler->nr_syscalls++;
+        if (xattr_size == -1)
+                /* ERANGE: larger than the buffer, probe its size */
+                return (errno == ERANGE) ? 0 : 1;
+
+        if (xattr_size == 0)
+                return 1;
+
+        value = GF_CALLOC (1, xattr_size + 1, gf_posix_mt_char);
+        if (!value)
+                return 1;
+
+        memcpy (value, filler->value, xattr_size);
+        if (dict_set_bin (filler->xattr, key, value, xattr_size) < 0) {
+                gf_log (filler->this->name, GF_LOG_DEBUG,
+                        "dict set failed. path: %s, key: %s",
+                        filler->real_path, key);
+                GF_FREE (value);
+        }
+
+        return 1;
+}
+
 static int
 _posix_xattr_get_set_from_backend (posix_xattr_filler_t *filler, char *key)
 {
@@ -128,7 +289,11 @@ _posix_xattr_get_set_from_backend (posix_xattr_filler_t *filler, char *key)
         int      ret        = 0;
         char    *value      = NULL;
 
+        if (filler->list && posix_xattr_get_set_from_list (filler, key))
+                goto out;
+
         xattr_size = sys_lgetxattr (filler->real_path, key, NULL, 0);
+        filler->nr_syscalls++;
 
         if (xattr_size > 0) {
                 value = GF_CALLOC (1, xattr_size + 1,
@@ -138,6 +303,7 @@ _posix_xattr_get_set_from_backend (posix_xattr_filler_t *filler, char *key)
 
                 xattr_size = sys_lgetxattr (filler->real_path, key, value,
                                             xattr_size);
+                filler->nr_syscalls++;
                 if (xattr_size <= 0) {
                         gf_log (filler->this->name, GF_LOG_WARNING,
                                 "getxattr failed. path: %s, key: %s",
@@ -171,6 +337,12 @@ _posix_get_marker_all_contributions (posix_xattr_filler_t *filler)
         int      ret  = -1;
         char    *list = NULL, key[4096] = {0, };
 
+        if (filler->list) {
+                list = filler->list;
+                size = filler->list_size;
+                goto iterate;
+        }
+
         size = sys_llistxattr (filler->real_path, NULL, 0);
         if (size == -1) {
                 if ((errno == ENOTSUP) || (errno == ENOSYS)) {
@@ -206,6 +378,7 @@ _posix_get_marker_all_contributions (posix_xattr_filler_t *filler)
                 goto out;
         }
 
+iterate:
         remaining_size = size;
         list_offset = 0;
 
@@ -455,22 +628,76 @@ out:
 }
 
 
+/*
+ * stat @basename (or the directory itself) relative to the cached O_PATH fd
+ * of directory @gfid. Returns 1 if the cached fd turned out to be stale and
+ * the caller has to resolve the handle path instead.
+ */
+static int
+posix_istat_cached (xlator_t *this, int dfd, const char *basename,
+                    struct stat *lstatbuf, char *fdpath, size_t fdpath_len)
+{
+        struct stat dirbuf = {0, };
+        int         ret    = 0;
+
+        if (basename)
+                ret = fstatat (dfd, basename, lstatbuf, AT_SYMLINK_NOFOLLOW);
+        else
+                ret = fstatat (dfd, "", lstatbuf, AT_EMPTY_PATH);
+
+        if (ret == 0 && !basename && lstatbuf->st_nlink == 0)
+                return 1;
+
+        if (ret == -1 && errno == ENOENT && basename) {
+                if (fstatat (dfd, "", &dirbuf, AT_EMPTY_PATH) == 0 &&
+                    dirbuf.st_nlink == 0)
+                        return 1;
+                errno = ENOENT;
+        }
+
+        if (basename)
+                snprintf (fdpath, fdpath_len, "/proc/self/fd/%d/%s", dfd,
+                          basename);
+        else
+                snprintf (fdpath, fdpath_len, "/proc/self/fd/%d", dfd);
+
+        return ret;
+}
+
+
 int
 posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
              struct iatt *buf_p)
 {
         char        *real_path = NULL;
+        char        *dir_path = NULL;
         struct stat  lstatbuf = {0, };
         struct iatt  stbuf = {0, };
         int          ret = 0;
         struct posix_private *priv = NULL;
+        struct posix_hcache_entry *entry = NULL;
 
 
         priv = this->private;
 
-        MAKE_HANDLE_PATH (real_path, this, gfid, basename);
+        entry = posix_hcache_get (this, gfid);
+        if (entry) {
+                real_path = alloca (PATH_MAX);
+                ret = posix_istat_cached (this, posix_hcache_fd (entry),
+                                          basename, &lstatbuf, real_path,
+                                          PATH_MAX);
+                if (ret == 1) {
+                        posix_hcache_put (this, entry);
+                        posix_hcache_invalidate (this, gfid);
+                        entry = NULL;
+                }
+        }
+
+        if (!entry) {
+                MAKE_HANDLE_PATH (real_path, this, gfid, basename);
 
-        ret = lstat (real_path, &lstatbuf);
+                ret = lstat (real_path, &lstatbuf);
+        }
 
         if (ret != 0) {
                 if (ret == -1) {
@@ -493,7 +720,8 @@ posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
         if ((lstatbuf.st_ino == priv->handledir.st_ino) &&
             (lstatbuf.st_dev == priv->handledir.st_dev)) {
                 errno = ENOENT;
-                return -1;
+                ret = -1;
+                goto out;
         }
 
         if (!S_ISDIR (lstatbuf.st_mode))
@@ -510,7 +738,22 @@ posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
 
         if (buf_p)
                 *buf_p = stbuf;
+
+        if (entry || !priv->hcache_size)
+                goto out;
+
+        /* cache the directory for the next resolution through it */
+        if (!basename && S_ISDIR (lstatbuf.st_mode)) {
+                posix_hcache_add (this, gfid, real_path);
+        } else if (basename) {
+                MAKE_HANDLE_PATH (dir_path, this, gfid, NULL);
+                if (dir_path)
+                        posix_hcache_add (this, gfid, dir_path);
+        }
 out:
+        if (entry)
+                posix_hcache_put (this, entry);
+
         return ret;
 }
 
@@ -586,6 +829,12 @@ _handle_list_xattr (dict_t *xattr_req, const char *real_path,
         if (!real_path)
                 goto out;
 
+        if (filler->list) {
+                list = filler->list;
+                size = filler->list_size;
+                goto iterate;
+        }
+
         size = sys_llistxattr (real_path, NULL, 0);
         if (size <= 0)
                 goto out;
@@ -598,6 +847,7 @@ _handle_list_xattr (dict_t *xattr_req, const char *real_path,
         if (size <= 0)
                 goto out;
 
+iterate:
         remaining_size = size;
         list_offset = 0;
         while (remaining_size > 0) {
@@ -624,11 +874,16 @@ out:
 
 dict_t *
 posix_lookup_xattr_fill (xlator_t *this, const char *real_path, loc_t *loc,
-                         dict_t *xattr_req, struct iatt *buf)
+                         dict_t *xattr_req, struct iatt *buf,
+                         glusterfs_fop_t fop)
 {
         dict_t     *xattr             = NULL;
         posix_xattr_filler_t filler   = {0, };
         gf_boolean_t    list          = _gf_false;
+        struct posix_xattr_tsd *tsd   = NULL;
+        struct posix_private   *priv  = NULL;
+
+        priv = this->private;
 
         if (dict_get (xattr_req, "list-xattr")) {
                 dict_del (xattr_req, "list-xattr");
@@ -646,10 +901,33 @@ posix_lookup_xattr_fill (xlator_t *this, const char *real_path, loc_t *loc,
         filler.stbuf     = buf;
         filler.loc       = loc;
 
+        /* requests for one or two keys are cheaper without the listing */
+        tsd = posix_xattr_tsd_get ();
+        if (tsd && !tsd->busy && real_path &&
+            (list || xattr_req->count > 2)) {
+                if (posix_xattr_list_fetch (&filler, tsd) == 0)
+                        tsd->busy = _gf_true;
+                else
+                        tsd = NULL;
+        } else {
+                tsd = NULL;
+        }
+
         dict_foreach (xattr_req, _posix_xattr_get_set, &filler);
         if (list)
                 _handle_list_xattr (xattr_req, real_path, &filler);
 
+        if (tsd)
+                tsd->busy = _gf_false;
+
+        if (fop >= 0 && fop < GF_FOP_MAXVALUE) {
+                LOCK (&priv->lock);
+                {
+                        priv->xattr_syscalls[fop] += filler.nr_syscalls;
+                        priv->xattr_avoided[fop] += filler.nr_avoided;
+                }
+                UNLOCK (&priv->lock);
+        }
 out:
         return xattr;
 }
@@ -1647,6 +1925,181 @@ posix_fsyncer_syncfs (xlator_t *this, struct list_head *head)
 }
 
 
+/* upper bound of the group-commit window if batch-fsync-delay-usec is 0 */
+#define POSIX_FSYNC_MAX_WINDOW_USEC 10000
+
+struct posix_fsync_group {
+        inode_t *inode;
+        int      fd;
+        int      datasync;
+        int      op_ret;
+        int      op_errno;
+};
+
+static int
+posix_fsyncer_pick_more (xlator_t *this, struct list_head *head)
+{
+        struct posix_private *priv = NULL;
+        int count = 0;
+
+        priv = this->private;
+        pthread_mutex_lock (&priv->fsync_mutex);
+        {
+                count = priv->fsync_queue_count;
+                priv->fsync_queue_count = 0;
+                list_append_init (&priv->fsyncs, head);
+        }
+        pthread_mutex_unlock (&priv->fsync_mutex);
+
+        return count;
+}
+
+/*
+ * How long to hold a batch open for more fsyncs. A lone fsync does not
+ * wait; under concurrency the window is half of the observed flush
+ * latency, so that waiting never costs more than the flush it saves.
+ */
+static uint64_t
+posix_fsyncer_window (struct posix_private *priv)
+{
+        uint64_t window = 0;
+        uint64_t max    = POSIX_FSYNC_MAX_WINDOW_USEC;
+
+        if (priv->fsync_last_batch <= 1)
+                return 0;
+
+        if (priv->batch_fsync_delay_usec)
+                max = priv->batch_fsync_delay_usec;
+
+        window = priv->fsync_latency_usec / 2;
+        if (window > max)
+                window = max;
+
+        return window;
+}
+
+static struct posix_fsync_group *
+posix_fsync_group_find (struct posix_fsync_group *groups, int nr,
+                        inode_t *inode)
+{
+        int i = 0;
+
+        for (i = 0; i < nr; i++) {
+                if (groups[i].inode == inode)
+                        return &groups[i];
+        }
+
+        return NULL;
+}
+
+/*
+ * Flush a batch with one fdatasync()/fsync() per inode and complete every
+ * waiter of that inode with its result. Writeback of all files is started
+ * before waiting on any of them, so the device gets the whole batch at once
+ * instead of one file per journal commit.
+ */
+static void
+posix_fsyncer_group_commit (xlator_t *this, struct list_head *head, int count)
+{
+        struct posix_private     *priv   = NULL;
+        struct posix_fsync_group *groups = NULL;
+        struct posix_fsync_group *group  = NULL;
+        struct posix_fd          *pfd    = NULL;
+        call_stub_t              *stub   = NULL;
+        call_stub_t              *tmp    = NULL;
+        struct timeval            start  = {0, };
+        struct timeval            end    = {0, };
+        uint64_t                  latency = 0;
+        int                       nr     = 0;
+        int                       i      = 0;
+        int                       ret    = -1;
+
+        priv = this->private;
+
+        groups = GF_CALLOC (count, sizeof (*groups), gf_posix_mt_fsync_group);
+
+        list_for_each_entry (stub, head, list) {
+                if (!groups)
+                        break;
+                group = posix_fsync_group_find (groups, nr,
+                                                stub->args.fd->inode);
+                if (group) {
+                        group->datasync &= !!stub->args.datasync;
+                        continue;
+                }
+                if (nr == count)
+                        break;
+                if (posix_fd_ctx_get (stub->args.fd, this, &pfd) < 0)
+                        continue;
+
+                group = &groups[nr++];
+                group->inode = stub->args.fd->inode;
+                group->fd = pfd->fd;
+                group->datasync = !!stub->args.datasync;
+        }
+
+        gettimeofday (&start, NULL);
+
+#if defined(GF_LINUX_HOST_OS) && defined(SYNC_FILE_RANGE_WRITE)
+        for (i = 0; i < nr; i++)
+                sync_file_range (groups[i].fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+
+        for (i = 0; i < nr; i++) {
+                if (groups[i].datasync)
+                        ret = sys_fdatasync (groups[i].fd);
+                else
+                        ret = sys_fsync (groups[i].fd);
+                if (ret) {
+                        groups[i].op_ret = -1;
+                        groups[i].op_errno = errno;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "group fsync of %s failed: %s",
+                                uuid_utoa (groups[i].inode->gfid),
+                                strerror (errno));
+                }
+        }
+
+        gettimeofday (&end, NULL);
+        latency = (end.tv_sec - start.tv_sec) * 1000000 +
+                  (end.tv_usec - start.tv_usec);
+
+        list_for_each_entry_safe (stub, tmp, head, list) {
+                list_del_init (&stub->list);
+
+                group = NULL;
+                if (groups)
+                        group = posix_fsync_group_find (groups, nr,
+                                                        stub->args.fd->inode);
+                /* not part of a group: flush it on its own */
+                if (!group) {
+                        posix_fsyncer_process (this, stub, _gf_true);
+                        continue;
+                }
+
+                call_unwind_error (stub, group->op_ret, group->op_errno);
+        }
+
+        GF_FREE (groups);
+
+        pthread_mutex_lock (&priv->fsync_mutex);
+        {
+                if (nr) {
+                        if (priv->fsync_latency_usec)
+                                priv->fsync_latency_usec =
+                                        (priv->fsync_latency_usec * 7 +
+                                         latency) / 8;
+                        else
+                                priv->fsync_latency_usec = latency;
+                }
+                priv->fsync_last_batch = count;
+                priv->fsync_flushes++;
+                priv->fsync_waiters += count;
+        }
+        pthread_mutex_unlock (&priv->fsync_mutex);
+}
+
+
 void *
 posix_fsyncer (void *d)
 {
@@ -1657,6 +2110,7 @@ posix_fsyncer (void *d)
         struct list_head list;
         int count = 0;
         gf_boolean_t do_fsync = _gf_true;
+        uint64_t window = 0;
 
         priv = this->private;
 
@@ -1665,6 +2119,20 @@ posix_fsyncer (void *d)
 
                 count = posix_fsyncer_pick (this, &list);
 
+                if (priv->batch_fsync_mode == BATCH_GROUP_COMMIT) {
+                        window = posix_fsyncer_window (priv);
+                        if (window) {
+                                usleep (window);
+                                count += posix_fsyncer_pick_more (this, &list);
+                        }
+
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "group commit of %d fsyncs", count);
+
+                        posix_fsyncer_group_commit (this, &list, count);
+                        continue;
+                }
+
                 usleep (priv->batch_fsync_delay_usec);
 
                 gf_log (this->name, GF_LOG_DEBUG,
@@ -1673,6 +2141,7 @@ posix_fsyncer (void *d)
                 switch (priv->batch_fsync_mode) {
                 case BATCH_NONE:
                 case BATCH_REVERSE_FSYNC:
+                case BATCH_GROUP_COMMIT:
                         break;
                 case BATCH_SYNCFS:
                 case BATCH_SYNCFS_SINGLE_FSYNC:
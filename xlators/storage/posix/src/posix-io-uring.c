@@ -0,0 +1,1157 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+#include "glusterfs.h"
+#include "posix.h"
+#include "posix-aio.h"
+#include "posix-io-uring.h"
+#include <sys/uio.h>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+
+/*
+ * io_uring engine for posix.
+ *
+ * Fops prepare a submission queue entry under io_uring_sq_lock and
+ * submit everything that is ready in the queue, so requests issued
+ * concurrently by the io-threads are pushed to the kernel in a single
+ * io_uring_enter(). With io-uring-sqpoll the kernel polls the queue and
+ * the submit is mostly a memory barrier. A single thread reaps
+ * completions in batches and unwinds the frames.
+ *
+ * Unlike linux-aio, O_DIRECT is not required: buffered IO is completed
+ * asynchronously by the kernel's io-wq workers.
+ */
+
+/* page sizes whose arenas get registered as fixed buffers */
+static size_t posix_io_uring_fixed_sizes[] = {
+        8 * 1024,
+        32 * 1024,
+        128 * 1024,
+        256 * 1024,
+        1 * 1024 * 1024,
+};
+
+
+struct posix_io_uring_cb {
+        call_frame_t   *frame;
+        fd_t           *fd;
+        struct iobuf   *iobuf;
+        struct iobref  *iobref;
+        dict_t         *xdata;
+        struct iatt     prebuf;
+        struct iovec    iov;
+        int             _fd;
+        int             op;
+        off_t           offset;
+        size_t          size;
+};
+
+
+static void
+posix_io_uring_cb_destroy (struct posix_io_uring_cb *cb)
+{
+        if (!cb)
+                return;
+
+        if (cb->fd)
+                fd_unref (cb->fd);
+        if (cb->iobuf)
+                iobuf_unref (cb->iobuf);
+        if (cb->iobref)
+                iobref_unref (cb->iobref);
+        if (cb->xdata)
+                dict_unref (cb->xdata);
+
+        GF_FREE (cb);
+}
+
+
+static struct posix_io_uring_cb *
+posix_io_uring_cb_new (call_frame_t *frame, fd_t *fd, struct posix_fd *pfd,
+                       int op, off_t offset, size_t size, dict_t *xdata)
+{
+        struct posix_io_uring_cb *cb = NULL;
+
+        cb = GF_CALLOC (1, sizeof (*cb), gf_posix_mt_io_uring_cb);
+        if (!cb)
+                return NULL;
+
+        cb->frame = frame;
+        cb->fd = fd_ref (fd);
+        cb->_fd = pfd->fd;
+        cb->op = op;
+        cb->offset = offset;
+        cb->size = size;
+        if (xdata)
+                cb->xdata = dict_ref (xdata);
+
+        return cb;
+}
+
+
+/* returns the index of the registered buffer holding [buf, buf + len) */
+static int
+posix_io_uring_fixed_index (struct posix_private *priv, void *buf, size_t len)
+{
+        int    i    = 0;
+        char  *base = NULL;
+
+        for (i = 0; i < priv->io_uring_nr_fixed; i++) {
+                base = priv->io_uring_fixed[i].iov_base;
+                if ((char *)buf >= base &&
+                    (char *)buf + len <= base + priv->io_uring_fixed[i].iov_len)
+                        return i;
+        }
+
+        return -1;
+}
+
+
+/* times a failing io_uring_submit() is retried before leaving the queued
+   entries to the next submit */
+#define POSIX_IO_URING_SUBMIT_RETRIES 3
+
+/*
+ * Queue one request and submit whatever is pending in the SQ. @prep fills
+ * the entry; it is called with the SQ lock held.
+ *
+ * Returns 0 once the entry is prepared: from then on @cb belongs to the
+ * ring and the completion unwinds the frame, even if io_uring_submit()
+ * failed (the entry is then pushed by the next submit, done by the
+ * completion thread after each batch at the latest). A negative value
+ * means nothing was queued and the caller still owns @cb.
+ */
+static int
+posix_io_uring_submit (struct posix_private *priv,
+                       struct posix_io_uring_cb *cb,
+                       void (*prep) (struct posix_private *priv,
+                                     struct io_uring_sqe *sqe,
+                                     struct posix_io_uring_cb *cb,
+                                     void *data),
+                       void *data)
+{
+        struct io_uring_sqe *sqe   = NULL;
+        int                  ret   = -EAGAIN;
+        int                  tries = 0;
+
+        pthread_mutex_lock (&priv->io_uring_sq_lock);
+        {
+                if (priv->io_uring_stop) {
+                        ret = -ESHUTDOWN;
+                        goto unlock;
+                }
+
+                sqe = io_uring_get_sqe (&priv->io_uring);
+                if (!sqe) {
+                        /* SQ full, flush it and retry once */
+                        io_uring_submit (&priv->io_uring);
+                        sqe = io_uring_get_sqe (&priv->io_uring);
+                }
+                if (!sqe)
+                        goto unlock;
+
+                prep (priv, sqe, cb, data);
+                io_uring_sqe_set_data (sqe, cb);
+                priv->io_uring_inflight++;
+
+                do {
+                        ret = io_uring_submit (&priv->io_uring);
+                } while (ret < 0 && ret != -EINVAL && ret != -EFAULT &&
+                         ++tries < POSIX_IO_URING_SUBMIT_RETRIES);
+
+                if (ret < 0)
+                        gf_log (THIS->name, GF_LOG_WARNING,
+                                "io_uring_submit() returned %d, leaving the "
+                                "request queued", ret);
+                ret = 0;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->io_uring_sq_lock);
+
+        return ret;
+}
+
+
+int
+posix_io_uring_readv_complete (struct posix_io_uring_cb *cb, int res)
+{
+        call_frame_t          *frame    = NULL;
+        xlator_t              *this     = NULL;
+        struct iatt            postbuf  = {0,};
+        int                    op_ret   = -1;
+        int                    op_errno = 0;
+        struct iovec           iov      = {0,};
+        struct iobref         *iobref   = NULL;
+        int                    ret      = 0;
+        struct posix_private  *priv     = NULL;
+
+        frame = cb->frame;
+        this = frame->this;
+        priv = this->private;
+
+        if (res < 0) {
+                op_ret = -1;
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "readv(io_uring) failed fd=%d,size=%lu,offset=%llu "
+                        "(%d/%s)", cb->_fd, (unsigned long) cb->size,
+                        (unsigned long long) cb->offset, res,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &postbuf);
+        if (ret != 0) {
+                op_ret = -1;
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%d: %s", cb->_fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = res;
+        op_errno = 0;
+
+        iobref = iobref_new ();
+        if (!iobref) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        iobref_add (iobref, cb->iobuf);
+
+        iov.iov_base = iobuf_ptr (cb->iobuf);
+        iov.iov_len = op_ret;
+
+        /* Hack to notify higher layers of EOF. */
+        if (!postbuf.ia_size || (cb->offset + iov.iov_len) >= postbuf.ia_size)
+                op_errno = ENOENT;
+
+        LOCK (&priv->lock);
+        {
+                priv->read_value += op_ret;
+        }
+        UNLOCK (&priv->lock);
+
+out:
+        STACK_UNWIND_STRICT (readv, frame, op_ret, op_errno, &iov, 1,
+                             &postbuf, iobref, NULL);
+        if (iobref)
+                iobref_unref (iobref);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+static void
+posix_io_uring_prep_readv (struct posix_private *priv,
+                           struct io_uring_sqe *sqe,
+                           struct posix_io_uring_cb *cb, void *data)
+{
+        int idx = -1;
+
+        idx = posix_io_uring_fixed_index (priv, cb->iov.iov_base,
+                                          cb->iov.iov_len);
+        if (idx >= 0)
+                io_uring_prep_read_fixed (sqe, cb->_fd, cb->iov.iov_base,
+                                          cb->iov.iov_len, cb->offset, idx);
+        else
+                io_uring_prep_readv (sqe, cb->_fd, &cb->iov, 1, cb->offset);
+}
+
+
+int
+posix_io_uring_readv (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      size_t size, off_t offset, uint32_t flags,
+                      dict_t *xdata)
+{
+        int32_t                    op_errno = EINVAL;
+        struct iobuf              *iobuf    = NULL;
+        struct posix_fd           *pfd      = NULL;
+        int                        ret      = -1;
+        struct posix_io_uring_cb  *cb       = NULL;
+        struct posix_private      *priv     = NULL;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        priv = this->private;
+
+        /* nothing to read for a zero-copy reply */
+        if (xdata && dict_get (xdata, GLUSTERFS_ZERO_COPY_READ))
+                return posix_readv (frame, this, fd, size, offset, flags,
+                                    xdata);
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                op_errno = -ret;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL from fd=%p", fd);
+                goto err;
+        }
+
+        if (!size) {
+                op_errno = EINVAL;
+                gf_log (this->name, GF_LOG_WARNING, "size=%"GF_PRI_SIZET, size);
+                goto err;
+        }
+
+        iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
+        if (!iobuf) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        cb = posix_io_uring_cb_new (frame, fd, pfd, GF_FOP_READ, offset, size,
+                                    NULL);
+        if (!cb) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        cb->iobuf = iobuf;
+        iobuf = NULL;
+        cb->iov.iov_base = iobuf_ptr (cb->iobuf);
+        cb->iov.iov_len = size;
+
+        ret = posix_io_uring_submit (priv, cb, posix_io_uring_prep_readv,
+                                     NULL);
+        if (ret < 0) {
+                /* not queued, do it synchronously */
+                posix_io_uring_cb_destroy (cb);
+                return posix_readv (frame, this, fd, size, offset, flags,
+                                    xdata);
+        }
+
+        return 0;
+err:
+        STACK_UNWIND_STRICT (readv, frame, -1, op_errno, 0, 0, 0, 0, 0);
+        if (iobuf)
+                iobuf_unref (iobuf);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+int
+posix_io_uring_writev_complete (struct posix_io_uring_cb *cb, int res)
+{
+        call_frame_t          *frame     = NULL;
+        xlator_t              *this      = NULL;
+        struct iatt            postbuf   = {0,};
+        int                    op_ret    = -1;
+        int                    op_errno  = 0;
+        int                    ret       = 0;
+        dict_t                *rsp_xdata = NULL;
+        struct posix_private  *priv      = NULL;
+
+        frame = cb->frame;
+        this = frame->this;
+        priv = this->private;
+
+        if (res < 0) {
+                op_ret = -1;
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "writev(io_uring) failed fd=%d,offset=%llu (%d/%s)",
+                        cb->_fd, (unsigned long long) cb->offset, res,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &postbuf);
+        if (ret != 0) {
+                op_ret = -1;
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%d: %s", cb->_fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = res;
+        op_errno = 0;
+
+        rsp_xdata = _fill_writev_xdata (cb->fd, cb->xdata, this, 0);
+
+        LOCK (&priv->lock);
+        {
+                priv->write_value += op_ret;
+        }
+        UNLOCK (&priv->lock);
+
+out:
+        STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, &cb->prebuf,
+                             &postbuf, rsp_xdata);
+
+        if (rsp_xdata)
+                dict_unref (rsp_xdata);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+struct posix_io_uring_writev_args {
+        struct iovec   *vector;
+        int32_t         count;
+        int             rw_flags;
+};
+
+
+static void
+posix_io_uring_prep_writev (struct posix_private *priv,
+                            struct io_uring_sqe *sqe,
+                            struct posix_io_uring_cb *cb, void *data)
+{
+        struct posix_io_uring_writev_args *args = data;
+        int                                idx  = -1;
+
+        if (args->count == 1)
+                idx = posix_io_uring_fixed_index (priv,
+                                                  args->vector[0].iov_base,
+                                                  args->vector[0].iov_len);
+        if (idx >= 0)
+                io_uring_prep_write_fixed (sqe, cb->_fd,
+                                           args->vector[0].iov_base,
+                                           args->vector[0].iov_len,
+                                           cb->offset, idx);
+        else
+                io_uring_prep_writev (sqe, cb->_fd, args->vector, args->count,
+                                      cb->offset);
+
+        sqe->rw_flags = args->rw_flags;
+}
+
+
+int
+posix_io_uring_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       struct iovec *vector, int32_t count, off_t offset,
+                       uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+        int32_t                            op_errno = EINVAL;
+        struct posix_fd                   *pfd      = NULL;
+        int                                ret      = -1;
+        struct posix_io_uring_cb          *cb       = NULL;
+        struct posix_private              *priv     = NULL;
+        struct posix_io_uring_writev_args  args     = {0,};
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (vector, err);
+
+        priv = this->private;
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                op_errno = -ret;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL from fd=%p", fd);
+                goto err;
+        }
+
+        /* Appending writes need the pre-op stat and the write to be atomic
+           and O_DIRECT fds need aligned bounce buffers; both are handled by
+           the synchronous path. */
+        if ((xdata && dict_get (xdata, GLUSTERFS_WRITE_IS_APPEND)) ||
+            (pfd->flags & O_DIRECT))
+                return posix_writev (frame, this, fd, vector, count, offset,
+                                     flags, iobref, xdata);
+
+        if (flags & O_SYNC) {
+#ifdef RWF_SYNC
+                args.rw_flags = RWF_SYNC;
+#else
+                return posix_writev (frame, this, fd, vector, count, offset,
+                                     flags, iobref, xdata);
+#endif
+        } else if (flags & O_DSYNC) {
+#ifdef RWF_DSYNC
+                args.rw_flags = RWF_DSYNC;
+#else
+                return posix_writev (frame, this, fd, vector, count, offset,
+                                     flags, iobref, xdata);
+#endif
+        }
+
+        cb = posix_io_uring_cb_new (frame, fd, pfd, GF_FOP_WRITE, offset,
+                                    iov_length (vector, count), xdata);
+        if (!cb) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        cb->iobref = iobref_ref (iobref);
+
+        ret = posix_fdstat (this, cb->_fd, &cb->prebuf);
+        if (ret != 0) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%p: %s", fd,
+                        strerror (op_errno));
+                goto err;
+        }
+
+        args.vector = vector;
+        args.count = count;
+
+        ret = posix_io_uring_submit (priv, cb, posix_io_uring_prep_writev,
+                                     &args);
+        if (ret < 0) {
+                /* not queued, do it synchronously */
+                posix_io_uring_cb_destroy (cb);
+                return posix_writev (frame, this, fd, vector, count, offset,
+                                     flags, iobref, xdata);
+        }
+
+        return 0;
+err:
+        STACK_UNWIND_STRICT (writev, frame, -1, op_errno, 0, 0, 0);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+int
+posix_io_uring_fsync_complete (struct posix_io_uring_cb *cb, int res)
+{
+        call_frame_t  *frame    = NULL;
+        xlator_t      *this     = NULL;
+        struct iatt    postbuf  = {0,};
+        int            op_ret   = -1;
+        int            op_errno = 0;
+        int            ret      = 0;
+
+        frame = cb->frame;
+        this = frame->this;
+
+        if (res < 0) {
+                op_errno = -res;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fsync(io_uring) on fd=%d failed: %s", cb->_fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &postbuf);
+        if (ret != 0) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "post-operation fstat failed on fd=%d: %s", cb->_fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        STACK_UNWIND_STRICT (fsync, frame, op_ret, op_errno, &cb->prebuf,
+                             &postbuf, NULL);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+static void
+posix_io_uring_prep_fsync (struct posix_private *priv,
+                           struct io_uring_sqe *sqe,
+                           struct posix_io_uring_cb *cb, void *data)
+{
+        int datasync = *(int *)data;
+
+        io_uring_prep_fsync (sqe, cb->_fd,
+                             datasync ? IORING_FSYNC_DATASYNC : 0);
+}
+
+
+int32_t
+posix_io_uring_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      int32_t datasync, dict_t *xdata)
+{
+        int32_t                    op_errno = EINVAL;
+        struct posix_fd           *pfd      = NULL;
+        int                        ret      = -1;
+        struct posix_io_uring_cb  *cb       = NULL;
+        struct posix_private      *priv     = NULL;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+
+        priv = this->private;
+
+        /* batched fsyncs are owned by the fsyncer thread */
+        if (priv->batch_fsync_mode && xdata && dict_get (xdata, "batch-fsync"))
+                return posix_fsync (frame, this, fd, datasync, xdata);
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                op_errno = -ret;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd not found in fd's ctx");
+                goto err;
+        }
+
+        cb = posix_io_uring_cb_new (frame, fd, pfd, GF_FOP_FSYNC, 0, 0, NULL);
+        if (!cb) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &cb->prebuf);
+        if (ret != 0) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pre-operation fstat failed on fd=%p: %s", fd,
+                        strerror (op_errno));
+                goto err;
+        }
+
+        ret = posix_io_uring_submit (priv, cb, posix_io_uring_prep_fsync,
+                                     &datasync);
+        if (ret < 0) {
+                /* not queued, do it synchronously */
+                posix_io_uring_cb_destroy (cb);
+                return posix_fsync (frame, this, fd, datasync, xdata);
+        }
+
+        return 0;
+err:
+        STACK_UNWIND_STRICT (fsync, frame, -1, op_errno, NULL, NULL, NULL);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+int
+posix_io_uring_fallocate_complete (struct posix_io_uring_cb *cb, int res)
+{
+        call_frame_t  *frame    = NULL;
+        xlator_t      *this     = NULL;
+        struct iatt    postbuf  = {0,};
+        int            op_ret   = -1;
+        int            op_errno = 0;
+        int            ret      = 0;
+
+        frame = cb->frame;
+        this = frame->this;
+
+        if (res < 0) {
+                op_errno = -res;
+                goto out;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &postbuf);
+        if (ret != 0) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fallocate (fstat) failed on fd=%d: %s", cb->_fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        if (cb->op == GF_FOP_DISCARD)
+                STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno,
+                                     (op_ret == 0) ? &cb->prebuf : NULL,
+                                     (op_ret == 0) ? &postbuf : NULL, NULL);
+        else
+                STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno,
+                                     (op_ret == 0) ? &cb->prebuf : NULL,
+                                     (op_ret == 0) ? &postbuf : NULL, NULL);
+
+        posix_io_uring_cb_destroy (cb);
+
+        return 0;
+}
+
+
+static void
+posix_io_uring_prep_fallocate (struct posix_private *priv,
+                               struct io_uring_sqe *sqe,
+                               struct posix_io_uring_cb *cb, void *data)
+{
+        int mode = *(int *)data;
+
+        io_uring_prep_fallocate (sqe, cb->_fd, mode, cb->offset, cb->size);
+}
+
+
+static int32_t
+posix_io_uring_do_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                             int op, int mode, off_t offset, size_t len)
+{
+        struct posix_fd           *pfd      = NULL;
+        int                        ret      = -1;
+        struct posix_io_uring_cb  *cb       = NULL;
+        struct posix_private      *priv     = NULL;
+
+        priv = this->private;
+
+        ret = posix_fd_ctx_get (fd, this, &pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "pfd is NULL from fd=%p", fd);
+                goto out;
+        }
+
+        cb = posix_io_uring_cb_new (frame, fd, pfd, op, offset, len, NULL);
+        if (!cb) {
+                ret = -ENOMEM;
+                goto out;
+        }
+
+        ret = posix_fdstat (this, cb->_fd, &cb->prebuf);
+        if (ret == -1) {
+                ret = -errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fallocate (fstat) failed on fd=%p: %s", fd,
+                        strerror (errno));
+                goto out;
+        }
+
+        ret = posix_io_uring_submit (priv, cb, posix_io_uring_prep_fallocate,
+                                     &mode);
+        if (ret < 0) {
+                /* not queued, the caller does it synchronously */
+                ret = 1;
+                goto out;
+        }
+
+        return 0;
+out:
+        posix_io_uring_cb_destroy (cb);
+
+        return ret;
+}
+
+
+int32_t
+posix_io_uring_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          int32_t keep_size, off_t offset, size_t len,
+                          dict_t *xdata)
+{
+        int32_t ret  = 0;
+        int     mode = 0;
+
+        if (keep_size)
+                mode = FALLOC_FL_KEEP_SIZE;
+
+        ret = posix_io_uring_do_fallocate (frame, this, fd, GF_FOP_FALLOCATE,
+                                           mode, offset, len);
+        if (ret > 0)
+                return _posix_fallocate (frame, this, fd, keep_size, offset,
+                                         len, xdata);
+        if (ret < 0)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL,
+                                     NULL);
+        return 0;
+}
+
+
+int32_t
+posix_io_uring_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, size_t len, dict_t *xdata)
+{
+        int32_t ret  = 0;
+
+        ret = posix_io_uring_do_fallocate (frame, this, fd, GF_FOP_DISCARD,
+                                           FALLOC_FL_KEEP_SIZE |
+                                           FALLOC_FL_PUNCH_HOLE,
+                                           offset, len);
+        if (ret > 0)
+                return posix_discard (frame, this, fd, offset, len, xdata);
+        if (ret < 0)
+                STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL,
+                                     NULL);
+        return 0;
+}
+
+
+static void
+posix_io_uring_complete (xlator_t *this, struct posix_io_uring_cb *cb,
+                         int res)
+{
+        switch (cb->op) {
+        case GF_FOP_READ:
+                posix_io_uring_readv_complete (cb, res);
+                break;
+        case GF_FOP_WRITE:
+                posix_io_uring_writev_complete (cb, res);
+                break;
+        case GF_FOP_FSYNC:
+                posix_io_uring_fsync_complete (cb, res);
+                break;
+        case GF_FOP_FALLOCATE:
+        case GF_FOP_DISCARD:
+                posix_io_uring_fallocate_complete (cb, res);
+                break;
+        default:
+                gf_log (this->name, GF_LOG_ERROR,
+                        "unknown op %d found in io_uring cb", cb->op);
+                break;
+        }
+}
+
+
+void *
+posix_io_uring_thread (void *data)
+{
+        xlator_t              *this = NULL;
+        struct posix_private  *priv = NULL;
+        int                    ret  = 0;
+        unsigned               i    = 0;
+        unsigned               nr   = 0;
+        struct io_uring_cqe   *cqe  = NULL;
+        struct io_uring_cqe   *cqes[POSIX_IO_URING_MAX_NR_GETEVENTS];
+        struct posix_io_uring_cb *cb = NULL;
+        unsigned               done = 0;
+        gf_boolean_t           bye  = _gf_false;
+
+        this = data;
+        THIS = this;
+        priv = this->private;
+
+        while (!bye) {
+                ret = io_uring_wait_cqe (&priv->io_uring, &cqe);
+                if (ret < 0) {
+                        if (ret == -EINTR || ret == -EAGAIN)
+                                continue;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "io_uring_wait_cqe() returned %d", ret);
+                        break;
+                }
+
+                nr = io_uring_peek_batch_cqe (&priv->io_uring, cqes,
+                                              POSIX_IO_URING_MAX_NR_GETEVENTS);
+                done = 0;
+                for (i = 0; i < nr; i++) {
+                        /* the wake-up nop of posix_io_uring_fini() has none */
+                        cb = io_uring_cqe_get_data (cqes[i]);
+                        if (cb) {
+                                posix_io_uring_complete (this, cb,
+                                                         cqes[i]->res);
+                                done++;
+                        }
+                }
+
+                io_uring_cq_advance (&priv->io_uring, nr);
+
+                pthread_mutex_lock (&priv->io_uring_sq_lock);
+                {
+                        priv->io_uring_inflight -= done;
+
+                        /* push what a failed submit left queued, now that
+                           the CQ has room again */
+                        if (io_uring_sq_ready (&priv->io_uring))
+                                io_uring_submit (&priv->io_uring);
+
+                        bye = (priv->io_uring_stop &&
+                               !priv->io_uring_inflight);
+                }
+                pthread_mutex_unlock (&priv->io_uring_sq_lock);
+        }
+
+        return NULL;
+}
+
+
+static void
+posix_io_uring_register_iobufs (xlator_t *this)
+{
+        struct posix_private  *priv  = NULL;
+        struct iobuf          *iobuf = NULL;
+        struct iobuf_arena    *arena = NULL;
+        int                    i     = 0;
+        int                    j     = 0;
+        int                    nr    = 0;
+        int                    ret   = 0;
+
+        priv = this->private;
+
+        for (i = 0; i < sizeof (posix_io_uring_fixed_sizes) /
+                     sizeof (posix_io_uring_fixed_sizes[0]); i++) {
+                if (nr == POSIX_IO_URING_MAX_FIXED)
+                        break;
+
+                /* holding one iobuf keeps the arena active, so it is
+                   never munmap()ed while the kernel has it pinned */
+                iobuf = iobuf_get2 (this->ctx->iobuf_pool,
+                                    posix_io_uring_fixed_sizes[i]);
+                if (!iobuf)
+                        continue;
+
+                arena = iobuf->iobuf_arena;
+                if (!arena || !arena->mem_base) {
+                        iobuf_unref (iobuf);
+                        continue;
+                }
+
+                for (j = 0; j < nr; j++) {
+                        if (priv->io_uring_fixed[j].iov_base ==
+                            arena->mem_base)
+                                break;
+                }
+                if (j < nr) {
+                        iobuf_unref (iobuf);
+                        continue;
+                }
+
+                priv->io_uring_pins[nr] = iobuf;
+                priv->io_uring_fixed[nr].iov_base = arena->mem_base;
+                priv->io_uring_fixed[nr].iov_len = arena->arena_size;
+                nr++;
+        }
+
+        if (!nr)
+                return;
+
+        ret = io_uring_register_buffers (&priv->io_uring,
+                                         priv->io_uring_fixed, nr);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "registering iobuf arenas with io_uring failed (%s),"
+                        " continuing without fixed buffers", strerror (-ret));
+                for (i = 0; i < nr; i++) {
+                        iobuf_unref (priv->io_uring_pins[i]);
+                        priv->io_uring_pins[i] = NULL;
+                }
+                return;
+        }
+
+        priv->io_uring_nr_fixed = nr;
+}
+
+
+static void
+posix_io_uring_set_fops (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        this->fops->readv  = posix_io_uring_readv;
+        this->fops->writev = posix_io_uring_writev;
+        this->fops->fsync  = posix_io_uring_fsync;
+        if (priv->io_uring_fallocate) {
+                this->fops->fallocate = posix_io_uring_fallocate;
+                this->fops->discard   = posix_io_uring_discard;
+        }
+}
+
+
+int
+posix_io_uring_init (xlator_t *this)
+{
+        struct posix_private  *priv   = NULL;
+        struct io_uring_probe *probe  = NULL;
+        struct io_uring_params params = {0,};
+        int                    ret    = 0;
+
+        priv = this->private;
+
+        if (priv->io_uring_sqpoll) {
+                params.flags |= IORING_SETUP_SQPOLL;
+                params.sq_thread_idle = POSIX_IO_URING_SQPOLL_IDLE;
+        }
+
+        ret = io_uring_queue_init_params (POSIX_IO_URING_NR_ENTRIES,
+                                          &priv->io_uring, &params);
+        if (ret == -ENOSYS) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_uring not available at run-time."
+                        " Continuing with synchronous IO");
+                ret = -1;
+                goto out;
+        }
+
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "io_uring_queue_init() failed (%s)", strerror (-ret));
+                ret = -1;
+                goto out;
+        }
+
+        probe = io_uring_get_probe_ring (&priv->io_uring);
+        if (probe) {
+                priv->io_uring_fallocate =
+                        io_uring_opcode_supported (probe,
+                                                   IORING_OP_FALLOCATE);
+                io_uring_free_probe (probe);
+        }
+
+        priv->io_uring_stop = _gf_false;
+        priv->io_uring_inflight = 0;
+
+        posix_io_uring_register_iobufs (this);
+
+        ret = gf_thread_create (&priv->io_uring_thread, NULL,
+                                posix_io_uring_thread, this);
+        if (ret != 0) {
+                io_uring_queue_exit (&priv->io_uring);
+                goto out;
+        }
+
+        gf_log (this->name, GF_LOG_INFO, "io_uring enabled (sqpoll: %s, "
+                "fixed buffers: %d, fallocate: %s)",
+                priv->io_uring_sqpoll ? "on" : "off",
+                priv->io_uring_nr_fixed,
+                priv->io_uring_fallocate ? "async" : "sync");
+out:
+        return ret;
+}
+
+
+int
+posix_io_uring_on (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   ret = 0;
+
+        priv = this->private;
+
+        if (!priv->io_uring_init_done) {
+                ret = posix_io_uring_init (this);
+                if (ret == 0)
+                        priv->io_uring_capable = _gf_true;
+                else
+                        priv->io_uring_capable = _gf_false;
+                priv->io_uring_init_done = _gf_true;
+        }
+
+        /* not being able to use io_uring is not fatal */
+        ret = 0;
+
+        if (priv->io_uring_capable)
+                posix_io_uring_set_fops (this);
+
+        return ret;
+}
+
+
+/*
+ * Stop the completion thread once every queued request has completed and
+ * tear the ring down. Fops still racing in see io_uring_stop and go
+ * synchronous. The engine is set up afresh if turned on again.
+ */
+void
+posix_io_uring_fini (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        struct io_uring_sqe  *sqe  = NULL;
+        int                   i    = 0;
+
+        priv = this->private;
+
+        if (!priv->io_uring_init_done || !priv->io_uring_capable)
+                goto out;
+
+        pthread_mutex_lock (&priv->io_uring_sq_lock);
+        {
+                priv->io_uring_stop = _gf_true;
+
+                /* wake the thread up in case nothing is in flight */
+                sqe = io_uring_get_sqe (&priv->io_uring);
+                if (sqe) {
+                        io_uring_prep_nop (sqe);
+                        io_uring_sqe_set_data (sqe, NULL);
+                }
+                io_uring_submit (&priv->io_uring);
+        }
+        pthread_mutex_unlock (&priv->io_uring_sq_lock);
+
+        pthread_join (priv->io_uring_thread, NULL);
+
+        if (priv->io_uring_nr_fixed) {
+                io_uring_unregister_buffers (&priv->io_uring);
+                for (i = 0; i < priv->io_uring_nr_fixed; i++) {
+                        iobuf_unref (priv->io_uring_pins[i]);
+                        priv->io_uring_pins[i] = NULL;
+                }
+                priv->io_uring_nr_fixed = 0;
+        }
+
+        io_uring_queue_exit (&priv->io_uring);
+
+        gf_log (this->name, GF_LOG_INFO, "io_uring disabled");
+out:
+        priv->io_uring_capable = _gf_false;
+        priv->io_uring_init_done = _gf_false;
+}
+
+
+int
+posix_io_uring_off (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        this->fops->readv     = posix_readv;
+        this->fops->writev    = posix_writev;
+        this->fops->fsync     = posix_fsync;
+        this->fops->fallocate = _posix_fallocate;
+        this->fops->discard   = posix_discard;
+
+        /* hand readv/writev back to linux-aio if that is enabled */
+        if (priv->aio_configured && priv->aio_capable)
+                posix_aio_on (this);
+
+        posix_io_uring_fini (this);
+
+        return 0;
+}
+
+
+#else
+
+
+int
+posix_io_uring_on (xlator_t *this)
+{
+        gf_log (this->name, GF_LOG_INFO,
+                "io_uring not available at build-time."
+                " Continuing with synchronous IO");
+        return 0;
+}
+
+int
+posix_io_uring_off (xlator_t *this)
+{
+        return 0;
+}
+
+void
+posix_io_uring_fini (xlator_t *this)
+{
+}
+#endif
@@ -0,0 +1,49 @@
+/*
+   Copyright (c) 2015 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _POSIX_IO_URING_H
+#define _POSIX_IO_URING_H
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include "xlator.h"
+#include "glusterfs.h"
+
+// Number of submission queue entries. Completion queue is sized twice
+// this by the kernel.
+#define POSIX_IO_URING_NR_ENTRIES 256
+
+// Maximum number of completions reaped per pass of the completion thread
+#define POSIX_IO_URING_MAX_NR_GETEVENTS 32
+
+// Maximum number of iobuf arenas registered as fixed buffers
+#define POSIX_IO_URING_MAX_FIXED 8
+
+// Idle time (msecs) after which the kernel SQ polling thread sleeps
+#define POSIX_IO_URING_SQPOLL_IDLE 1000
+
+
+int posix_io_uring_on (xlator_t *this);
+int posix_io_uring_off (xlator_t *this);
+void posix_io_uring_fini (xlator_t *this);
+
+int32_t posix_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t datasync, dict_t *xdata);
+
+int32_t _posix_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          int32_t keep_size, off_t offset, size_t len,
+                          dict_t *xdata);
+
+int32_t posix_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       off_t offset, size_t len, dict_t *xdata);
+
+#endif /* !_POSIX_IO_URING_H */
@@ -21,6 +21,11 @@ enum gf_posix_mem_types_ {
         gf_posix_mt_posix_dev_t,
         gf_posix_mt_trash_path,
 	gf_posix_mt_paiocb,
+        gf_posix_mt_io_uring_cb,
+        gf_posix_mt_hcache_table,
+        gf_posix_mt_hcache_entry,
+        gf_posix_mt_hcache_handle,
+        gf_posix_mt_fsync_group,
         gf_posix_mt_end
 };
 #endif
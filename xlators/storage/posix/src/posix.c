@@ -52,6 +52,7 @@
 #include "glusterfs3-xdr.h"
 #include "hashfn.h"
 #include "posix-aio.h"
+#include "posix-io-uring.h"
 #include "glusterfs-acl.h"
 
 extern char *marker_xattrs[];
@@ -86,9 +87,137 @@ posix_forget (xlator_t *this, inode_t *inode)
         if (!inode_ctx_del (inode, this, &tmp_cache))
                 dict_destroy ((dict_t *)(long)tmp_cache);
 
+        if (IA_ISDIR (inode->ia_type))
+                posix_hcache_invalidate (this, inode->gfid);
+
         return 0;
 }
 
+/* puts the access ACL of @path, if it has one, in @xattr for the @index-th
+   entry of a GF_LOOKUP_PATH reply */
+static int
+posix_lookup_path_acl (xlator_t *this, const char *path, int index,
+                       dict_t *xattr)
+{
+        char     key[64] = {0,};
+        char    *value   = NULL;
+        ssize_t  size    = 0;
+        int      ret     = -1;
+
+        size = sys_lgetxattr (path, POSIX_ACL_ACCESS_XATTR, NULL, 0);
+        if (size < 0) {
+                if (errno == ENOATTR || errno == ENOTSUP)
+                        return 0;
+                return -1;
+        }
+
+        value = GF_CALLOC (1, size, gf_posix_mt_char);
+        if (!value)
+                return -1;
+
+        size = sys_lgetxattr (path, POSIX_ACL_ACCESS_XATTR, value, size);
+        if (size < 0)
+                goto out;
+
+        snprintf (key, sizeof (key), "%s.%d", GF_LOOKUP_PATH_ACL, index);
+        ret = dict_set_bin (xattr, key, value, size);
+        if (!ret)
+                value = NULL;
+out:
+        GF_FREE (value);
+        return ret;
+}
+
+/* resolves the path requested with GF_LOOKUP_PATH below the directory
+   just looked up, stopping at the first component missing or not a
+   directory. Each entry must be the one its gfid handle points to.
+   Whether the caller may search the directories is left to
+   access-control, which gets their access ACLs if it asked for the one
+   of the directory looked up. */
+static void
+posix_lookup_path (call_frame_t *frame, xlator_t *this, char *real_path,
+                   struct iatt *buf, dict_t *xdata, dict_t **xattr)
+{
+        char                        *rest      = NULL;
+        char                        *dup       = NULL;
+        char                        *component = NULL;
+        char                        *saveptr   = NULL;
+        char                        *hpath     = NULL;
+        char                         path[PATH_MAX] = {0,};
+        struct iatt                  stbuf     = {0,};
+        struct stat                  lstatbuf  = {0,};
+        struct stat                  hstatbuf  = {0,};
+        struct gf_lookup_path_entry *entries   = NULL;
+        gf_boolean_t                 acls      = _gf_false;
+        int                          count     = 0;
+        int                          ret       = -1;
+
+        if (dict_get_str (xdata, GF_LOOKUP_PATH, &rest) || !rest)
+                return;
+
+        if (!IA_ISDIR (buf->ia_type) || strlen (real_path) >= sizeof (path))
+                return;
+
+        acls = (dict_get (xdata, POSIX_ACL_ACCESS_XATTR) != NULL);
+
+        if (!*xattr)
+                *xattr = get_new_dict ();
+        dup = gf_strdup (rest);
+        entries = GF_CALLOC (GF_LOOKUP_PATH_MAX_DEPTH, sizeof (*entries),
+                             gf_common_mt_char);
+        if (!*xattr || !dup || !entries)
+                goto out;
+
+        strcpy (path, real_path);
+        stbuf = *buf;
+
+        for (component = strtok_r (dup, "/", &saveptr);
+             component && count < GF_LOOKUP_PATH_MAX_DEPTH;
+             component = strtok_r (NULL, "/", &saveptr)) {
+                if (!strcmp (component, ".") || !strcmp (component, "..") ||
+                    !strcmp (component, GF_HIDDEN_PATH))
+                        break;
+
+                if (strlen (path) + strlen (component) + 2 > sizeof (path))
+                        break;
+
+                strcat (path, "/");
+                strcat (path, component);
+
+                ret = posix_pstat (this, NULL, path, &stbuf);
+                if (ret || uuid_is_null (stbuf.ia_gfid) ||
+                    !IA_ISDIR (stbuf.ia_type))
+                        break;
+
+                MAKE_HANDLE_ABSPATH (hpath, this, stbuf.ia_gfid);
+                if (sys_lstat (path, &lstatbuf) ||
+                    sys_stat (hpath, &hstatbuf) ||
+                    (lstatbuf.st_ino != hstatbuf.st_ino) ||
+                    (lstatbuf.st_dev != hstatbuf.st_dev)) {
+                        gf_log (this->name, GF_LOG_DEBUG, "%s does not match "
+                                "its gfid handle %s", path, hpath);
+                        break;
+                }
+
+                if (acls && posix_lookup_path_acl (this, path, count, *xattr))
+                        break;
+
+                gf_lookup_path_entry_from_iatt (&entries[count], &stbuf);
+                count++;
+        }
+
+        if (!count)
+                goto out;
+
+        ret = dict_set_bin (*xattr, GF_LOOKUP_PATH, entries,
+                            count * sizeof (*entries));
+        if (!ret)
+                entries = NULL;
+out:
+        GF_FREE (entries);
+        GF_FREE (dup);
+}
+
 /* Regular fops */
 
 int32_t
@@ -154,9 +283,13 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
 
         if (xdata && (op_ret == 0)) {
                 xattr = posix_lookup_xattr_fill (this, real_path, loc,
-                                                 xdata, &buf);
+                                                 xdata, &buf, GF_FOP_LOOKUP);
         }
 
+        if (xdata && (op_ret == 0) && dict_get (xdata, GF_LOOKUP_PATH))
+                posix_lookup_path (frame, this, real_path, &buf, xdata,
+                                   &xattr);
+
 parent:
         if (par_path) {
                 op_ret = posix_pstat (this, loc->pargfid, par_path, &postparent);
@@ -791,7 +924,7 @@ out:
         return ret;
 }
 
-static int32_t
+int32_t
 _posix_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t keep_size,
 		off_t offset, size_t len, dict_t *xdata)
 {
@@ -821,7 +954,7 @@ err:
 	return 0;
 }
 
-static int32_t
+int32_t
 posix_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
 	      size_t len, dict_t *xdata)
 {
@@ -2427,6 +2560,69 @@ out:
         return 0;
 }
 
+/*
+ * Reply to a readv with a segment of the backend fd instead of the data;
+ * the transport sends it from the page cache. Only the size of the segment
+ * is needed here, so the file is not read at all.
+ */
+static void
+posix_readv_zero_copy (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       struct posix_fd *pfd, size_t size, off_t offset)
+{
+        int32_t                op_ret   = -1;
+        int32_t                op_errno = 0;
+        struct posix_private  *priv     = NULL;
+        struct iobref         *iobref   = NULL;
+        struct iatt            stbuf    = {0,};
+        size_t                 len      = 0;
+
+        priv = this->private;
+
+        op_ret = posix_fdstat (this, pfd->fd, &stbuf);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fstat failed on fd=%p: %s", fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        if (offset < stbuf.ia_size)
+                len = min (size, stbuf.ia_size - offset);
+
+        iobref = iobref_new ();
+        if (!iobref) {
+                op_ret = -1;
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        if (len && iobref_set_fdseg (iobref, pfd->fd, offset, len) < 0) {
+                op_ret = -1;
+                op_errno = errno ? errno : ENOMEM;
+                goto out;
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->read_value    += len;
+        }
+        UNLOCK (&priv->lock);
+
+        /* Hack to notify higher layers of EOF. */
+        if (!stbuf.ia_size || (offset + len) >= stbuf.ia_size)
+                op_errno = ENOENT;
+
+        op_ret = len;
+out:
+        STACK_UNWIND_STRICT (readv, frame, op_ret, op_errno,
+                             NULL, 0, &stbuf, iobref, NULL);
+
+        if (iobref)
+                iobref_unref (iobref);
+}
+
+
 int
 posix_readv (call_frame_t *frame, xlator_t *this,
              fd_t *fd, size_t size, off_t offset, uint32_t flags, dict_t *xdata)
@@ -2464,6 +2660,11 @@ posix_readv (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (xdata && dict_get (xdata, GLUSTERFS_ZERO_COPY_READ)) {
+                posix_readv_zero_copy (frame, this, fd, pfd, size, offset);
+                return 0;
+        }
+
         iobuf = iobuf_get2 (this->ctx->iobuf_pool, size);
         if (!iobuf) {
                 op_errno = ENOMEM;
@@ -2658,6 +2859,7 @@ posix_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
         struct iatt            postop    = {0,};
         int                      ret      = -1;
         dict_t                *rsp_xdata = NULL;
+        dict_t                *xattrop_xdata = NULL;
 	int                    is_append = 0;
 	gf_boolean_t           locked = _gf_false;
 
@@ -2681,6 +2883,16 @@ posix_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         _fd = pfd->fd;
 
+        if (xdata) {
+                ret = posix_write_xattrop (this, fd, _fd, xdata,
+                                           &xattrop_xdata);
+                if (ret < 0) {
+                        op_ret = -1;
+                        op_errno = -ret;
+                        goto out;
+                }
+        }
+
 	if (xdata && dict_get (xdata, GLUSTERFS_WRITE_IS_APPEND)) {
 		/* The write_is_append check and write must happen
 		   atomically. Else another write can overtake this
@@ -2730,6 +2942,14 @@ posix_writev (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         if (op_ret >= 0) {
                 rsp_xdata = _fill_writev_xdata (fd, xdata, this, is_append);
+                if (xattrop_xdata) {
+                        if (rsp_xdata) {
+                                dict_copy (xattrop_xdata, rsp_xdata);
+                        } else {
+                                rsp_xdata = xattrop_xdata;
+                                xattrop_xdata = NULL;
+                        }
+                }
                 /* wiretv successful, we also need to get the stat of
                  * the file we wrote to
                  */
@@ -2764,11 +2984,19 @@ out:
 		locked = _gf_false;
 	}
 
+        /* the deltas are on disk even though the write failed */
+        if (xattrop_xdata && !rsp_xdata) {
+                rsp_xdata = xattrop_xdata;
+                xattrop_xdata = NULL;
+        }
+
         STACK_UNWIND_STRICT (writev, frame, op_ret, op_errno, &preop, &postop,
                              rsp_xdata);
 
         if (rsp_xdata)
                 dict_unref (rsp_xdata);
+        if (xattrop_xdata)
+                dict_unref (xattrop_xdata);
         return 0;
 }
 
@@ -3239,7 +3467,8 @@ posix_links_in_same_directory (char *dirpath, int count, inode_t *leaf_inode,
                                 = posix_lookup_xattr_fill (this,
                                                            temppath,
                                                            &loc, xdata,
-                                                           NULL);
+                                                           NULL,
+                                                           GF_FOP_GETXATTR);
                         list_add_tail (&gf_entry->list, &head->list);
                         loc_wipe (&loc);
                 }
@@ -4325,6 +4554,24 @@ __add_long_array (int64_t *dest, int64_t *src, int count)
         }
 }
 
+static void
+__or_array (char *dest, char *src, int count)
+{
+        int i = 0;
+        for (i = 0; i < count; i++) {
+                dest[i] |= src[i];
+        }
+}
+
+static void
+__and_array (char *dest, char *src, int count)
+{
+        int i = 0;
+        for (i = 0; i < count; i++) {
+                dest[i] &= src[i];
+        }
+}
+
 static int
 _posix_handle_xattr_keyvalue_pair (dict_t *d, char *k, data_t *v,
                                    void *tmp)
@@ -4408,6 +4655,14 @@ _posix_handle_xattr_keyvalue_pair (dict_t *d, char *k, data_t *v,
                                           v->len / 8);
                         break;
 
+                case GF_XATTROP_OR_ARRAY:
+                        __or_array (array, v->data, v->len);
+                        break;
+
+                case GF_XATTROP_AND_ARRAY:
+                        __and_array (array, v->data, v->len);
+                        break;
+
                 default:
                         gf_log (this->name, GF_LOG_ERROR,
                                 "Unknown xattrop type (%d) on %s. Please send "
@@ -4472,6 +4727,8 @@ unlock:
         array = NULL;
 
 out:
+        if (op_ret == -1)
+                filler->op_errno = op_errno;
         return op_ret;
 }
 
@@ -4480,6 +4737,10 @@ out:
  * @optype: ADD_ARRAY:
  *            dict should contain:
  *               "key" ==> array of 32-bit numbers
+ *          OR_ARRAY, AND_ARRAY:
+ *            dict should contain:
+ *               "key" ==> array of bytes, combined bitwise with the
+ *                         current value (missing value reads as zeroes)
  */
 
 int
@@ -4527,6 +4788,8 @@ do_xattrop (call_frame_t *frame, xlator_t *this, loc_t *loc, fd_t *fd,
 
         op_ret = dict_foreach (xattr, _posix_handle_xattr_keyvalue_pair,
                                &filler);
+        if (op_ret < 0)
+                op_errno = filler.op_errno;
 
 out:
 
@@ -4535,6 +4798,75 @@ out:
 }
 
 
+/* The GF_XATTROP_ADD_ARRAY deltas sent along with a writev (AFR's pre-op
+   riding on the write) are applied before the write, so that the data is
+   never on disk without them. The resulting values are put in @rsp_xdata,
+   which tells the sender they were applied.
+*/
+int
+posix_write_xattrop (xlator_t *this, fd_t *fd, int _fd, dict_t *xdata,
+                     dict_t **rsp_xdata)
+{
+        int                   ret     = -1;
+        data_t               *data    = NULL;
+        dict_t               *xattr   = NULL;
+        char                 *buf     = NULL;
+        u_int                 len     = 0;
+        posix_xattr_filler_t  filler  = {0,};
+
+        data = dict_get (xdata, GLUSTERFS_WRITE_XATTROP);
+        if (!data)
+                return 0;
+
+        xattr = dict_new ();
+        if (!xattr)
+                return -ENOMEM;
+
+        ret = dict_unserialize (data->data, data->len, &xattr);
+        if (ret) {
+                gf_log (this->name, GF_LOG_WARNING, "%s: invalid %s",
+                        uuid_utoa (fd->inode->gfid), GLUSTERFS_WRITE_XATTROP);
+                ret = -EINVAL;
+                goto out;
+        }
+
+        filler.this = this;
+        filler.fd = _fd;
+        filler.flags = (int)GF_XATTROP_ADD_ARRAY;
+        filler.inode = fd->inode;
+
+        ret = dict_foreach (xattr, _posix_handle_xattr_keyvalue_pair,
+                            &filler);
+        if (ret < 0) {
+                ret = -(filler.op_errno ? filler.op_errno : EIO);
+                goto out;
+        }
+
+        ret = dict_allocate_and_serialize (xattr, &buf, &len);
+        if (ret) {
+                ret = -ENOMEM;
+                goto out;
+        }
+
+        if (!*rsp_xdata)
+                *rsp_xdata = dict_new ();
+        if (!*rsp_xdata) {
+                GF_FREE (buf);
+                ret = -ENOMEM;
+                goto out;
+        }
+
+        ret = dict_set_bin (*rsp_xdata, GLUSTERFS_WRITE_XATTROP, buf, len);
+        if (ret) {
+                GF_FREE (buf);
+                ret = -ENOMEM;
+        }
+out:
+        dict_unref (xattr);
+        return ret;
+}
+
+
 int
 posix_xattrop (call_frame_t *frame, xlator_t *this,
                loc_t *loc, gf_xattrop_flags_t optype, dict_t *xattr, dict_t *xdata)
@@ -4917,7 +5249,8 @@ posix_entry_xattr_fill (xlator_t *this, inode_t *inode,
         MAKE_HANDLE_PATH (entry_path, this, fd->inode->gfid, name);
 
         return posix_lookup_xattr_fill (this, entry_path,
-                                        &tmp_loc, dict, stbuf);
+                                        &tmp_loc, dict, stbuf,
+                                        GF_FOP_READDIRP);
 
 }
 
@@ -5109,6 +5442,8 @@ posix_priv (xlator_t *this)
 {
         struct posix_private *priv = NULL;
         char  key_prefix[GF_DUMP_MAX_BUF_LEN];
+        char  key[GF_DUMP_MAX_BUF_LEN];
+        int   i = 0;
 
         snprintf(key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s", this->type,
                  this->name);
@@ -5128,6 +5463,53 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write("max_write","%d", priv->write_value);
         gf_proc_dump_write("nr_files","%ld", priv->nr_files);
 
+        if (priv->hcache_table) {
+                pthread_mutex_lock (&priv->hcache_lock);
+                {
+                        gf_proc_dump_write ("handle_cache_size", "%u",
+                                            priv->hcache_size);
+                        gf_proc_dump_write ("handle_cache_fds", "%u",
+                                            priv->hcache_nr_fds);
+                        gf_proc_dump_write ("handle_cache_handles", "%u",
+                                            priv->hcache_nr_handles);
+                        gf_proc_dump_write ("handle_cache_hits", "%"PRIu64,
+                                            priv->hcache_hits);
+                        gf_proc_dump_write ("handle_cache_misses", "%"PRIu64,
+                                            priv->hcache_misses);
+                        gf_proc_dump_write ("handle_cache_reopens", "%"PRIu64,
+                                            priv->hcache_reopens);
+                }
+                pthread_mutex_unlock (&priv->hcache_lock);
+        }
+
+        if (priv->batch_fsync_mode == BATCH_GROUP_COMMIT) {
+                pthread_mutex_lock (&priv->fsync_mutex);
+                {
+                        gf_proc_dump_write ("fsync_latency_usec", "%"PRIu64,
+                                            priv->fsync_latency_usec);
+                        gf_proc_dump_write ("fsync_flushes", "%"PRIu64,
+                                            priv->fsync_flushes);
+                        gf_proc_dump_write ("fsync_waiters", "%"PRIu64,
+                                            priv->fsync_waiters);
+                }
+                pthread_mutex_unlock (&priv->fsync_mutex);
+        }
+
+        LOCK (&priv->lock);
+        {
+                for (i = 0; i < GF_FOP_MAXVALUE; i++) {
+                        if (!priv->xattr_syscalls[i] &&
+                            !priv->xattr_avoided[i])
+                                continue;
+                        gf_proc_dump_build_key (key, "xattr_syscalls", "%s",
+                                                gf_fop_list[i]);
+                        gf_proc_dump_write (key, "%"PRIu64" (avoided %"PRIu64
+                                            ")", priv->xattr_syscalls[i],
+                                            priv->xattr_avoided[i]);
+                }
+        }
+        UNLOCK (&priv->lock);
+
         return 0;
 }
 
@@ -5297,6 +5679,8 @@ set_batch_fsync_mode (struct posix_private *priv, const char *str)
 		priv->batch_fsync_mode = BATCH_SYNCFS_REVERSE_FSYNC;
 	else if (strcmp (str, "reverse-fsync") == 0)
 		priv->batch_fsync_mode = BATCH_REVERSE_FSYNC;
+	else if (strcmp (str, "group-commit") == 0)
+		priv->batch_fsync_mode = BATCH_GROUP_COMMIT;
 	else
 		return -1;
 
@@ -5372,6 +5756,14 @@ reconfigure (xlator_t *this, dict_t *options)
 	else
 		posix_aio_off (this);
 
+	GF_OPTION_RECONF ("io-uring", priv->io_uring_configured,
+			  options, bool, out);
+
+	if (priv->io_uring_configured)
+		posix_io_uring_on (this);
+	else
+		posix_io_uring_off (this);
+
         GF_OPTION_RECONF ("update-link-count-parent", priv->update_pgfid_nlinks,
                           options, bool, out);
 
@@ -5389,6 +5781,15 @@ reconfigure (xlator_t *this, dict_t *options)
                           options, uint32, out);
         posix_spawn_health_check_thread (this);
 
+        GF_OPTION_RECONF ("handle-cache-open-by-handle",
+                          priv->hcache_by_handle, options, bool, out);
+
+        if (priv->hcache_table) {
+                GF_OPTION_RECONF ("handle-cache-size", priv->hcache_size,
+                                  options, uint32, out);
+                posix_hcache_shrink (this);
+        }
+
 	ret = 0;
 out:
 	return ret;
@@ -5752,6 +6153,11 @@ init (xlator_t *this)
 
 	_private->aio_init_done = _gf_false;
 	_private->aio_capable = _gf_false;
+	_private->io_uring_init_done = _gf_false;
+	_private->io_uring_capable = _gf_false;
+#ifdef HAVE_LIBURING
+        pthread_mutex_init (&_private->io_uring_sq_lock, NULL);
+#endif
 
         GF_OPTION_INIT ("brick-uid", uid, int32, out);
         GF_OPTION_INIT ("brick-gid", gid, int32, out);
@@ -5771,6 +6177,22 @@ init (xlator_t *this)
 		}
 	}
 
+	GF_OPTION_INIT ("io-uring-sqpoll", _private->io_uring_sqpoll,
+			bool, out);
+
+	GF_OPTION_INIT ("io-uring", _private->io_uring_configured, bool, out);
+
+	if (_private->io_uring_configured) {
+		op_ret = posix_io_uring_on (this);
+
+		if (op_ret == -1) {
+			gf_log (this->name, GF_LOG_ERROR,
+				"Posix io_uring init failed");
+			ret = -1;
+			goto out;
+		}
+	}
+
         GF_OPTION_INIT ("node-uuid-pathinfo",
                         _private->node_uuid_pathinfo, bool, out);
         if (_private->node_uuid_pathinfo &&
@@ -5786,6 +6208,22 @@ init (xlator_t *this)
         if (_private->health_check_interval)
                 posix_spawn_health_check_thread (this);
 
+        GF_OPTION_INIT ("handle-cache-size", _private->hcache_size,
+                        uint32, out);
+        GF_OPTION_INIT ("handle-cache-open-by-handle",
+                        _private->hcache_by_handle, bool, out);
+
+        /* gfids of entries are read through /proc/self/fd/<dirfd>/<name> */
+        if (access ("/proc/self/fd", X_OK) != 0) {
+                if (_private->hcache_size)
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "/proc/self/fd not accessible, disabling "
+                                "handle-cache");
+                _private->hcache_size = 0;
+        } else if (posix_hcache_init (this) != 0) {
+                _private->hcache_size = 0;
+        }
+
         pthread_mutex_init (&_private->janitor_lock, NULL);
         pthread_cond_init (&_private->janitor_cond, NULL);
         INIT_LIST_HEAD (&_private->janitor_fds);
@@ -5839,8 +6277,10 @@ fini (xlator_t *this)
         struct posix_private *priv = this->private;
         if (!priv)
                 return;
+        posix_io_uring_fini (this);
         this->private = NULL;
         /*unlock brick dir*/
+        posix_hcache_fini (this);
         if (priv->mount_lock)
                 closedir (priv->mount_lock);
         GF_FREE (priv);
@@ -5930,6 +6370,22 @@ struct volume_options options[] = {
 	  .default_value = "off",
           .description = "Support for native Linux AIO"
 	},
+	{
+	  .key  = {"io-uring"},
+	  .type = GF_OPTION_TYPE_BOOL,
+	  .default_value = "off",
+          .description = "Submit readv, writev, fsync, fallocate and discard "
+                         "asynchronously through io_uring. Takes precedence "
+                         "over linux-aio when both are enabled"
+	},
+	{
+	  .key  = {"io-uring-sqpoll"},
+	  .type = GF_OPTION_TYPE_BOOL,
+	  .default_value = "off",
+          .description = "Let a kernel thread poll the io_uring submission "
+                         "queue so that batches of requests are submitted "
+                         "without a syscall. Takes effect on brick restart"
+	},
         {
           .key = {"brick-uid"},
           .type = GF_OPTION_TYPE_INT,
@@ -5961,6 +6417,24 @@ struct volume_options options[] = {
           .description = "Interval in seconds for a filesystem health check, "
                          "set to 0 to disable"
         },
+        { .key = {"handle-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 65536,
+          .default_value = "0",
+          .validate = GF_OPT_VALIDATE_BOTH,
+          .description = "Number of directory handles kept open (O_PATH) "
+                         "to resolve gfids with *at() syscalls instead of "
+                         "walking the .glusterfs symlink tree. 0 disables "
+                         "the cache"
+        },
+        { .key = {"handle-cache-open-by-handle"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Keep the kernel file handle of directories evicted "
+                         "from the handle cache and reopen them with "
+                         "open_by_handle_at(). Needs CAP_DAC_READ_SEARCH"
+        },
 	{ .key = {"batch-fsync-mode"},
 	  .type = GF_OPTION_TYPE_STR,
 	  .default_value = "reverse-fsync",
@@ -5973,13 +6447,17 @@ struct volume_options options[] = {
 	  " of fsyncs and fsync() each file in the batch in reverse order.\n"
 	  " in reverse order.\n"
 	  "\t- reverse-fsync: Perform fsync() of each file in the batch in"
-	  " reverse order."
+	  " reverse order.\n"
+	  "\t- group-commit: Hold the batch open for a window derived from"
+	  " the observed fsync latency, then flush each file in the batch once"
+	  " and complete all its waiters."
 	},
 	{ .key = {"batch-fsync-delay-usec"},
 	  .type = GF_OPTION_TYPE_INT,
 	  .default_value = "0",
 	  .description = "Num of usecs to wait for aggregating fsync"
-	  " requests",
+	  " requests. With group-commit, the upper bound of the adaptive"
+	  " window.",
 	},
         { .key = {"update-link-count-parent"},
           .type = GF_OPTION_TYPE_BOOL,
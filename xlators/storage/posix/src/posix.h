@@ -50,6 +50,11 @@
 #include "posix-aio.h"
 #endif
 
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include "posix-io-uring.h"
+#endif
+
 #define VECTOR_SIZE 64 * 1024 /* vector size 64KB*/
 #define MAX_NO_VECT 1024
 
@@ -136,6 +141,24 @@ struct posix_private {
         pthread_t       aiothread;
 #endif
 
+	gf_boolean_t    io_uring_configured;
+	gf_boolean_t    io_uring_sqpoll;
+	gf_boolean_t    io_uring_init_done;
+	gf_boolean_t    io_uring_capable;
+#ifdef HAVE_LIBURING
+        struct io_uring io_uring;
+        pthread_t       io_uring_thread;
+        pthread_mutex_t io_uring_sq_lock; /* serialises SQ producers */
+        gf_boolean_t    io_uring_stop;    /* no more submissions */
+        uint64_t        io_uring_inflight; /* queued, not yet reaped */
+        gf_boolean_t    io_uring_fallocate; /* kernel has OP_FALLOCATE */
+        /* iobufs pinning the arenas registered as fixed buffers, so
+           that the arenas are never pruned while registered */
+        struct iobuf   *io_uring_pins[POSIX_IO_URING_MAX_FIXED];
+        struct iovec    io_uring_fixed[POSIX_IO_URING_MAX_FIXED];
+        int             io_uring_nr_fixed;
+#endif
+
         /* node-uuid in pathinfo xattr */
         gf_boolean_t  node_uuid_pathinfo;
 
@@ -150,12 +173,36 @@ struct posix_private {
 		BATCH_SYNCFS,
 		BATCH_SYNCFS_SINGLE_FSYNC,
 		BATCH_REVERSE_FSYNC,
-		BATCH_SYNCFS_REVERSE_FSYNC
+		BATCH_SYNCFS_REVERSE_FSYNC,
+		BATCH_GROUP_COMMIT
 	}               batch_fsync_mode;
 
 	uint32_t        batch_fsync_delay_usec;
+
+	/* group-commit: moving average of one flush and batch stats */
+	uint64_t        fsync_latency_usec;
+	int             fsync_last_batch;
+	uint64_t        fsync_flushes;
+	uint64_t        fsync_waiters;
         gf_boolean_t    update_pgfid_nlinks;
 
+        /* gfid -> O_PATH fd cache of directory handles */
+        uint32_t          hcache_size;     /* max cached fds, 0 disables */
+        gf_boolean_t      hcache_by_handle;
+        pthread_mutex_t   hcache_lock;
+        struct list_head *hcache_table;
+        struct list_head  hcache_lru;      /* entries holding an fd */
+        struct list_head  hcache_handles;  /* entries holding a handle only */
+        uint32_t          hcache_nr_fds;
+        uint32_t          hcache_nr_handles;
+        uint64_t          hcache_hits;
+        uint64_t          hcache_misses;
+        uint64_t          hcache_reopens;
+
+        /* xattr syscalls issued/avoided while filling lookup xattrs */
+        uint64_t          xattr_syscalls[GF_FOP_MAXVALUE];
+        uint64_t          xattr_avoided[GF_FOP_MAXVALUE];
+
         /* seconds to sleep between health checks */
         uint32_t        health_check_interval;
         pthread_t       health_check;
@@ -182,6 +229,13 @@ typedef struct {
         int          fd;
         int          flags;
         int32_t     op_errno;
+        /* lookup fast path: llistxattr() result and value buffer */
+        char        *list;
+        ssize_t      list_size;
+        char        *value;
+        size_t       value_size;
+        uint32_t     nr_syscalls;  /* xattr syscalls issued */
+        uint32_t     nr_avoided;   /* absent keys answered from list */
 } posix_xattr_filler_t;
 
 
@@ -198,7 +252,8 @@ int posix_istat (xlator_t *this, uuid_t gfid, const char *basename,
 int posix_pstat (xlator_t *this, uuid_t gfid, const char *real_path,
                  struct iatt *iatt);
 dict_t *posix_lookup_xattr_fill (xlator_t *this, const char *path,
-                                 loc_t *loc, dict_t *xattr, struct iatt *buf);
+                                 loc_t *loc, dict_t *xattr, struct iatt *buf,
+                                 glusterfs_fop_t fop);
 int posix_handle_pair (xlator_t *this, const char *real_path, char *key,
                        data_t *value, int flags);
 int posix_fhandle_pair (xlator_t *this, int fd, char *key, data_t *value,
@@ -223,6 +278,11 @@ __posix_fd_set_odirect (fd_t *fd, struct posix_fd *pfd, int opflags,
 			off_t offset, size_t size);
 void posix_spawn_health_check_thread (xlator_t *this);
 
+dict_t *_fill_writev_xdata (fd_t *fd, dict_t *xdata, xlator_t *this,
+                            int is_append);
+int posix_write_xattrop (xlator_t *this, fd_t *fd, int _fd, dict_t *xdata,
+                         dict_t **rsp_xdata);
+
 void *posix_fsyncer (void *);
 int
 posix_get_ancestry (xlator_t *this, inode_t *leaf_inode,
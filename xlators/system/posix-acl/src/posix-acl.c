@@ -177,33 +177,18 @@ sticky_permits (call_frame_t *frame, inode_t *parent, inode_t *inode)
 }
 
 
+/* whether @acl lets the caller @want on a file owned by @ctx->uid and
+   @ctx->gid with the mode bits @ctx->perm */
 static int
-acl_permits (call_frame_t *frame, inode_t *inode, int want)
+__acl_permits (call_frame_t *frame, struct posix_acl_ctx *ctx,
+               struct posix_acl *acl, int want)
 {
-        int                     verdict = 0;
-        struct posix_acl       *acl = NULL;
         struct posix_ace       *ace = NULL;
-        struct posix_acl_ctx   *ctx = NULL;
-        struct posix_acl_conf  *conf = NULL;
         int                     i = 0;
         int                     perm = 0;
         int                     found = 0;
         int                     acl_present = 0;
 
-        conf = frame->this->private;
-
-        ctx = posix_acl_ctx_get (inode, frame->this);
-        if (!ctx)
-                goto red;
-
-        if (frame_is_super_user (frame))
-                goto green;
-
-        posix_acl_get (inode, frame->this, &acl, NULL);
-        if (!acl) {
-                acl = posix_acl_ref (frame->this, conf->minimal_acl);
-        }
-
         ace = acl->entries;
 
         if (acl->count > POSIX_ACL_MINIMAL_ACE_COUNT)
@@ -274,13 +259,37 @@ perm_check:
         }
 
 green:
-        verdict = 1;
-        goto out;
+        return 1;
 red:
-        verdict = 0;
-out:
-        if (acl)
-                posix_acl_unref (frame->this, acl);
+        return 0;
+}
+
+
+static int
+acl_permits (call_frame_t *frame, inode_t *inode, int want)
+{
+        int                     verdict = 0;
+        struct posix_acl       *acl = NULL;
+        struct posix_acl_ctx   *ctx = NULL;
+        struct posix_acl_conf  *conf = NULL;
+
+        conf = frame->this->private;
+
+        ctx = posix_acl_ctx_get (inode, frame->this);
+        if (!ctx)
+                return 0;
+
+        if (frame_is_super_user (frame))
+                return 1;
+
+        posix_acl_get (inode, frame->this, &acl, NULL);
+        if (!acl) {
+                acl = posix_acl_ref (frame->this, conf->minimal_acl);
+        }
+
+        verdict = __acl_permits (frame, ctx, acl, want);
+
+        posix_acl_unref (frame->this, acl);
 
         return verdict;
 }
@@ -748,6 +757,96 @@ out:
 }
 
 
+/* The entries of a GF_LOOKUP_PATH reply below @inode are only passed up
+   as far as the caller may search the directories leading to them. Their
+   access ACLs are for this check only and are dropped. */
+static void
+posix_acl_lookup_path (call_frame_t *frame, xlator_t *this, inode_t *inode,
+                       dict_t *xattr)
+{
+        struct posix_acl_conf       *conf = NULL;
+        struct gf_lookup_path_entry *entries = NULL;
+        struct gf_lookup_path_entry *permitted = NULL;
+        struct posix_acl_ctx         ctx = {0,};
+        struct posix_acl            *acl = NULL;
+        struct iatt                  iatt = {0,};
+        data_t                      *data = NULL;
+        char                         key[64] = {0,};
+        int                          count = 0;
+        int                          i = 0;
+        int                          ret = 0;
+
+        conf = this->private;
+
+        data = dict_get (xattr, GF_LOOKUP_PATH);
+        if (!data || (data->len % sizeof (*entries)))
+                goto drop;
+
+        entries = (struct gf_lookup_path_entry *) data->data;
+        count = data->len / sizeof (*entries);
+
+        if (!acl_permits (frame, inode, POSIX_ACL_EXECUTE)) {
+                count = 0;
+                goto drop;
+        }
+
+        if (frame_is_super_user (frame))
+                goto drop;
+
+        /* the i-th entry is reached through the (i-1)-th one */
+        for (i = 1; i < count; i++) {
+                gf_lookup_path_entry_to_iatt (&entries[i - 1], &iatt);
+
+                ctx.uid = iatt.ia_uid;
+                ctx.gid = iatt.ia_gid;
+                ctx.perm = st_mode_from_ia (iatt.ia_prot, iatt.ia_type);
+
+                snprintf (key, sizeof (key), "%s.%d", GF_LOOKUP_PATH_ACL,
+                          i - 1);
+                data = dict_get (xattr, key);
+                if (data)
+                        acl = posix_acl_from_xattr (this, data->data,
+                                                    data->len);
+                else
+                        acl = posix_acl_ref (this, conf->minimal_acl);
+                if (!acl)
+                        break;
+
+                ret = __acl_permits (frame, &ctx, acl, POSIX_ACL_EXECUTE);
+                posix_acl_unref (this, acl);
+                if (!ret)
+                        break;
+        }
+
+        if (i < count) {
+                gf_log (this->name, GF_LOG_TRACE, "lookup-path cut at %d "
+                        "of %d entries", i, count);
+                count = i;
+                permitted = GF_CALLOC (count, sizeof (*entries),
+                                       gf_common_mt_char);
+                if (permitted) {
+                        memcpy (permitted, entries, count * sizeof (*entries));
+                        ret = dict_set_bin (xattr, GF_LOOKUP_PATH, permitted,
+                                            count * sizeof (*entries));
+                        if (ret) {
+                                GF_FREE (permitted);
+                                count = 0;
+                        }
+                } else {
+                        count = 0;
+                }
+        }
+drop:
+        if (!count)
+                dict_del (xattr, GF_LOOKUP_PATH);
+
+        for (i = 0; i < GF_LOOKUP_PATH_MAX_DEPTH; i++) {
+                snprintf (key, sizeof (key), "%s.%d", GF_LOOKUP_PATH_ACL, i);
+                dict_del (xattr, key);
+        }
+}
+
+
 int
 posix_acl_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                       int op_ret, int op_errno, inode_t *inode,
@@ -800,6 +899,9 @@ acl_set:
         if (ret)
                 gf_log (this->name, GF_LOG_WARNING,
                         "failed to set ACL in context");
+
+        if (xattr && dict_get (frame->local, GF_LOOKUP_PATH))
+                posix_acl_lookup_path (frame, this, inode, xattr);
 unwind:
         my_xattr = frame->local;
         frame->local = NULL;